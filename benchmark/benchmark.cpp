@@ -15,6 +15,9 @@ std::map<std::string, std::function<void()>> features {
    { "key", key_benchmarking },
    { "hash", hash_benchmarking },
    { "blake2", blake2_benchmarking },
+   { "unapplied_queue", unapplied_queue_benchmarking },
+   { "platform_timer", platform_timer_benchmarking },
+   { "snapshot", snapshot_benchmarking },
 };
 
 // values to control cout format
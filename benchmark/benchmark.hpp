@@ -19,6 +19,9 @@ void modexp_benchmarking();
 void key_benchmarking();
 void hash_benchmarking();
 void blake2_benchmarking();
+void unapplied_queue_benchmarking();
+void platform_timer_benchmarking();
+void snapshot_benchmarking();
 
 void benchmarking(std::string name, const std::function<void()>& func);
 
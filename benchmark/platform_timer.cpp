@@ -0,0 +1,34 @@
+#include <eosio/chain/platform_timer.hpp>
+#include <eosio/chain/platform_timer_accuracy.hpp>
+
+#include <iostream>
+
+#include <benchmark.hpp>
+
+using namespace eosio::chain;
+
+namespace benchmark {
+
+// arming and cancelling a deadline is done for every transaction and, with the cpu limit of each action, every action
+void platform_timer_benchmarking() {
+   constexpr uint32_t cycles = 1000;
+
+   for( auto [backend, name] : { std::pair{platform_timer::backend_t::native, "native"},
+                                 std::pair{platform_timer::backend_t::watchdog, "watchdog"} } ) {
+      platform_timer t(backend);
+
+      const timer_accuracy a = measure_timer_accuracy(t);
+      std::cout << name << " timer accuracy: min " << a.min << "us max " << a.max << "us mean " << a.mean
+                << "us stddev " << a.stddev << "us" << std::endl;
+
+      auto start_stop = [&]() {
+         for( uint32_t i = 0; i < cycles; ++i ) {
+            t.start(fc::time_point::now() + fc::milliseconds(30));
+            t.stop();
+         }
+      };
+      benchmarking(std::string("timer start/stop x1000 ") + name, start_stop);
+   }
+}
+
+} // benchmark
@@ -0,0 +1,88 @@
+#include <eosio/chain/snapshot.hpp>
+
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include <benchmark.hpp>
+
+using namespace eosio::chain;
+
+namespace benchmark {
+
+namespace {
+
+// stands in for a contract table row: fixed size keys and a value whose size is fixed or varies per row
+struct bench_row {
+   uint64_t          primary_key = 0;
+   uint64_t          payer       = 0;
+   std::vector<char> value;
+};
+
+} // anonymous namespace
+
+} // benchmark
+
+FC_REFLECT(benchmark::bench_row, (primary_key)(payer)(value))
+
+namespace benchmark {
+
+namespace {
+
+constexpr uint32_t num_rows = 100'000;
+
+std::vector<bench_row> make_rows(bool same_size) {
+   std::mt19937_64 rng(0x5eed);
+   std::vector<bench_row> rows(num_rows);
+   for (uint32_t i = 0; i < num_rows; ++i) {
+      rows[i].primary_key = i;
+      rows[i].payer       = rng();
+      rows[i].value.resize(same_size ? 32 : 8 + rng() % 120, static_cast<char>(i));
+   }
+   return rows;
+}
+
+std::string write_snapshot(const std::vector<bench_row>& rows, uint32_t version) {
+   std::ostringstream out;
+   ostream_snapshot_writer writer(out, version);
+   writer.write_section("bench_row", [&](auto& section) {
+      for (const auto& row : rows)
+         section.add_row(row);
+   });
+   writer.finalize();
+   return out.str();
+}
+
+uint64_t read_snapshot(const std::string& bin) {
+   std::istringstream in(bin);
+   istream_snapshot_reader reader(in);
+   uint64_t sum = 0;
+   reader.read_section("bench_row", [&](auto& section) {
+      bench_row row;
+      bool more = !section.empty();
+      while (more) {
+         more = section.read_row(row);
+         sum += row.value.size();
+      }
+   });
+   return sum;
+}
+
+} // anonymous namespace
+
+void snapshot_benchmarking() {
+   for (bool same_size : {true, false}) {
+      const auto rows = make_rows(same_size);
+      const std::string rows_desc = same_size ? "fixed" : "varied";
+      for (uint32_t version = ostream_snapshot_writer::minimum_version; version <= ostream_snapshot_writer::current_version; ++version) {
+         const std::string desc = "v" + std::to_string(version) + " " + rows_desc;
+         std::string bin;
+         benchmarking("write " + desc, [&]() { bin = write_snapshot(rows, version); });
+         uint64_t sum = 0;
+         benchmarking("read " + desc, [&]() { sum = read_snapshot(bin); });
+         std::cout << "   " << desc << ": " << num_rows << " rows, " << bin.size() << " bytes" << std::endl;
+      }
+   }
+}
+
+} // benchmark
@@ -0,0 +1,105 @@
+#include <eosio/chain/unapplied_transaction_queue.hpp>
+#include <eosio/chain/contract_types.hpp>
+
+#include <iostream>
+#include <random>
+
+#include <benchmark.hpp>
+
+using namespace eosio::chain;
+
+namespace benchmark {
+
+namespace {
+
+constexpr uint32_t block_cpu_us         = 200'000;
+constexpr uint32_t num_blocks           = 100;
+constexpr uint32_t trxs_per_block       = 1'000; // arrivals per block interval, more than fits in a block
+constexpr uint32_t num_accounts         = 100;
+constexpr uint32_t heavy_account_every  = 10;    // every 10th account sends expensive transactions
+
+struct stream_trx {
+   transaction_metadata_ptr trx;
+   account_name             first_auth;
+   uint32_t                 cpu_us = 0;
+};
+
+// Deterministic transaction stream standing in for a captured one: mostly cheap transfers with a few accounts
+// sending transactions that are an order of magnitude more expensive.
+std::vector<stream_trx> make_stream() {
+   std::mt19937_64 rng(0x5eed);
+   std::vector<stream_trx> stream;
+   stream.reserve(num_blocks * trxs_per_block);
+   for (uint64_t i = 0; i < num_blocks * trxs_per_block; ++i) {
+      const uint32_t account = rng() % num_accounts;
+      const bool     heavy   = account % heavy_account_every == 0;
+      const uint32_t cpu_us  = heavy ? 2'000 + rng() % 8'000 : 100 + rng() % 400;
+
+      signed_transaction trx;
+      account_name first_auth{"bench"_n.to_uint64_t() + account};
+      trx.expiration = fc::time_point_sec{fc::time_point::now() + fc::hours(1)};
+      trx.actions.emplace_back(std::vector<permission_level>{{first_auth, config::active_name}}, onerror{i, "bench", 5});
+      stream.push_back({transaction_metadata::create_no_recover_keys(std::make_shared<packed_transaction>(std::move(trx)),
+                                                                     transaction_metadata::trx_type::input),
+                        first_auth, cpu_us});
+   }
+   return stream;
+}
+
+struct fill_stats {
+   uint64_t trxs = 0;
+   uint64_t cpu_us = 0;
+};
+
+// Replays the stream into an unapplied_transaction_queue a block interval at a time and fills each block the way
+// the producer does: in queue order until a transaction does not fit the remaining block cpu.
+fill_stats fill_blocks(const std::vector<stream_trx>& stream, bool by_cpu) {
+   std::map<transaction_id_type, const stream_trx*> lookup;
+   std::map<account_name, uint32_t>                 account_cpu; // last observed cpu, stands in for subjective billing
+   for (const auto& s : stream)
+      lookup[s.trx->id()] = &s;
+
+   unapplied_transaction_queue q;
+   if (by_cpu) {
+      q.set_incoming_priority([&](const transaction_metadata_ptr& trx, trx_enum_type) {
+         auto itr = account_cpu.find(lookup.at(trx->id())->first_auth);
+         return itr == account_cpu.end() ? int64_t{0} : -static_cast<int64_t>(itr->second);
+      });
+   }
+
+   fill_stats stats;
+   auto next_arrival = stream.begin();
+   for (uint32_t b = 0; b < num_blocks; ++b) {
+      for (uint32_t i = 0; i < trxs_per_block && next_arrival != stream.end(); ++i, ++next_arrival)
+         q.add_incoming(next_arrival->trx, false, false, {});
+
+      uint32_t remaining = block_cpu_us;
+      for (auto itr = q.incoming_begin(); itr != q.incoming_end();) {
+         const stream_trx& s = *lookup.at(itr->id());
+         account_cpu[s.first_auth] = s.cpu_us;
+         if (s.cpu_us > remaining)
+            break; // block exhausted
+         remaining -= s.cpu_us;
+         ++stats.trxs;
+         stats.cpu_us += s.cpu_us;
+         itr = q.erase(itr);
+      }
+   }
+   return stats;
+}
+
+} // anonymous namespace
+
+void unapplied_queue_benchmarking() {
+   const auto stream = make_stream();
+
+   for (bool by_cpu : {false, true}) {
+      const std::string policy = by_cpu ? "cpu" : "arrival";
+      fill_stats stats;
+      benchmarking("block fill (" + policy + ")", [&]() { stats = fill_blocks(stream, by_cpu); });
+      std::cout << "   " << policy << ": " << stats.trxs / num_blocks << " trxs/block, "
+                << (100 * stats.cpu_us) / (uint64_t{num_blocks} * block_cpu_us) << "% block cpu utilization" << std::endl;
+   }
+}
+
+} // benchmark
@@ -0,0 +1,82 @@
+#include <eosio/chain/action_profiler.hpp>
+#include <eosio/chain/trace.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace eosio::chain {
+
+namespace {
+   std::atomic<uint64_t> next_profiler_id{1};
+
+   // profiler id -> table of the profiler for this thread
+   thread_local std::map<uint64_t, void*> thread_tables;
+}
+
+action_profiler::action_profiler()
+   : id(next_profiler_id++) {}
+
+action_profiler::~action_profiler() = default;
+
+action_profiler::thread_table& action_profiler::local_table() {
+   void*& table = thread_tables[id];
+   if( !table ) {
+      std::lock_guard g( tables_mtx );
+      tables.push_back( std::make_unique<thread_table>() );
+      table = tables.back().get();
+   }
+   return *static_cast<thread_table*>( table );
+}
+
+void action_profiler::record( account_name receiver, action_name action, const stats& s ) {
+   thread_table& t = local_table();
+   std::lock_guard g( t.mtx );
+   t.totals[key_type{receiver, action}] += s;
+}
+
+void action_profiler::record_billed_cpu( const transaction_trace& trace, int64_t billed_cpu_time_us ) {
+   if( billed_cpu_time_us <= 0 )
+      return;
+
+   int64_t total_elapsed_us = 0;
+   for( const auto& at : trace.action_traces )
+      total_elapsed_us += at.elapsed.count();
+   if( total_elapsed_us <= 0 )
+      return;
+
+   thread_table& t = local_table();
+   std::lock_guard g( t.mtx );
+   for( const auto& at : trace.action_traces ) {
+      stats s;
+      s.cpu_billed_us = static_cast<uint64_t>( billed_cpu_time_us * at.elapsed.count() / total_elapsed_us );
+      t.totals[key_type{at.receiver, at.act.name}] += s;
+   }
+}
+
+std::vector<action_profiler::entry> action_profiler::top( size_t k ) const {
+   std::map<key_type, stats> merged;
+   {
+      std::lock_guard g( tables_mtx );
+      for( const auto& t : tables ) {
+         std::lock_guard tg( t->mtx );
+         for( const auto& [key, s] : t->totals )
+            merged[key] += s;
+      }
+   }
+
+   std::vector<entry> result;
+   result.reserve( merged.size() );
+   for( const auto& [key, s] : merged )
+      result.push_back( entry{key.first, key.second, s} );
+
+   auto by_wall_time = []( const entry& lhs, const entry& rhs ) { return lhs.totals.wall_time_us > rhs.totals.wall_time_us; };
+   if( result.size() > k ) {
+      std::partial_sort( result.begin(), result.begin() + k, result.end(), by_wall_time );
+      result.resize( k );
+   } else {
+      std::sort( result.begin(), result.end(), by_wall_time );
+   }
+   return result;
+}
+
+} // namespace eosio::chain
@@ -11,6 +11,7 @@
 #include <eosio/chain/code_object.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/deep_mind.hpp>
+#include <eosio/chain/action_profiler.hpp>
 #include <boost/container/flat_set.hpp>
 
 using boost::container::flat_set;
@@ -49,6 +50,7 @@ apply_context::apply_context(controller& con, transaction_context& trx_ctx, uint
 ,recurse_depth(depth)
 ,first_receiver_action_ordinal(action_ordinal)
 ,action_ordinal(action_ordinal)
+,trace_table_access(con.get_table_access_tracer() != nullptr && !trx_ctx.is_transient())
 ,idx64(*this)
 ,idx128(*this)
 ,idx256(*this)
@@ -81,6 +83,7 @@ void apply_context::exec_one()
    try {
       try {
          action_return_value.clear();
+         db_intrinsic_calls = 0;
          receiver_account = &db.get<account_metadata_object,by_name>( receiver );
          if( !(context_free && control.skip_trx_checks()) ) {
             privileged = receiver_account->is_privileged();
@@ -208,6 +211,15 @@ void apply_context::finalize_trace( action_trace& trace, const fc::time_point& s
    _pending_console_output.clear();
 
    trace.elapsed = fc::time_point::now() - start;
+
+   if( auto* profiler = control.get_action_profiler() ) {
+      int64_t ram_delta = 0;
+      for( const auto& d : trace.account_ram_deltas )
+         ram_delta += d.delta;
+      profiler->record( trace.receiver, trace.act.name,
+                        { .count = 1, .wall_time_us = static_cast<uint64_t>(trace.elapsed.count()),
+                          .ram_delta = ram_delta, .db_calls = db_intrinsic_calls } );
+   }
 }
 
 void apply_context::exec()
@@ -674,10 +686,14 @@ uint32_t apply_context::schedule_action( action&& act_to_schedule, account_name
 }
 
 const table_id_object* apply_context::find_table( name code, name scope, name table ) {
+   if( trace_table_access )
+      trx_context.table_access.reads.insert( table_access_key{code, scope, table} );
    return db.find<table_id_object, by_code_scope_table>(boost::make_tuple(code, scope, table));
 }
 
 const table_id_object& apply_context::find_or_create_table( name code, name scope, name table, const account_name &payer ) {
+   if( trace_table_access )
+      trx_context.table_access.writes.insert( table_access_key{code, scope, table} );
    const auto* existing_tid =  db.find<table_id_object, by_code_scope_table>(boost::make_tuple(code, scope, table));
    if (existing_tid != nullptr) {
       return *existing_tid;
@@ -842,6 +858,7 @@ void apply_context::db_update_i64( int iterator, account_name payer, const char*
 
    const auto& table_obj = keyval_cache.get_table( obj.t_id );
    EOS_ASSERT( table_obj.code == receiver, table_access_violation, "db access violation" );
+   record_table_write( table_obj );
 
 //   require_write_lock( table_obj.scope );
 
@@ -899,6 +916,7 @@ void apply_context::db_remove_i64( int iterator ) {
 
    const auto& table_obj = keyval_cache.get_table( obj.t_id );
    EOS_ASSERT( table_obj.code == receiver, table_access_violation, "db access violation" );
+   record_table_write( table_obj );
 
 //   require_write_lock( table_obj.scope );
 
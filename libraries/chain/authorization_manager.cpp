@@ -130,6 +130,21 @@ namespace eosio { namespace chain {
       });
    }
 
+   void authorization_manager::copy_snapshot( snapshot_reader& snapshot, snapshot_writer& writer, chainbase::allocator<char> alloc,
+                                              const std::function<bool(const std::string&)>& filter ) {
+      authorization_index_set::walk_indices([&]( auto utils ){
+         using section_t = typename decltype(utils)::index_t::value_type;
+
+         // skip the permission_usage_index as its inlined with permission_index
+         if (std::is_same<section_t, permission_usage_object>::value) {
+            return;
+         }
+
+         if (filter(detail::snapshot_section_traits<section_t>::section_name()))
+            copy_snapshot_section<section_t>(snapshot, writer, alloc);
+      });
+   }
+
    const permission_object& authorization_manager::create_permission( account_name account,
                                                                       permission_name name,
                                                                       permission_id_type parent,
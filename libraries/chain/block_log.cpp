@@ -6,8 +6,15 @@
 #include <eosio/chain/log_index.hpp>
 #include <fc/bitutil.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/log/logger_config.hpp> //set_thread_name
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <atomic>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unistd.h>
 
 #if defined(__BYTE_ORDER__)
 static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
@@ -315,7 +322,26 @@ namespace eosio { namespace chain {
          std::tuple<uint64_t, uint32_t, std::string>
          full_validate_blocks(uint32_t last_block_num, const std::filesystem::path& blocks_dir, fc::time_point now);
 
+         /// @return true if the log ends with a complete block entry, which the block positions can be walked back from
+         bool has_valid_tail() {
+            try {
+               const uint64_t pos = last_block_position();
+               if (pos < first_block_position() || pos >= end_of_block_position())
+                  return false;
+               signed_block entry;
+               file.seek(pos);
+               full_validate_block_entry(block_num_at(pos) - 1, {}, entry);
+               return file.tellp() == end_of_block_position();
+            } catch (...) { return false; }
+         }
+
          void construct_index(const std::filesystem::path& index_file_path);
+
+         /// Write the index entries from the last block backwards into an index file already sized for all blocks,
+         /// flushing them every chunk_blocks blocks
+         /// @param on_chunk called with the lowest block number indexed so far, returns false to stop
+         template <typename F>
+         void construct_index_backwards(const std::filesystem::path& index_file_path, uint32_t chunk_blocks, F&& on_chunk);
       };
 
       using block_log_index = eosio::chain::log_index<block_log_exception>;
@@ -434,12 +460,55 @@ namespace eosio { namespace chain {
          }
       }
 
+      template <typename F>
+      void block_log_data::construct_index_backwards(const std::filesystem::path& index_file_path, uint32_t chunk_blocks,
+                                                     F&& on_chunk) {
+         fc::cfile index_file;
+         index_file.set_file_path(index_file_path);
+         index_file.open(fc::cfile::update_rw_mode);
+
+         std::vector<uint64_t> chunk;
+         chunk.reserve(chunk_blocks);
+         uint32_t unindexed = number_of_blocks();
+         for (auto iter = reverse_block_position_iterator{ file, first_block_position(), end_of_block_position() };
+              !iter.done() && unindexed > 0;) {
+            chunk.push_back(iter.get_value_then_advance());
+            if (chunk.size() == chunk_blocks || chunk.size() == unindexed || iter.done()) {
+               std::reverse(chunk.begin(), chunk.end());
+               unindexed -= chunk.size();
+               index_file.seek(unindexed * sizeof(uint64_t));
+               index_file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(uint64_t));
+               index_file.flush();
+               chunk.clear();
+               if (!on_chunk(first_block_num() + unindexed))
+                  return;
+            }
+         }
+         EOS_ASSERT(unindexed == 0, block_log_exception, "${file} is missing the positions of ${n} blocks",
+                    ("file", file.get_file_path())("n", unindexed));
+      }
+
+      /// Background reconstruction of blocks.index from the last block backwards, see basic_block_log::open
+      struct index_rebuild {
+         static constexpr uint32_t chunk_blocks  = 64 * 1024;
+         static constexpr uint32_t anchor_blocks = 1024;
+
+         block_log_data               log_data;
+         uint32_t                     end_block = 0; ///< one past the last block to index
+         uint64_t                     end_pos   = 0; ///< where the entry of end_block starts
+         std::atomic<uint32_t>        indexed_from;  ///< blocks from this one on have their index entry written
+         std::atomic<bool>            stop = false;
+         std::map<uint32_t, uint64_t> anchors;       ///< block positions found by lookups below indexed_from
+         std::thread                  thread;
+      };
+
    } // namespace
 
    struct block_log_verifier {
       chain_id_type chain_id = chain_id_type::empty_chain_id();
 
-      void verify(block_log_data& log, const std::filesystem::path& log_path) {
+      template <typename LogData>
+      void verify(LogData& log, const std::filesystem::path& log_path) {
          if (chain_id.empty()) {
             chain_id = log.chain_id();
          } else {
@@ -450,6 +519,178 @@ namespace eosio { namespace chain {
    };
    using block_log_catalog = eosio::chain::log_catalog<block_log_data, block_log_index, block_log_verifier>;
 
+   namespace {
+
+      namespace bio = boost::iostreams;
+
+      constexpr uint32_t compressed_log_magic   = 0x5a4c4245; // "EBLZ"
+      constexpr uint32_t compressed_log_version = 1;
+
+      struct compressed_log_header {
+         uint32_t magic         = compressed_log_magic;
+         uint32_t version       = compressed_log_version;
+         uint32_t frame_blocks  = 0;
+         uint32_t preamble_size = 0;
+      };
+
+      struct compressed_log_frame {
+         uint64_t pos               = 0; ///< of the compressed frame in the compressed file
+         uint64_t uncompressed_pos  = 0; ///< of the first block of the frame in the uncompressed log
+         uint32_t size              = 0; ///< compressed
+         uint32_t uncompressed_size = 0;
+      };
+
+      struct compressed_log_trailer {
+         uint64_t frames_pos      = 0; ///< of the frame table, followed by the block offsets
+         uint32_t first_block_num = 0;
+         uint32_t num_blocks      = 0;
+         uint32_t num_frames      = 0;
+         uint32_t magic           = compressed_log_magic;
+      };
+
+      // written as is
+      static_assert(sizeof(compressed_log_header) == 16 && sizeof(compressed_log_frame) == 24 && sizeof(compressed_log_trailer) == 24);
+
+      /// Provide the read only view of a compressed retained block log, blocks-<first>-<last>.zlog
+      ///
+      /// +--------+----------+---------+---------+-----+---------+-------------+---------------+---------+
+      /// | header | preamble | Frame 0 | Frame 1 | ... | Frame N | frame table | block offsets | trailer |
+      /// +--------+----------+---------+---------+-----+---------+-------------+---------------+---------+
+      ///
+      /// A frame is the zlib compressed run of frame_blocks consecutive entries of the uncompressed log, each block
+      /// with its trailing position, so a block is read by decompressing only its frame. The block offsets are the
+      /// uint32_t offset of each block within its frame; with the uncompressed position of the frame they are the
+      /// blocks.index of the uncompressed log, which the preamble and frames reproduce byte for byte.
+      class compressed_block_log_data {
+         fc::datastream<fc::cfile> file;
+         compressed_log_header  header;
+         block_log_preamble     preamble;
+         compressed_log_trailer trailer;
+         uint32_t               cached_frame = std::numeric_limits<uint32_t>::max();
+         std::vector<char>      frame_data;
+
+         template <typename T>
+         T read_at(uint64_t pos) {
+            T value;
+            file.seek(pos);
+            file.read(reinterpret_cast<char*>(&value), sizeof(value));
+            return value;
+         }
+
+       public:
+         compressed_block_log_data() = default;
+         explicit compressed_block_log_data(const std::filesystem::path& path) { open(path); }
+
+         void open(const std::filesystem::path& path) {
+            if (file.is_open())
+               file.close();
+            cached_frame = std::numeric_limits<uint32_t>::max();
+            file.set_file_path(path);
+            file.open("rb");
+            header = read_at<compressed_log_header>(0);
+            EOS_ASSERT(header.magic == compressed_log_magic && header.version == compressed_log_version && header.frame_blocks > 0,
+                       block_log_exception, "${path} is not a compressed block log", ("path", path));
+            file.seek(sizeof(header));
+            preamble.read_from(file, path);
+            file.seek_end(-static_cast<long>(sizeof(trailer)));
+            file.read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+            EOS_ASSERT(trailer.magic == compressed_log_magic && trailer.first_block_num == preamble.first_block_num &&
+                       trailer.num_frames == (trailer.num_blocks + header.frame_blocks - 1) / header.frame_blocks,
+                       block_log_exception, "${path} is truncated", ("path", path));
+         }
+
+         void copy_preamble_to(fc::cfile& out) {
+            file.seek(sizeof(header));
+            copy_file_content(file, out, header.preamble_size);
+         }
+
+         const compressed_log_header&  get_header() const { return header; }
+         const block_log_preamble&     get_preamble() const { return preamble; }
+         uint32_t                      first_block_num() const { return trailer.first_block_num; }
+         uint32_t                      last_block_num() const { return trailer.first_block_num + trailer.num_blocks - 1; }
+         uint32_t                      num_blocks() const { return trailer.num_blocks; }
+         uint32_t                      num_frames() const { return trailer.num_frames; }
+         chain_id_type                 chain_id() const { return preamble.chain_id(); }
+
+         compressed_log_frame frame_at(uint32_t frame_num) {
+            return read_at<compressed_log_frame>(trailer.frames_pos + frame_num * sizeof(compressed_log_frame));
+         }
+
+         uint32_t block_offset(uint32_t block_num) {
+            const uint64_t offsets_pos = trailer.frames_pos + num_frames() * sizeof(compressed_log_frame);
+            return read_at<uint32_t>(offsets_pos + (block_num - first_block_num()) * sizeof(uint32_t));
+         }
+
+         /// decompressed entries of a frame, valid until the next call
+         const std::vector<char>& read_frame(uint32_t frame_num) {
+            if (frame_num == cached_frame)
+               return frame_data;
+            const compressed_log_frame frame = frame_at(frame_num);
+            std::vector<char> compressed(frame.size);
+            file.seek(frame.pos);
+            file.read(compressed.data(), compressed.size());
+
+            frame_data.clear();
+            frame_data.reserve(frame.uncompressed_size);
+            bio::filtering_ostream decomp;
+            decomp.push(bio::zlib_decompressor());
+            decomp.push(bio::back_inserter(frame_data));
+            bio::write(decomp, compressed.data(), compressed.size());
+            bio::close(decomp);
+            EOS_ASSERT(frame_data.size() == frame.uncompressed_size, block_log_exception,
+                       "frame ${f} of ${path} decompressed to ${s} bytes, expected ${e}",
+                       ("f", frame_num)("path", file.get_file_path())("s", frame_data.size())("e", frame.uncompressed_size));
+            cached_frame = frame_num;
+            return frame_data;
+         }
+
+         /// stream positioned at block_num, valid until the next call
+         std::optional<fc::datastream<const char*>> ro_stream_for_block(uint32_t block_num) {
+            if (block_num < first_block_num() || block_num > last_block_num())
+               return {};
+            const uint32_t           offset = block_offset(block_num);
+            const std::vector<char>& data   = read_frame((block_num - first_block_num()) / header.frame_blocks);
+            EOS_ASSERT(offset < data.size(), block_log_exception, "invalid offset of block ${n} in ${path}",
+                       ("n", block_num)("path", file.get_file_path()));
+            return fc::datastream<const char*>(data.data() + offset, data.size() - offset);
+         }
+      };
+
+      /// Compressed retained block logs found at startup, see block_log::compress_blocklog
+      struct compressed_block_log_catalog {
+         std::map<uint32_t, std::pair<uint32_t, std::filesystem::path>> collection; ///< first -> last, file
+         std::optional<uint32_t>   active; ///< first block num of the open file
+         compressed_block_log_data log_data;
+
+         void open(const std::filesystem::path& retained_dir, block_log_verifier& verifier) {
+            for_each_file_in_dir_matches(retained_dir, R"(blocks-\d+-\d+\.zlog)", [&](const std::filesystem::path& path) {
+               compressed_block_log_data log(path);
+               verifier.verify(log, path);
+               if (!collection.emplace(log.first_block_num(), std::make_pair(log.last_block_num(), path)).second)
+                  wlog("${path} overlaps another compressed block log, dropping it from the catalog", ("path", path));
+            });
+         }
+
+         bool     empty() const { return collection.empty(); }
+         uint32_t first_block_num() const { return collection.begin()->first; }
+         uint32_t last_block_num() const { return collection.rbegin()->second.first; }
+
+         std::optional<fc::datastream<const char*>> ro_stream_for_block(uint32_t block_num) {
+            auto it = collection.upper_bound(block_num);
+            if (it == collection.begin() || block_num > std::prev(it)->second.first)
+               return {};
+            --it;
+            if (active != it->first) {
+               active.reset();
+               log_data.open(it->second.second);
+               active = it->first;
+            }
+            return log_data.ro_stream_for_block(block_num);
+         }
+      };
+
+   } // namespace
+
    namespace detail {
 
       static bool is_pruned_log_and_mask_version(uint32_t& version) {
@@ -523,11 +764,14 @@ namespace eosio { namespace chain {
          fc::datastream<fc::cfile> index_file;
          block_log_preamble        preamble;
          bool                      genesis_written_to_block_log = false;
+         std::unique_ptr<index_rebuild> rebuild; // while blocks.index is reconstructed in the background
 
          basic_block_log() = default;
 
          explicit basic_block_log(std::filesystem::path log_dir) { open(log_dir); }
 
+         ~basic_block_log() override { stop_index_rebuild(); }
+
          static void ensure_file_exists(fc::cfile& f) {
             if (std::filesystem::exists(f.get_file_path()))
                return;
@@ -557,6 +801,7 @@ namespace eosio { namespace chain {
          virtual void             post_append(uint64_t pos) {}
          virtual signed_block_ptr retry_read_block_by_num(uint32_t block_num) { return {}; }
          virtual std::optional<signed_block_header> retry_read_block_header_by_num(uint32_t block_num) { return {}; }
+         virtual bool             rebuild_index_in_background() const { return true; }
 
          void append(const signed_block_ptr& b, const block_id_type& id,
                      const std::vector<char>& packed_block) override {
@@ -591,12 +836,102 @@ namespace eosio { namespace chain {
             if (!(head && block_num <= block_header::num_from_id(head->id) &&
                   block_num >= working_block_file_first_block_num()))
                return block_log::npos;
-            index_file.seek(sizeof(uint64_t) * (block_num - index_first_block_num()));
-            uint64_t pos;
+            if (rebuild && block_num < rebuild->indexed_from)
+               return find_unindexed_block_pos(block_num);
+            return read_index_entry(block_num);
+         }
+
+         uint64_t read_index_entry(uint32_t block_num) {
+            const uint64_t offset = sizeof(uint64_t) * (block_num - index_first_block_num());
+            uint64_t       pos;
+            if (rebuild) {
+               // the rebuild thread writes through its own file, bypass the read buffer of index_file which may predate it
+               EOS_ASSERT(::pread(index_file.fileno(), &pos, sizeof(pos), offset) == static_cast<ssize_t>(sizeof(pos)), block_log_exception,
+                          "failed to read the position of block ${n} from ${file}", ("n", block_num)("file", index_file.get_file_path()));
+               return pos;
+            }
+            index_file.seek(offset);
             index_file.read((char*)&pos, sizeof(pos));
             return pos;
          }
 
+         /// slow path of get_block_pos() while blocks.index is rebuilt, walk the block positions back from the closest
+         /// known position above block_num
+         uint64_t find_unindexed_block_pos(uint32_t block_num) {
+            const uint32_t indexed_from = rebuild->indexed_from;
+            uint32_t       from_block   = indexed_from;
+            uint64_t       pos          = 0;
+            if (auto it = rebuild->anchors.lower_bound(block_num); it != rebuild->anchors.end() && it->first < indexed_from) {
+               from_block = it->first;
+               pos        = it->second;
+            } else {
+               pos = indexed_from == rebuild->end_block ? rebuild->end_pos : read_index_entry(indexed_from);
+            }
+
+            for (uint32_t n = from_block; n > block_num; --n) {
+               uint64_t prev_pos;
+               block_file.seek(pos - sizeof(uint64_t));
+               block_file.read((char*)&prev_pos, sizeof(prev_pos));
+               EOS_ASSERT(prev_pos < pos, block_log_exception, "invalid position of block ${n} in ${file}",
+                          ("n", n - 1)("file", block_file.get_file_path()));
+               pos = prev_pos;
+               if ((n - 1) % index_rebuild::anchor_blocks == 0)
+                  rebuild->anchors.emplace(n - 1, pos);
+            }
+            return pos;
+         }
+
+         static std::filesystem::path index_rebuild_marker(const std::filesystem::path& index_path) {
+            return std::filesystem::path(index_path).replace_extension("index.rebuild");
+         }
+
+         /// Reconstruct blocks.index on a thread while blocks are read and appended, num_blocks is the number of
+         /// blocks in the log at open
+         void start_index_rebuild(uint32_t num_blocks) {
+            const auto index_path = index_file.get_file_path();
+            auto       r          = std::make_unique<index_rebuild>();
+            r->log_data.open(block_file.get_file_path());
+            r->end_block    = preamble.first_block_num + num_blocks;
+            r->end_pos      = r->log_data.end_of_block_position();
+            r->indexed_from = r->end_block;
+            r->thread       = std::thread([r = r.get(), index_path]() {
+               fc::set_thread_name("blocklog-index");
+               try {
+                  r->log_data.construct_index_backwards(index_path, index_rebuild::chunk_blocks, [r](uint32_t lowest) {
+                     r->indexed_from = lowest;
+                     return !r->stop;
+                  });
+                  if (!r->stop) {
+                     std::filesystem::remove(index_rebuild_marker(index_path));
+                     ilog("Reconstructed ${file}", ("file", index_path));
+                  }
+                  r->log_data.close();
+               } FC_LOG_AND_DROP()
+            });
+            rebuild = std::move(r);
+         }
+
+         /// wait for the reconstruction of blocks.index to complete, e.g. before the index is moved
+         void finish_index_rebuild() {
+            if (!rebuild)
+               return;
+            if (rebuild->thread.joinable())
+               rebuild->thread.join();
+            EOS_ASSERT(rebuild->indexed_from == index_first_block_num(), block_log_exception,
+                       "failed to reconstruct ${file}", ("file", index_file.get_file_path()));
+            rebuild.reset();
+         }
+
+         /// abandon the reconstruction of blocks.index, its marker makes the next open start over unless it completed
+         void stop_index_rebuild() {
+            if (!rebuild)
+               return;
+            rebuild->stop = true;
+            if (rebuild->thread.joinable())
+               rebuild->thread.join();
+            rebuild.reset();
+         }
+
          signed_block_ptr read_block_by_num(uint32_t block_num) final {
             try {
                uint64_t pos = get_block_pos(block_num);
@@ -644,8 +979,8 @@ namespace eosio { namespace chain {
              *
              * Checking the heads of the files has several conditions as well.
              *  - If they are the same, do nothing.
-             *  - If the index file head is not in the log file, delete the index and replay.
-             *  - If the index file head is in the log, but not up to date, replay from index head.
+             *  - Otherwise the index is reconstructed, in the background from the last block backwards unless the
+             *    log is pruned. Blocks not indexed yet are found by walking the block positions back.
              */
             ensure_file_exists(block_file);
             ensure_file_exists(index_file);
@@ -663,30 +998,40 @@ namespace eosio { namespace chain {
                uint32_t number_of_blocks = log_data.number_of_blocks();
                ilog("Log has ${n} blocks", ("n", number_of_blocks));
 
-               EOS_ASSERT(index_size || number_of_blocks == 0, block_log_exception,
-                          "${index_file} file is empty, please use leap-util to fix the problem.",
-                          ("index_file", index_file.get_file_path().string()));
-               EOS_ASSERT(index_size % sizeof(uint64_t) == 0, block_log_exception,
-                          "${index_file} file is invalid, please use leap-util to reconstruct the index.",
-                          ("index_file", index_file.get_file_path().string()));
-
-               if (index_size) {
-                  block_log_index index(index_file.get_file_path());
-                  auto last_block_pos = log_data.last_block_position();
-                  auto last_index_pos = index.back();
-
-                  EOS_ASSERT(last_block_pos == last_index_pos, block_log_exception,
-                             "The last block position from ${block_file} is at ${block_pos} "
-                             "which does not match the last block postion ${index_pos} from ${index_file}, please use "
-                             "leap-util to fix the inconsistency.",
-                             ("block_pos", last_block_pos)("index_pos", last_index_pos)
-                             ("block_file", block_file.get_file_path().string())
-                             ("index_file", index_file.get_file_path().string()));
+               const auto index_path  = index_file.get_file_path();
+               bool       index_valid = index_size && index_size % sizeof(uint64_t) == 0 &&
+                                        !std::filesystem::exists(index_rebuild_marker(index_path));
+               if (index_valid) {
+                  block_log_index index(index_path);
+                  index_valid = index.back() == log_data.last_block_position();
+               }
+
+               bool rebuild_in_background = false;
+               if (!index_valid && number_of_blocks > 0) {
+                  EOS_ASSERT(log_data.has_valid_tail(), block_log_exception,
+                             "${block_file} does not end with a complete block and does not match ${index_file}, please "
+                             "use leap-util to fix the inconsistency.",
+                             ("block_file", block_file.get_file_path().string())("index_file", index_path.string()));
+                  if (preamble.is_currently_pruned() || !rebuild_index_in_background()) {
+                     log_data.construct_index(index_path);
+                  } else {
+                     ilog("Reconstructing ${index_file} in the background", ("index_file", index_path.string()));
+                     std::filesystem::resize_file(index_path, number_of_blocks * sizeof(uint64_t));
+                     fc::cfile marker;
+                     marker.set_file_path(index_rebuild_marker(index_path));
+                     ensure_file_exists(marker);
+                     rebuild_in_background = true;
+                  }
+               } else if (!index_valid && index_size) {
+                  std::filesystem::resize_file(index_path, 0);
                }
                log_data.close();
 
                transform_block_log();
 
+               if (rebuild_in_background)
+                  start_index_rebuild(number_of_blocks);
+
             } else if (index_size) {
                ilog("Log file is empty while the index file is nonempty, discard the index file");
                std::filesystem::resize_file(index_file.get_file_path(), 0);
@@ -709,6 +1054,8 @@ namespace eosio { namespace chain {
 
          void reset(uint32_t first_bnum, std::variant<genesis_state, chain_id_type>&& chain_context, uint32_t version) {
 
+            stop_index_rebuild();
+            std::filesystem::remove(index_rebuild_marker(index_file.get_file_path()));
             block_file.open(fc::cfile::truncate_rw_mode);
             preamble.ver             = version | (preamble.ver & pruned_version_flag);
             preamble.first_block_num = first_bnum;
@@ -940,19 +1287,23 @@ namespace eosio { namespace chain {
       };
 
       struct partitioned_block_log final : basic_block_log {
-         block_log_catalog catalog;
-         const size_t      stride;
+         block_log_catalog            catalog;
+         compressed_block_log_catalog compressed_catalog; // read only, not subject to max_retained_files
+         const size_t                 stride;
 
          partitioned_block_log(const std::filesystem::path& log_dir, const partitioned_blocklog_config& config) : stride(config.stride) {
             catalog.open(log_dir, config.retained_dir, config.archive_dir, "blocks");
             catalog.max_retained_files = config.max_retained_files;
+            compressed_catalog.open(catalog.retained_dir, catalog.verifier);
 
             open(log_dir);
             const auto log_size = std::filesystem::file_size(block_file.get_file_path());
 
-            if (log_size == 0 && !catalog.empty()) {
-               basic_block_log::reset(catalog.verifier.chain_id, catalog.last_block_num() + 1);
-               update_head(read_block_by_num(catalog.last_block_num()));
+            if (log_size == 0 && (!catalog.empty() || !compressed_catalog.empty())) {
+               const uint32_t last_block_num = compressed_catalog.empty() ? catalog.last_block_num()
+                                                                          : std::max(catalog.last_block_num(), compressed_catalog.last_block_num());
+               basic_block_log::reset(catalog.verifier.chain_id, last_block_num + 1);
+               update_head(read_block_by_num(last_block_num));
             } else {
                EOS_ASSERT(catalog.verifier.chain_id.empty() || catalog.verifier.chain_id == preamble.chain_id(),
                           block_log_exception, "block log file ${path} has a different chain id",
@@ -961,6 +1312,9 @@ namespace eosio { namespace chain {
          }
 
          void split_log() {
+            // the index moves to the retained dir with the log
+            finish_index_rebuild();
+
             fc::datastream<fc::cfile> new_block_file;
             fc::datastream<fc::cfile> new_index_file;
 
@@ -1008,6 +1362,8 @@ namespace eosio { namespace chain {
          }
 
          uint32_t first_block_num() final {
+            if (!compressed_catalog.empty())
+               return std::min(catalog.first_block_num(), compressed_catalog.first_block_num()); // max() when empty
             if (!catalog.empty())
                return catalog.collection.begin()->first;
             return preamble.first_block_num;
@@ -1023,6 +1379,9 @@ namespace eosio { namespace chain {
             auto ds = catalog.ro_stream_for_block(block_num);
             if (ds)
                return read_block(*ds, block_num);
+            auto cds = compressed_catalog.ro_stream_for_block(block_num);
+            if (cds)
+               return read_block(*cds, block_num);
             return {};
          }
 
@@ -1030,6 +1389,9 @@ namespace eosio { namespace chain {
             auto ds = catalog.ro_stream_for_block(block_num);
             if (ds)
                return read_block_header(*ds, block_num);
+            auto cds = compressed_catalog.ro_stream_for_block(block_num);
+            if (cds)
+               return read_block_header(*cds, block_num);
             return {};
          }
 
@@ -1068,6 +1430,8 @@ namespace eosio { namespace chain {
 
          uint32_t first_block_num() final { return first_block_number; }
          uint32_t working_block_file_first_block_num() final { return first_block_number; }
+         // pruning and vacuuming need the whole index
+         bool     rebuild_index_in_background() const final { return false; }
 
          void transform_block_log() final {
             // convert from  non-pruned block log to pruned if necessary
@@ -1373,7 +1737,7 @@ namespace eosio { namespace chain {
                                                                             const std::filesystem::path& retained_dir) {
       std::filesystem::path first_block_file;
       if (!retained_dir.empty() && std::filesystem::exists(retained_dir)) {
-         for_each_file_in_dir_matches(retained_dir, R"(blocks-1-\d+\.log)",
+         for_each_file_in_dir_matches(retained_dir, R"(blocks-1-\d+\.z?log)",
                                       [&](std::filesystem::path log_path) {
                                           first_block_file = std::move(log_path);
                                       });
@@ -1384,11 +1748,13 @@ namespace eosio { namespace chain {
       }
 
       if (!first_block_file.empty()) {
+         if (first_block_file.extension() == ".zlog")
+            return compressed_block_log_data(first_block_file).get_preamble().chain_context;
          return block_log_data(first_block_file).get_preamble().chain_context;
       }
       
       if (!retained_dir.empty() && std::filesystem::exists(retained_dir)) {
-         const std::regex        my_filter(R"(blocks-\d+-\d+\.log)");
+         const std::regex        my_filter(R"(blocks-\d+-\d+\.z?log)");
          std::smatch             what;
          std::filesystem::directory_iterator end_itr; // Default ctor yields past-the-end
          for (std::filesystem::directory_iterator p(retained_dir); p != end_itr; ++p) {
@@ -1399,6 +1765,8 @@ namespace eosio { namespace chain {
             std::string file = p->path().filename().string();
             if (!std::regex_match(file, what, my_filter))
                continue;
+            if (p->path().extension() == ".zlog")
+               return compressed_block_log_data(p->path()).chain_id();
             return block_log_data(p->path()).chain_id();
          }
       }
@@ -1721,4 +2089,106 @@ namespace eosio { namespace chain {
       }
    }
 
+   // static
+   std::filesystem::path block_log::compress_blocklog(const std::filesystem::path& block_file, uint32_t frame_blocks) {
+      EOS_ASSERT(frame_blocks > 0, block_log_exception, "frame_blocks must be greater than 0");
+
+      std::filesystem::path index_file      = std::filesystem::path(block_file).replace_extension("index");
+      std::filesystem::path compressed_file = std::filesystem::path(block_file).replace_extension("zlog");
+      std::filesystem::path tmp_file        = std::filesystem::path(block_file).replace_extension("zlog.tmp");
+
+      block_log_bundle log_bundle(block_file, index_file);
+      block_log_data&  log_data   = log_bundle.log_data;
+      const uint32_t   num_blocks = log_data.num_blocks();
+      EOS_ASSERT(num_blocks > 0, block_log_exception, "${file} contains no blocks", ("file", block_file));
+
+      fc::cfile out;
+      out.set_file_path(tmp_file);
+      out.open(fc::cfile::truncate_rw_mode);
+
+      compressed_log_header header{ .frame_blocks  = frame_blocks,
+                                    .preamble_size = static_cast<uint32_t>(log_data.first_block_position()) };
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      copy_file_content(log_data.ro_stream_at(0), out, header.preamble_size);
+
+      std::vector<compressed_log_frame> frames;
+      std::vector<uint32_t>             offsets;
+      offsets.reserve(num_blocks);
+      std::vector<char> data, compressed;
+      for (uint32_t first = 0; first < num_blocks; first += frame_blocks) {
+         const uint32_t end       = std::min(first + frame_blocks, num_blocks);
+         const uint64_t begin_pos = log_bundle.log_index.nth_block_position(first);
+         const uint64_t end_pos   = end < num_blocks ? log_bundle.log_index.nth_block_position(end) : log_data.end_of_block_position();
+         EOS_ASSERT(end_pos - begin_pos <= std::numeric_limits<uint32_t>::max(), block_log_exception,
+                    "blocks ${b} to ${e} of ${file} do not fit in a frame, use fewer blocks per frame",
+                    ("b", log_data.first_block_num() + first)("e", log_data.first_block_num() + end - 1)("file", block_file));
+         for (uint32_t i = first; i < end; ++i)
+            offsets.push_back(log_bundle.log_index.nth_block_position(i) - begin_pos);
+
+         data.resize(end_pos - begin_pos);
+         log_data.ro_stream_at(begin_pos).read(data.data(), data.size());
+         compressed.clear();
+         bio::filtering_ostream comp;
+         comp.push(bio::zlib_compressor(bio::zlib::best_compression));
+         comp.push(bio::back_inserter(compressed));
+         bio::write(comp, data.data(), data.size());
+         bio::close(comp);
+
+         frames.push_back(compressed_log_frame{ .pos               = out.tellp(),
+                                                .uncompressed_pos  = begin_pos,
+                                                .size              = static_cast<uint32_t>(compressed.size()),
+                                                .uncompressed_size = static_cast<uint32_t>(data.size()) });
+         out.write(compressed.data(), compressed.size());
+      }
+
+      compressed_log_trailer trailer{ .frames_pos      = out.tellp(),
+                                      .first_block_num = log_data.first_block_num(),
+                                      .num_blocks      = num_blocks,
+                                      .num_frames      = static_cast<uint32_t>(frames.size()) };
+      out.write(reinterpret_cast<const char*>(frames.data()), frames.size() * sizeof(compressed_log_frame));
+      out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint32_t));
+      out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+      out.flush();
+      out.close();
+
+      std::filesystem::rename(tmp_file, compressed_file);
+      ilog("Compressed ${file} to ${compressed}, ${s} of ${o} bytes",
+           ("file", block_file)("compressed", compressed_file)("s", std::filesystem::file_size(compressed_file))("o", log_data.size()));
+      return compressed_file;
+   }
+
+   // static
+   std::filesystem::path block_log::decompress_blocklog(const std::filesystem::path& compressed_file) {
+      compressed_block_log_data log_data(compressed_file);
+
+      std::filesystem::path block_file = std::filesystem::path(compressed_file).replace_extension("log");
+      std::filesystem::path index_file = std::filesystem::path(compressed_file).replace_extension("index");
+      EOS_ASSERT(!std::filesystem::exists(block_file), block_log_exception, "${file} already exists", ("file", block_file));
+
+      fc::cfile out, index;
+      out.set_file_path(block_file);
+      out.open(fc::cfile::truncate_rw_mode);
+      index.set_file_path(index_file);
+      index.open(fc::cfile::truncate_rw_mode);
+
+      log_data.copy_preamble_to(out);
+      for (uint32_t f = 0; f < log_data.num_frames(); ++f) {
+         const compressed_log_frame frame = log_data.frame_at(f);
+         EOS_ASSERT(out.tellp() == frame.uncompressed_pos, block_log_exception,
+                    "frame ${f} of ${file} does not follow the previous frame", ("f", f)("file", compressed_file));
+         const std::vector<char>& data = log_data.read_frame(f);
+         out.write(data.data(), data.size());
+
+         const uint32_t first = log_data.first_block_num() + f * log_data.get_header().frame_blocks;
+         const uint32_t last  = std::min(first + log_data.get_header().frame_blocks - 1, log_data.last_block_num());
+         for (uint32_t block_num = first; block_num <= last; ++block_num) {
+            const uint64_t pos = frame.uncompressed_pos + log_data.block_offset(block_num);
+            index.write(reinterpret_cast<const char*>(&pos), sizeof(pos));
+         }
+      }
+      out.flush();
+      index.flush();
+      return block_file;
+   }
+
 }} // namespace eosio::chain
@@ -26,15 +26,19 @@
 #include <eosio/chain/thread_utils.hpp>
 #include <eosio/chain/platform_timer.hpp>
 #include <eosio/chain/deep_mind.hpp>
+#include <eosio/chain/table_access_tracer.hpp>
 #include <eosio/chain/wasm_interface_collection.hpp>
 
 #include <chainbase/chainbase.hpp>
+#include <boost/interprocess/managed_heap_memory.hpp>
 #include <eosio/vm/allocator.hpp>
+#include <fc/io/fstream.hpp>
 #include <fc/io/json.hpp>
 #include <fc/log/logger_config.hpp>
 #include <fc/scoped_exit.hpp>
 #include <fc/variant_object.hpp>
 
+#include <fstream>
 #include <new>
 #include <shared_mutex>
 
@@ -249,7 +253,11 @@ struct controller_impl {
    struct chain; // chain is a namespace so use an embedded type for the named_thread_pool tag
    named_thread_pool<chain>        thread_pool;
    deep_mind_handler*              deep_mind_logger = nullptr;
+   action_profiler*                action_prof = nullptr;
+   table_access_tracer*            table_access_trace = nullptr;
    bool                            okay_to_print_integrity_hash_on_stop = false;
+   std::optional<state_checkpoint_writer> checkpoint_writer;
+   std::optional<uint32_t>         next_checkpoint_block_num; ///< head block num from which an interval checkpoint is due
 
    thread_local static platform_timer timer; // a copy for main thread and each read-only thread
 #if defined(EOSIO_EOS_VM_RUNTIME_ENABLED) || defined(EOSIO_EOS_VM_JIT_RUNTIME_ENABLED)
@@ -322,6 +330,14 @@ struct controller_impl {
                            { check_protocol_features( timestamp, cur_features, new_features ); }
       );
 
+      if( !cfg.state_checkpoint.dir.empty() ) {
+         // a checkpoint reads the state file, which only holds the state when it is mapped
+         EOS_ASSERT( cfg.db_map_mode == pinnable_mapped_file::map_mode::mapped && !cfg.read_only, state_checkpoint_exception,
+                     "state checkpoints require the database map mode \"mapped\" and a writable state" );
+         checkpoint_writer.emplace( cfg.state_checkpoint, cfg.state_dir / "shared_memory.bin",
+                                    cfg.blocks_dir / config::reversible_blocks_dir_name );
+      }
+
       thread_pool.start( cfg.thread_pool_size, [this]( const fc::exception& e ) {
          elog( "Exception in chain thread pool, exiting: ${e}", ("e", e.to_detail_string()) );
          if( shutdown ) shutdown();
@@ -736,6 +752,8 @@ struct controller_impl {
 
       if( check_shutdown() ) return;
 
+      preinstantiate_recently_used_code();
+
       // At this point head != nullptr && fork_db.head() != nullptr && fork_db.root() != nullptr.
       // Furthermore, fork_db.root()->block_num <= lib_num.
       // Also, even though blog.head() may still be nullptr, blog.first_block_num() is guaranteed to be lib_num + 1.
@@ -759,6 +777,7 @@ struct controller_impl {
 
    ~controller_impl() {
       thread_pool.stop();
+      write_recently_used_code();
       pending.reset();
       //only log this not just if configured to, but also if initialization made it to the point we'd log the startup too
       if(okay_to_print_integrity_hash_on_stop && conf.integrity_hash_on_stop)
@@ -783,28 +802,33 @@ struct controller_impl {
                   */
    }
 
-   void add_contract_tables_to_snapshot( const snapshot_writer_ptr& snapshot ) const {
-      snapshot->write_section("contract_tables", [this]( auto& section ) {
-         index_utils<table_id_multi_index>::walk(db, [this, &section]( const table_id_object& table_row ){
-            // add a row for the table
-            section.add_row(table_row, db);
+   template<typename Section>
+   void add_contract_table_to_snapshot( Section& section, const table_id_object& table_row ) const {
+      // add a row for the table
+      section.add_row(table_row, db);
 
-            // followed by a size row and then N data rows for each type of table
-            contract_database_index_set::walk_indices([this, &section, &table_row]( auto utils ) {
-               using utils_t = decltype(utils);
-               using value_t = typename decltype(utils)::index_t::value_type;
-               using by_table_id = object_to_table_id_tag_t<value_t>;
+      // followed by a size row and then N data rows for each type of table
+      contract_database_index_set::walk_indices([this, &section, &table_row]( auto utils ) {
+         using utils_t = decltype(utils);
+         using value_t = typename decltype(utils)::index_t::value_type;
+         using by_table_id = object_to_table_id_tag_t<value_t>;
 
-               auto tid_key = boost::make_tuple(table_row.id);
-               auto next_tid_key = boost::make_tuple(table_id_object::id_type(table_row.id._id + 1));
+         auto tid_key = boost::make_tuple(table_row.id);
+         auto next_tid_key = boost::make_tuple(table_id_object::id_type(table_row.id._id + 1));
 
-               unsigned_int size = utils_t::template size_range<by_table_id>(db, tid_key, next_tid_key);
-               section.add_row(size, db);
+         unsigned_int size = utils_t::template size_range<by_table_id>(db, tid_key, next_tid_key);
+         section.add_row(size, db);
 
-               utils_t::template walk_range<by_table_id>(db, tid_key, next_tid_key, [this, &section]( const auto &row ) {
-                  section.add_row(row, db);
-               });
-            });
+         utils_t::template walk_range<by_table_id>(db, tid_key, next_tid_key, [this, &section]( const auto &row ) {
+            section.add_row(row, db);
+         });
+      });
+   }
+
+   void add_contract_tables_to_snapshot( snapshot_writer& snapshot ) const {
+      snapshot.write_section("contract_tables", [this]( auto& section ) {
+         index_utils<table_id_multi_index>::walk(db, [this, &section]( const table_id_object& table_row ){
+            add_contract_table_to_snapshot(section, table_row);
          });
       });
    }
@@ -842,6 +866,11 @@ struct controller_impl {
       // clear in case the previous call to clear did not finish in time of deadline
       clear_expired_input_transactions( fc::time_point::maximum() );
 
+      add_sections_to_snapshot( snapshot );
+   }
+
+   /// does not modify the database, so sections can be written from several threads at once
+   void add_sections_to_snapshot( const snapshot_writer_ptr& snapshot ) const {
       snapshot->write_section<chain_snapshot_header>([this]( auto &section ){
          section.add_row(chain_snapshot_header(), db);
       });
@@ -870,7 +899,7 @@ struct controller_impl {
          });
       });
 
-      add_contract_tables_to_snapshot(snapshot);
+      add_contract_tables_to_snapshot(*snapshot);
 
       authorization.add_to_snapshot(snapshot);
       resource_limits.add_to_snapshot(snapshot);
@@ -1023,6 +1052,95 @@ struct controller_impl {
       return enc.result();
    }
 
+   controller::sectioned_integrity_hash calculate_sectioned_integrity_hash( const controller::integrity_hash_progress_callback& progress ) {
+      clear_expired_input_transactions( fc::time_point::maximum() );
+
+      // names of the sections in snapshot order, without walking any rows
+      struct section_name_writer : snapshot_writer {
+         mutable std::vector<std::string> names;
+         bool accepts_section( const std::string& section_name ) const override {
+            names.push_back(section_name);
+            return false;
+         }
+         void write_start_section( const std::string& ) override {}
+         void write_row( const detail::abstract_snapshot_row_writer& ) override {}
+         void write_end_section() override {}
+      };
+      auto name_writer = std::make_shared<section_name_writer>();
+      add_sections_to_snapshot(name_writer);
+
+      std::vector<const table_id_object*> tables;
+      index_utils<table_id_multi_index>::walk(db, [&tables]( const table_id_object& table_row ){
+         tables.push_back(&table_row);
+      });
+
+      // each section, and each chunk of contract tables, is hashed by its own task on the thread pool; the state is
+      // only read so the tasks need no synchronization beyond the progress count
+      static constexpr size_t tables_per_task = 256;
+      const uint32_t total = name_writer->names.size() + tables.size();
+      std::atomic<uint32_t> done = 0;
+      auto report = [&]( uint32_t n ) {
+         const uint32_t d = done += n;
+         if( progress )
+            progress( d, total );
+      };
+
+      std::vector<digest_type> section_hashes( name_writer->names.size() );
+      std::vector<digest_type> table_hashes( tables.size() );
+      std::vector<std::future<void>> tasks;
+      for( size_t i = 0; i < name_writer->names.size(); ++i ) {
+         if( name_writer->names[i] == "contract_tables" )
+            continue;
+         tasks.emplace_back( post_async_task( thread_pool.get_executor(), [&, i]() {
+            sha256::encoder enc;
+            auto hash_writer = std::make_shared<integrity_hash_snapshot_writer>( enc, name_writer->names[i] );
+            add_sections_to_snapshot( hash_writer );
+            section_hashes[i] = enc.result();
+            report( 1 );
+         } ) );
+      }
+      for( size_t first = 0; first < tables.size(); first += tables_per_task ) {
+         tasks.emplace_back( post_async_task( thread_pool.get_executor(), [&, first]() {
+            const size_t last = std::min( first + tables_per_task, tables.size() );
+            for( size_t t = first; t < last; ++t ) {
+               sha256::encoder enc;
+               integrity_hash_snapshot_writer hash_writer( enc );
+               hash_writer.write_section( "contract_tables", [&]( auto& section ) {
+                  add_contract_table_to_snapshot( section, *tables[t] );
+               } );
+               table_hashes[t] = enc.result();
+            }
+            report( last - first );
+         } ) );
+      }
+
+      // wait for every task before rethrowing, the tasks reference this frame
+      std::exception_ptr except;
+      for( auto& t : tasks ) {
+         try {
+            t.get();
+         } catch( ... ) {
+            if( !except )
+               except = std::current_exception();
+         }
+      }
+      if( except )
+         std::rethrow_exception( except );
+
+      controller::sectioned_integrity_hash result;
+      deque<digest_type> leaves;
+      for( size_t i = 0; i < name_writer->names.size(); ++i ) {
+         if( name_writer->names[i] == "contract_tables" ) {
+            section_hashes[i] = merkle( deque<digest_type>( table_hashes.begin(), table_hashes.end() ) );
+            report( 1 ); // the section itself, counted in total along with its tables
+         }
+         leaves.push_back( section_hashes[i] );
+         result.sections.emplace_back( name_writer->names[i], section_hashes[i] );
+      }
+      result.root = merkle( std::move(leaves) );
+      return result;
+   }
+
    void create_native_account( const fc::time_point& initial_timestamp, account_name name, const authority& owner, const authority& active, bool is_privileged = false ) {
       db.create<account_object>([&](auto& a) {
          a.name = name;
@@ -1401,6 +1519,9 @@ struct controller_impl {
 
          restore.cancel();
 
+         if( table_access_trace )
+            table_access_trace->on_applied_transaction( gtrx.trx_id, trace->receipt->cpu_usage_us, std::move(trx_context.table_access) );
+
          pending->_block_report.total_net_usage += trace->net_usage;
          pending->_block_report.total_cpu_usage_us += trace->receipt->cpu_usage_us;
          pending->_block_report.total_elapsed_time += trace->elapsed;
@@ -1644,6 +1765,8 @@ struct controller_impl {
             } else {
                restore.cancel();
                trx_context.squash();
+               if( table_access_trace && !trx->implicit() )
+                  table_access_trace->on_applied_transaction( trx->id(), trace->receipt->cpu_usage_us, std::move(trx_context.table_access) );
             }
 
             if( !trx->is_transient() ) {
@@ -1695,12 +1818,28 @@ struct controller_impl {
 
       emit( self.block_start, head->block_num + 1 );
 
+      // between blocks the state is not modified. A checkpoint reads and hashes the whole state file, so it is never
+      // written at the start of a block being produced, the producer_plugin writes it when it has time between blocks.
+      // Checked first as the first check starts the interval from the head.
+      if( state_checkpoint_due() && s != controller::block_status::incomplete ) {
+         try {
+            write_state_checkpoint();
+         } catch( const fc::exception& e ) {
+            elog( "unable to write state checkpoint at block ${b}: ${e}", ("b", head->block_num)("e", e.to_detail_string()) );
+         } catch( const std::exception& e ) {
+            elog( "unable to write state checkpoint at block ${b}: ${e}", ("b", head->block_num)("e", e.what()) );
+         }
+      }
+
       // at block level, no transaction specific logging is possible
       if (auto dm_logger = get_deep_mind_logger(false)) {
          // The head block represents the block just before this one that is about to start, so add 1 to get this block num
          dm_logger->on_start_block(head->block_num + 1);
       }
 
+      if( table_access_trace )
+         table_access_trace->on_start_block( head->block_num + 1 );
+
       auto guard_pending = fc::make_scoped_exit([this, head_block_num=head->block_num](){
          protocol_features.popped_blocks_to( head_block_num );
          pending.reset();
@@ -1955,6 +2094,9 @@ struct controller_impl {
             dm_logger->on_accepted_block(bsp);
          }
 
+         if( table_access_trace )
+            table_access_trace->on_accepted_block( bsp->block_num );
+
          emit( self.accepted_block, bsp );
 
          if( s == controller::block_status::incomplete ) {
@@ -2700,6 +2842,83 @@ struct controller_impl {
       wasm_if_collect.code_block_num_last_used(code_hash, vm_type, vm_version, block_num);
    }
 
+   /// an interval checkpoint is due once the head reaches the multiple of the interval following the last checkpoint,
+   /// and only of a head which startup would take from the fork database on restore, e.g. not while switching forks
+   bool state_checkpoint_due() {
+      if( !checkpoint_writer || checkpoint_writer->config().interval_blocks == 0 )
+         return false;
+      const uint32_t interval = checkpoint_writer->config().interval_blocks;
+      if( !next_checkpoint_block_num )
+         next_checkpoint_block_num = (head->block_num + interval - 1) / interval * interval;
+      if( head->block_num < *next_checkpoint_block_num )
+         return false;
+      auto restored_head = read_mode == db_read_mode::IRREVERSIBLE ? fork_db.root() : fork_db.head();
+      return restored_head && restored_head->id == head->id;
+   }
+
+   state_checkpoint_info write_state_checkpoint() {
+      // a speculative block restarted on the same head is not checkpointed again, also when this checkpoint fails
+      if( const uint32_t interval = checkpoint_writer->config().interval_blocks; interval > 0 )
+         next_checkpoint_block_num = (head->block_num / interval + 1) * interval;
+      return checkpoint_writer->write( chain_id, head->block_num, head->id );
+   }
+
+   void preinstantiate_code(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, const bytes& code) {
+      if( replaying || !conf.wasm_preinstantiate )
+         return;
+      // evictable once the block is irreversible if the code was never applied, e.g. setcode of a failed transaction
+      wasm_if_collect.preinstantiate(code_hash, vm_type, vm_version, code.data(), code.size(), head->block_num + 1);
+   }
+
+   static constexpr uint32_t recently_used_code_magic_number = 0x52554344;
+   static constexpr size_t   max_recently_used_code = 64;
+
+   // preinstantiate the code most recently applied before the last shutdown
+   void preinstantiate_recently_used_code() {
+      const auto filename = conf.state_dir / config::recently_used_code_filename;
+      if( !conf.wasm_preinstantiate || !std::filesystem::exists( filename ) )
+         return;
+      try {
+         string content;
+         fc::read_file_contents( filename, content );
+         fc::datastream<const char*> ds( content.data(), content.size() );
+
+         uint32_t totem = 0;
+         fc::raw::unpack( ds, totem );
+         EOS_ASSERT( totem == recently_used_code_magic_number, misc_exception,
+                     "Recently used code file '${f}' has unexpected magic number", ("f", filename) );
+
+         fc::unsigned_int size;
+         fc::raw::unpack( ds, size );
+         for( uint32_t i = 0; i < size.value && i < max_recently_used_code; ++i ) {
+            digest_type code_hash;
+            uint8_t vm_type = 0, vm_version = 0;
+            fc::raw::unpack( ds, code_hash );
+            fc::raw::unpack( ds, vm_type );
+            fc::raw::unpack( ds, vm_version );
+            if( const auto* code = db.find<code_object, by_code_hash>( boost::make_tuple( code_hash, vm_type, vm_version ) ) )
+               wasm_if_collect.preinstantiate( code_hash, vm_type, vm_version, code->code.data(), code->code.size(), UINT32_MAX );
+         }
+      } FC_LOG_AND_DROP()
+   }
+
+   void write_recently_used_code() {
+      try {
+         const auto code = wasm_if_collect.recently_used_code( max_recently_used_code );
+         if( code.empty() )
+            return; // keep the previous list, nothing was applied since startup
+         const auto filename = conf.state_dir / config::recently_used_code_filename;
+         std::ofstream out( filename.generic_string().c_str(), std::ios::out | std::ios::binary | std::ofstream::trunc );
+         fc::raw::pack( out, recently_used_code_magic_number );
+         fc::raw::pack( out, fc::unsigned_int( code.size() ) );
+         for( const auto& [code_hash, vm_type, vm_version] : code ) {
+            fc::raw::pack( out, code_hash );
+            fc::raw::pack( out, vm_type );
+            fc::raw::pack( out, vm_version );
+         }
+      } FC_LOG_AND_DROP()
+   }
+
    block_state_ptr fork_db_head() const;
 }; /// controller_impl
 
@@ -3218,11 +3437,26 @@ sha256 controller::calculate_integrity_hash() { try {
    return my->calculate_integrity_hash();
 } FC_LOG_AND_RETHROW() }
 
+controller::sectioned_integrity_hash controller::calculate_sectioned_integrity_hash( const integrity_hash_progress_callback& progress ) { try {
+   EOS_ASSERT( !my->pending, block_validate_exception, "cannot calculate a consistent integrity hash with a pending block" );
+   return my->calculate_sectioned_integrity_hash( progress );
+} FC_LOG_AND_RETHROW() }
+
 void controller::write_snapshot( const snapshot_writer_ptr& snapshot ) {
    EOS_ASSERT( !my->pending, block_validate_exception, "cannot take a consistent snapshot with a pending block" );
    return my->add_to_snapshot(snapshot);
 }
 
+state_checkpoint_info controller::write_state_checkpoint() {
+   EOS_ASSERT( my->checkpoint_writer, state_checkpoint_exception, "no state checkpoint directory configured" );
+   EOS_ASSERT( !my->pending, block_validate_exception, "cannot take a consistent state checkpoint with a pending block" );
+   return my->write_state_checkpoint();
+}
+
+bool controller::is_state_checkpoint_due()const {
+   return my->state_checkpoint_due();
+}
+
 int64_t controller::set_proposed_producers( vector<producer_authority> producers ) {
    const auto& gpo = get_global_properties();
    auto cur_block_num = head_block_num() + 1;
@@ -3566,6 +3800,24 @@ void controller::enable_deep_mind(deep_mind_handler* logger) {
    my->deep_mind_logger = logger;
 }
 
+action_profiler* controller::get_action_profiler()const {
+   return my->action_prof;
+}
+
+void controller::enable_action_profiler(action_profiler* profiler) {
+   EOS_ASSERT( profiler != nullptr, misc_exception, "Invalid profiler passed into enable_action_profiler, must be set" );
+   my->action_prof = profiler;
+}
+
+table_access_tracer* controller::get_table_access_tracer()const {
+   return my->table_access_trace;
+}
+
+void controller::enable_table_access_tracer(table_access_tracer* tracer) {
+   EOS_ASSERT( tracer != nullptr, misc_exception, "Invalid tracer passed into enable_table_access_tracer, must be set" );
+   my->table_access_trace = tracer;
+}
+
 uint32_t controller::earliest_available_block_num() const{
    return my->earliest_available_block_num();
 }
@@ -3624,6 +3876,77 @@ chain_id_type controller::extract_chain_id(snapshot_reader& snapshot) {
    return chain_id;
 }
 
+void controller::copy_snapshot(snapshot_reader& snapshot, snapshot_writer& writer,
+                               const std::function<bool(const std::string&)>& filter) {
+   // rows are unpacked one at a time, the heap only has to hold the largest row, e.g. a contract's code
+   static constexpr size_t row_heap_size = 64*1024*1024;
+   boost::interprocess::managed_heap_memory row_heap(row_heap_size);
+   chainbase::allocator<char> alloc(row_heap.get_segment_manager());
+
+   chain_snapshot_header header;
+   snapshot.read_section<chain_snapshot_header>([&header]( auto &section ){
+      section.read_row(header);
+      header.validate();
+   });
+   using v4 = legacy::snapshot_global_property_object_v4;
+   EOS_ASSERT( header.version > v4::maximum_version, snapshot_exception,
+               "Snapshot version ${v} holds legacy rows, load it into a database to upgrade them", ("v", header.version) );
+
+   if (filter(detail::snapshot_section_traits<chain_snapshot_header>::section_name()))
+      copy_snapshot_section<chain_snapshot_header>(snapshot, writer, alloc);
+
+   if (filter(detail::snapshot_section_traits<block_state>::section_name()))
+      copy_snapshot_section<block_header_state>(snapshot, writer, alloc, detail::snapshot_section_traits<block_state>::section_name());
+
+   controller_index_set::walk_indices([&]( auto utils ){
+      using value_t = typename decltype(utils)::index_t::value_type;
+
+      // skip the table_id_object as its inlined with contract tables section
+      if (std::is_same<value_t, table_id_object>::value) {
+         return;
+      }
+
+      // skip the database_header as it is only relevant to in-memory database
+      if (std::is_same<value_t, database_header_object>::value) {
+         return;
+      }
+
+      if (filter(detail::snapshot_section_traits<value_t>::section_name()))
+         copy_snapshot_section<value_t>(snapshot, writer, alloc);
+   });
+
+   if (filter("contract_tables")) {
+      snapshot.read_section("contract_tables", [&]( auto& in ) {
+         writer.write_section("contract_tables", [&]( auto& out ) {
+            bool more = !in.empty();
+            while (more) {
+               // the row for the table followed by a size row and then N data rows for each type of table
+               table_id_object table_row([](auto&){}, alloc);
+               in.read_row(table_row);
+               out.add_row(table_row);
+
+               contract_database_index_set::walk_indices([&]( auto utils ) {
+                  using value_t = typename decltype(utils)::index_t::value_type;
+
+                  unsigned_int size;
+                  more = in.read_row(size);
+                  out.add_row(size);
+
+                  for (size_t idx = 0; idx < size.value; idx++) {
+                     value_t row([](auto&){}, alloc);
+                     more = in.read_row(row);
+                     out.add_row(row);
+                  }
+               });
+            }
+         });
+      });
+   }
+
+   authorization_manager::copy_snapshot(snapshot, writer, alloc, filter);
+   resource_limits_manager::copy_snapshot(snapshot, writer, alloc, filter);
+}
+
 std::optional<chain_id_type> controller::extract_chain_id_from_db( const path& state_dir ) {
    try {
       chainbase::database db( state_dir, chainbase::database::read_only );
@@ -3715,6 +4038,10 @@ void controller::code_block_num_last_used(const digest_type& code_hash, uint8_t
    return my->code_block_num_last_used(code_hash, vm_type, vm_version, block_num);
 }
 
+void controller::preinstantiate_code(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, const bytes& code) {
+   my->preinstantiate_code(code_hash, vm_type, vm_version, code);
+}
+
 /// Protocol feature activation handlers:
 
 template<>
@@ -185,6 +185,7 @@ void apply_eosio_setcode(apply_context& context) {
             o.vm_version = act.vmversion;
          });
       }
+      context.control.preinstantiate_code(code_hash, act.vmtype, act.vmversion, act.code);
    }
 
    db.modify( account, [&]( auto& a ) {
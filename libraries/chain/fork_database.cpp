@@ -7,6 +7,8 @@
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/global_fun.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/io/cfile.hpp>
 #include <fc/io/fstream.hpp>
 #include <fstream>
 #include <shared_mutex>
@@ -16,9 +18,10 @@ namespace eosio { namespace chain {
    using namespace boost::multi_index;
 
    const uint32_t fork_database::magic_number = 0x30510FDB;
+   const uint32_t fork_database::journal_magic_number = 0x30510FDC;
 
    const uint32_t fork_database::min_supported_version = 1;
-   const uint32_t fork_database::max_supported_version = 1;
+   const uint32_t fork_database::max_supported_version = 2;
 
    // work around block_state::is_valid being private
    inline bool block_state_is_valid( const block_state& bs ) {
@@ -28,8 +31,28 @@ namespace eosio { namespace chain {
    /**
     * History:
     * Version 1: initial version of the new refactored fork database portable format
+    * Version 2: generation of the journal that applies on top of the file, appended after the head block id
     */
 
+   /**
+    * Journal format:
+    *   header: journal_magic_number (uint32_t), generation (uint64_t)
+    *   records: payload size (uint32_t), city_hash32 of payload (uint32_t), payload
+    *   payload: journal_op (uint8_t) followed by its argument
+    *
+    * A record that is truncated or fails its checksum ends the journal, it was being written when the node crashed.
+    */
+   enum class journal_op : uint8_t {
+      add                   = 1, ///< block_state
+      mark_valid            = 2, ///< block_id_type
+      advance_root          = 3, ///< block_id_type
+      remove                = 4, ///< block_id_type
+      rollback_head_to_root = 5  ///< no argument
+   };
+
+   // the journal is compacted once larger than both this and the last fork_db.dat written
+   constexpr uint64_t min_journal_compaction_size = 64*1024*1024;
+
    struct by_block_id;
    struct by_lib_block_num;
    struct by_prev;
@@ -70,12 +93,24 @@ namespace eosio { namespace chain {
       block_state_ptr       root; // Only uses the block_header_state portion
       block_state_ptr       head;
       std::filesystem::path datadir;
+      fc::datastream<fc::cfile> journal;           // modifications since fork_db.dat was written, open after open_impl
+      uint64_t              journal_generation = 0; // matches the generation written in fork_db.dat
+      uint64_t              compacted_size = 0;     // size of fork_db.dat when last written
 
       void open_impl( const std::function<void( block_timestamp_type,
                                                 const flat_set<digest_type>&,
                                                 const vector<digest_type>& )>& validator );
       void close_impl();
 
+      bool replay_journal( const std::filesystem::path& journal_file, uint64_t generation,
+                           const std::function<void( block_timestamp_type,
+                                                     const flat_set<digest_type>&,
+                                                     const vector<digest_type>& )>& validator );
+      template<typename... T>
+      void journal_append( journal_op op, const T&... args );
+      void write_fork_db( const std::filesystem::path& fork_db_file, uint64_t generation );
+      void compact();
+
 
       block_header_state_ptr  get_block_header_impl( const block_id_type& id )const;
       block_state_ptr         get_block_impl( const block_id_type& id )const;
@@ -118,6 +153,8 @@ namespace eosio { namespace chain {
          std::filesystem::create_directories(datadir);
 
       auto fork_db_dat = datadir / config::forkdb_filename;
+      auto fork_db_journal = datadir / config::forkdb_journal_filename;
+      bool journal_replayed = false;
       if( std::filesystem::exists( fork_db_dat ) ) {
          try {
             string content;
@@ -162,6 +199,9 @@ namespace eosio { namespace chain {
             }
             block_id_type head_id;
             fc::raw::unpack( ds, head_id );
+            uint64_t generation = 0;
+            if( version >= 2 )
+               fc::raw::unpack( ds, generation );
 
             if( root->id == head_id ) {
                head = root;
@@ -182,10 +222,150 @@ namespace eosio { namespace chain {
                            "head not set to best available option available; '${filename}' is likely corrupted",
                            ("filename", fork_db_dat) );
             }
-         } FC_CAPTURE_AND_RETHROW( (fork_db_dat) )
 
-         std::filesystem::remove( fork_db_dat );
+            compacted_size = content.size();
+            journal_generation = generation;
+            if( version >= 2 && std::filesystem::exists( fork_db_journal ) )
+               journal_replayed = replay_journal( fork_db_journal, generation, validator );
+         } FC_CAPTURE_AND_RETHROW( (fork_db_dat)(fork_db_journal) )
+      }
+
+      if( journal_replayed ) {
+         journal.set_file_path( fork_db_journal );
+         journal.open( fc::cfile::create_or_update_rw_mode );
+         journal.seek_end( 0 );
+      } else if( root ) {
+         // written by a version without journal, or its journal belongs to an older fork_db.dat
+         compact();
       }
+      // otherwise the journal is started by the first reset
+   }
+
+   bool fork_database_impl::replay_journal( const std::filesystem::path& journal_file, uint64_t generation,
+                                            const std::function<void( block_timestamp_type,
+                                                                      const flat_set<digest_type>&,
+                                                                      const vector<digest_type>& )>& validator )
+   {
+      string content;
+      fc::read_file_contents( journal_file, content );
+
+      fc::datastream<const char*> ds( content.data(), content.size() );
+
+      uint32_t totem = 0;
+      uint64_t journal_gen = 0;
+      if( ds.remaining() < sizeof(totem) + sizeof(journal_gen) )
+         return false;
+      fc::raw::unpack( ds, totem );
+      EOS_ASSERT( totem == fork_database::journal_magic_number, fork_database_exception,
+                  "Fork database journal '${filename}' has unexpected magic number: ${actual_totem}. Expected ${expected_totem}",
+                  ("filename", journal_file)
+                  ("actual_totem", totem)
+                  ("expected_totem", fork_database::journal_magic_number)
+      );
+      fc::raw::unpack( ds, journal_gen );
+      if( journal_gen != generation )
+         return false; // left behind by a compaction that was interrupted, fork_db.dat already includes it
+
+      uint32_t num_records = 0;
+      size_t end_of_records = ds.tellp();
+      while( ds.remaining() >= 2 * sizeof(uint32_t) ) {
+         uint32_t size = 0, checksum = 0;
+         fc::raw::unpack( ds, size );
+         fc::raw::unpack( ds, checksum );
+         if( ds.remaining() < size || fc::city_hash32( ds.pos(), size ) != checksum )
+            break;
+
+         fc::datastream<const char*> record( ds.pos(), size );
+         ds.skip( size );
+
+         uint8_t op = 0;
+         fc::raw::unpack( record, op );
+         switch( static_cast<journal_op>(op) ) {
+            case journal_op::add: {
+               block_state s;
+               fc::raw::unpack( record, s );
+               // do not populate transaction_metadatas, they will be created as needed in apply_block with appropriate key recovery
+               s.header_exts = s.block->validate_and_extract_header_extensions();
+               add_impl( std::make_shared<block_state>( std::move( s ) ), false, true, validator );
+               break;
+            }
+            case journal_op::mark_valid: {
+               block_id_type id;
+               fc::raw::unpack( record, id );
+               auto bsp = get_block_impl( id );
+               EOS_ASSERT( bsp, fork_database_exception,
+                           "block ${id} marked valid in fork database journal '${filename}' does not exist",
+                           ("id", id)("filename", journal_file) );
+               mark_valid_impl( bsp );
+               break;
+            }
+            case journal_op::advance_root: {
+               block_id_type id;
+               fc::raw::unpack( record, id );
+               advance_root_impl( id );
+               break;
+            }
+            case journal_op::remove: {
+               block_id_type id;
+               fc::raw::unpack( record, id );
+               remove_impl( id );
+               break;
+            }
+            case journal_op::rollback_head_to_root:
+               rollback_head_to_root_impl();
+               break;
+            default:
+               EOS_THROW( fork_database_exception, "Fork database journal '${filename}' has unknown operation ${op}",
+                          ("filename", journal_file)("op", op) );
+         }
+         ++num_records;
+         end_of_records = ds.tellp();
+      }
+
+      if( end_of_records != content.size() ) {
+         wlog( "discarding incomplete record at the end of fork database journal '${filename}', ${n} bytes",
+               ("filename", journal_file)("n", content.size() - end_of_records) );
+         std::filesystem::resize_file( journal_file, end_of_records );
+      }
+      ilog( "replayed ${n} records of fork database journal", ("n", num_records) );
+      return true;
+   }
+
+   template<typename... T>
+   void fork_database_impl::journal_append( journal_op op, const T&... args ) {
+      if( !journal.is_open() )
+         return;
+
+      fc::datastream<size_t> ps;
+      fc::raw::pack( ps, static_cast<uint8_t>(op) );
+      ( fc::raw::pack( ps, args ), ... );
+      std::vector<char> payload( ps.tellp() );
+      fc::datastream<char*> ds( payload.data(), payload.size() );
+      fc::raw::pack( ds, static_cast<uint8_t>(op) );
+      ( fc::raw::pack( ds, args ), ... );
+
+      fc::raw::pack( journal, static_cast<uint32_t>(payload.size()) );
+      fc::raw::pack( journal, fc::city_hash32( payload.data(), payload.size() ) );
+      journal.write( payload.data(), payload.size() );
+      // hand the record to the OS so that it survives the process crashing
+      journal.flush();
+   }
+
+   void fork_database_impl::compact() {
+      const auto fork_db_dat = datadir / config::forkdb_filename;
+      const auto fork_db_tmp = datadir / (std::string( config::forkdb_filename ) + ".tmp");
+      const uint64_t generation = journal_generation + 1;
+
+      write_fork_db( fork_db_tmp, generation );
+      std::filesystem::rename( fork_db_tmp, fork_db_dat );
+
+      // a crash before the new journal is written leaves the journal of the previous generation, which open_impl ignores
+      journal.set_file_path( datadir / config::forkdb_journal_filename );
+      journal.open( fc::cfile::truncate_rw_mode );
+      fc::raw::pack( journal, fork_database::journal_magic_number );
+      fc::raw::pack( journal, generation );
+      journal.flush();
+      journal_generation = generation;
    }
 
    void fork_database::close() {
@@ -194,17 +374,26 @@ namespace eosio { namespace chain {
    }
 
    void fork_database_impl::close_impl() {
-      auto fork_db_dat = datadir / config::forkdb_filename;
-
       if( !root ) {
          if( index.size() > 0 ) {
-            elog( "fork_database is in a bad state when closing; not writing out '${filename}'",
-                  ("filename", fork_db_dat) );
+            elog( "fork_database is in a bad state when closing; '${filename}' is likely unusable",
+                  ("filename", datadir / config::forkdb_journal_filename) );
          }
          return;
       }
 
-      std::ofstream out( fork_db_dat.generic_string().c_str(), std::ios::out | std::ios::binary | std::ofstream::trunc );
+      if( journal.is_open() ) {
+         journal.flush();
+         journal.close();
+      }
+
+      index.clear();
+   }
+
+   void fork_database_impl::write_fork_db( const std::filesystem::path& fork_db_file, uint64_t generation ) {
+      fc::datastream<fc::cfile> out;
+      out.set_file_path( fork_db_file );
+      out.open( fc::cfile::truncate_rw_mode );
       fc::raw::pack( out, fork_database::magic_number );
       fc::raw::pack( out, fork_database::max_supported_version ); // write out current version which is always max_supported_version
       fc::raw::pack( out, *static_cast<block_header_state*>(&*root) );
@@ -250,10 +439,13 @@ namespace eosio { namespace chain {
          fc::raw::pack( out, head->id );
       } else {
          elog( "head not set in fork database; '${filename}' will be corrupted",
-               ("filename", fork_db_dat) );
+               ("filename", fork_db_file) );
       }
+      fc::raw::pack( out, generation );
 
-      index.clear();
+      out.flush();
+      out.sync();
+      compacted_size = out.tellp();
    }
 
    fork_database::~fork_database() {
@@ -263,6 +455,7 @@ namespace eosio { namespace chain {
    void fork_database::reset( const block_header_state& root_bhs ) {
       std::lock_guard g( my->mtx );
       my->reset_impl(root_bhs);
+      my->compact();
    }
 
    void fork_database_impl::reset_impl( const block_header_state& root_bhs ) {
@@ -276,6 +469,7 @@ namespace eosio { namespace chain {
    void fork_database::rollback_head_to_root() {
       std::lock_guard g( my->mtx );
       my->rollback_head_to_root_impl();
+      my->journal_append( journal_op::rollback_head_to_root );
    }
 
    void fork_database_impl::rollback_head_to_root_impl() {
@@ -293,6 +487,9 @@ namespace eosio { namespace chain {
    void fork_database::advance_root( const block_id_type& id ) {
       std::lock_guard g( my->mtx );
       my->advance_root_impl( id );
+      my->journal_append( journal_op::advance_root, id );
+      if( my->journal.is_open() && my->journal.tellp() > std::max( min_journal_compaction_size, my->compacted_size ) )
+         my->compact();
    }
 
    void fork_database_impl::advance_root_impl( const block_id_type& id ) {
@@ -384,12 +581,15 @@ namespace eosio { namespace chain {
 
    void fork_database::add( const block_state_ptr& n, bool ignore_duplicate ) {
       std::lock_guard g( my->mtx );
+      const auto num_blocks = my->index.size();
       my->add_impl( n, ignore_duplicate, false,
                     []( block_timestamp_type timestamp,
                         const flat_set<digest_type>& cur_features,
                         const vector<digest_type>& new_features )
                     {}
       );
+      if( my->index.size() != num_blocks ) // not an ignored duplicate
+         my->journal_append( journal_op::add, *n );
    }
 
    block_state_ptr fork_database::root()const {
@@ -516,7 +716,8 @@ namespace eosio { namespace chain {
    /// remove all of the invalid forks built off of this id including this id
    void fork_database::remove( const block_id_type& id ) {
       std::lock_guard g( my->mtx );
-      return my->remove_impl( id );
+      my->remove_impl( id );
+      my->journal_append( journal_op::remove, id );
    }
 
    void fork_database_impl::remove_impl( const block_id_type& id ) {
@@ -542,7 +743,9 @@ namespace eosio { namespace chain {
 
    void fork_database::mark_valid( const block_state_ptr& h ) {
       std::lock_guard g( my->mtx );
+      if( h->validated ) return;
       my->mark_valid_impl( h );
+      my->journal_append( journal_op::mark_valid, h->id );
    }
 
    void fork_database_impl::mark_valid_impl( const block_state_ptr& h ) {
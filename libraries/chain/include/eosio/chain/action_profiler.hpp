@@ -0,0 +1,76 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eosio::chain {
+
+struct transaction_trace;
+
+/**
+ * Opt-in aggregation of action execution costs per (receiver, action name), enabled with
+ * controller::enable_action_profiler.
+ *
+ * Samples are recorded from apply_context::exec_one on the main thread and the read-only threads. Each thread
+ * records into its own table so recording only takes an uncontended lock; top() merges the tables.
+ */
+class action_profiler {
+public:
+   struct stats {
+      uint64_t count         = 0; ///< number of executions
+      uint64_t wall_time_us  = 0; ///< elapsed time of the executions
+      uint64_t cpu_billed_us = 0; ///< billed cpu of the transactions, attributed to their actions in proportion to elapsed time
+      int64_t  ram_delta     = 0; ///< sum of the account ram deltas
+      uint64_t db_calls      = 0; ///< number of database intrinsic calls
+
+      stats& operator+=( const stats& s ) {
+         count         += s.count;
+         wall_time_us  += s.wall_time_us;
+         cpu_billed_us += s.cpu_billed_us;
+         ram_delta     += s.ram_delta;
+         db_calls      += s.db_calls;
+         return *this;
+      }
+   };
+
+   struct entry {
+      account_name receiver;
+      action_name  action;
+      stats        totals;
+   };
+
+   action_profiler();
+   ~action_profiler();
+
+   action_profiler( const action_profiler& ) = delete;
+   action_profiler& operator=( const action_profiler& ) = delete;
+
+   /// thread safe
+   void record( account_name receiver, action_name action, const stats& s );
+
+   /// attribute the billed cpu of a transaction to its actions in proportion to their elapsed time, thread safe
+   void record_billed_cpu( const transaction_trace& trace, int64_t billed_cpu_time_us );
+
+   /// totals since the profiler was created of the k entries with the highest wall time, thread safe
+   std::vector<entry> top( size_t k ) const;
+
+private:
+   using key_type = std::pair<account_name, action_name>;
+
+   struct thread_table {
+      std::mutex                 mtx;
+      std::map<key_type, stats>  totals;
+   };
+
+   thread_table& local_table();
+
+   const uint64_t                              id; ///< key of the thread local table lookup, never reused
+   mutable std::mutex                          tables_mtx;
+   std::vector<std::unique_ptr<thread_table>>  tables;
+};
+
+} // namespace eosio::chain
@@ -217,6 +217,7 @@ class apply_context {
 
                const auto& table_obj = itr_cache.get_table( obj.t_id );
                EOS_ASSERT( table_obj.code == context.receiver, table_access_violation, "db access violation" );
+               context.record_table_write( table_obj );
 
                if (auto dm_logger = context.control.get_deep_mind_logger(context.trx_context.is_transient())) {
                   std::string event_id = RAM_EVENT_ID("${code}:${scope}:${table}:${index_name}",
@@ -250,6 +251,7 @@ class apply_context {
 
                const auto& table_obj = itr_cache.get_table( obj.t_id );
                EOS_ASSERT( table_obj.code == context.receiver, table_access_violation, "db access violation" );
+               context.record_table_write( table_obj );
 
 //               context.require_write_lock( table_obj.scope );
 
@@ -573,6 +575,11 @@ class apply_context {
       const table_id_object& find_or_create_table( name code, name scope, name table, const account_name &payer );
       void                   remove_table( const table_id_object& tid );
 
+      void record_table_write( const table_id_object& tid ) {
+         if( trace_table_access )
+            trx_context.table_access.writes.insert( table_access_key{tid.code, tid.scope, tid.table} );
+      }
+
       int  db_store_i64( name code, name scope, name table, const account_name& payer, uint64_t id, const char* buffer, size_t buffer_size );
 
 
@@ -617,9 +624,11 @@ class apply_context {
       uint32_t                      action_ordinal = 0;
       bool                          privileged   = false;
       bool                          context_free = false;
+      const bool                    trace_table_access; ///< record read/write sets for the table_access_tracer
 
    public:
       std::vector<char>             action_return_value;
+      uint64_t                      db_intrinsic_calls = 0; ///< database intrinsic calls of the current exec_one, for the action profiler
       generic_index<index64_object>                                  idx64;
       generic_index<index128_object>                                 idx128;
       generic_index<index256_object, uint128_t*, const uint128_t*>   idx256;
@@ -26,6 +26,8 @@ namespace eosio { namespace chain {
          void initialize_database();
          void add_to_snapshot( const snapshot_writer_ptr& snapshot ) const;
          void read_from_snapshot( const snapshot_reader_ptr& snapshot );
+         static void copy_snapshot( snapshot_reader& snapshot, snapshot_writer& writer, chainbase::allocator<char> alloc,
+                                    const std::function<bool(const std::string&)>& filter );
 
          const permission_object& create_permission( account_name account,
                                                      permission_name name,
@@ -121,6 +121,16 @@ namespace eosio { namespace chain {
 
          static void split_blocklog(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir, uint32_t stride);
          static void merge_blocklogs(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir);
+
+         /**
+          * Compress a retained blocks-<first>-<last>.log and its index into blocks-<first>-<last>.zlog, where runs of
+          * frame_blocks blocks are compressed independently. A block log with retained_dir reads the blocks of .zlog
+          * files found there at startup; they are not counted against max_retained_files. The original files are kept.
+          * @return path of the compressed file
+          */
+         static std::filesystem::path compress_blocklog(const std::filesystem::path& block_file, uint32_t frame_blocks);
+         /// @return path of the block log reproduced, with its index, next to the compressed file
+         static std::filesystem::path decompress_blocklog(const std::filesystem::path& compressed_file);
    private:
          std::unique_ptr<detail::block_log_impl> my;
    };
@@ -9,6 +9,7 @@
 #include <eosio/chain/abi_serializer.hpp>
 #include <eosio/chain/account_object.hpp>
 #include <eosio/chain/snapshot.hpp>
+#include <eosio/chain/state_checkpoint.hpp>
 #include <eosio/chain/protocol_feature_manager.hpp>
 #include <eosio/chain/webassembly/eos-vm-oc/config.hpp>
 
@@ -39,6 +40,8 @@ namespace eosio { namespace chain {
    class permission_object;
    class account_object;
    class deep_mind_handler;
+   class action_profiler;
+   class table_access_tracer;
    class subjective_billing;
    class wasm_interface_collection;
    using resource_limits::resource_limits_manager;
@@ -92,11 +95,13 @@ namespace eosio { namespace chain {
             wasm_interface::vm_type  wasm_runtime = chain::config::default_wasm_runtime;
             eosvmoc::config          eosvmoc_config;
             wasm_interface::vm_oc_enable eosvmoc_tierup     = wasm_interface::vm_oc_enable::oc_auto;
+            bool                     wasm_preinstantiate    = true;
 
             db_read_mode             read_mode              = db_read_mode::HEAD;
             validation_mode          block_validation_mode  = validation_mode::FULL;
 
             pinnable_mapped_file::map_mode db_map_mode      = pinnable_mapped_file::map_mode::mapped;
+            state_checkpoint_config  state_checkpoint;      ///< requires db_map_mode mapped
 
             flat_set<account_name>   resource_greylist;
             flat_set<account_name>   trusted_producers;
@@ -258,7 +263,25 @@ namespace eosio { namespace chain {
          block_id_type get_block_id_for_num( uint32_t block_num )const;
 
          sha256 calculate_integrity_hash();
+
+         struct sectioned_integrity_hash {
+            digest_type                                      root;     ///< merkle root of the section hashes
+            std::vector<std::pair<std::string, digest_type>> sections; ///< in snapshot order
+         };
+         /// called from thread pool threads with the number of sections and contract tables hashed so far
+         using integrity_hash_progress_callback = std::function<void(uint32_t done, uint32_t total)>;
+
+         /**
+          * Hashes each snapshot section, and each contract table, independently on the thread pool and combines the
+          * hashes with a merkle tree; the hash of the contract_tables section is the merkle root of its table hashes.
+          * Differs from calculate_integrity_hash() but, section by section, shows where the state of two nodes differs.
+          */
+         sectioned_integrity_hash calculate_sectioned_integrity_hash( const integrity_hash_progress_callback& progress = {} );
          void write_snapshot( const snapshot_writer_ptr& snapshot );
+         /// write an incremental checkpoint of the state, requires a configured checkpoint directory and no pending block
+         state_checkpoint_info write_state_checkpoint();
+         /// an interval checkpoint is due, it is written at the start of a block not produced or by write_state_checkpoint
+         bool is_state_checkpoint_due()const;
 
          bool sender_avoids_whitelist_blacklist_enforcement( account_name sender )const;
          void check_actor_list( const flat_set<account_name>& actors )const;
@@ -318,6 +341,10 @@ namespace eosio { namespace chain {
 
          deep_mind_handler* get_deep_mind_logger(bool is_trx_transient) const;
          void enable_deep_mind( deep_mind_handler* logger );
+         action_profiler* get_action_profiler() const;
+         void enable_action_profiler( action_profiler* profiler );
+         table_access_tracer* get_table_access_tracer() const;
+         void enable_table_access_tracer( table_access_tracer* tracer );
          uint32_t earliest_available_block_num() const;
 
 #if defined(EOSIO_EOS_VM_RUNTIME_ENABLED) || defined(EOSIO_EOS_VM_JIT_RUNTIME_ENABLED)
@@ -353,6 +380,14 @@ namespace eosio { namespace chain {
 
       static chain_id_type extract_chain_id(snapshot_reader& snapshot);
 
+      /**
+       * Copies the sections of a snapshot accepted by @p filter to @p writer row by row, without loading the snapshot
+       * into a chainbase database, e.g. to convert a snapshot to JSON with constant memory. Snapshots older than
+       * chain_snapshot_header version 5 hold legacy rows upgraded only on load and are not supported.
+       */
+      static void copy_snapshot(snapshot_reader& snapshot, snapshot_writer& writer,
+                                const std::function<bool(const std::string&)>& filter);
+
       static std::optional<chain_id_type> extract_chain_id_from_db( const path& state_dir );
 
       void replace_producer_keys( const public_key_type& key );
@@ -368,6 +403,8 @@ namespace eosio { namespace chain {
       void set_to_read_window();
       bool is_write_window() const;
       void code_block_num_last_used(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, uint32_t block_num);
+      /// instantiate code on a background thread ahead of its first apply, not done while replaying
+      void preinstantiate_code(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, const bytes& code);
 
       private:
          friend class apply_context;
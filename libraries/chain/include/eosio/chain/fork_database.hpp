@@ -17,6 +17,10 @@ namespace eosio { namespace chain {
     * blocks older than the last irreversible block are freed after emitting the
     * irreversible signal.
     *
+    * Modifications are appended to a journal in the data directory as they happen, so the
+    * fork database survives a crash. The journal is compacted into fork_db.dat when it grows
+    * larger than the fork database itself and when the fork database is reset.
+    *
     * An internal mutex is used to provide thread-safety.
     */
    class fork_database {
@@ -89,6 +93,7 @@ namespace eosio { namespace chain {
          void mark_valid( const block_state_ptr& h );
 
          static const uint32_t magic_number;
+         static const uint32_t journal_magic_number;
 
          static const uint32_t min_supported_version;
          static const uint32_t max_supported_version;
@@ -238,6 +238,16 @@ struct log_catalog {
       }
    }
 
+   /// Remove the bundle holding the lowest blocks from the catalog, leaving its files in place for the caller.
+   ///
+   /// \return the path of the removed bundle without extension
+   std::filesystem::path pop_front() {
+      auto name = std::move(collection.begin()->second.filename_base);
+      collection.erase(collection.begin());
+      active_index = active_index == npos || active_index == 0 ? npos : active_index - 1;
+      return name;
+   }
+
    /// Truncate the catalog so that the log/index bundle containing the block with \c block_num
    /// would be rename to \c new_name; the log/index bundles with blocks strictly higher
    /// than \c block_num would be deleted, and all the renamed/removed entries would be erased
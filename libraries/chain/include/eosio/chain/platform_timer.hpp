@@ -11,12 +11,36 @@
 
 namespace eosio { namespace chain {
 
+class platform_timer_watchdog;
+
 struct platform_timer {
-   platform_timer();
+   enum class backend_t {
+      native,  ///< the platform's timer facility: a POSIX timer signal, kqueue or asio timer thread
+      watchdog ///< deadlines in per-timer atomics polled by a shared watchdog thread, no system call to arm or cancel
+   };
+
+   /// backend of platform_timers subsequently constructed without an explicit backend, native by default
+   static void set_default_backend(backend_t b);
+   static backend_t default_backend();
+
+   platform_timer() : platform_timer(default_backend()) {}
+   explicit platform_timer(backend_t b);
    ~platform_timer();
 
-   void start(fc::time_point tp);
-   void stop();
+   void start(fc::time_point tp) {
+      if(_backend == backend_t::watchdog)
+         watchdog_start(tp);
+      else
+         native_start(tp);
+   }
+   void stop() {
+      if(_backend == backend_t::watchdog)
+         watchdog_stop();
+      else
+         native_stop();
+   }
+
+   backend_t backend() const { return _backend; }
 
    /* Sets a callback for when timer expires. Be aware this could might fire from a signal handling context and/or
       on any particular thread. Only a single callback can be registered at once; trying to register more will
@@ -37,10 +61,23 @@ struct platform_timer {
    std::atomic_bool expired = true;
 
 private:
+   friend class platform_timer_watchdog;
+
    struct impl;
    constexpr static size_t fwd_size = 8;
    fc::fwd<impl,fwd_size> my;
 
+   const backend_t _backend;
+   uint32_t        _watchdog_slot = 0;
+
+   void native_start(fc::time_point tp);
+   void native_stop();
+
+   void watchdog_create();
+   void watchdog_destroy();
+   void watchdog_start(fc::time_point tp);
+   void watchdog_stop();
+
    void call_expiration_callback() {
       bool expect_false = false;
       if(atomic_compare_exchange_strong(&_callback_variables_busy, &expect_false, true)) {
@@ -3,6 +3,18 @@
 namespace eosio { namespace chain {
 
 struct platform_timer;
+
+/// deviation in microseconds of the observed expiration from the requested one, weighted towards longer intervals
+struct timer_accuracy {
+   int min    = 0;
+   int max    = 0;
+   int mean   = 0;
+   int stddev = 0;
+};
+
+/// busy waits on a range of intervals up to 50ms; the timer must not be in use
+timer_accuracy measure_timer_accuracy(platform_timer& t);
+
 void compute_and_print_timer_accuracy(platform_timer& t);
 
-}}
\ No newline at end of file
+}}
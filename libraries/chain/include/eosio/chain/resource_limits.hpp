@@ -73,6 +73,8 @@ namespace eosio { namespace chain {
          void initialize_database();
          void add_to_snapshot( const snapshot_writer_ptr& snapshot ) const;
          void read_from_snapshot( const snapshot_reader_ptr& snapshot );
+         static void copy_snapshot( snapshot_reader& snapshot, snapshot_writer& writer, chainbase::allocator<char> alloc,
+                                    const std::function<bool(const std::string&)>& filter );
 
          void initialize_account( const account_name& account, bool is_trx_transient );
          void set_block_parameters( const elastic_limit_parameters& cpu_limit_parameters, const elastic_limit_parameters& net_limit_parameters );
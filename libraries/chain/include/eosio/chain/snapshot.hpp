@@ -4,8 +4,12 @@
 #include <eosio/chain/exceptions.hpp>
 #include <fc/variant_object.hpp>
 #include <boost/core/demangle.hpp>
-#include <ostream>
+#include <istream>
+#include <map>
 #include <memory>
+#include <optional>
+#include <ostream>
+#include <vector>
 
 namespace eosio { namespace chain {
    /**
@@ -68,9 +72,32 @@ namespace eosio { namespace chain {
          std::ostream& inner;
       };
 
+      /// appends to a buffer, for packing a block of rows in memory before writing it with a single write
+      struct buffer_wrapper {
+         explicit buffer_wrapper(std::vector<char>& b)
+         :inner(b) {
+
+         }
+
+         void write( const char* d, size_t s ) {
+            inner.insert(inner.end(), d, d + s);
+         }
+
+         void put(char c) {
+            inner.push_back(c);
+         }
+
+         size_t tellp() const {
+            return inner.size();
+         }
+
+         std::vector<char>& inner;
+      };
+
 
       struct abstract_snapshot_row_writer {
          virtual void write(ostream_wrapper& out) const = 0;
+         virtual void write(buffer_wrapper& out) const = 0;
          virtual void write(fc::sha256::encoder& out) const = 0;
          virtual fc::variant to_variant() const = 0;
          virtual std::string row_type_name() const = 0;
@@ -90,6 +117,10 @@ namespace eosio { namespace chain {
             write_stream(out);
          }
 
+         void write(buffer_wrapper& out) const override {
+            write_stream(out);
+         }
+
          void write(fc::sha256::encoder& out) const override {
             write_stream(out);
          }
@@ -122,6 +153,11 @@ namespace eosio { namespace chain {
                   _writer.write_row(detail::make_row_writer(detail::snapshot_row_traits<T>::to_snapshot_row(row, db)));
                }
 
+               template<typename T>
+               auto add_row( const T& row ) -> std::enable_if_t<std::is_same<std::decay_t<T>, typename detail::snapshot_row_traits<T>::snapshot_type>::value> {
+                  _writer.write_row(detail::make_row_writer(row));
+               }
+
             private:
                friend class snapshot_writer;
                section_writer(snapshot_writer& writer)
@@ -134,6 +170,8 @@ namespace eosio { namespace chain {
 
          template<typename F>
          void write_section(const std::string section_name, F f) {
+            if (!accepts_section(section_name))
+               return;
             write_start_section(section_name);
             auto section = section_writer(*this);
             f(section);
@@ -148,6 +186,8 @@ namespace eosio { namespace chain {
       virtual ~snapshot_writer(){};
 
       protected:
+         /// sections not accepted are skipped without walking their rows
+         virtual bool accepts_section( const std::string& section_name ) const { return true; }
          virtual void write_start_section( const std::string& section_name ) = 0;
          virtual void write_row( const detail::abstract_snapshot_row_writer& row_writer ) = 0;
          virtual void write_end_section() = 0;
@@ -158,6 +198,7 @@ namespace eosio { namespace chain {
    namespace detail {
       struct abstract_snapshot_row_reader {
          virtual void provide(std::istream& in) const = 0;
+         virtual void provide(fc::datastream<const char*>& in) const = 0;
          virtual void provide(const fc::variant&) const = 0;
          virtual std::string row_type_name() const = 0;
       };
@@ -203,6 +244,12 @@ namespace eosio { namespace chain {
             });
          }
 
+         void provide(fc::datastream<const char*>& in) const override {
+            row_validation_helper::apply(data, [&in,this](){
+               fc::raw::unpack(in, data);
+            });
+         }
+
          void provide(const fc::variant& var) const override {
             row_validation_helper::apply(data, [&var,this]() {
                fc::from_variant(var, data);
@@ -320,9 +367,19 @@ namespace eosio { namespace chain {
          uint64_t cur_row;
    };
 
+   /**
+    * Binary format history:
+    * Version 1: rows of a section packed one after the other
+    * Version 2: rows of a section packed in blocks. A block is its row count, the size of its rows, and the size of
+    *            every row when they are all the same size; otherwise the sizes of its rows follow as a column. Rows are
+    *            packed in memory and written a block at a time, and read back a block at a time.
+    *
+    * Sections are framed the same in both versions, by their size, row count and name. Version 1 is written unless
+    * another version is chosen, as nodes that predate version 2 only read version 1.
+    */
    class ostream_snapshot_writer : public snapshot_writer {
       public:
-         explicit ostream_snapshot_writer(std::ostream& snapshot);
+         explicit ostream_snapshot_writer(std::ostream& snapshot, uint32_t version = default_version);
 
          void write_start_section( const std::string& section_name ) override;
          void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
@@ -331,16 +388,36 @@ namespace eosio { namespace chain {
 
          static const uint32_t magic_number = 0x30510550;
 
+         static const uint32_t minimum_version = 1;
+         static const uint32_t current_version = 2;
+         static const uint32_t default_version = 1;
+
+         /// a block is written once its rows reach this size or count
+         static constexpr size_t   block_size = 1024*1024;
+         static constexpr uint32_t block_rows = 64*1024;
+
+         /// block row size when the rows of a block differ in size
+         static const uint32_t variable_row_size = std::numeric_limits<uint32_t>::max();
+
       private:
+         void write_block();
+
          detail::ostream_wrapper snapshot;
+         uint32_t                version;
          std::streampos          header_pos;
          std::streampos          section_pos;
          uint64_t                row_count;
+         std::vector<char>       block;       ///< packed rows of the block being written
+         std::vector<uint32_t>   block_sizes; ///< size of each row of the block being written
    };
 
+   /**
+    * Without the header only the sections are written, for assembling a JSON snapshot from sections written
+    * separately after the header of another writer and before its finalize().
+    */
    class ostream_json_snapshot_writer : public snapshot_writer {
       public:
-         explicit ostream_json_snapshot_writer(std::ostream& snapshot);
+         explicit ostream_json_snapshot_writer(std::ostream& snapshot, bool write_header = true);
 
          void write_start_section( const std::string& section_name ) override;
          void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
@@ -354,9 +431,26 @@ namespace eosio { namespace chain {
          uint64_t                row_count;
    };
 
+   namespace detail {
+      class snapshot_read_ahead_thread;
+      class snapshot_read_ahead_buffer;
+   }
+
+   /**
+    * Rows of the current section are read through a read ahead buffer which prefetches the next chunk of the
+    * section while the current chunk is unpacked, overlapping snapshot I/O with inserting the rows into chainbase.
+    * Chunks are read by a single thread of the reader, started with the first section read. Rows are still
+    * provided in file order so the loaded state is identical.
+    *
+    * The snapshot stream is only used directly once the read in flight, if any, has completed.
+    */
    class istream_snapshot_reader : public snapshot_reader {
       public:
-         explicit istream_snapshot_reader(std::istream& snapshot);
+         /// bytes of a section read ahead at a time
+         static constexpr uint64_t default_read_ahead_size = 32*1024*1024;
+
+         explicit istream_snapshot_reader(std::istream& snapshot, uint64_t read_ahead_size = default_read_ahead_size);
+         ~istream_snapshot_reader() override;
 
          void validate() const override;
          void set_section( const string& section_name ) override;
@@ -365,13 +459,48 @@ namespace eosio { namespace chain {
          void clear_section() override;
          void return_to_header() override;
 
+         struct section_info {
+            std::string name;
+            uint64_t    row_count = 0;
+            uint64_t    size      = 0; ///< bytes of all rows
+         };
+
+         /// sections in file order
+         std::vector<section_info> list_sections();
+
+         /// sha256 of the packed rows of a section, hashed as read without unpacking any row
+         fc::sha256 hash_section( const std::string& section_name );
+
       private:
-         bool validate_section() const;
+         struct section_location {
+            std::streampos rows_pos;   ///< first byte of the first row
+            uint64_t       rows_size;  ///< bytes of all rows
+            uint64_t       row_count;
+         };
 
-         std::istream&  snapshot;
-         std::streampos header_pos;
-         uint64_t       num_rows;
-         uint64_t       cur_row;
+         bool validate_section() const;
+         void index_sections();
+         void release_section();
+         void join_read_ahead() const;
+         void read_block();
+
+         std::istream&                                         snapshot;
+         std::streampos                                        header_pos;
+         uint64_t                                              read_ahead_size;
+         uint64_t                                              num_rows;
+         uint64_t                                              cur_row;
+         std::optional<std::map<std::string, section_location>> sections; ///< built on first set_section
+         std::streampos                                        section_rows_pos;
+         std::unique_ptr<detail::snapshot_read_ahead_thread>   read_ahead_thread; ///< outlives section_buf
+         std::unique_ptr<detail::snapshot_read_ahead_buffer>   section_buf;
+         std::unique_ptr<std::istream>                         section_stream;
+         uint32_t                                              version = 0; ///< read with the sections
+         std::vector<char>                                     block;       ///< packed rows of the current block
+         std::vector<uint32_t>                                 block_sizes; ///< size of each row of the current block
+         uint32_t                                              block_row_size = 0;
+         uint32_t                                              block_num_rows = 0;
+         uint32_t                                              block_row = 0;
+         size_t                                                block_pos = 0;
    };
 
    class istream_json_snapshot_reader : public snapshot_reader {
@@ -392,9 +521,40 @@ namespace eosio { namespace chain {
          std::unique_ptr<struct istream_json_snapshot_reader_impl> impl;
    };
 
+   /**
+    * Copies a section of @p snapshot to @p writer row by row, unpacking each row as the snapshot row type of T outside
+    * of any database. Shared members of chainbase object rows are allocated with @p alloc and released after each row.
+    */
+   template<typename T>
+   void copy_snapshot_section( snapshot_reader& snapshot, snapshot_writer& writer, chainbase::allocator<char> alloc,
+                               const std::string& section_name = detail::snapshot_section_traits<T>::section_name() ) {
+      using row_t = typename detail::snapshot_row_traits<T>::snapshot_type;
+      snapshot.read_section(section_name, [&]( auto& in ) {
+         writer.write_section(section_name, [&]( auto& out ) {
+            bool more = !in.empty();
+            while (more) {
+               if constexpr (std::is_default_constructible_v<row_t>) {
+                  row_t row;
+                  more = in.read_row(row);
+                  out.add_row(row);
+               } else {
+                  row_t row([](auto&){}, alloc);
+                  more = in.read_row(row);
+                  out.add_row(row);
+               }
+            }
+         });
+      });
+   }
+
+   /**
+    * Given a section name, only the rows of that section are hashed.
+    */
    class integrity_hash_snapshot_writer : public snapshot_writer {
       public:
-         explicit integrity_hash_snapshot_writer(fc::sha256::encoder&  enc);
+         explicit integrity_hash_snapshot_writer(fc::sha256::encoder&  enc, std::optional<std::string> section = {});
+
+         bool accepts_section( const std::string& section_name ) const override;
 
          void write_start_section( const std::string& section_name ) override;
          void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
@@ -402,7 +562,8 @@ namespace eosio { namespace chain {
          void finalize();
 
       private:
-         fc::sha256::encoder&  enc;
+         fc::sha256::encoder&        enc;
+         std::optional<std::string>  section;
 
    };
 
@@ -7,6 +7,7 @@
 #include <eosio/chain/exceptions.hpp>
 #include <eosio/chain/resource_limits.hpp>
 #include <eosio/chain/resource_limits_private.hpp>
+#include <eosio/chain/snapshot.hpp>
 #include <eosio/chain/transaction.hpp>
 #include <eosio/chain/types.hpp>
 
@@ -175,6 +176,9 @@ private:
    // path to write the snapshots to
    fs::path _snapshots_dir;
 
+   // binary snapshot version written
+   uint32_t _snapshot_version = ostream_snapshot_writer::default_version;
+
    void x_serialize() {
       auto& vec = _snapshot_requests.get<as_vector>();
       std::vector<snapshot_schedule_information> sr(vec.begin(), vec.end());
@@ -201,6 +205,9 @@ public:
    // set snapshot path
    void set_snapshots_path(fs::path sn_path);
 
+   // set binary snapshot version written
+   void set_snapshot_version(uint32_t version);
+
    // add pending snapshot info to inflight snapshot request
    void add_pending_snapshot_info(const snapshot_information& si);
 
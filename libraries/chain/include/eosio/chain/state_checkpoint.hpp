@@ -0,0 +1,98 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+#include <eosio/chain/chain_id_type.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace eosio::chain {
+
+   struct state_checkpoint_config {
+      std::filesystem::path dir;                            ///< where checkpoints are written, empty disables checkpoints
+      uint32_t              interval_blocks      = 0;       ///< take a checkpoint every this many blocks, 0 disables checkpoints
+      uint32_t              increments_per_full  = 64;      ///< incremental checkpoints written on top of a full one before the next full one
+      uint32_t              retained_full        = 2;       ///< full checkpoints kept along with their increments, older ones are removed
+      uint32_t              threads              = 4;       ///< threads digesting the state file
+   };
+
+   /**
+    * Description of a checkpoint file, read from its header
+    */
+   struct state_checkpoint_info {
+      std::filesystem::path file;
+      uint64_t              seq             = 0;
+      uint64_t              parent_seq      = 0;  ///< checkpoint this one applies on top of, 0 for a full checkpoint
+      chain_id_type         chain_id        = chain_id_type::empty_chain_id();
+      uint32_t              head_block_num  = 0;
+      block_id_type         head_block_id;
+      uint64_t              state_size      = 0;  ///< size of shared_memory.bin
+      uint32_t              chunk_size      = 0;
+      uint64_t              num_chunks      = 0;  ///< chunks stored in this checkpoint
+   };
+
+   /**
+    * Writes incremental checkpoints of a chainbase state file mapped in `mapped` mode.
+    *
+    * The state file is divided in chunks and the digest of each chunk is kept in memory. A checkpoint reads the
+    * file through the page cache, which is coherent with the shared mapping, and stores only the chunks whose digest
+    * changed since the previous checkpoint, along with the fork database files. The first checkpoint after startup,
+    * and every `increments_per_full` checkpoints after that, store every chunk that is not a hole.
+    *
+    * A checkpoint must be taken while the state is not modified, between blocks on the main thread.
+    *
+    * File layout of checkpoint-<seq>.bin:
+    *   header: magic, version, seq, parent seq, chain id, head block num, head block id, state size, chunk size,
+    *           number of chunks
+    *   chunks: chunk index (uint64_t), size (uint32_t), city_hash64 (uint64_t), data
+    *   fork database: vector of file name (string) and contents (vector<char>)
+    *   trailer: sha256 of everything before the trailer, magic
+    */
+   class state_checkpoint_writer {
+   public:
+      static constexpr uint32_t default_chunk_size = 64*1024;
+
+      state_checkpoint_writer( state_checkpoint_config cfg, std::filesystem::path state_file, std::filesystem::path fork_db_dir );
+
+      state_checkpoint_info write( const chain_id_type& chain_id, uint32_t head_block_num, const block_id_type& head_block_id );
+
+      const state_checkpoint_config& config() const { return cfg; }
+
+   private:
+      void remove_expired();
+
+      state_checkpoint_config cfg;
+      std::filesystem::path   state_file;
+      std::filesystem::path   fork_db_dir;
+      std::vector<uint64_t>   digests;                ///< of each chunk at the last checkpoint, empty before the first
+      uint64_t                last_seq = 0;
+      uint32_t                increments_since_full = 0;
+   };
+
+   /**
+    * @return the checkpoints found in `dir` ordered by sequence number
+    */
+   std::vector<state_checkpoint_info> list_state_checkpoints( const std::filesystem::path& dir );
+
+   /**
+    * Verify the checkpoint `seq`, or the latest one, and every checkpoint it applies on top of: the chain of
+    * checkpoints down to a full one, the sha256 of each file and the digest of each chunk.
+    *
+    * @return the checkpoints from the full one to the one verified
+    * @throws state_checkpoint_exception on the first problem found
+    */
+   std::vector<state_checkpoint_info> verify_state_checkpoint( const std::filesystem::path& dir, std::optional<uint64_t> seq = {} );
+
+   /**
+    * Verify and then restore the checkpoint `seq`, or the latest one, creating shared_memory.bin in `state_dir` and
+    * replacing the fork database files in `fork_db_dir`. The state directory must not already hold a state file.
+    *
+    * @return the checkpoint restored
+    */
+   state_checkpoint_info restore_state_checkpoint( const std::filesystem::path& dir, std::optional<uint64_t> seq,
+                                                   const std::filesystem::path& state_dir, const std::filesystem::path& fork_db_dir );
+
+} /// namespace eosio::chain
+
+FC_REFLECT( eosio::chain::state_checkpoint_info, (file)(seq)(parent_seq)(chain_id)(head_block_num)(head_block_id)(state_size)(chunk_size)(num_chunks) )
@@ -10,6 +10,11 @@
 
 #include <fc/time.hpp>
 
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -40,23 +45,149 @@ private:
    using decaying_accumulator = chain::resource_limits::impl::exponential_decay_accumulator<>;
 
    struct subjective_billing_info {
+      chain::account_name   account;
+      bool                  occupied = false;      // slot of account_table in use
       uint64_t              pending_cpu_us = 0;    // tracked cpu us for transactions that may still succeed in a block
       decaying_accumulator  expired_accumulator;   // accumulator used to account for transactions that have expired
+      uint32_t              exhausted_block_num = 0; // head block num when the account was found without cpu for its subjective bill
+      int64_t               exhausted_bill = 0;      // subjective bill at that time
 
       bool empty(uint32_t time_ordinal, uint32_t expired_accumulator_average_window) const {
          return pending_cpu_us == 0 && expired_accumulator.value_at(time_ordinal, expired_accumulator_average_window) == 0;
       }
    };
 
-   using account_subjective_bill_cache = std::map<chain::account_name, subjective_billing_info>;
+   static uint64_t hash_account( const chain::account_name& a ) {
+      // names have low entropy in their low bits, mix them (murmur3 finalizer)
+      uint64_t h = a.to_uint64_t();
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return h;
+   }
+
+public: // public for tests
+   /// open addressing hash table of subjective_billing_info with linear probing, entries are stored inline
+   class account_table {
+   public:
+      account_table() : _slots(initial_capacity) {}
+
+      size_t size() const { return _size; }
+      size_t capacity() const { return _slots.size(); }
+
+      subjective_billing_info* find( const chain::account_name& a ) {
+         for( size_t i = slot_of( a ); _slots[i].occupied; i = next( i ) ) {
+            if( _slots[i].account == a )
+               return &_slots[i];
+         }
+         return nullptr;
+      }
+      const subjective_billing_info* find( const chain::account_name& a ) const {
+         return const_cast<account_table*>(this)->find( a );
+      }
+
+      /// find or insert, may move existing entries
+      subjective_billing_info& operator[]( const chain::account_name& a ) {
+         if( auto* e = find( a ) )
+            return *e;
+         if( (_size + 1) * 2 > _slots.size() )
+            grow();
+         size_t i = slot_of( a );
+         while( _slots[i].occupied )
+            i = next( i );
+         _slots[i].account = a;
+         _slots[i].occupied = true;
+         ++_size;
+         return _slots[i];
+      }
+
+      void erase( subjective_billing_info* e ) {
+         erase_slot( e - _slots.data() );
+      }
+
+      /// visit at most max_slots slots from where the previous sweep stopped, erasing the entries for which erase_if is true
+      /// @return number of erased entries
+      template <typename Pred>
+      size_t sweep( size_t max_slots, Pred&& erase_if ) {
+         size_t erased = 0;
+         for( size_t n = 0; n < max_slots && _size > 0; ++n ) {
+            _sweep_pos &= _slots.size() - 1;
+            if( _slots[_sweep_pos].occupied && erase_if( _slots[_sweep_pos] ) ) {
+               erase_slot( _sweep_pos ); // slot may now hold a shifted entry, visit it again
+               ++erased;
+            } else {
+               ++_sweep_pos;
+            }
+         }
+         return erased;
+      }
+
+   private:
+      static constexpr size_t initial_capacity = 64; // power of 2
+
+      size_t slot_of( const chain::account_name& a ) const { return hash_account( a ) & (_slots.size() - 1); }
+      size_t next( size_t i ) const { return (i + 1) & (_slots.size() - 1); }
+
+      // backward shift deletion, keeps probe sequences without tombstones
+      void erase_slot( size_t i ) {
+         for( size_t j = next( i ); _slots[j].occupied; j = next( j ) ) {
+            const size_t k = slot_of( _slots[j].account );
+            const bool in_place = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+            if( !in_place ) {
+               _slots[i] = std::move( _slots[j] );
+               i = j;
+            }
+         }
+         _slots[i] = subjective_billing_info{};
+         --_size;
+      }
+
+      void grow() {
+         std::vector<subjective_billing_info> old( _slots.size() * 2 );
+         old.swap( _slots );
+         for( auto& e : old ) {
+            if( !e.occupied )
+               continue;
+            size_t i = slot_of( e.account );
+            while( _slots[i].occupied )
+               i = next( i );
+            _slots[i] = std::move( e );
+         }
+      }
+
+      std::vector<subjective_billing_info> _slots;
+      size_t                               _size = 0;
+      size_t                               _sweep_pos = 0;
+   };
+
+private:
+   // accounts are sharded so that other threads can read them while the main thread updates other shards
+   struct account_shard {
+      mutable std::shared_mutex mtx;
+      account_table             accounts;
+   };
+   static constexpr size_t num_account_shards = 16;
+   static constexpr size_t sweep_slots_per_shard = 256;
 
    bool                                      _disabled = false;
+   bool                                      _frozen = false; ///< _disabled and _disabled_accounts no longer change
    trx_cache_index                           _trx_cache_index;
-   account_subjective_bill_cache             _account_subjective_bill_cache;
+   std::array<account_shard, num_account_shards> _account_shards;
+   size_t                                    _sweep_shard = 0;
+   std::atomic<uint32_t>                     _head_block_num = 0;
    std::set<chain::account_name>             _disabled_accounts;
    uint32_t                                  _expired_accumulator_average_window = chain::config::account_cpu_usage_average_window_ms / subjective_time_interval_ms;
 
 private:
+   account_shard& shard_for( const chain::account_name& a ) {
+      return _account_shards[hash_account( a ) >> 60]; // high bits, account_table uses the low bits
+   }
+   const account_shard& shard_for( const chain::account_name& a ) const {
+      return _account_shards[hash_account( a ) >> 60];
+   }
+
    static uint32_t time_ordinal_for( const fc::time_point& t ) {
       auto ordinal = t.time_since_epoch().count() / (1000U * (uint64_t)subjective_time_interval_ms);
       EOS_ASSERT(ordinal <= std::numeric_limits<uint32_t>::max(), chain::tx_resource_exhaustion, "overflow of quantized time in subjective billing");
@@ -64,21 +195,40 @@ private:
    }
 
    void remove_subjective_billing( const trx_cache_entry& entry, uint32_t time_ordinal ) {
-      auto aitr = _account_subjective_bill_cache.find( entry.account );
-      if( aitr != _account_subjective_bill_cache.end() ) {
-         aitr->second.pending_cpu_us -= entry.subjective_cpu_bill;
-         EOS_ASSERT( aitr->second.pending_cpu_us >= 0, chain::tx_resource_exhaustion,
+      auto& shard = shard_for( entry.account );
+      std::unique_lock g( shard.mtx );
+      if( auto* info = shard.accounts.find( entry.account ) ) {
+         info->pending_cpu_us -= entry.subjective_cpu_bill;
+         EOS_ASSERT( info->pending_cpu_us >= 0, chain::tx_resource_exhaustion,
                      "Logic error in subjective account billing ${a}", ("a", entry.account) );
-         if( aitr->second.empty(time_ordinal, _expired_accumulator_average_window) ) _account_subjective_bill_cache.erase( aitr );
+         if( info->empty(time_ordinal, _expired_accumulator_average_window) ) shard.accounts.erase( info );
       }
    }
 
    void transition_to_expired( const trx_cache_entry& entry, uint32_t time_ordinal ) {
-      auto aitr = _account_subjective_bill_cache.find( entry.account );
-      if( aitr != _account_subjective_bill_cache.end() ) {
-         aitr->second.pending_cpu_us -= entry.subjective_cpu_bill;
-         aitr->second.expired_accumulator.add(entry.subjective_cpu_bill, time_ordinal, _expired_accumulator_average_window);
+      auto& shard = shard_for( entry.account );
+      std::unique_lock g( shard.mtx );
+      if( auto* info = shard.accounts.find( entry.account ) ) {
+         info->pending_cpu_us -= entry.subjective_cpu_bill;
+         info->expired_accumulator.add(entry.subjective_cpu_bill, time_ordinal, _expired_accumulator_average_window);
+      }
+   }
+
+   // erase accounts whose bill has decayed to zero, a bounded number of slots at a time
+   template <typename Yield>
+   size_t sweep_accounts( uint32_t time_ordinal, Yield&& yield ) {
+      size_t erased = 0;
+      for( size_t n = 0; n < num_account_shards; ++n ) {
+         if( yield() )
+            break;
+         auto& shard = _account_shards[_sweep_shard];
+         _sweep_shard = (_sweep_shard + 1) % num_account_shards;
+         std::unique_lock g( shard.mtx );
+         erased += shard.accounts.sweep( sweep_slots_per_shard, [&]( const subjective_billing_info& info ) {
+            return info.empty( time_ordinal, _expired_accumulator_average_window );
+         } );
       }
+      return erased;
    }
 
    void remove_subjective_billing( const chain::block_state_ptr& bsp, uint32_t time_ordinal ) {
@@ -94,7 +244,14 @@ private:
 
 public: // public for tests
    static constexpr uint32_t subjective_time_interval_ms = 5'000;
-   size_t get_account_cache_size() const {return _account_subjective_bill_cache.size();}
+   size_t get_account_cache_size() const {
+      size_t size = 0;
+      for( const auto& shard : _account_shards ) {
+         std::shared_lock g( shard.mtx );
+         size += shard.accounts.size();
+      }
+      return size;
+   }
    void remove_subjective_billing( const chain::transaction_id_type& trx_id, uint32_t time_ordinal ) {
       auto& idx = _trx_cache_index.get<by_id>();
       auto itr = idx.find( trx_id );
@@ -105,8 +262,17 @@ public: // public for tests
    }
 
 public:
-   void disable() { _disabled = true; }
-   void disable_account( chain::account_name a ) { _disabled_accounts.emplace( a ); }
+   // _disabled and _disabled_accounts are read by other threads without synchronization, they can only be changed
+   // until freeze() is called before those threads start
+   void freeze() { _frozen = true; }
+   void disable() {
+      EOS_ASSERT( !_frozen, chain::misc_exception, "subjective billing can no longer be disabled" );
+      _disabled = true;
+   }
+   void disable_account( chain::account_name a ) {
+      EOS_ASSERT( !_frozen, chain::misc_exception, "subjective billing of ${a} can no longer be disabled", ("a", a) );
+      _disabled_accounts.emplace( a );
+   }
    bool is_account_disabled(const chain::account_name& a ) const { return _disabled || _disabled_accounts.count( a ); }
 
    void subjective_bill( const chain::transaction_id_type& id, fc::time_point_sec expire,
@@ -120,7 +286,9 @@ public:
                                bill,
                                expire.to_time_point()} );
          if( p.second ) {
-            _account_subjective_bill_cache[first_auth].pending_cpu_us += bill;
+            auto& shard = shard_for( first_auth );
+            std::unique_lock g( shard.mtx );
+            shard.accounts[first_auth].pending_cpu_us += bill;
          }
       }
    }
@@ -130,18 +298,44 @@ public:
       if( !_disabled && !_disabled_accounts.count( first_auth ) ) {
          int64_t bill = std::max<int64_t>( 0, elapsed.count() );
          const auto time_ordinal = time_ordinal_for(now);
-         _account_subjective_bill_cache[first_auth].expired_accumulator.add(bill, time_ordinal, _expired_accumulator_average_window);
+         auto& shard = shard_for( first_auth );
+         std::unique_lock g( shard.mtx );
+         shard.accounts[first_auth].expired_accumulator.add(bill, time_ordinal, _expired_accumulator_average_window);
+      }
+   }
+
+   /// Record that a transaction of first_auth failed before execution because its subjective bill left no cpu.
+   /// Until the next block, transactions of the account are rejected by is_account_exhausted while its bill is not lower.
+   void account_exhausted( const chain::account_name& first_auth, int64_t subjective_bill ) {
+      if( !_disabled && !_disabled_accounts.count( first_auth ) && subjective_bill > 0 ) {
+         auto& shard = shard_for( first_auth );
+         std::unique_lock g( shard.mtx );
+         auto& info = shard.accounts[first_auth];
+         info.exhausted_block_num = _head_block_num.load( std::memory_order_relaxed );
+         info.exhausted_bill = subjective_bill;
       }
    }
 
+   /// Thread safe pre-check, may be called from any thread.
+   /// @return true if a transaction of first_auth would fail because of its subjective bill
+   bool is_account_exhausted( const chain::account_name& first_auth, const fc::time_point& now ) const {
+      if( _disabled || _disabled_accounts.count( first_auth ) ) return false;
+      const auto time_ordinal = time_ordinal_for(now);
+      const auto& shard = shard_for( first_auth );
+      std::shared_lock g( shard.mtx );
+      const auto* info = shard.accounts.find( first_auth );
+      if( !info || info->exhausted_bill == 0 || info->exhausted_block_num != _head_block_num.load( std::memory_order_relaxed ) )
+         return false;
+      const int64_t sub_bill = info->pending_cpu_us + info->expired_accumulator.value_at(time_ordinal, _expired_accumulator_average_window );
+      return sub_bill >= info->exhausted_bill;
+   }
+
    int64_t get_subjective_bill( const chain::account_name& first_auth, const fc::time_point& now ) const {
       if( _disabled || _disabled_accounts.count( first_auth ) ) return 0;
       const auto time_ordinal = time_ordinal_for(now);
-      const subjective_billing_info* sub_bill_info = nullptr;
-      auto aitr = _account_subjective_bill_cache.find( first_auth );
-      if( aitr != _account_subjective_bill_cache.end() ) {
-         sub_bill_info = &aitr->second;
-      }
+      const auto& shard = shard_for( first_auth );
+      std::shared_lock g( shard.mtx );
+      const subjective_billing_info* sub_bill_info = shard.accounts.find( first_auth );
 
       if (sub_bill_info) {
          int64_t sub_bill = sub_bill_info->pending_cpu_us + sub_bill_info->expired_accumulator.value_at(time_ordinal, _expired_accumulator_average_window );
@@ -153,12 +347,13 @@ public:
 
    void on_block( fc::logger& log, const chain::block_state_ptr& bsp, const fc::time_point& now ) {
       if( bsp == nullptr || _disabled ) return;
+      _head_block_num.store( bsp->block_num, std::memory_order_relaxed );
       const auto time_ordinal = time_ordinal_for(now);
-      const auto orig_count = _account_subjective_bill_cache.size();
+      const auto orig_count = get_account_cache_size();
       remove_subjective_billing( bsp, time_ordinal );
       if (orig_count > 0) {
          fc_dlog( log, "Subjective billed accounts ${n} removed ${r}",
-                  ("n", orig_count)("r", orig_count - _account_subjective_bill_cache.size()) );
+                  ("n", orig_count)("r", orig_count - get_account_cache_size()) );
       }
    }
 
@@ -186,6 +381,12 @@ public:
          fc_dlog( log, "Processed ${n} subjective billed transactions, Expired ${expired}",
                   ("n", orig_count)( "expired", num_expired ) );
       }
+      if( !exhausted ) {
+         // not required for the pending block, does not report exhaustion
+         const auto num_erased = sweep_accounts( time_ordinal_for(now), yield );
+         if( num_erased > 0 )
+            fc_dlog( log, "Removed ${n} subjective billed accounts with no remaining bill", ("n", num_erased) );
+      }
       return !exhausted;
    }
 
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <eosio/chain/types.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <tuple>
+#include <vector>
+
+namespace eosio::chain {
+
+/// a contract table, the granularity read/write sets are recorded at
+struct table_access_key {
+   name code;
+   name scope;
+   name table;
+
+   friend bool operator<( const table_access_key& a, const table_access_key& b ) {
+      return std::tie( a.code, a.scope, a.table ) < std::tie( b.code, b.scope, b.table );
+   }
+   friend bool operator==( const table_access_key& a, const table_access_key& b ) {
+      return std::tie( a.code, a.scope, a.table ) == std::tie( b.code, b.scope, b.table );
+   }
+};
+
+/// tables a transaction read and wrote through the db intrinsics, including notifications and inline actions
+struct table_access_set {
+   flat_set<table_access_key> reads;
+   flat_set<table_access_key> writes;
+};
+
+/**
+ * Opt-in recording of the read/write sets of the transactions of each block, enabled with
+ * controller::enable_table_access_tracer.
+ *
+ * apply_context records every table a transaction looks up as read and every table it stores into, updates or
+ * removes from as written. When a block is accepted its conflict graph is built: an edge from an earlier to a later
+ * transaction when one writes a table the other reads or writes. Each block is summarized as the number of waves of
+ * non-conflicting transactions and its critical path in billed cpu, and, when the logger is enabled at debug level,
+ * logged with its read/write sets and edges as one JSON line.
+ *
+ * Only called from the main thread. Transient (read-only and dry-run) transactions are not recorded.
+ */
+class table_access_tracer {
+public:
+   struct block_summary {
+      uint32_t block_num            = 0;
+      uint32_t trxs                 = 0;
+      uint32_t waves                = 0; ///< length of the longest chain of conflicting transactions
+      uint32_t conflicts            = 0; ///< edges of the conflict graph
+      uint64_t cpu_usage_us         = 0; ///< billed cpu of all transactions
+      uint64_t critical_path_cpu_us = 0; ///< billed cpu of the most expensive chain of conflicting transactions
+   };
+
+   struct totals_type {
+      uint32_t blocks               = 0;
+      uint64_t trxs                 = 0;
+      uint64_t waves                = 0;
+      uint64_t conflicts            = 0;
+      uint64_t cpu_usage_us         = 0;
+      uint64_t critical_path_cpu_us = 0;
+   };
+
+   void update_logger( const std::string& logger_name );
+
+   void on_start_block( uint32_t block_num );
+   void on_applied_transaction( const transaction_id_type& id, uint32_t cpu_usage_us, table_access_set&& access );
+   block_summary on_accepted_block( uint32_t block_num );
+
+   const totals_type& totals()const { return _totals; }
+
+private:
+   struct trx_access {
+      transaction_id_type id;
+      uint32_t            cpu_usage_us = 0;
+      table_access_set    access;
+   };
+
+   fc::logger              _logger;
+   std::vector<trx_access> _pending; ///< transactions of the block being built or applied
+   totals_type             _totals;
+};
+
+} // namespace eosio::chain
+
+FC_REFLECT( eosio::chain::table_access_key, (code)(scope)(table) )
+FC_REFLECT( eosio::chain::table_access_tracer::block_summary,
+            (block_num)(trxs)(waves)(conflicts)(cpu_usage_us)(critical_path_cpu_us) )
@@ -2,6 +2,7 @@
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/trace.hpp>
 #include <eosio/chain/platform_timer.hpp>
+#include <eosio/chain/table_access_tracer.hpp>
 #include <signal.h>
 
 namespace eosio { namespace chain {
@@ -139,6 +140,7 @@ namespace eosio { namespace chain {
          deque<digest_type>           executed_action_receipt_digests;
          flat_set<account_name>        bill_to_accounts;
          flat_set<account_name>        validate_ram_usage;
+         table_access_set              table_access; ///< only recorded when a table_access_tracer is enabled
 
          /// the maximum number of virtual CPU instructions of the transaction that can be safely billed to the billable accounts
          uint64_t                      initial_max_billable_cpu = 0;
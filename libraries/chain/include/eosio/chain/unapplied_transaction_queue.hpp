@@ -8,6 +8,8 @@
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/composite_key.hpp>
 
 namespace fc {
   inline std::size_t hash_value( const fc::sha256& v ) {
@@ -29,11 +31,15 @@ enum class trx_enum_type {
 
 using next_func_t = next_function<transaction_trace_ptr>;
 
+/// higher priority incoming transactions are ordered first, equal priority in arrival order
+using incoming_priority_func_t = std::function<int64_t(const transaction_metadata_ptr&, trx_enum_type)>;
+
 struct unapplied_transaction {
    const transaction_metadata_ptr trx_meta;
    trx_enum_type                  trx_type = trx_enum_type::unknown;
    bool                           return_failure_trace = false;
    next_func_t                    next;
+   int64_t                        priority = 0; // only assigned for incoming, forked & aborted always in original order
 
    const transaction_id_type& id()const { return trx_meta->id(); }
    fc::time_point_sec expiration()const { return trx_meta->packed_trx()->expiration(); }
@@ -41,6 +47,10 @@ struct unapplied_transaction {
 
 /**
  * Track unapplied transactions for incoming, forked blocks, and aborted blocks.
+ *
+ * Within a trx_enum_type transactions are ordered by priority, highest first, then arrival order. Priority of
+ * incoming transactions is assigned by the optional incoming priority policy when the transaction is added; without
+ * a policy all priorities are equal and the queue is strictly arrival ordered.
  */
 class unapplied_transaction_queue {
 private:
@@ -53,7 +63,13 @@ private:
          hashed_unique< tag<by_trx_id>,
                const_mem_fun<unapplied_transaction, const transaction_id_type&, &unapplied_transaction::id>
          >,
-         ordered_non_unique< tag<by_type>, member<unapplied_transaction, trx_enum_type, &unapplied_transaction::trx_type> >,
+         ordered_non_unique< tag<by_type>,
+               composite_key< unapplied_transaction,
+                  member<unapplied_transaction, trx_enum_type, &unapplied_transaction::trx_type>,
+                  member<unapplied_transaction, int64_t, &unapplied_transaction::priority>
+               >,
+               composite_key_compare< std::less<trx_enum_type>, std::greater<int64_t> >
+         >,
          ordered_non_unique< tag<by_expiry>, const_mem_fun<unapplied_transaction, fc::time_point_sec, &unapplied_transaction::expiration> >
       >
    > unapplied_trx_queue_type;
@@ -62,11 +78,15 @@ private:
    uint64_t max_transaction_queue_size = 1024*1024*1024; // enforced for incoming
    uint64_t size_in_bytes = 0;
    size_t incoming_count = 0;
+   incoming_priority_func_t incoming_priority;
 
 public:
 
    void set_max_transaction_queue_size( uint64_t v ) { max_transaction_queue_size = v; }
 
+   /// policy used to order incoming transactions, empty for arrival order; only applies to subsequently added trxs
+   void set_incoming_priority( incoming_priority_func_t f ) { incoming_priority = std::move( f ); }
+
    bool empty() const {
       return queue.empty();
    }
@@ -155,8 +175,9 @@ public:
    void add_incoming( const transaction_metadata_ptr& trx, bool api_trx, bool return_failure_trace, next_func_t next ) {
       auto itr = queue.get<by_trx_id>().find( trx->id() );
       if( itr == queue.get<by_trx_id>().end() ) {
-         auto insert_itr = queue.insert(
-               { trx, api_trx ? trx_enum_type::incoming_api : trx_enum_type::incoming_p2p, return_failure_trace, std::move( next ) } );
+         const trx_enum_type trx_type = api_trx ? trx_enum_type::incoming_api : trx_enum_type::incoming_p2p;
+         const int64_t priority = incoming_priority ? incoming_priority( trx, trx_type ) : 0;
+         auto insert_itr = queue.insert( { trx, trx_type, return_failure_trace, std::move( next ), priority } );
          if( insert_itr.second ) added( insert_itr.first );
       } else {
          if( itr->trx_meta == trx ) return; // same trx meta pointer
@@ -174,9 +195,9 @@ public:
 
    // forked, aborted
    iterator unapplied_begin() { return queue.get<by_type>().begin(); }
-   iterator unapplied_end() { return queue.get<by_type>().upper_bound( trx_enum_type::aborted ); }
+   iterator unapplied_end() { return queue.get<by_type>().upper_bound( boost::make_tuple( trx_enum_type::aborted ) ); }
 
-   iterator incoming_begin() { return queue.get<by_type>().lower_bound( trx_enum_type::incoming_api ); }
+   iterator incoming_begin() { return queue.get<by_type>().lower_bound( boost::make_tuple( trx_enum_type::incoming_api ) ); }
    iterator incoming_end() { return queue.get<by_type>().end(); } // if changed to upper_bound, verify usage performance
 
    iterator lower_bound( const transaction_id_type& id ) {
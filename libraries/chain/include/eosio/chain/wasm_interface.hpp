@@ -4,11 +4,13 @@
 #include <eosio/chain/whitelisted_intrinsics.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <functional>
+#include <tuple>
 
 namespace eosio { namespace chain {
 
    class apply_context;
    class wasm_runtime_interface;
+   class wasm_module_store;
    class controller;
    namespace eosvmoc { struct config; }
 
@@ -46,9 +48,13 @@ namespace eosio { namespace chain {
             oc_none
          };
 
-         wasm_interface(vm_type vm, const chainbase::database& d, const std::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, bool profile);
+         // instantiated modules are shared with every wasm_interface constructed with the same module_store
+         wasm_interface(vm_type vm, const chainbase::database& d, const std::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, bool profile,
+                        std::shared_ptr<wasm_module_store> module_store = {});
          ~wasm_interface();
 
+         static std::shared_ptr<wasm_module_store> make_module_store();
+
          // initialize exec per thread
          void init_thread_local_data();
 
@@ -69,6 +75,24 @@ namespace eosio { namespace chain {
 
          //Returns true if the code is cached
          bool is_code_cached(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const;
+
+         //Returns true if the code is preinstantiated and has not been applied yet, waits for a preinstantiation in progress
+         bool is_code_preinstantiated(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const;
+
+         //mark code as being preinstantiated, until preinstantiate is called an apply of the code waits for it
+         //returns false if the code is already instantiated or being preinstantiated
+         bool begin_preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version);
+
+         //instantiate code after begin_preinstantiate, may be called from a thread not applying with this wasm_interface
+         //the module may be evicted after evictable_after if it was never applied
+         void preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, const std::vector<char>& code, uint32_t evictable_after);
+
+         //no preinstantiation is started anymore and applies no longer wait for those in progress, called once the
+         //thread calling preinstantiate is stopped
+         void stop_preinstantiate();
+
+         //code most recently applied, most recent first
+         std::vector<std::tuple<digest_type, uint8_t, uint8_t>> recently_used_code(size_t max_size) const;
       private:
          unique_ptr<struct wasm_interface_impl> my;
    };
@@ -1,5 +1,6 @@
 #pragma once
 #include <eosio/chain/wasm_interface.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -27,6 +28,12 @@ namespace eosio::chain {
             return wasmif.is_code_cached(code_hash, vm_type, vm_version);
          }
 
+         // used for tests, only valid on main thread
+         bool is_code_preinstantiated(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) {
+            EOS_ASSERT(is_on_main_thread(), wasm_execution_error, "is_code_preinstantiated called off the main thread");
+            return wasmif.is_code_preinstantiated(code_hash, vm_type, vm_version);
+         }
+
          // update current lib of all wasm interfaces
          void current_lib(const uint32_t lib);
 
@@ -41,6 +48,16 @@ namespace eosio::chain {
 
          void code_block_num_last_used(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, uint32_t block_num);
 
+         // instantiate code on a background thread so that its first apply does not instantiate it, only called from main thread.
+         // The module may be evicted after evictable_after if it was never applied.
+         void preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, const char* code, size_t code_size,
+                             uint32_t evictable_after);
+
+         // code most recently applied, most recent first
+         std::vector<std::tuple<digest_type, uint8_t, uint8_t>> recently_used_code(size_t max_size) const {
+            return wasmif.recently_used_code(max_size);
+         }
+
          // If substitute_apply is set, then apply calls it before doing anything else. If substitute_apply returns true,
          // then apply returns immediately. Provided function must be multi-thread safe.
          std::function<bool(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, apply_context& context)> substitute_apply;
@@ -53,9 +70,14 @@ namespace eosio::chain {
          const wasm_interface::vm_type wasm_runtime;
          const wasm_interface::vm_oc_enable eosvmoc_tierup;
 
+         std::shared_ptr<wasm_module_store> module_store; // instantiated eos-vm and eos-vm-jit modules shared by all threads
          wasm_interface wasmif;  // used by main thread
          std::mutex threaded_wasmifs_mtx;
-         std::unordered_map<std::thread::id, std::unique_ptr<wasm_interface>> threaded_wasmifs; // one for each read-only thread, used by eos-vm and eos-vm-jit
+         std::unordered_map<std::thread::id, std::unique_ptr<wasm_interface>> threaded_wasmifs; // one runtime for each read-only thread, used by eos-vm and eos-vm-jit
+
+         struct wasm; // tag for the named_thread_pool
+         std::unique_ptr<wasm_interface> preinstantiate_wasmif; // runtime of the preinstantiate thread, shares module_store
+         named_thread_pool<wasm>         preinstantiate_thread_pool;
 
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
          std::unique_ptr<struct eosvmoc_tier> eosvmoc; // used by all threads
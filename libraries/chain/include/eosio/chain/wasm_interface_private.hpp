@@ -14,6 +14,12 @@
 #include <eosio/chain/exceptions.hpp>
 #include <fc/scoped_exit.hpp>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <tuple>
+
 #include "IR/Module.h"
 #include "Platform/Platform.h"
 #include "WAST/WAST.h"
@@ -32,20 +38,214 @@ namespace eosio { namespace chain {
 
    namespace eosvmoc { struct config; }
 
-   struct wasm_interface_impl {
-      struct wasm_cache_entry {
-         digest_type                                          code_hash;
-         uint32_t                                             last_block_num_used;
-         std::unique_ptr<wasm_instantiated_module_interface>  module;
-         uint8_t                                              vm_type = 0;
-         uint8_t                                              vm_version = 0;
-      };
-      struct by_hash;
-      struct by_last_block_num;
+   /**
+    * Instantiated modules shared by the wasm_interface of the main thread and those of the read-only threads, so a
+    * contract is parsed, validated and compiled once instead of once per thread. An instantiated module only holds the
+    * compiled module, each thread applies it with its own execution context, so any number of threads apply a module
+    * at the same time.
+    *
+    * Eviction (current_lib) and code_block_num_last_used only happen on the main thread in the write window. A module
+    * evicted while a thread still applies it is destroyed once that apply returns, it is never put back in the store.
+    *
+    * Modules can be preinstantiated on another thread: between begin_preinstantiate and end_preinstantiate, a thread
+    * that needs the module waits for it, up to max_preinstantiate_wait, instead of compiling it a second time. Once
+    * stop_preinstantiate is called, preinstantiations that never ended are no longer waited for.
+    */
+   class wasm_module_store {
+      public:
+         using module_ptr = std::shared_ptr<wasm_instantiated_module_interface>;
+         using code_key   = std::tuple<digest_type, uint8_t, uint8_t>; ///< code_hash, vm_type, vm_version
+
+         /// @return true if the module is instantiated
+         bool contains(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version) const {
+            std::lock_guard g(mtx);
+            return cache.find(boost::make_tuple(code_hash, vm_type, vm_version)) != cache.end();
+         }
+
+         /// the cached module, or the one created by instantiate() when none is cached
+         template<typename Instantiate>
+         module_ptr get(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, Instantiate&& instantiate) {
+            {
+               std::lock_guard g(mtx);
+               if (module_ptr m = use(code_hash, vm_type, vm_version))
+                  return m;
+            }
+            // instantiate without holding the lock, other threads keep using cached modules meanwhile
+            module_ptr m = instantiate();
+            std::lock_guard g(mtx);
+            // another thread may have cached the module meanwhile, all threads share the cached one
+            if (module_ptr cached = use(code_hash, vm_type, vm_version))
+               return cached;
+            cache.emplace(entry{.code_hash = code_hash,
+                                .last_block_num_used = UINT32_MAX,
+                                .vm_type = vm_type,
+                                .vm_version = vm_version,
+                                .module = m,
+                                .last_use = ++use_sequence});
+            return m;
+         }
+
+         /// @return false if the module is already cached or being preinstantiated, or preinstantiation is stopped
+         bool begin_preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version) {
+            std::lock_guard g(mtx);
+            if (preinstantiate_stopped || cache.count(boost::make_tuple(code_hash, vm_type, vm_version)))
+               return false;
+            return preinstantiating.emplace(code_hash, vm_type, vm_version).second;
+         }
+
+         /// @param module nullptr if instantiation failed
+         /// @param evictable_after block num after which a new entry may be evicted if it was never applied
+         void end_preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, module_ptr module,
+                                 uint32_t evictable_after) {
+            {
+               std::lock_guard g(mtx);
+               preinstantiating.erase(std::make_tuple(code_hash, vm_type, vm_version));
+               if (module) {
+                  // kept only if no thread instantiated the module itself meanwhile
+                  cache.emplace(entry{.code_hash = code_hash,
+                                      .last_block_num_used = evictable_after,
+                                      .vm_type = vm_type,
+                                      .vm_version = vm_version,
+                                      .preinstantiated = evictable_after != UINT32_MAX,
+                                      .module = std::move(module)});
+               }
+            }
+            preinstantiated_cv.notify_all();
+         }
+
+         /// no preinstantiation is started or waited for anymore, those not ended yet may never end as the thread
+         /// running them is stopped
+         void stop_preinstantiate() {
+            {
+               std::lock_guard g(mtx);
+               preinstantiate_stopped = true;
+               preinstantiating.clear();
+            }
+            preinstantiated_cv.notify_all();
+         }
+
+         /// a preinstantiation is waited for at most this long, the waiting thread then instantiates the module itself
+         static constexpr std::chrono::seconds max_preinstantiate_wait{5};
+
+         /// wait for a preinstantiation in progress
+         /// @return the preinstantiated module, nullptr if there was none or it failed
+         module_ptr wait_preinstantiated(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version) {
+            std::unique_lock g(mtx);
+            preinstantiated_cv.wait_for(g, max_preinstantiate_wait, [&]() {
+               return !preinstantiating.count(std::make_tuple(code_hash, vm_type, vm_version));
+            });
+            return use(code_hash, vm_type, vm_version);
+         }
+
+         /// wait for a preinstantiation in progress
+         /// @return true if the module is cached and has never been applied
+         bool preinstantiated(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version) {
+            std::unique_lock g(mtx);
+            preinstantiated_cv.wait_for(g, max_preinstantiate_wait, [&]() {
+               return !preinstantiating.count(std::make_tuple(code_hash, vm_type, vm_version));
+            });
+            auto it = cache.find(boost::make_tuple(code_hash, vm_type, vm_version));
+            return it != cache.end() && it->last_use == 0;
+         }
+
+         /// at most max_size modules, most recently applied first
+         std::vector<code_key> recently_used(size_t max_size) const {
+            std::lock_guard g(mtx);
+            std::vector<const entry*> entries;
+            for (const auto& e : cache) {
+               if (e.last_use)
+                  entries.push_back(&e);
+            }
+            const size_t n = std::min(max_size, entries.size());
+            std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+                              [](const entry* lhs, const entry* rhs) { return lhs->last_use > rhs->last_use; });
+            std::vector<code_key> result;
+            result.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+               result.emplace_back(entries[i]->code_hash, entries[i]->vm_type, entries[i]->vm_version);
+            return result;
+         }
+
+         void code_block_num_last_used(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, uint32_t block_num) {
+            std::lock_guard g(mtx);
+            auto it = cache.find(boost::make_tuple(code_hash, vm_type, vm_version));
+            if (it != cache.end())
+               cache.modify(it, [block_num](entry& e) {
+                  e.last_block_num_used = block_num;
+               });
+         }
 
+         // reports each code_hash and vm_version that will be erased to callback
+         void current_lib(uint32_t lib, const std::function<void(const digest_type&, uint8_t)>& callback) {
+            std::lock_guard g(mtx);
+            //anything last used before or on the LIB can be evicted
+            const auto first_it = cache.get<by_last_block_num>().begin();
+            const auto last_it  = cache.get<by_last_block_num>().upper_bound(lib);
+            if (callback) {
+               for (auto it = first_it; it != last_it; it++) {
+                  callback(it->code_hash, it->vm_version);
+               }
+            }
+            cache.get<by_last_block_num>().erase(first_it, last_it);
+         }
+
+      private:
+         struct entry {
+            digest_type                       code_hash;
+            uint32_t                          last_block_num_used;
+            uint8_t                           vm_type = 0;
+            uint8_t                           vm_version = 0;
+            bool                              preinstantiated = false; ///< never applied, evictable after last_block_num_used
+            module_ptr                        module;
+            mutable uint64_t                  last_use = 0; ///< use sequence number, 0 if never applied, not part of any key
+         };
+         struct by_hash;
+         struct by_last_block_num;
+
+         typedef boost::multi_index_container<
+            entry,
+            indexed_by<
+               ordered_unique<tag<by_hash>,
+                  composite_key< entry,
+                     member<entry, digest_type, &entry::code_hash>,
+                     member<entry, uint8_t,     &entry::vm_type>,
+                     member<entry, uint8_t,     &entry::vm_version>
+                  >
+               >,
+               ordered_non_unique<tag<by_last_block_num>, member<entry, uint32_t, &entry::last_block_num_used>>
+            >
+         > cache_index;
+
+         // requires mtx
+         module_ptr use(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version) {
+            auto it = cache.find(boost::make_tuple(code_hash, vm_type, vm_version));
+            if (it == cache.end())
+               return {};
+            if (it->preinstantiated) {
+               // in use, keep it until its code is replaced like any instantiated module
+               cache.modify(it, [](entry& e) {
+                  e.last_block_num_used = UINT32_MAX;
+                  e.preinstantiated = false;
+               });
+            }
+            it->last_use = ++use_sequence;
+            return it->module;
+         }
+
+         mutable std::mutex       mtx;
+         cache_index              cache;
+         uint64_t                 use_sequence = 0;
+         std::set<code_key>       preinstantiating;
+         bool                     preinstantiate_stopped = false;
+         std::condition_variable  preinstantiated_cv;
+   };
+
+   struct wasm_interface_impl {
       wasm_interface_impl(wasm_interface::vm_type vm, const chainbase::database& d,
-                          const std::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, bool profile)
-         : db(d)
+                          const std::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, bool profile,
+                          std::shared_ptr<wasm_module_store> store)
+         : module_store(store ? std::move(store) : std::make_shared<wasm_module_store>())
+         , db(d)
          , wasm_runtime_time(vm)
       {
 #ifdef EOSIO_EOS_VM_RUNTIME_ENABLED
@@ -71,80 +271,54 @@ namespace eosio { namespace chain {
       ~wasm_interface_impl() = default;
 
       bool is_code_cached(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const {
-         wasm_cache_index::iterator it = wasm_instantiation_cache.find( boost::make_tuple(code_hash, vm_type, vm_version) );
-         return it != wasm_instantiation_cache.end();
+         return module_store->contains(code_hash, vm_type, vm_version);
+      }
+
+      bool is_code_preinstantiated(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const {
+         return module_store->preinstantiated(code_hash, vm_type, vm_version);
       }
 
       void code_block_num_last_used(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, const uint32_t& block_num) {
-         wasm_cache_index::iterator it = wasm_instantiation_cache.find(boost::make_tuple(code_hash, vm_type, vm_version));
-         if(it != wasm_instantiation_cache.end())
-            wasm_instantiation_cache.modify(it, [block_num](wasm_cache_entry& e) {
-               e.last_block_num_used = block_num;
-            });
+         module_store->code_block_num_last_used(code_hash, vm_type, vm_version, block_num);
       }
 
       // reports each code_hash and vm_version that will be erased to callback
       void current_lib(uint32_t lib, const std::function<void(const digest_type&, uint8_t)>& callback) {
-         //anything last used before or on the LIB can be evicted
-         const auto first_it = wasm_instantiation_cache.get<by_last_block_num>().begin();
-         const auto last_it  = wasm_instantiation_cache.get<by_last_block_num>().upper_bound(lib);
-         if (callback) {
-            for(auto it = first_it; it != last_it; it++) {
-               callback(it->code_hash, it->vm_version);
-            }
-         }
-         wasm_instantiation_cache.get<by_last_block_num>().erase(first_it, last_it);
+         module_store->current_lib(lib, callback);
       }
 
-      const std::unique_ptr<wasm_instantiated_module_interface>& get_instantiated_module( const digest_type& code_hash, const uint8_t& vm_type,
-                                                                                 const uint8_t& vm_version, transaction_context& trx_context )
-      {
-         wasm_cache_index::iterator it = wasm_instantiation_cache.find(
-                                             boost::make_tuple(code_hash, vm_type, vm_version) );
-         const code_object* codeobject = nullptr;
-         if(it == wasm_instantiation_cache.end()) {
-            codeobject = &db.get<code_object,by_code_hash>(boost::make_tuple(code_hash, vm_type, vm_version));
-
-            it = wasm_instantiation_cache.emplace( wasm_interface_impl::wasm_cache_entry{
-                                                      .code_hash = code_hash,
-                                                      .last_block_num_used = UINT32_MAX,
-                                                      .module = nullptr,
-                                                      .vm_type = vm_type,
-                                                      .vm_version = vm_version
-                                                   } ).first;
-         }
-
-         if(!it->module) {
-            if(!codeobject)
-               codeobject = &db.get<code_object,by_code_hash>(boost::make_tuple(code_hash, vm_type, vm_version));
+      std::unique_ptr<wasm_instantiated_module_interface> instantiate_module( const digest_type& code_hash, const uint8_t& vm_type,
+                                                                              const uint8_t& vm_version ) {
+         const code_object& codeobject = db.get<code_object,by_code_hash>(boost::make_tuple(code_hash, vm_type, vm_version));
+         return runtime_interface->instantiate_module(codeobject.code.data(), codeobject.code.size(), code_hash, vm_type, vm_version);
+      }
 
+      wasm_module_store::module_ptr get_instantiated_module( const digest_type& code_hash, const uint8_t& vm_type,
+                                                             const uint8_t& vm_version, transaction_context& trx_context )
+      {
+         return module_store->get(code_hash, vm_type, vm_version, [&]() -> wasm_module_store::module_ptr {
             auto timer_pause = fc::make_scoped_exit([&](){
                trx_context.resume_billing_timer();
             });
             trx_context.pause_billing_timer();
-            wasm_instantiation_cache.modify(it, [&](auto& c) {
-               c.module = runtime_interface->instantiate_module(codeobject->code.data(), codeobject->code.size(), code_hash, vm_type, vm_version);
-            });
-         }
-         return it->module;
+            if (auto m = module_store->wait_preinstantiated(code_hash, vm_type, vm_version))
+               return m;
+            return instantiate_module(code_hash, vm_type, vm_version);
+         });
       }
 
-      std::unique_ptr<wasm_runtime_interface> runtime_interface;
+      // may be called from any thread, instantiates with the runtime of this wasm_interface
+      void preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, const std::vector<char>& code,
+                          uint32_t evictable_after) {
+         std::unique_ptr<wasm_instantiated_module_interface> module;
+         try {
+            module = runtime_interface->instantiate_module(code.data(), code.size(), code_hash, vm_type, vm_version);
+         } FC_LOG_AND_DROP()
+         module_store->end_preinstantiate(code_hash, vm_type, vm_version, std::move(module), evictable_after);
+      }
 
-      typedef boost::multi_index_container<
-         wasm_cache_entry,
-         indexed_by<
-            ordered_unique<tag<by_hash>,
-               composite_key< wasm_cache_entry,
-                  member<wasm_cache_entry, digest_type, &wasm_cache_entry::code_hash>,
-                  member<wasm_cache_entry, uint8_t,     &wasm_cache_entry::vm_type>,
-                  member<wasm_cache_entry, uint8_t,     &wasm_cache_entry::vm_version>
-               >
-            >,
-            ordered_non_unique<tag<by_last_block_num>, member<wasm_cache_entry, uint32_t, &wasm_cache_entry::last_block_num_used>>
-         >
-      > wasm_cache_index;
-      wasm_cache_index wasm_instantiation_cache;
+      std::unique_ptr<wasm_runtime_interface> runtime_interface;
+      std::shared_ptr<wasm_module_store>      module_store;
 
       const chainbase::database& db;
       const wasm_interface::vm_type wasm_runtime_time;
@@ -47,8 +47,10 @@ class eos_vm_runtime : public eosio::chain::wasm_runtime_interface {
                                                                              const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) override;
 
    private:
-      // todo: managing this will get more complicated with sync calls;
-      eos_vm_backend_t<Backend>* _bkend = nullptr;  // non owning pointer to allow for immediate exit
+      // an instantiated module only holds the compiled module, shared by all threads applying it; each thread applies
+      // it with its own backend and execution context, which take no constructor arguments so are safe thread_local
+      thread_local static eos_vm_backend_t<Backend> _bkend;
+      thread_local static typename eos_vm_backend_t<Backend>::context_t _exec_ctx;
 
    template<typename Impl>
    friend class eos_vm_instantiated_module;
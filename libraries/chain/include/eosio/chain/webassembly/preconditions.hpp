@@ -118,6 +118,12 @@ namespace eosio { namespace chain { namespace webassembly {
                        "${code} does not have permission to call this API", ("code", ctx.get_host().get_context().get_receiver()));
          }));
 
+   // counted for the action profiler, on every database intrinsic
+   EOS_VM_PRECONDITION(db_call_counter,
+         EOS_VM_INVOKE_ONCE([&](auto&&...) {
+            ++ctx.get_host().get_context().db_intrinsic_calls;
+         }));
+
    namespace detail {
       template<typename T>
       vm::span<const char> to_span(const vm::argument_proxy<T*>& val) {
@@ -18,15 +18,7 @@ namespace eosio { namespace chain {
 
 namespace bacc = boost::accumulators;
 
-void compute_and_print_timer_accuracy(platform_timer& timer) {
-   static std::mutex m;
-   static bool once_is_enough;
-
-   std::lock_guard guard(m);
-
-   if(once_is_enough)
-      return;
-
+timer_accuracy measure_timer_accuracy(platform_timer& timer) {
    bacc::accumulator_set<int, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::variance>, float> samples;
 
    //keep longest first in list. You're effectively going to take test_intervals[0]*sizeof(test_intervals[0])
@@ -54,13 +46,24 @@ void compute_and_print_timer_accuracy(platform_timer& timer) {
       }
    }
 
-   #define TIMER_STATS_FORMAT "min:${min}us max:${max}us mean:${mean}us stddev:${stddev}us"
-   #define TIMER_STATS \
-      ("min", bacc::min(samples))("max", bacc::max(samples)) \
-      ("mean", (int)bacc::mean(samples))("stddev", (int)sqrt(bacc::variance(samples)))
+   return { .min = bacc::min(samples), .max = bacc::max(samples),
+            .mean = (int)bacc::mean(samples), .stddev = (int)sqrt(bacc::variance(samples)) };
+}
+
+void compute_and_print_timer_accuracy(platform_timer& timer) {
+   static std::mutex m;
+   static bool once_is_enough;
+
+   std::lock_guard guard(m);
+
+   if(once_is_enough)
+      return;
+
+   const timer_accuracy a = measure_timer_accuracy(timer);
 
-   ilog("Checktime timer accuracy: " TIMER_STATS_FORMAT, TIMER_STATS);
-   if(bacc::mean(samples) + sqrt(bacc::variance(samples))*2 > 250)
+   ilog("Checktime timer accuracy: min:${min}us max:${max}us mean:${mean}us stddev:${stddev}us",
+        ("min", a.min)("max", a.max)("mean", a.mean)("stddev", a.stddev));
+   if(a.mean + a.stddev*2 > 250)
       wlog("Checktime timer accuracy on this platform and hardware combination is poor; accuracy of subjective transaction deadline enforcement will suffer");
 
    once_is_enough = true;
@@ -21,9 +21,14 @@ struct platform_timer::impl {
    std::unique_ptr<boost::asio::high_resolution_timer> timer;
 };
 
-platform_timer::platform_timer() {
+platform_timer::platform_timer(backend_t b) : _backend(b) {
    static_assert(sizeof(impl) <= fwd_size);
 
+   if(_backend == backend_t::watchdog) {
+      watchdog_create();
+      return;
+   }
+
    std::lock_guard guard(timer_ref_mutex);
 
    if(refcount++ == 0) {
@@ -46,6 +51,10 @@ platform_timer::platform_timer() {
 }
 
 platform_timer::~platform_timer() {
+   if(_backend == backend_t::watchdog) {
+      watchdog_destroy();
+      return;
+   }
    stop();
    if(std::lock_guard guard(timer_ref_mutex); --refcount == 0) {
       checktime_ios->stop();
@@ -54,7 +63,7 @@ platform_timer::~platform_timer() {
    }
 }
 
-void platform_timer::start(fc::time_point tp) {
+void platform_timer::native_start(fc::time_point tp) {
    if(tp == fc::time_point::maximum()) {
       expired = 0;
       return;
@@ -83,7 +92,7 @@ void platform_timer::start(fc::time_point tp) {
    }
 }
 
-void platform_timer::stop() {
+void platform_timer::native_stop() {
    if(expired)
       return;
 
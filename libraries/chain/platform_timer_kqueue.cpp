@@ -35,9 +35,14 @@ struct platform_timer::impl {
    constexpr static uint64_t quit_event_id = 1;
 };
 
-platform_timer::platform_timer() {
+platform_timer::platform_timer(backend_t b) : _backend(b) {
    static_assert(sizeof(impl) <= fwd_size);
 
+   if(_backend == backend_t::watchdog) {
+      watchdog_create();
+      return;
+   }
+
    std::lock_guard guard(timer_ref_mutex);
 
    if(refcount++ == 0) {
@@ -77,6 +82,10 @@ platform_timer::platform_timer() {
 }
 
 platform_timer::~platform_timer() {
+   if(_backend == backend_t::watchdog) {
+      watchdog_destroy();
+      return;
+   }
    stop();
    if(std::lock_guard guard(timer_ref_mutex); --refcount == 0) {
       struct kevent64_s signal_quit_event;
@@ -88,7 +97,7 @@ platform_timer::~platform_timer() {
    }
 }
 
-void platform_timer::start(fc::time_point tp) {
+void platform_timer::native_start(fc::time_point tp) {
    if(tp == fc::time_point::maximum()) {
       expired = 0;
       return;
@@ -106,7 +115,7 @@ void platform_timer::start(fc::time_point tp) {
    }
 }
 
-void platform_timer::stop() {
+void platform_timer::native_stop() {
    if(expired)
       return;
 
@@ -24,9 +24,14 @@ struct platform_timer::impl {
    }
 };
 
-platform_timer::platform_timer() {
+platform_timer::platform_timer(backend_t b) : _backend(b) {
    static_assert(sizeof(impl) <= fwd_size);
 
+   if(_backend == backend_t::watchdog) {
+      watchdog_create();
+      return;
+   }
+
    static bool initialized;
    static std::mutex initalized_mutex;
 
@@ -50,10 +55,14 @@ platform_timer::platform_timer() {
 }
 
 platform_timer::~platform_timer() {
+   if(_backend == backend_t::watchdog) {
+      watchdog_destroy();
+      return;
+   }
    timer_delete(my->timerid);
 }
 
-void platform_timer::start(fc::time_point tp) {
+void platform_timer::native_start(fc::time_point tp) {
    if(tp == fc::time_point::maximum()) {
       expired = 0;
       return;
@@ -71,7 +80,7 @@ void platform_timer::start(fc::time_point tp) {
    }
 }
 
-void platform_timer::stop() {
+void platform_timer::native_stop() {
    if(expired)
       return;
    struct itimerspec disable = {{0, 0}, {0, 0}};
@@ -0,0 +1,257 @@
+#include <eosio/chain/platform_timer.hpp>
+#include <eosio/chain/platform_timer_accuracy.hpp>
+
+#include <fc/time.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger_config.hpp>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#if defined(__linux__)
+#include <sys/prctl.h>
+#endif
+
+namespace eosio { namespace chain {
+
+static std::atomic<platform_timer::backend_t> default_timer_backend = platform_timer::backend_t::native;
+
+void platform_timer::set_default_backend(backend_t b) {
+   default_timer_backend = b;
+}
+
+platform_timer::backend_t platform_timer::default_backend() {
+   return default_timer_backend;
+}
+
+/**
+ * Watchdog thread shared by all watchdog platform_timers. Each timer owns a slot holding its deadline in ticks of
+ * the invariant TSC, or of steady_clock where no invariant TSC is available. Arming and cancelling are stores to the
+ * slot; the watchdog expires a slot by swapping its deadline out with a compare-exchange, so a deadline cancelled
+ * concurrently is never expired.
+ *
+ * The watchdog sleeps until shortly before the earliest deadline and spins for the remainder. Arming only wakes it,
+ * under its mutex, when the new deadline is earlier than the watchdog planned to look again; with deadlines of tens
+ * of milliseconds and a watchdog that looks at least every idle_us that is rare. Such an arm also sets rearmed, which
+ * the watchdog waits on, so it is not lost when it lands between the watchdog's last look and the start of its wait.
+ */
+class platform_timer_watchdog {
+public:
+   static platform_timer_watchdog& instance() {
+      static platform_timer_watchdog w;
+      return w;
+   }
+
+   uint32_t acquire(platform_timer* t) {
+      std::lock_guard g(mtx);
+      uint32_t i = 0;
+      while(i < max_timers && slots[i].owner.load(std::memory_order_relaxed))
+         ++i;
+      FC_ASSERT(i < max_timers, "exceeded maximum number of watchdog platform timers ${m}", ("m", max_timers));
+      slots[i].deadline.store(disarmed, std::memory_order_relaxed);
+      slots[i].owner.store(t, std::memory_order_release);
+      if(i >= used_slots.load(std::memory_order_relaxed))
+         used_slots.store(i + 1, std::memory_order_release);
+
+      if(refcount++ == 0) {
+         quit = false;
+         watchdog_thread = std::thread([this]() { run(); });
+      }
+      return i;
+   }
+
+   void release(uint32_t i) {
+      std::unique_lock g(mtx);
+      disarm(i); // the owner is about to be destroyed, wait out an in-flight expiration callback
+      slots[i].owner.store(nullptr, std::memory_order_release);
+      if(--refcount == 0) {
+         quit = true;
+         cv.notify_one();
+         g.unlock();
+         watchdog_thread.join();
+      }
+   }
+
+   uint64_t ticks_after(fc::microseconds x) const {
+      return now() + static_cast<uint64_t>(x.count() * ticks_per_us);
+   }
+
+   void arm(uint32_t i, uint64_t deadline) {
+      slots[i].deadline.store(deadline, std::memory_order_seq_cst);
+      if(deadline < wake_at.load(std::memory_order_seq_cst)) {
+         std::lock_guard g(mtx);
+         rearmed = true; // the watchdog may not be waiting yet, so it checks this before and while it waits
+         cv.notify_one();
+      }
+   }
+
+   /// @return false if the deadline expired concurrently, after its expiration callback completed
+   bool disarm(uint32_t i) {
+      auto& s = slots[i];
+      if(s.deadline.exchange(disarmed, std::memory_order_seq_cst) != disarmed)
+         return true;
+      // wait out an in-flight expiration so its callback cannot be mistaken for expiry of the next deadline
+      while(s.firing.load(std::memory_order_acquire))
+         pause();
+      return false;
+   }
+
+private:
+   static constexpr uint32_t max_timers = 256;
+   static constexpr uint64_t disarmed   = std::numeric_limits<uint64_t>::max();
+   static constexpr int64_t  spin_us    = 20;     ///< spin rather than sleep this close to a deadline
+   static constexpr int64_t  idle_us    = 10'000; ///< longest sleep
+
+   struct slot {
+      std::atomic<uint64_t>        deadline = disarmed;
+      std::atomic<bool>            firing   = false;
+      std::atomic<platform_timer*> owner    = nullptr;
+   };
+
+   platform_timer_watchdog() {
+#if defined(__x86_64__)
+      unsigned int eax, ebx, ecx, edx;
+      use_tsc = __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)); // invariant TSC
+      if(use_tsc) {
+         auto     start_time = std::chrono::steady_clock::now();
+         uint64_t start_tsc  = __rdtsc();
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+         uint64_t end_tsc    = __rdtsc();
+         auto     elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+         ticks_per_us = (end_tsc - start_tsc) / elapsed_us;
+      }
+#endif
+   }
+
+   uint64_t now() const {
+#if defined(__x86_64__)
+      if(use_tsc)
+         return __rdtsc();
+#endif
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+   }
+
+   static void pause() {
+#if defined(__x86_64__)
+      _mm_pause();
+#else
+      std::this_thread::yield();
+#endif
+   }
+
+   void fire(slot& s, uint64_t deadline) {
+      s.firing.store(true, std::memory_order_seq_cst);
+      if(s.deadline.compare_exchange_strong(deadline, disarmed, std::memory_order_seq_cst)) {
+         platform_timer* t = s.owner.load(std::memory_order_acquire);
+         t->expired = 1;
+         t->call_expiration_callback();
+      }
+      s.firing.store(false, std::memory_order_release);
+   }
+
+   /// expire due deadlines, @return the earliest remaining deadline
+   uint64_t poll() {
+      uint64_t next = disarmed;
+      const uint64_t t = now();
+      const uint32_t n = used_slots.load(std::memory_order_acquire);
+      for(uint32_t i = 0; i < n; ++i) {
+         uint64_t d = slots[i].deadline.load(std::memory_order_seq_cst);
+         if(d == disarmed)
+            continue;
+         if(d <= t)
+            fire(slots[i], d);
+         else
+            next = std::min(next, d);
+      }
+      return next;
+   }
+
+   void run() {
+      fc::set_thread_name("checktime");
+#if defined(__linux__)
+      prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0); // wake at the requested time rather than up to the default 50us later
+#endif
+      const uint64_t spin_ticks = spin_us * ticks_per_us;
+      const uint64_t idle_ticks = idle_us * ticks_per_us;
+
+      std::unique_lock g(mtx);
+      while(!quit) {
+         rearmed = false;
+         g.unlock();
+         uint64_t next = poll();
+         uint64_t t    = now();
+         if(next != disarmed && next <= t + spin_ticks) {
+            pause();
+            g.lock();
+            continue;
+         }
+
+         // publish when the watchdog looks again so arm() wakes it for anything earlier, then look once more for a
+         // deadline armed before the publication
+         const uint64_t target = next == disarmed ? t + idle_ticks : std::min(next - spin_ticks, t + idle_ticks);
+         wake_at.store(target, std::memory_order_seq_cst);
+         next = poll();
+         g.lock();
+         if(next == disarmed || next > target)
+            cv.wait_for(g, std::chrono::nanoseconds(static_cast<int64_t>((target - t) * 1000 / ticks_per_us)),
+                        [this]() { return quit || rearmed; });
+         wake_at.store(0, std::memory_order_seq_cst);
+      }
+   }
+
+   bool     use_tsc      = false;
+   double   ticks_per_us = 1000.0; // steady_clock nanoseconds
+
+   std::array<slot, max_timers> slots;
+   std::atomic<uint32_t>        used_slots = 0;
+   std::atomic<uint64_t>        wake_at    = 0; ///< when the sleeping watchdog looks again, 0 while awake
+
+   std::mutex                   mtx;
+   std::condition_variable      cv;
+   bool                         quit = false;
+   bool                         rearmed = false; ///< an arm() since the watchdog last looked wants it earlier
+   unsigned                     refcount = 0;
+   std::thread                  watchdog_thread;
+};
+
+void platform_timer::watchdog_create() {
+   _watchdog_slot = platform_timer_watchdog::instance().acquire(this);
+   compute_and_print_timer_accuracy(*this);
+}
+
+void platform_timer::watchdog_destroy() {
+   stop();
+   platform_timer_watchdog::instance().release(_watchdog_slot);
+}
+
+void platform_timer::watchdog_start(fc::time_point tp) {
+   if(tp == fc::time_point::maximum()) {
+      expired = 0;
+      return;
+   }
+   fc::microseconds x = tp.time_since_epoch() - fc::time_point::now().time_since_epoch();
+   if(x.count() <= 0)
+      expired = 1;
+   else {
+      auto& w = platform_timer_watchdog::instance();
+      expired = 0;
+      w.arm(_watchdog_slot, w.ticks_after(x));
+   }
+}
+
+void platform_timer::watchdog_stop() {
+   if(expired)
+      return;
+   platform_timer_watchdog::instance().disarm(_watchdog_slot);
+   expired = 1;
+}
+
+}}
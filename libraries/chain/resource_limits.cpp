@@ -81,6 +81,15 @@ void resource_limits_manager::add_to_snapshot( const snapshot_writer_ptr& snapsh
    });
 }
 
+void resource_limits_manager::copy_snapshot( snapshot_reader& snapshot, snapshot_writer& writer, chainbase::allocator<char> alloc,
+                                             const std::function<bool(const std::string&)>& filter ) {
+   resource_index_set::walk_indices([&]( auto utils ){
+      using value_t = typename decltype(utils)::index_t::value_type;
+      if (filter(detail::snapshot_section_traits<value_t>::section_name()))
+         copy_snapshot_section<value_t>(snapshot, writer, alloc);
+   });
+}
+
 void resource_limits_manager::read_from_snapshot( const snapshot_reader_ptr& snapshot ) {
    resource_index_set::walk_indices([this, &snapshot]( auto utils ){
       snapshot->read_section<typename decltype(utils)::index_t::value_type>([this]( auto& section ) {
@@ -2,6 +2,7 @@
 
 #include <eosio/chain/snapshot.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <fc/scoped_exit.hpp>
 #include <fc/io/json.hpp>
 
@@ -10,10 +11,107 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <numeric>
+
 using namespace eosio_rapidjson;
 
 namespace eosio { namespace chain {
 
+namespace detail {
+
+/// The thread reading ahead the sections of a snapshot, for the lifetime of its reader
+class snapshot_read_ahead_thread {
+   public:
+      snapshot_read_ahead_thread() {
+         pool.start(1, {});
+      }
+
+      boost::asio::io_context& get_executor() { return pool.get_executor(); }
+
+   private:
+      named_thread_pool<struct snapread> pool;
+};
+
+/// Provides a section of the source stream, reading it in chunks with the next chunk read on the read ahead thread.
+/// The source stream must not be used by anything else while a read is in flight, see join().
+class snapshot_read_ahead_buffer : public std::streambuf {
+   public:
+      snapshot_read_ahead_buffer(snapshot_read_ahead_thread& thread, std::istream& src, std::streampos pos, uint64_t size, uint64_t chunk_size)
+      : thread(thread)
+      , src(src)
+      , remaining(size)
+      , chunk_size(std::max<uint64_t>(chunk_size, 1))
+      {
+         src.seekg(pos);
+         start_read();
+      }
+
+      ~snapshot_read_ahead_buffer() override {
+         join();
+      }
+
+      /// wait for the read in flight, the source stream can then be used directly until the next chunk is needed
+      void join() const {
+         if (pending.valid())
+            pending.wait();
+      }
+
+      /// a read of the source stream is in flight
+      bool reading() const {
+         return in_flight;
+      }
+
+      /// bytes of the section provided so far
+      uint64_t consumed() const {
+         return consumed_before + (gptr() - eback());
+      }
+
+   protected:
+      int_type underflow() override {
+         if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+         if (!pending.valid())
+            return traits_type::eof();
+
+         consumed_before += current.size();
+         current = pending.get();
+         start_read();
+
+         setg(current.data(), current.data(), current.data() + current.size());
+         return traits_type::to_int_type(*gptr());
+      }
+
+   private:
+      void start_read() {
+         if (remaining == 0)
+            return;
+         const uint64_t n = std::min(remaining, chunk_size);
+         remaining -= n;
+         in_flight = true;
+         pending = post_async_task(thread.get_executor(), [this, n]() {
+            auto done = fc::make_scoped_exit([this]() { in_flight = false; });
+            std::vector<char> chunk(n);
+            src.read(chunk.data(), n);
+            EOS_ASSERT(static_cast<uint64_t>(src.gcount()) == n, snapshot_exception, "Binary snapshot section is truncated");
+            return chunk;
+         });
+      }
+
+      snapshot_read_ahead_thread&    thread;
+      std::istream&                  src;
+      uint64_t                       remaining;
+      const uint64_t                 chunk_size;
+      std::atomic<bool>              in_flight = false;
+      uint64_t                       consumed_before = 0;
+      std::vector<char>              current;
+      std::future<std::vector<char>> pending;
+};
+
+} // namespace detail
+
 variant_snapshot_writer::variant_snapshot_writer(fc::mutable_variant_object& snapshot)
 : snapshot(snapshot)
 {
@@ -118,18 +216,21 @@ void variant_snapshot_reader::return_to_header() {
    clear_section();
 }
 
-ostream_snapshot_writer::ostream_snapshot_writer(std::ostream& snapshot)
+ostream_snapshot_writer::ostream_snapshot_writer(std::ostream& snapshot, uint32_t version)
 :snapshot(snapshot)
+,version(version)
 ,header_pos(snapshot.tellp())
 ,section_pos(-1)
 ,row_count(0)
 {
+   EOS_ASSERT(minimum_version <= version && version <= current_version, snapshot_exception,
+              "Unsupported binary snapshot version ${v}", ("v", version));
+
    // write magic number
    auto totem = magic_number;
    snapshot.write((char*)&totem, sizeof(totem));
 
    // write version
-   auto version = current_snapshot_version;
    snapshot.write((char*)&version, sizeof(version));
 }
 
@@ -153,17 +254,56 @@ void ostream_snapshot_writer::write_start_section( const std::string& section_na
 }
 
 void ostream_snapshot_writer::write_row( const detail::abstract_snapshot_row_writer& row_writer ) {
-   auto restore = snapshot.tellp();
+   if (version == 1) {
+      auto restore = snapshot.tellp();
+      try {
+         row_writer.write(snapshot);
+      } catch (...) {
+         snapshot.seekp(restore);
+         throw;
+      }
+      row_count++;
+      return;
+   }
+
+   const auto restore = block.size();
    try {
-      row_writer.write(snapshot);
+      detail::buffer_wrapper out(block);
+      row_writer.write(out);
    } catch (...) {
-      snapshot.seekp(restore);
+      block.resize(restore);
       throw;
    }
+   block_sizes.push_back(block.size() - restore);
    row_count++;
+
+   if (block.size() >= block_size || block_sizes.size() >= block_rows)
+      write_block();
+}
+
+void ostream_snapshot_writer::write_block() {
+   if (block_sizes.empty())
+      return;
+
+   const uint32_t num_rows = block_sizes.size();
+   const uint32_t rows_size = block.size();
+   const bool same_size = std::all_of(block_sizes.begin(), block_sizes.end(), [&](uint32_t s) { return s == block_sizes.front(); });
+   const uint32_t row_size = same_size ? block_sizes.front() : variable_row_size;
+
+   snapshot.write((const char*)&num_rows, sizeof(num_rows));
+   snapshot.write((const char*)&rows_size, sizeof(rows_size));
+   snapshot.write((const char*)&row_size, sizeof(row_size));
+   if (!same_size)
+      snapshot.write((const char*)block_sizes.data(), block_sizes.size() * sizeof(uint32_t));
+   snapshot.write(block.data(), block.size());
+
+   block.clear();
+   block_sizes.clear();
 }
 
 void ostream_snapshot_writer::write_end_section( ) {
+   write_block();
+
    auto restore = snapshot.tellp();
 
    uint64_t section_size = restore - section_pos - sizeof(uint64_t);
@@ -189,10 +329,13 @@ void ostream_snapshot_writer::finalize() {
    snapshot.write((char*)&end_marker, sizeof(end_marker));
 }
 
-ostream_json_snapshot_writer::ostream_json_snapshot_writer(std::ostream& snapshot)
+ostream_json_snapshot_writer::ostream_json_snapshot_writer(std::ostream& snapshot, bool write_header)
       :snapshot(snapshot)
       ,row_count(0)
 {
+   if (!write_header)
+      return;
+
    snapshot << "{\n";
    // write magic number
    auto totem = magic_number;
@@ -228,16 +371,23 @@ void ostream_json_snapshot_writer::finalize() {
 }
 
 
-istream_snapshot_reader::istream_snapshot_reader(std::istream& snapshot)
+istream_snapshot_reader::istream_snapshot_reader(std::istream& snapshot, uint64_t read_ahead_size)
 :snapshot(snapshot)
 ,header_pos(snapshot.tellg())
+,read_ahead_size(read_ahead_size)
 ,num_rows(0)
 ,cur_row(0)
 {
 
 }
 
+istream_snapshot_reader::~istream_snapshot_reader() {
+   release_section();
+}
+
 void istream_snapshot_reader::validate() const {
+   join_read_ahead();
+
    // make sure to restore the read pos
    auto restore_pos = fc::make_scoped_exit([this,pos=snapshot.tellg(),ex=snapshot.exceptions()](){
       snapshot.seekg(pos);
@@ -255,12 +405,12 @@ void istream_snapshot_reader::validate() const {
                  "Binary snapshot has unexpected magic number!");
 
       // validate version
-      auto expected_version = current_snapshot_version;
-      decltype(expected_version) actual_version;
+      uint32_t actual_version = 0;
       snapshot.read((char*)&actual_version, sizeof(actual_version));
-      EOS_ASSERT(actual_version == expected_version, snapshot_exception,
-                 "Binary snapshot is an unsuppored version.  Expected : ${expected}, Got: ${actual}",
-                 ("expected", expected_version)("actual", actual_version));
+      EOS_ASSERT(ostream_snapshot_writer::minimum_version <= actual_version && actual_version <= ostream_snapshot_writer::current_version,
+                 snapshot_exception,
+                 "Binary snapshot is an unsuppored version.  Expected : ${min} to ${max}, Got: ${actual}",
+                 ("min", ostream_snapshot_writer::minimum_version)("max", ostream_snapshot_writer::current_version)("actual", actual_version));
 
       while (validate_section()) {}
    } catch( const std::exception& e ) {  \
@@ -284,19 +434,27 @@ bool istream_snapshot_reader::validate_section() const {
    return true;
 }
 
-void istream_snapshot_reader::set_section( const string& section_name ) {
+void istream_snapshot_reader::index_sections() {
+   join_read_ahead();
+
    auto restore_pos = fc::make_scoped_exit([this,pos=snapshot.tellg()](){
+      snapshot.clear();
       snapshot.seekg(pos);
    });
 
-   const std::streamoff header_size = sizeof(ostream_snapshot_writer::magic_number) + sizeof(current_snapshot_version);
+   snapshot.seekg(header_pos + std::streamoff(sizeof(ostream_snapshot_writer::magic_number)));
+   snapshot.read((char*)&version, sizeof(version));
+
+   const std::streamoff header_size = sizeof(ostream_snapshot_writer::magic_number) + sizeof(version);
 
    auto next_section_pos = header_pos + header_size;
 
+   sections.emplace();
    while (true) {
       snapshot.seekg(next_section_pos);
       uint64_t section_size = 0;
       snapshot.read((char*)&section_size,sizeof(section_size));
+      EOS_ASSERT(static_cast<size_t>(snapshot.gcount()) == sizeof(section_size), snapshot_exception, "Binary snapshot is truncated");
       if (section_size == std::numeric_limits<uint64_t>::max()) {
          break;
       }
@@ -306,29 +464,147 @@ void istream_snapshot_reader::set_section( const string& section_name ) {
       uint64_t row_count = 0;
       snapshot.read((char*)&row_count,sizeof(row_count));
 
-      bool match = true;
-      for(auto c : section_name) {
-         if(snapshot.get() != c) {
-            match = false;
-            break;
-         }
-      }
+      std::string name;
+      std::getline(snapshot, name, '\0');
 
-      if (match && snapshot.get() == 0) {
-         cur_row = 0;
-         num_rows = row_count;
+      // the first section with a given name wins, as when scanning for it
+      const auto rows_pos = snapshot.tellg();
+      sections->emplace(std::move(name), section_location{rows_pos, static_cast<uint64_t>(next_section_pos - rows_pos), row_count});
+   }
+}
 
-         // leave the stream at the right point
-         restore_pos.cancel();
-         return;
+void istream_snapshot_reader::release_section() {
+   block.clear();
+   block_sizes.clear();
+   block_num_rows = 0;
+   block_row = 0;
+   block_pos = 0;
+
+   if (!section_buf)
+      return;
+
+   section_buf->join(); // before the stream is used again
+   const auto end_pos = section_rows_pos + std::streamoff(section_buf->consumed());
+   section_stream.reset();
+   section_buf.reset();
+
+   // leave the stream after the last row read, also when a read ahead failed on a truncated section
+   snapshot.clear();
+   snapshot.seekg(end_pos);
+}
+
+void istream_snapshot_reader::join_read_ahead() const {
+   if (!section_buf)
+      return;
+   section_buf->join();
+   EOS_ASSERT(!section_buf->reading(), snapshot_exception, "Binary snapshot stream used while a section is read ahead");
+}
+
+void istream_snapshot_reader::set_section( const string& section_name ) {
+   release_section();
+
+   if (!sections) {
+      index_sections();
+   }
+
+   auto itr = sections->find(section_name);
+   EOS_ASSERT(itr != sections->end(), snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
+
+   cur_row = 0;
+   num_rows = itr->second.row_count;
+   section_rows_pos = itr->second.rows_pos;
+   if (!read_ahead_thread)
+      read_ahead_thread = std::make_unique<detail::snapshot_read_ahead_thread>();
+   section_buf = std::make_unique<detail::snapshot_read_ahead_buffer>(*read_ahead_thread, snapshot, itr->second.rows_pos, itr->second.rows_size, read_ahead_size);
+   section_stream = std::make_unique<std::istream>(section_buf.get());
+   section_stream->exceptions(std::istream::failbit|std::istream::badbit);
+}
+
+std::vector<istream_snapshot_reader::section_info> istream_snapshot_reader::list_sections() {
+   if (!sections) {
+      index_sections();
+   }
+
+   std::vector<std::pair<std::streampos, section_info>> by_pos;
+   by_pos.reserve(sections->size());
+   for (const auto& [name, loc] : *sections) {
+      by_pos.emplace_back(loc.rows_pos, section_info{name, loc.row_count, loc.rows_size});
+   }
+   std::sort(by_pos.begin(), by_pos.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+   std::vector<section_info> result;
+   result.reserve(by_pos.size());
+   for (auto& p : by_pos) {
+      result.emplace_back(std::move(p.second));
+   }
+   return result;
+}
+
+fc::sha256 istream_snapshot_reader::hash_section( const std::string& section_name ) {
+   set_section(section_name);
+   auto clear = fc::make_scoped_exit([this]() { clear_section(); });
+
+   // only the packed rows are hashed, so that the hash does not depend on the binary version
+   fc::sha256::encoder enc;
+   if (version == 1) {
+      std::vector<char> buf(1024*1024);
+      uint64_t remaining = sections->at(section_name).rows_size;
+      while (remaining > 0) {
+         const auto n = std::min<uint64_t>(remaining, buf.size());
+         section_stream->read(buf.data(), n);
+         enc.write(buf.data(), n);
+         remaining -= n;
+      }
+   } else {
+      for (uint64_t rows = 0; rows < num_rows; rows += block_num_rows) {
+         read_block();
+         enc.write(block.data(), block.size());
       }
    }
+   return enc.result();
+}
+
+void istream_snapshot_reader::read_block() {
+   uint32_t rows_size = 0;
+   section_stream->read((char*)&block_num_rows, sizeof(block_num_rows));
+   section_stream->read((char*)&rows_size, sizeof(rows_size));
+   section_stream->read((char*)&block_row_size, sizeof(block_row_size));
+   EOS_ASSERT(block_num_rows > 0, snapshot_exception, "Binary snapshot has an empty block of rows");
+
+   if (block_row_size == ostream_snapshot_writer::variable_row_size) {
+      block_sizes.resize(block_num_rows);
+      section_stream->read((char*)block_sizes.data(), block_sizes.size() * sizeof(uint32_t));
+      const uint64_t total = std::accumulate(block_sizes.begin(), block_sizes.end(), uint64_t(0));
+      EOS_ASSERT(total == rows_size, snapshot_exception, "Binary snapshot block row sizes do not add up to the size of its rows");
+   } else {
+      block_sizes.clear();
+      EOS_ASSERT(uint64_t(block_row_size) * block_num_rows == rows_size, snapshot_exception,
+                 "Binary snapshot block row size does not match the size of its rows");
+   }
 
-   EOS_THROW(snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
+   block.resize(rows_size);
+   section_stream->read(block.data(), block.size());
+   block_row = 0;
+   block_pos = 0;
 }
 
 bool istream_snapshot_reader::read_row( detail::abstract_snapshot_row_reader& row_reader ) {
-   row_reader.provide(snapshot);
+   if (version == 1) {
+      row_reader.provide(*section_stream);
+      return ++cur_row < num_rows;
+   }
+
+   EOS_ASSERT(cur_row < num_rows, snapshot_exception, "Binary snapshot has no more rows in the section");
+   if (block_row == block_num_rows)
+      read_block();
+
+   const uint32_t row_size = block_sizes.empty() ? block_row_size : block_sizes[block_row];
+   fc::datastream<const char*> ds(block.data() + block_pos, row_size);
+   row_reader.provide(ds);
+   EOS_ASSERT(ds.remaining() == 0, snapshot_exception, "Binary snapshot row of ${t} is ${s} bytes but ${r} were unpacked",
+              ("t", row_reader.row_type_name())("s", row_size)("r", row_size - ds.remaining()));
+   block_pos += row_size;
+   ++block_row;
    return ++cur_row < num_rows;
 }
 
@@ -337,13 +613,14 @@ bool istream_snapshot_reader::empty ( ) {
 }
 
 void istream_snapshot_reader::clear_section() {
+   release_section();
    num_rows = 0;
    cur_row = 0;
 }
 
 void istream_snapshot_reader::return_to_header() {
-   snapshot.seekg( header_pos );
    clear_section();
+   snapshot.seekg( header_pos );
 }
 
 struct istream_json_snapshot_reader_impl {
@@ -431,11 +708,16 @@ void istream_json_snapshot_reader::return_to_header() {
    clear_section();
 }
 
-integrity_hash_snapshot_writer::integrity_hash_snapshot_writer(fc::sha256::encoder& enc)
+integrity_hash_snapshot_writer::integrity_hash_snapshot_writer(fc::sha256::encoder& enc, std::optional<std::string> section)
 :enc(enc)
+,section(std::move(section))
 {
 }
 
+bool integrity_hash_snapshot_writer::accepts_section( const std::string& section_name ) const {
+   return !section || *section == section_name;
+}
+
 void integrity_hash_snapshot_writer::write_start_section( const std::string& )
 {
    // no-op for structural details
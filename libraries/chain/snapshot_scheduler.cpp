@@ -113,6 +113,12 @@ void snapshot_scheduler::set_snapshots_path(fs::path sn_path) {
    _snapshots_dir = std::move(sn_path);
 }
 
+void snapshot_scheduler::set_snapshot_version(uint32_t version) {
+   EOS_ASSERT(ostream_snapshot_writer::minimum_version <= version && version <= ostream_snapshot_writer::current_version,
+              snapshot_exception, "Unsupported binary snapshot version ${v}", ("v", version));
+   _snapshot_version = version;
+}
+
 void snapshot_scheduler::add_pending_snapshot_info(const snapshot_information& si) {
    auto& snapshot_by_id = _snapshot_requests.get<by_snapshot_id>();
    auto snapshot_req = snapshot_by_id.find(_inflight_sid);
@@ -174,7 +180,7 @@ void snapshot_scheduler::create_snapshot(next_function<snapshot_information> nex
       if(predicate) predicate();
       fs::create_directory(p.parent_path());
       auto snap_out = std::ofstream(p.generic_string(), (std::ios::out | std::ios::binary));
-      auto writer = std::make_shared<ostream_snapshot_writer>(snap_out);
+      auto writer = std::make_shared<ostream_snapshot_writer>(snap_out, _snapshot_version);
       chain.write_snapshot(writer);
       writer->finalize();
       snap_out.flush();
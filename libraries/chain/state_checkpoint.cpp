@@ -0,0 +1,505 @@
+#include <eosio/chain/state_checkpoint.hpp>
+#include <eosio/chain/config.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/log_catalog.hpp>
+
+#include <fc/crypto/city.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/io/cfile.hpp>
+#include <fc/io/fstream.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/scoped_exit.hpp>
+
+#include <chainbase/pinnable_mapped_file.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace eosio::chain {
+
+namespace {
+
+   constexpr uint32_t checkpoint_magic   = 0x504b4353; // "SCKP"
+   constexpr uint32_t checkpoint_version = 1;
+
+   const char* checkpoint_pattern = R"(checkpoint-\d+\.bin)";
+
+   std::filesystem::path checkpoint_path( const std::filesystem::path& dir, uint64_t seq ) {
+      return dir / ("checkpoint-" + std::to_string(seq) + ".bin");
+   }
+
+   /// file descriptor read and written at explicit offsets
+   class fd_file {
+   public:
+      fd_file( const std::filesystem::path& path, int flags, mode_t mode = 0 ) : path(path) {
+         fd = ::open( path.c_str(), flags | O_CLOEXEC, mode );
+         EOS_ASSERT( fd >= 0, state_checkpoint_exception, "unable to open ${p}: ${e}", ("p", path)("e", std::strerror(errno)) );
+      }
+      ~fd_file() { ::close( fd ); }
+
+      fd_file( const fd_file& ) = delete;
+      fd_file& operator=( const fd_file& ) = delete;
+
+      uint64_t size() const {
+         struct stat st;
+         EOS_ASSERT( ::fstat( fd, &st ) == 0, state_checkpoint_exception, "unable to stat ${p}: ${e}", ("p", path)("e", std::strerror(errno)) );
+         return st.st_size;
+      }
+
+      void read_at( uint64_t offset, char* d, size_t n ) const {
+         while( n > 0 ) {
+            const ssize_t r = ::pread( fd, d, n, offset );
+            if( r < 0 && errno == EINTR )
+               continue;
+            EOS_ASSERT( r > 0, state_checkpoint_exception, "unable to read ${n} bytes at ${o} of ${p}: ${e}",
+                        ("n", n)("o", offset)("p", path)("e", r < 0 ? std::strerror(errno) : "end of file") );
+            d += r;
+            n -= r;
+            offset += r;
+         }
+      }
+
+      void write_at( uint64_t offset, const char* d, size_t n ) {
+         while( n > 0 ) {
+            const ssize_t r = ::pwrite( fd, d, n, offset );
+            if( r < 0 && errno == EINTR )
+               continue;
+            EOS_ASSERT( r > 0, state_checkpoint_exception, "unable to write ${n} bytes at ${o} of ${p}: ${e}",
+                        ("n", n)("o", offset)("p", path)("e", std::strerror(errno)) );
+            d += r;
+            n -= r;
+            offset += r;
+         }
+      }
+
+      void resize( uint64_t size ) {
+         EOS_ASSERT( ::ftruncate( fd, size ) == 0, state_checkpoint_exception, "unable to resize ${p}: ${e}", ("p", path)("e", std::strerror(errno)) );
+      }
+
+      void sync() {
+         EOS_ASSERT( ::fsync( fd ) == 0, state_checkpoint_exception, "unable to sync ${p}: ${e}", ("p", path)("e", std::strerror(errno)) );
+      }
+
+      /// @return true if [offset, offset + n) is a hole, `begin` and `end` cache the data region at or after the last offset asked
+      bool is_hole( uint64_t offset, uint64_t n, uint64_t file_size, uint64_t& begin, uint64_t& end ) const {
+         if( offset >= end ) {
+            const off_t d = ::lseek( fd, offset, SEEK_DATA );
+            if( d < 0 ) {
+               // ENXIO: no data past offset, otherwise the file system cannot tell and everything is data
+               begin = errno == ENXIO ? file_size : offset;
+               end   = file_size;
+            } else {
+               begin = d;
+               const off_t h = ::lseek( fd, d, SEEK_HOLE );
+               end = h < 0 ? file_size : h;
+            }
+         }
+         return offset + n <= begin;
+      }
+
+   private:
+      std::filesystem::path path;
+      int                   fd = -1;
+   };
+
+   /// writes to a file and hashes what is written, for fc::raw::pack
+   struct hashing_writer {
+      fc::cfile&          file;
+      fc::sha256::encoder enc;
+
+      void write( const char* d, size_t n ) {
+         file.write( d, n );
+         enc.write( d, n );
+      }
+      void put( char c ) { write( &c, 1 ); }
+   };
+
+   /// reads from a file and hashes what is read, for fc::raw::unpack
+   struct hashing_reader {
+      fc::cfile&          file;
+      fc::sha256::encoder enc;
+
+      bool read( char* d, size_t n ) {
+         file.read( d, n );
+         enc.write( d, n );
+         return true;
+      }
+      bool get( char& c ) { return read( &c, 1 ); }
+      bool get( unsigned char& c ) { return read( reinterpret_cast<char*>(&c), 1 ); }
+   };
+
+   template<typename Stream>
+   void read_header( Stream& ds, state_checkpoint_info& info ) {
+      uint32_t magic = 0, version = 0;
+      fc::raw::unpack( ds, magic );
+      EOS_ASSERT( magic == checkpoint_magic, state_checkpoint_exception, "${f} is not a state checkpoint", ("f", info.file) );
+      fc::raw::unpack( ds, version );
+      EOS_ASSERT( version == checkpoint_version, state_checkpoint_exception, "${f} has unsupported version ${v}", ("f", info.file)("v", version) );
+      fc::raw::unpack( ds, info.seq );
+      fc::raw::unpack( ds, info.parent_seq );
+      ds >> info.chain_id;
+      fc::raw::unpack( ds, info.head_block_num );
+      fc::raw::unpack( ds, info.head_block_id );
+      fc::raw::unpack( ds, info.state_size );
+      fc::raw::unpack( ds, info.chunk_size );
+      fc::raw::unpack( ds, info.num_chunks );
+      EOS_ASSERT( info.chunk_size > 0, state_checkpoint_exception, "${f} has a chunk size of 0", ("f", info.file) );
+   }
+
+   state_checkpoint_info read_info( const std::filesystem::path& file ) {
+      state_checkpoint_info info;
+      info.file = file;
+      fc::datastream<fc::cfile> f;
+      f.set_file_path( file );
+      f.open( "rb" );
+      read_header( f, info );
+      const auto name = file.filename().string();
+      EOS_ASSERT( name == checkpoint_path( {}, info.seq ).filename().string(), state_checkpoint_exception,
+                  "${f} holds checkpoint ${s}", ("f", file)("s", info.seq) );
+      return info;
+   }
+
+   bool is_fork_db_file( const std::string& name ) {
+      return name == config::forkdb_filename || name == config::forkdb_journal_filename;
+   }
+
+   using fork_db_files = std::vector<std::pair<std::string, std::vector<char>>>;
+
+   /// read and verify a whole checkpoint, calling on_chunk(index, data) for each chunk
+   template<typename OnChunk>
+   fork_db_files read_checkpoint( const state_checkpoint_info& info, OnChunk&& on_chunk ) {
+      fc::datastream<fc::cfile> f;
+      f.set_file_path( info.file );
+      f.open( "rb" );
+      const uint64_t file_size = std::filesystem::file_size( info.file );
+
+      hashing_reader ds{f};
+      state_checkpoint_info header;
+      header.file = info.file;
+      read_header( ds, header );
+      EOS_ASSERT( header.seq == info.seq && header.parent_seq == info.parent_seq && header.state_size == info.state_size &&
+                  header.chunk_size == info.chunk_size && header.num_chunks == info.num_chunks, state_checkpoint_exception,
+                  "${f} changed while it was read", ("f", info.file) );
+
+      const uint64_t state_chunks = (header.state_size + header.chunk_size - 1) / header.chunk_size;
+      std::vector<char> data;
+      uint64_t next_index = 0;
+      for( uint64_t i = 0; i < header.num_chunks; ++i ) {
+         uint64_t index = 0, digest = 0;
+         uint32_t size = 0;
+         fc::raw::unpack( ds, index );
+         fc::raw::unpack( ds, size );
+         fc::raw::unpack( ds, digest );
+         EOS_ASSERT( index >= next_index && index < state_chunks, state_checkpoint_exception,
+                     "${f} holds chunk ${i} out of order or past the end of the state", ("f", info.file)("i", index) );
+         const uint64_t offset = index * header.chunk_size;
+         EOS_ASSERT( size == std::min<uint64_t>( header.chunk_size, header.state_size - offset ), state_checkpoint_exception,
+                     "${f} holds chunk ${i} of size ${s}", ("f", info.file)("i", index)("s", size) );
+         EOS_ASSERT( f.tellp() + size <= file_size, state_checkpoint_exception, "${f} is truncated", ("f", info.file) );
+         data.resize( size );
+         ds.read( data.data(), size );
+         EOS_ASSERT( fc::city_hash64( data.data(), size ) == digest, state_checkpoint_exception,
+                     "${f} chunk ${i} does not match its digest", ("f", info.file)("i", index) );
+         on_chunk( index, data );
+         next_index = index + 1;
+      }
+
+      fork_db_files files;
+      fc::raw::unpack( ds, files );
+      for( const auto& [name, contents] : files )
+         EOS_ASSERT( is_fork_db_file( name ), state_checkpoint_exception, "${f} holds unexpected file ${n}", ("f", info.file)("n", name) );
+
+      const fc::sha256 expected = ds.enc.result();
+      fc::sha256 hash;
+      uint32_t magic = 0;
+      fc::raw::unpack( f, hash );
+      fc::raw::unpack( f, magic );
+      EOS_ASSERT( magic == checkpoint_magic && f.tellp() == file_size, state_checkpoint_exception,
+                  "${f} has an invalid trailer", ("f", info.file) );
+      EOS_ASSERT( hash == expected, state_checkpoint_exception, "${f} does not match its hash", ("f", info.file) );
+      return files;
+   }
+
+   /// the checkpoints to apply in order to restore `seq`, from a full one to `seq`
+   std::vector<state_checkpoint_info> resolve_chain( const std::filesystem::path& dir, std::optional<uint64_t> seq ) {
+      auto all = list_state_checkpoints( dir );
+      EOS_ASSERT( !all.empty(), state_checkpoint_exception, "no state checkpoint found in ${d}", ("d", dir) );
+
+      std::map<uint64_t, state_checkpoint_info> by_seq;
+      for( auto& info : all )
+         by_seq.emplace( info.seq, std::move(info) );
+
+      auto itr = seq ? by_seq.find( *seq ) : std::prev( by_seq.end() );
+      EOS_ASSERT( itr != by_seq.end(), state_checkpoint_exception, "state checkpoint ${s} not found in ${d}", ("s", *seq)("d", dir) );
+
+      std::vector<state_checkpoint_info> chain{ itr->second };
+      while( chain.back().parent_seq != 0 ) {
+         const auto& child = chain.back();
+         auto parent = by_seq.find( child.parent_seq );
+         EOS_ASSERT( parent != by_seq.end(), state_checkpoint_exception,
+                     "state checkpoint ${s} applies on top of checkpoint ${p} which is missing", ("s", child.seq)("p", child.parent_seq) );
+         EOS_ASSERT( parent->second.seq < child.seq && parent->second.chain_id == child.chain_id &&
+                     parent->second.chunk_size == child.chunk_size, state_checkpoint_exception,
+                     "state checkpoint ${s} does not apply on top of checkpoint ${p}", ("s", child.seq)("p", child.parent_seq) );
+         chain.push_back( parent->second );
+      }
+      std::reverse( chain.begin(), chain.end() );
+      return chain;
+   }
+
+} // namespace
+
+state_checkpoint_writer::state_checkpoint_writer( state_checkpoint_config cfg, std::filesystem::path state_file, std::filesystem::path fork_db_dir )
+   : cfg( std::move(cfg) )
+   , state_file( std::move(state_file) )
+   , fork_db_dir( std::move(fork_db_dir) ) {
+   std::filesystem::create_directories( this->cfg.dir );
+   for_each_file_in_dir_matches( this->cfg.dir, R"(checkpoint-\d+\.bin\.tmp)", []( const std::filesystem::path& p ) {
+      std::filesystem::remove( p );
+   } );
+   for( const auto& info : list_state_checkpoints( this->cfg.dir ) )
+      last_seq = std::max( last_seq, info.seq );
+}
+
+state_checkpoint_info state_checkpoint_writer::write( const chain_id_type& chain_id, uint32_t head_block_num, const block_id_type& head_block_id ) {
+   const auto start = fc::time_point::now();
+   fd_file state( state_file, O_RDONLY );
+   const uint64_t state_size = state.size();
+   const uint32_t chunk_size = default_chunk_size;
+   const uint64_t n = (state_size + chunk_size - 1) / chunk_size;
+   const bool full = digests.size() != n || increments_since_full >= cfg.increments_per_full;
+
+   // digest each chunk, the ranges of chunks are split between threads
+   std::vector<uint64_t> new_digests( n );
+   std::vector<char>     holes( n );
+   {
+      const std::vector<char> zeros( chunk_size );
+      const uint64_t zero_digest = fc::city_hash64( zeros.data(), chunk_size );
+      const uint32_t num_threads = std::clamp<uint64_t>( cfg.threads, 1, std::max<uint64_t>( n, 1 ) );
+      const uint64_t per_thread  = (n + num_threads - 1) / num_threads;
+      std::vector<std::exception_ptr> errors( num_threads );
+
+      auto digest_range = [&]( uint32_t t ) {
+         try {
+            std::vector<char> buf( chunk_size );
+            uint64_t data_begin = 0, data_end = 0;
+            for( uint64_t i = t * per_thread; i < std::min( n, (t + 1) * per_thread ); ++i ) {
+               const uint64_t offset = i * chunk_size;
+               const uint64_t size   = std::min<uint64_t>( chunk_size, state_size - offset );
+               if( state.is_hole( offset, size, state_size, data_begin, data_end ) ) {
+                  holes[i] = 1;
+                  new_digests[i] = size == chunk_size ? zero_digest : fc::city_hash64( zeros.data(), size );
+                  continue;
+               }
+               state.read_at( offset, buf.data(), size );
+               new_digests[i] = fc::city_hash64( buf.data(), size );
+            }
+         } catch( ... ) {
+            errors[t] = std::current_exception();
+         }
+      };
+
+      std::vector<std::thread> workers;
+      for( uint32_t t = 1; t < num_threads; ++t )
+         workers.emplace_back( digest_range, t );
+      digest_range( 0 );
+      for( auto& w : workers )
+         w.join();
+      for( auto& e : errors ) {
+         if( e )
+            std::rethrow_exception( e );
+      }
+   }
+
+   std::vector<uint64_t> chunks;
+   for( uint64_t i = 0; i < n; ++i ) {
+      if( full ? !holes[i] : new_digests[i] != digests[i] )
+         chunks.push_back( i );
+   }
+
+   state_checkpoint_info info;
+   info.seq            = last_seq + 1;
+   info.parent_seq     = full ? 0 : last_seq;
+   info.file           = checkpoint_path( cfg.dir, info.seq );
+   info.chain_id       = chain_id;
+   info.head_block_num = head_block_num;
+   info.head_block_id  = head_block_id;
+   info.state_size     = state_size;
+   info.chunk_size     = chunk_size;
+   info.num_chunks     = chunks.size();
+
+   const auto tmp_file = std::filesystem::path( info.file ).concat( ".tmp" );
+   auto remove_tmp = fc::make_scoped_exit( [&tmp_file]() {
+      std::error_code ec;
+      std::filesystem::remove( tmp_file, ec );
+   } );
+
+   fc::datastream<fc::cfile> out;
+   out.set_file_path( tmp_file );
+   out.open( fc::cfile::truncate_rw_mode );
+   hashing_writer ds{out};
+   fc::raw::pack( ds, checkpoint_magic );
+   fc::raw::pack( ds, checkpoint_version );
+   fc::raw::pack( ds, info.seq );
+   fc::raw::pack( ds, info.parent_seq );
+   ds << info.chain_id;
+   fc::raw::pack( ds, info.head_block_num );
+   fc::raw::pack( ds, info.head_block_id );
+   fc::raw::pack( ds, info.state_size );
+   fc::raw::pack( ds, info.chunk_size );
+   fc::raw::pack( ds, info.num_chunks );
+
+   std::vector<char> buf( chunk_size );
+   for( uint64_t i : chunks ) {
+      const uint64_t offset = i * chunk_size;
+      const uint32_t size   = std::min<uint64_t>( chunk_size, state_size - offset );
+      state.read_at( offset, buf.data(), size );
+      fc::raw::pack( ds, i );
+      fc::raw::pack( ds, size );
+      fc::raw::pack( ds, new_digests[i] );
+      ds.write( buf.data(), size );
+   }
+
+   // the fork database journal is flushed as it is appended, a record cut short at its end is discarded on open
+   fork_db_files files;
+   for( const char* name : { config::forkdb_filename, config::forkdb_journal_filename } ) {
+      const auto path = fork_db_dir / name;
+      if( !std::filesystem::exists( path ) )
+         continue;
+      std::string contents;
+      fc::read_file_contents( path, contents );
+      files.emplace_back( name, std::vector<char>( contents.begin(), contents.end() ) );
+   }
+   fc::raw::pack( ds, files );
+
+   fc::raw::pack( out, ds.enc.result() );
+   fc::raw::pack( out, checkpoint_magic );
+   out.flush();
+   out.sync();
+   out.close();
+   std::filesystem::rename( tmp_file, info.file );
+   remove_tmp.cancel();
+
+   digests = std::move( new_digests );
+   last_seq = info.seq;
+   increments_since_full = full ? 0 : increments_since_full + 1;
+   if( full )
+      remove_expired();
+
+   ilog( "wrote ${t} state checkpoint ${s} at block ${b}, ${c} of ${n} chunks in ${d}ms",
+         ("t", full ? "full" : "incremental")("s", info.seq)("b", head_block_num)("c", chunks.size())("n", n)
+         ("d", (fc::time_point::now() - start).count() / 1000) );
+   return info;
+}
+
+void state_checkpoint_writer::remove_expired() {
+   auto all = list_state_checkpoints( cfg.dir );
+   std::vector<uint64_t> full_seqs;
+   for( const auto& info : all ) {
+      if( info.parent_seq == 0 )
+         full_seqs.push_back( info.seq );
+   }
+   if( full_seqs.size() <= std::max<uint32_t>( cfg.retained_full, 1 ) )
+      return;
+
+   // keep the retained full checkpoints and everything written after the oldest of them
+   const uint64_t oldest_kept = full_seqs[full_seqs.size() - std::max<uint32_t>( cfg.retained_full, 1 )];
+   for( const auto& info : all ) {
+      if( info.seq < oldest_kept ) {
+         ilog( "removing state checkpoint ${f}", ("f", info.file) );
+         std::filesystem::remove( info.file );
+      }
+   }
+}
+
+std::vector<state_checkpoint_info> list_state_checkpoints( const std::filesystem::path& dir ) {
+   std::vector<state_checkpoint_info> result;
+   if( !std::filesystem::is_directory( dir ) )
+      return result;
+   for_each_file_in_dir_matches( dir, checkpoint_pattern, [&result]( const std::filesystem::path& p ) {
+      try {
+         result.push_back( read_info( p ) );
+      } catch( const fc::exception& e ) {
+         wlog( "ignoring unreadable state checkpoint ${p}: ${e}", ("p", p)("e", e.to_string()) );
+      } catch( const std::exception& e ) {
+         wlog( "ignoring unreadable state checkpoint ${p}: ${e}", ("p", p)("e", e.what()) );
+      }
+   } );
+   std::sort( result.begin(), result.end(), []( const auto& a, const auto& b ) { return a.seq < b.seq; } );
+   return result;
+}
+
+std::vector<state_checkpoint_info> verify_state_checkpoint( const std::filesystem::path& dir, std::optional<uint64_t> seq ) {
+   auto chain = resolve_chain( dir, seq );
+   for( const auto& info : chain )
+      read_checkpoint( info, []( uint64_t, const std::vector<char>& ) {} );
+   return chain;
+}
+
+state_checkpoint_info restore_state_checkpoint( const std::filesystem::path& dir, std::optional<uint64_t> seq,
+                                                const std::filesystem::path& state_dir, const std::filesystem::path& fork_db_dir ) {
+   const auto chain = resolve_chain( dir, seq );
+   const auto& target = chain.back();
+
+   const auto state_file = state_dir / "shared_memory.bin";
+   EOS_ASSERT( !std::filesystem::exists( state_file ), state_checkpoint_exception,
+               "${f} already exists, remove it before restoring a state checkpoint", ("f", state_file) );
+   std::filesystem::create_directories( state_dir );
+   std::filesystem::create_directories( fork_db_dir );
+
+   // chunks are written into a sparse file, a chunk absent from the full checkpoint was a hole
+   const auto tmp_file = std::filesystem::path( state_file ).concat( ".tmp" );
+   std::filesystem::remove( tmp_file );
+   auto remove_tmp = fc::make_scoped_exit( [&tmp_file]() {
+      std::error_code ec;
+      std::filesystem::remove( tmp_file, ec );
+   } );
+
+   fork_db_files files;
+   {
+      fd_file state( tmp_file, O_RDWR | O_CREAT | O_EXCL, 0644 );
+      for( const auto& info : chain ) {
+         state.resize( info.state_size );
+         files = read_checkpoint( info, [&]( uint64_t index, const std::vector<char>& data ) {
+            state.write_at( index * info.chunk_size, data.data(), data.size() );
+         } );
+      }
+
+      // the checkpoint was read from a database open for writing, which chainbase marks as dirty while it is open
+      EOS_ASSERT( target.state_size >= chainbase::header_size, state_checkpoint_exception, "state checkpoint ${s} is too small", ("s", target.seq) );
+      char header[chainbase::header_size];
+      state.read_at( 0, header, sizeof(header) );
+      auto* dbheader = reinterpret_cast<chainbase::db_header*>( header );
+      EOS_ASSERT( dbheader->id == chainbase::header_id, state_checkpoint_exception,
+                  "state checkpoint ${s} does not hold a compatible chainbase database", ("s", target.seq) );
+      dbheader->dirty = false;
+      state.write_at( 0, header, sizeof(header) );
+      state.sync();
+   }
+   std::filesystem::rename( tmp_file, state_file );
+   remove_tmp.cancel();
+
+   for( const char* name : { config::forkdb_filename, config::forkdb_journal_filename } )
+      std::filesystem::remove( fork_db_dir / name );
+   for( const auto& [name, contents] : files ) {
+      fc::cfile out;
+      out.set_file_path( fork_db_dir / name );
+      out.open( fc::cfile::truncate_rw_mode );
+      out.write( contents.data(), contents.size() );
+      out.flush();
+      out.sync();
+   }
+
+   ilog( "restored state checkpoint ${s} at block ${b} from ${n} checkpoint files", ("s", target.seq)("b", target.head_block_num)("n", chain.size()) );
+   return target;
+}
+
+} /// namespace eosio::chain
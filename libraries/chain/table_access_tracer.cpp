@@ -0,0 +1,100 @@
+#include <eosio/chain/table_access_tracer.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace eosio::chain {
+
+void table_access_tracer::update_logger( const std::string& logger_name ) {
+   fc::logger::update( logger_name, _logger );
+}
+
+void table_access_tracer::on_start_block( uint32_t ) {
+   _pending.clear(); // transactions of an aborted block
+}
+
+void table_access_tracer::on_applied_transaction( const transaction_id_type& id, uint32_t cpu_usage_us, table_access_set&& access ) {
+   _pending.push_back( trx_access{id, cpu_usage_us, std::move(access)} );
+}
+
+table_access_tracer::block_summary table_access_tracer::on_accepted_block( uint32_t block_num ) {
+   struct key_state {
+      int64_t               last_writer = -1;
+      std::vector<uint32_t> readers; ///< since the last write
+   };
+   std::map<table_access_key, key_state> keys;
+
+   const bool log = _logger.is_enabled( fc::log_level::debug );
+   std::vector<std::pair<uint32_t, uint32_t>> edges;
+   std::vector<uint32_t> wave( _pending.size() );
+   std::vector<uint64_t> finish_cpu_us( _pending.size() );
+
+   block_summary s{ .block_num = block_num, .trxs = static_cast<uint32_t>(_pending.size()) };
+   for( uint32_t i = 0; i < _pending.size(); ++i ) {
+      const auto& t = _pending[i];
+      flat_set<uint32_t> preds;
+      for( const auto& k : t.access.reads ) {
+         if( auto itr = keys.find( k ); itr != keys.end() && itr->second.last_writer >= 0 )
+            preds.insert( itr->second.last_writer );
+      }
+      for( const auto& k : t.access.writes ) {
+         if( auto itr = keys.find( k ); itr != keys.end() ) {
+            if( itr->second.last_writer >= 0 )
+               preds.insert( itr->second.last_writer );
+            preds.insert( itr->second.readers.begin(), itr->second.readers.end() );
+         }
+      }
+      for( const auto& k : t.access.reads )
+         keys[k].readers.push_back( i );
+      for( const auto& k : t.access.writes ) {
+         auto& ks = keys[k];
+         ks.last_writer = i;
+         ks.readers.clear();
+      }
+
+      uint32_t w = 0;
+      uint64_t start_cpu_us = 0;
+      for( uint32_t p : preds ) {
+         w = std::max( w, wave[p] + 1 );
+         start_cpu_us = std::max( start_cpu_us, finish_cpu_us[p] );
+         if( log )
+            edges.emplace_back( p, i );
+      }
+      wave[i] = w;
+      finish_cpu_us[i] = start_cpu_us + t.cpu_usage_us;
+
+      s.waves = std::max( s.waves, w + 1 );
+      s.conflicts += preds.size();
+      s.cpu_usage_us += t.cpu_usage_us;
+      s.critical_path_cpu_us = std::max( s.critical_path_cpu_us, finish_cpu_us[i] );
+   }
+
+   if( log ) {
+      fc::variants trxs;
+      trxs.reserve( _pending.size() );
+      for( uint32_t i = 0; i < _pending.size(); ++i ) {
+         const auto& t = _pending[i];
+         trxs.emplace_back( fc::mutable_variant_object()
+                               ( "id", t.id )( "cpu_usage_us", t.cpu_usage_us )( "wave", wave[i] )
+                               ( "reads", t.access.reads )( "writes", t.access.writes ) );
+      }
+      fc_dlog( _logger, "TABLE_ACCESS ${b}",
+               ("b", fc::json::to_string( fc::mutable_variant_object()( "summary", s )( "trxs", trxs )( "edges", edges ),
+                                          fc::time_point::maximum() )) );
+   }
+
+   ++_totals.blocks;
+   _totals.trxs                 += s.trxs;
+   _totals.waves                += s.waves;
+   _totals.conflicts            += s.conflicts;
+   _totals.cpu_usage_us         += s.cpu_usage_us;
+   _totals.critical_path_cpu_us += s.critical_path_cpu_us;
+
+   _pending.clear();
+   return s;
+}
+
+} // namespace eosio::chain
@@ -7,6 +7,7 @@
 #include <eosio/chain/transaction_object.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/deep_mind.hpp>
+#include <eosio/chain/action_profiler.hpp>
 
 #pragma push_macro("N")
 #undef N
@@ -407,6 +408,9 @@ namespace eosio { namespace chain {
 
       rl.add_transaction_usage( bill_to_accounts, static_cast<uint64_t>(billed_cpu_time_us), net_usage,
                                 block_timestamp_type(control.pending_block_time()).slot, is_transient() ); // Should never fail
+
+      if( auto* profiler = control.get_action_profiler() )
+         profiler->record_billed_cpu( *trace, billed_cpu_time_us );
    }
 
    void transaction_context::squash() {
@@ -32,11 +32,16 @@
 
 namespace eosio { namespace chain {
 
-   wasm_interface::wasm_interface(vm_type vm, const chainbase::database& d, const std::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, bool profile)
-     : my( new wasm_interface_impl(vm, d, data_dir, eosvmoc_config, profile) ) {}
+   wasm_interface::wasm_interface(vm_type vm, const chainbase::database& d, const std::filesystem::path data_dir, const eosvmoc::config& eosvmoc_config, bool profile,
+                                  std::shared_ptr<wasm_module_store> module_store)
+     : my( new wasm_interface_impl(vm, d, data_dir, eosvmoc_config, profile, std::move(module_store)) ) {}
 
    wasm_interface::~wasm_interface() {}
 
+   std::shared_ptr<wasm_module_store> wasm_interface::make_module_store() {
+      return std::make_shared<wasm_module_store>();
+   }
+
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
    void wasm_interface::init_thread_local_data() {
       if (my->wasm_runtime_time == wasm_interface::vm_type::eos_vm_oc && my->runtime_interface)
@@ -88,6 +93,26 @@ namespace eosio { namespace chain {
       return my->is_code_cached(code_hash, vm_type, vm_version);
    }
 
+   bool wasm_interface::is_code_preinstantiated(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const {
+      return my->is_code_preinstantiated(code_hash, vm_type, vm_version);
+   }
+
+   bool wasm_interface::begin_preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version) {
+      return my->module_store->begin_preinstantiate(code_hash, vm_type, vm_version);
+   }
+
+   void wasm_interface::preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, const std::vector<char>& code, uint32_t evictable_after) {
+      my->preinstantiate(code_hash, vm_type, vm_version, code, evictable_after);
+   }
+
+   void wasm_interface::stop_preinstantiate() {
+      my->module_store->stop_preinstantiate();
+   }
+
+   std::vector<std::tuple<digest_type, uint8_t, uint8_t>> wasm_interface::recently_used_code(size_t max_size) const {
+      return my->module_store->recently_used(max_size);
+   }
+
    wasm_instantiated_module_interface::~wasm_instantiated_module_interface() = default;
    wasm_runtime_interface::~wasm_runtime_interface() = default;
 
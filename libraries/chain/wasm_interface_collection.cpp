@@ -37,7 +37,16 @@ wasm_interface_collection::wasm_interface_collection(wasm_interface::vm_type vm,
    : main_thread_id(std::this_thread::get_id())
    , wasm_runtime(vm)
    , eosvmoc_tierup(eosvmoc_tierup)
-   , wasmif(vm, d, data_dir, eosvmoc_config, profile) {
+   // eos-vm-oc as the base runtime keeps its per thread executor in its runtime, and a profiled module records its
+   // profile in the module itself, so neither is shared
+   , module_store(vm != wasm_interface::vm_type::eos_vm_oc && !profile ? wasm_interface::make_module_store() : nullptr)
+   , wasmif(vm, d, data_dir, eosvmoc_config, profile, module_store) {
+   if (module_store) {
+      preinstantiate_wasmif = std::make_unique<wasm_interface>(vm, d, data_dir, eosvmoc_config, profile, module_store);
+      preinstantiate_thread_pool.start(1, [](const fc::exception& e) {
+         elog("Exception in wasm preinstantiate thread: ${e}", ("e", e.to_detail_string()));
+      });
+   }
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
    if (eosvmoc_tierup != wasm_interface::vm_oc_enable::oc_none) {
       EOS_ASSERT(vm != wasm_interface::vm_type::eos_vm_oc, wasm_exception, "You can't use EOS VM OC as the base runtime when tier up is activated");
@@ -46,7 +55,12 @@ wasm_interface_collection::wasm_interface_collection(wasm_interface::vm_type vm,
 #endif
 }
 
-wasm_interface_collection::~wasm_interface_collection() = default;
+wasm_interface_collection::~wasm_interface_collection() {
+   // preinstantiations still queued are dropped with the thread, applies waiting for them instantiate the code instead
+   preinstantiate_thread_pool.stop();
+   if (preinstantiate_wasmif)
+      preinstantiate_wasmif->stop_preinstantiate();
+}
 
 void wasm_interface_collection::apply(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, apply_context& context) {
    if (substitute_apply && substitute_apply(code_hash, vm_type, vm_version, context))
@@ -95,8 +109,10 @@ void wasm_interface_collection::current_lib(const uint32_t lib) {
    }
 #endif
    wasmif.current_lib(lib, cb);
-   for (auto& w : threaded_wasmifs) {
-      w.second->current_lib(lib, cb);
+   if (!module_store) { // otherwise the read-only threads share the module store of the main thread
+      for (auto& w : threaded_wasmifs) {
+         w.second->current_lib(lib, cb);
+      }
    }
 }
 
@@ -115,7 +131,18 @@ void wasm_interface_collection::init_thread_local_data(const chainbase::database
 
    std::lock_guard g(threaded_wasmifs_mtx);
    // Non-EOSVMOC needs a wasmif per thread
-   threaded_wasmifs[std::this_thread::get_id()] = std::make_unique<wasm_interface>(wasm_runtime, d, data_dir, eosvmoc_config, profile);
+   threaded_wasmifs[std::this_thread::get_id()] = std::make_unique<wasm_interface>(wasm_runtime, d, data_dir, eosvmoc_config, profile, module_store);
+}
+
+void wasm_interface_collection::preinstantiate(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version,
+                                               const char* code, size_t code_size, uint32_t evictable_after) {
+   EOS_ASSERT(is_on_main_thread(), misc_exception, "preinstantiate called off the main thread");
+   if (!preinstantiate_wasmif || !preinstantiate_wasmif->begin_preinstantiate(code_hash, vm_type, vm_version))
+      return;
+   boost::asio::post(preinstantiate_thread_pool.get_executor(),
+                     [this, code_hash, vm_type, vm_version, code = std::vector<char>(code, code + code_size), evictable_after]() {
+                        preinstantiate_wasmif->preinstantiate(code_hash, vm_type, vm_version, code, evictable_after);
+                     });
 }
 
 void wasm_interface_collection::code_block_num_last_used(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, uint32_t block_num) {
@@ -123,8 +150,10 @@ void wasm_interface_collection::code_block_num_last_used(const digest_type& code
    // the transaction is not a read-only trx, which implies we are
    // in write window. Safe to call threaded_wasmifs's code_block_num_last_used
    wasmif.code_block_num_last_used(code_hash, vm_type, vm_version, block_num);
-   for (auto& w : threaded_wasmifs) {
-      w.second->code_block_num_last_used(code_hash, vm_type, vm_version, block_num);
+   if (!module_store) {
+      for (auto& w : threaded_wasmifs) {
+         w.second->code_block_num_last_used(code_hash, vm_type, vm_version, block_num);
+      }
    }
 }
 
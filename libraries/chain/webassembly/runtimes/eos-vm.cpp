@@ -123,13 +123,18 @@ class eos_vm_instantiated_module : public wasm_instantiated_module_interface {
    using backend_t = eos_vm_backend_t<Impl>;
    public:
 
-      eos_vm_instantiated_module(eos_vm_runtime<Impl>* runtime, std::unique_ptr<backend_t> mod) :
-         _runtime(runtime),
+      // the compiled module is shared by all threads, it is only read while applied
+      explicit eos_vm_instantiated_module(std::unique_ptr<backend_t> mod) :
          _instantiated_module(std::move(mod)) {}
 
       void apply(apply_context& context) override {
-         _instantiated_module->set_wasm_allocator(&context.control.get_wasm_allocator());
-         _runtime->_bkend = _instantiated_module.get();
+         auto& bkend = eos_vm_runtime<Impl>::_bkend;
+         // the backend of this thread runs the compiled module with the execution context of this thread
+         bkend.share(*_instantiated_module);
+         bkend.set_context(&eos_vm_runtime<Impl>::_exec_ctx);
+         bkend.reset_max_call_depth();
+         bkend.reset_max_pages();
+         bkend.set_wasm_allocator(&context.control.get_wasm_allocator());
          apply_options opts;
          if(context.control.is_builtin_activated(builtin_protocol_feature_t::configurable_wasm_limits)) {
             const wasm_config& config = context.control.get_global_properties().wasm_configuration;
@@ -137,8 +142,8 @@ class eos_vm_instantiated_module : public wasm_instantiated_module_interface {
          }
          auto fn = [&]() {
             eosio::chain::webassembly::interface iface(context);
-            _runtime->_bkend->initialize(&iface, opts);
-            _runtime->_bkend->call(
+            bkend.initialize(&iface, opts);
+            bkend.call(
                 iface, "env", "apply",
                 context.get_receiver().to_uint64_t(),
                 context.get_action().account.to_uint64_t(),
@@ -146,7 +151,7 @@ class eos_vm_instantiated_module : public wasm_instantiated_module_interface {
          };
          try {
             checktime_watchdog wd(context.trx_context.transaction_timer);
-            _runtime->_bkend->timed_run(wd, fn);
+            bkend.timed_run(wd, fn);
          } catch(eosio::vm::timeout_exception&) {
             context.trx_context.checktime();
          } catch(eosio::vm::wasm_memory_exception& e) {
@@ -154,11 +159,9 @@ class eos_vm_instantiated_module : public wasm_instantiated_module_interface {
          } catch(eosio::vm::exception& e) {
             FC_THROW_EXCEPTION(wasm_execution_error, "eos-vm system failure");
          }
-         _runtime->_bkend = nullptr;
       }
 
    private:
-      eos_vm_runtime<Impl>*            _runtime;
       std::unique_ptr<backend_t> _instantiated_module;
 };
 
@@ -226,6 +229,11 @@ class eos_vm_profiling_module : public wasm_instantiated_module_interface {
 };
 #endif
 
+template<typename Impl>
+thread_local eos_vm_backend_t<Impl> eos_vm_runtime<Impl>::_bkend;
+template<typename Impl>
+thread_local typename eos_vm_backend_t<Impl>::context_t eos_vm_runtime<Impl>::_exec_ctx;
+
 template<typename Impl>
 eos_vm_runtime<Impl>::eos_vm_runtime() {}
 
@@ -238,9 +246,10 @@ std::unique_ptr<wasm_instantiated_module_interface> eos_vm_runtime<Impl>::instan
       wasm_code_ptr code((uint8_t*)code_bytes, code_size);
       apply_options options = { .max_pages = 65536,
                                 .max_call_depth = 0 };
-      std::unique_ptr<backend_t> bkend = std::make_unique<backend_t>(code, code_size, nullptr, options, false); // uses 2-passes parsing
+      // uses 2-passes parsing, no execution context as each thread applies the module with its own
+      std::unique_ptr<backend_t> bkend = std::make_unique<backend_t>(code, code_size, nullptr, options, false, false);
       eos_vm_host_functions_t::resolve(bkend->get_module());
-      return std::make_unique<eos_vm_instantiated_module<Impl>>(this, std::move(bkend));
+      return std::make_unique<eos_vm_instantiated_module<Impl>>(std::move(bkend));
    } catch(eosio::vm::exception& e) {
       FC_THROW_EXCEPTION(wasm_execution_error, "Error building eos-vm interp: ${e}", ("e", e.what()));
    }
@@ -468,76 +477,76 @@ REGISTER_LEGACY_CF_HOST_FUNCTION(printhex);
 
 // database api
 // primary index api
-REGISTER_LEGACY_HOST_FUNCTION(db_store_i64);
-REGISTER_LEGACY_HOST_FUNCTION(db_update_i64);
-REGISTER_HOST_FUNCTION(db_remove_i64);
-REGISTER_LEGACY_HOST_FUNCTION(db_get_i64);
-REGISTER_LEGACY_HOST_FUNCTION(db_next_i64);
-REGISTER_LEGACY_HOST_FUNCTION(db_previous_i64);
-REGISTER_HOST_FUNCTION(db_find_i64);
-REGISTER_HOST_FUNCTION(db_lowerbound_i64);
-REGISTER_HOST_FUNCTION(db_upperbound_i64);
-REGISTER_HOST_FUNCTION(db_end_i64);
+REGISTER_LEGACY_HOST_FUNCTION(db_store_i64, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_update_i64, db_call_counter);
+REGISTER_HOST_FUNCTION(db_remove_i64, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_get_i64, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_next_i64, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_previous_i64, db_call_counter);
+REGISTER_HOST_FUNCTION(db_find_i64, db_call_counter);
+REGISTER_HOST_FUNCTION(db_lowerbound_i64, db_call_counter);
+REGISTER_HOST_FUNCTION(db_upperbound_i64, db_call_counter);
+REGISTER_HOST_FUNCTION(db_end_i64, db_call_counter);
 
 // uint64_t secondary index api
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_store);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_update);
-REGISTER_HOST_FUNCTION(db_idx64_remove);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_find_secondary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_find_primary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_lowerbound);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_upperbound);
-REGISTER_HOST_FUNCTION(db_idx64_end);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_next);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx64_previous);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_store, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_update, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx64_remove, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_find_secondary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_find_primary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_lowerbound, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_upperbound, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx64_end, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_next, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx64_previous, db_call_counter);
 
 // uint128_t secondary index api
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_store);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_update);
-REGISTER_HOST_FUNCTION(db_idx128_remove);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_find_secondary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_find_primary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_lowerbound);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_upperbound);
-REGISTER_HOST_FUNCTION(db_idx128_end);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_next);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx128_previous);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_store, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_update, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx128_remove, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_find_secondary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_find_primary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_lowerbound, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_upperbound, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx128_end, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_next, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx128_previous, db_call_counter);
 
 // 256-bit secondary index api
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_store);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_update);
-REGISTER_HOST_FUNCTION(db_idx256_remove);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_find_secondary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_find_primary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_lowerbound);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_upperbound);
-REGISTER_HOST_FUNCTION(db_idx256_end);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_next);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx256_previous);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_store, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_update, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx256_remove, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_find_secondary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_find_primary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_lowerbound, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_upperbound, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx256_end, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_next, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx256_previous, db_call_counter);
 
 // double secondary index api
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_store, is_nan_check);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_update, is_nan_check);
-REGISTER_HOST_FUNCTION(db_idx_double_remove);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_find_secondary, is_nan_check);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_find_primary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_lowerbound, is_nan_check);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_upperbound, is_nan_check);
-REGISTER_HOST_FUNCTION(db_idx_double_end);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_next);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_previous);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_store, is_nan_check, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_update, is_nan_check, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx_double_remove, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_find_secondary, is_nan_check, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_find_primary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_lowerbound, is_nan_check, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_upperbound, is_nan_check, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx_double_end, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_next, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_double_previous, db_call_counter);
 
 // long double secondary index api
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_store, is_nan_check);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_update, is_nan_check);
-REGISTER_HOST_FUNCTION(db_idx_long_double_remove);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_find_secondary, is_nan_check);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_find_primary);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_lowerbound, is_nan_check);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_upperbound, is_nan_check);
-REGISTER_HOST_FUNCTION(db_idx_long_double_end);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_next);
-REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_previous);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_store, is_nan_check, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_update, is_nan_check, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx_long_double_remove, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_find_secondary, is_nan_check, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_find_primary, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_lowerbound, is_nan_check, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_upperbound, is_nan_check, db_call_counter);
+REGISTER_HOST_FUNCTION(db_idx_long_double_end, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_next, db_call_counter);
+REGISTER_LEGACY_HOST_FUNCTION(db_idx_long_double_previous, db_call_counter);
 
 // memory api
 REGISTER_LEGACY_CF_HOST_FUNCTION(memcpy);
@@ -49,6 +49,36 @@ extern const char* const state_history_plugin_abi = R"({
                 { "name": "deltas", "type": "bytes?" }
             ]
         },
+        {
+            "name": "get_scrub_status_request_v0", "fields": []
+        },
+        {
+            "name": "scrub_problem", "fields": [
+                { "name": "block_num", "type": "uint32" },
+                { "name": "file", "type": "string" },
+                { "name": "message", "type": "string" }
+            ]
+        },
+        {
+            "name": "scrub_status", "fields": [
+                { "name": "enabled", "type": "bool" },
+                { "name": "passes_completed", "type": "uint32" },
+                { "name": "pass_begin_block", "type": "uint32" },
+                { "name": "pass_end_block", "type": "uint32" },
+                { "name": "next_block", "type": "uint32" },
+                { "name": "last_pass_problems", "type": "uint32" },
+                { "name": "entries_verified", "type": "uint64" },
+                { "name": "bytes_read", "type": "uint64" },
+                { "name": "problems_found", "type": "uint64" },
+                { "name": "problems", "type": "scrub_problem[]" }
+            ]
+        },
+        {
+            "name": "get_scrub_status_result_v0", "fields": [
+                { "name": "trace", "type": "scrub_status" },
+                { "name": "chain_state", "type": "scrub_status" }
+            ]
+        },
         {
             "name": "row", "fields": [
                 { "name": "present", "type": "bool" },
@@ -552,8 +582,8 @@ extern const char* const state_history_plugin_abi = R"({
         { "new_type_name": "transaction_id", "type": "checksum256" }
     ],
     "variants": [
-        { "name": "request", "types": ["get_status_request_v0", "get_blocks_request_v0", "get_blocks_ack_request_v0"] },
-        { "name": "result", "types": ["get_status_result_v0", "get_blocks_result_v0"] },
+        { "name": "request", "types": ["get_status_request_v0", "get_blocks_request_v0", "get_blocks_ack_request_v0", "get_scrub_status_request_v0"] },
+        { "name": "result", "types": ["get_status_result_v0", "get_blocks_result_v0", "get_scrub_status_result_v0"] },
 
         { "name": "action_receipt", "types": ["action_receipt_v0"] },
         { "name": "action_trace", "types": ["action_trace_v0", "action_trace_v1"] },
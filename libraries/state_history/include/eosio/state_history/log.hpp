@@ -1,6 +1,7 @@
 #pragma once
 
 #include <eosio/state_history/compression.hpp>
+#include <eosio/state_history/types.hpp>
 #include <eosio/chain/block_header.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <eosio/chain/types.hpp>
@@ -12,16 +13,26 @@
 #include <fc/log/logger.hpp>
 #include <fc/log/logger_config.hpp> //set_thread_name
 #include <fc/bitutil.hpp>
+#include <fc/scoped_exit.hpp>
 
 #include <boost/asio.hpp>
 #include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/device/null.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
 #include <boost/iostreams/restrict.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <cstdint>
+#include <functional>
+#include <thread>
+
+#include <sys/resource.h>
 
 
 struct state_history_test_fixture;
@@ -89,6 +100,13 @@ namespace state_history {
       std::filesystem::path archive_dir        = "archive";
       uint32_t              stride             = 1000000;
       uint32_t              max_retained_files = UINT32_MAX;
+      std::filesystem::path cold_dir;                          //when set, retained files beyond max_retained_files are compacted here instead of archived
+      uint64_t              cold_frame_size    = 4*1024*1024;  //(approximately) how many decompressed bytes are compressed together in the cold tier
+   };
+
+   struct scrub_config {
+      uint32_t              interval_sec       = 3600;         //seconds between the end of a pass over the log and the start of the next one
+      uint64_t              max_bytes_per_sec  = 8*1024*1024;  //how many bytes the scrubber reads per second at most
    };
 } // namespace state_history
 
@@ -277,6 +295,449 @@ private:
     uint64_t chars_;
 };
 
+constexpr uint32_t cold_log_magic   = 0x4c5a4853; // "SHZL"
+constexpr uint32_t cold_log_version = 1;
+
+struct cold_log_header {
+   uint32_t magic   = cold_log_magic;
+   uint32_t version = cold_log_version;
+};
+
+struct cold_log_frame {
+   uint64_t pos               = 0; ///< of the compressed frame in the cold file
+   uint64_t size              = 0; ///< compressed
+   uint64_t uncompressed_size = 0;
+   uint32_t first_block_num   = 0;
+   uint32_t num_blocks        = 0;
+};
+
+struct cold_log_entry {
+   chain::block_id_type block_id;
+   uint64_t             offset = 0; ///< of the decompressed entry in the decompressed frame
+   uint64_t             size   = 0; ///< decompressed
+   uint32_t             frame  = 0;
+   uint32_t             reserved = 0;
+};
+
+struct cold_log_trailer {
+   uint64_t frames_pos      = 0; ///< of the frame table, followed by the entry table
+   uint32_t first_block_num = 0;
+   uint32_t num_blocks      = 0;
+   uint32_t num_frames      = 0;
+   uint32_t magic           = cold_log_magic;
+};
+
+// written as is
+static_assert(sizeof(cold_log_header) == 8 && sizeof(cold_log_frame) == 32 && sizeof(cold_log_entry) == 56 &&
+              sizeof(cold_log_trailer) == 24);
+
+/// Provide the read only view of a partition compacted into the cold tier, <name>-<first>-<last>.zlog
+///
+/// +--------+---------+---------+-----+---------+-------------+-------------+---------+
+/// | header | Frame 0 | Frame 1 | ... | Frame N | frame table | entry table | trailer |
+/// +--------+---------+---------+-----+---------+-------------+-------------+---------+
+///
+/// A frame is the zlib compressed concatenation of the decompressed payloads of consecutive entries, so entries
+/// compress against each other at the best compression level and a read decompresses only the frame of its block.
+/// The entry table holds the block id and the location in its frame of every entry.
+class cold_log_data {
+   fc::cfile         file;
+   cold_log_trailer  trailer;
+   uint32_t          cached_frame = std::numeric_limits<uint32_t>::max();
+   std::vector<char> frame_data;
+
+   template <typename T>
+   T read_at(uint64_t pos) {
+      T value;
+      file.seek(pos);
+      file.read(reinterpret_cast<char*>(&value), sizeof(value));
+      return value;
+   }
+
+ public:
+   cold_log_data() = default;
+   explicit cold_log_data(const std::filesystem::path& path) { open(path); }
+
+   void open(const std::filesystem::path& path) {
+      if (file.is_open())
+         file.close();
+      cached_frame = std::numeric_limits<uint32_t>::max();
+      file.set_file_path(path);
+      file.open("rb");
+      cold_log_header header = read_at<cold_log_header>(0);
+      EOS_ASSERT(header.magic == cold_log_magic && header.version == cold_log_version, chain::plugin_exception,
+                 "${path} is not a cold state history log", ("path", path));
+      file.seek_end(-static_cast<long>(sizeof(trailer)));
+      file.read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+      EOS_ASSERT(trailer.magic == cold_log_magic && trailer.num_blocks > 0, chain::plugin_exception,
+                 "${path} is truncated", ("path", path));
+   }
+
+   uint32_t first_block_num() const { return trailer.first_block_num; }
+   uint32_t last_block_num() const { return trailer.first_block_num + trailer.num_blocks - 1; }
+   uint32_t num_blocks() const { return trailer.num_blocks; }
+   uint32_t num_frames() const { return trailer.num_frames; }
+
+   cold_log_frame frame_at(uint32_t frame_num) {
+      return read_at<cold_log_frame>(trailer.frames_pos + frame_num * sizeof(cold_log_frame));
+   }
+
+   cold_log_entry entry_at(uint32_t block_num) {
+      const uint64_t entries_pos = trailer.frames_pos + num_frames() * sizeof(cold_log_frame);
+      return read_at<cold_log_entry>(entries_pos + (block_num - first_block_num()) * sizeof(cold_log_entry));
+   }
+
+   /// decompressed payloads of a frame, valid until the next call
+   const std::vector<char>& read_frame(uint32_t frame_num) {
+      if (frame_num == cached_frame)
+         return frame_data;
+      const cold_log_frame frame = frame_at(frame_num);
+      std::vector<char> compressed(frame.size);
+      file.seek(frame.pos);
+      file.read(compressed.data(), compressed.size());
+
+      frame_data.clear();
+      frame_data.reserve(frame.uncompressed_size);
+      bio::filtering_ostream decomp;
+      decomp.push(bio::zlib_decompressor());
+      decomp.push(bio::back_inserter(frame_data));
+      bio::write(decomp, compressed.data(), compressed.size());
+      bio::close(decomp);
+      EOS_ASSERT(frame_data.size() == frame.uncompressed_size, chain::plugin_exception,
+                 "frame ${f} of ${path} decompressed to ${s} bytes, expected ${e}",
+                 ("f", frame_num)("path", file.get_file_path())("s", frame_data.size())("e", frame.uncompressed_size));
+      cached_frame = frame_num;
+      return frame_data;
+   }
+
+   /// @return the decompressed entry size
+   uint64_t ro_stream_for_block(uint32_t block_num, locked_decompress_stream& result) {
+      const cold_log_entry entry = entry_at(block_num);
+      const cold_log_frame frame = frame_at(entry.frame);
+      if (frame.num_blocks == 1) {
+         // stream an entry that fills its frame, it may be too large to hold in memory
+         auto istream = std::make_unique<bio::filtering_istreambuf>();
+         istream->push(bio::zlib_decompressor());
+         istream->push(bio::restrict(bio::file_source(file.get_file_path().string()), frame.pos, frame.size));
+         result.buf = std::move(istream);
+         return entry.size;
+      }
+      const std::vector<char>& data = read_frame(entry.frame);
+      EOS_ASSERT(entry.offset + entry.size <= data.size(), chain::plugin_exception,
+                 "invalid entry of block ${n} in ${path}", ("n", block_num)("path", file.get_file_path()));
+      return result.init(std::vector<char>(data.begin() + entry.offset, data.begin() + entry.offset + entry.size));
+   }
+
+   chain::block_id_type block_id_at(uint32_t block_num) { return entry_at(block_num).block_id; }
+
+   /// Recompress the retained log/index bundle `bundle` into `cold_dir`
+   ///
+   /// @return the path of the cold file, or nothing if `stop` was set before it was complete
+   static std::optional<std::filesystem::path> compact(const std::filesystem::path& bundle, const std::filesystem::path& cold_dir,
+                                                       uint64_t frame_size, const std::atomic<bool>& stop) {
+      std::filesystem::path log_path  = std::filesystem::path(bundle).replace_extension("log");
+      std::filesystem::path cold_path = cold_dir / (bundle.filename().string() + ".zlog");
+      std::filesystem::path tmp_path  = cold_dir / (bundle.filename().string() + ".zlog.tmp");
+
+      state_history_log_data                    log(log_path);
+      chain::log_index<chain::plugin_exception> index(std::filesystem::path(bundle).replace_extension("index"));
+      const uint32_t                            num_blocks = log.num_blocks();
+      EOS_ASSERT(num_blocks > 0 && index.num_blocks() == num_blocks, chain::plugin_exception,
+                 "${file} does not match its index", ("file", log_path));
+
+      fc::cfile out;
+      out.set_file_path(tmp_path);
+      out.open(fc::cfile::truncate_rw_mode);
+      cold_log_header header;
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+      std::vector<cold_log_frame> frames;
+      std::vector<cold_log_entry> entries;
+      entries.reserve(num_blocks);
+      std::vector<char> data, compressed;
+      uint32_t          frame_begin = 0;
+      auto write_frame = [&](uint32_t frame_end) {
+         compressed.clear();
+         bio::filtering_ostream comp;
+         comp.push(bio::zlib_compressor(bio::zlib::best_compression));
+         comp.push(bio::back_inserter(compressed));
+         bio::write(comp, data.data(), data.size());
+         bio::close(comp);
+
+         frames.push_back(cold_log_frame{ .pos               = out.tellp(),
+                                          .size              = compressed.size(),
+                                          .uncompressed_size = data.size(),
+                                          .first_block_num   = log.first_block_num() + frame_begin,
+                                          .num_blocks        = frame_end - frame_begin });
+         out.write(compressed.data(), compressed.size());
+         data.clear();
+         frame_begin = frame_end;
+      };
+
+      for (uint32_t i = 0; i < num_blocks; ++i) {
+         if (stop) {
+            out.close();
+            std::filesystem::remove(tmp_path);
+            return {};
+         }
+         const uint64_t           pos = index.nth_block_position(i);
+         locked_decompress_stream entry{ std::unique_lock<std::mutex>{} };
+         const uint64_t           size = log.ro_stream_at(pos, entry);
+         entries.push_back(cold_log_entry{ .block_id = log.block_id_at(pos),
+                                           .offset   = data.size(),
+                                           .size     = size,
+                                           .frame    = static_cast<uint32_t>(frames.size()) });
+         std::visit(chain::overloaded{ [&](std::vector<char>& bytes) { data.insert(data.end(), bytes.begin(), bytes.end()); },
+                                       [&](std::unique_ptr<bio::filtering_istreambuf>& strm) {
+                                          data.resize(data.size() + size);
+                                          const auto n = bio::read(*strm, data.data() + data.size() - size, size);
+                                          EOS_ASSERT(n >= 0 && static_cast<uint64_t>(n) == size, chain::plugin_exception,
+                                                     "entry at position ${pos} of ${file} is shorter than its size",
+                                                     ("pos", pos)("file", log_path));
+                                       } },
+                    entry.buf);
+         if (data.size() >= frame_size)
+            write_frame(i + 1);
+      }
+      if (frame_begin < num_blocks)
+         write_frame(num_blocks);
+
+      cold_log_trailer trailer{ .frames_pos      = out.tellp(),
+                                .first_block_num = log.first_block_num(),
+                                .num_blocks      = num_blocks,
+                                .num_frames      = static_cast<uint32_t>(frames.size()) };
+      out.write(reinterpret_cast<const char*>(frames.data()), frames.size() * sizeof(cold_log_frame));
+      out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(cold_log_entry));
+      out.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+      out.flush();
+      out.close();
+
+      std::filesystem::rename(tmp_path, cold_path);
+      ilog("Compacted ${file} to ${cold}, ${s} of ${o} bytes",
+           ("file", log_path)("cold", cold_path)("s", std::filesystem::file_size(cold_path))("o", log.size()));
+      return cold_path;
+   }
+};
+
+/// Partitions compacted into the cold tier, read only
+struct cold_log_catalog {
+   std::filesystem::path                                          cold_dir;
+   std::map<uint32_t, std::pair<uint32_t, std::filesystem::path>> collection; ///< first -> last, file
+   std::optional<uint32_t>                                        active;     ///< first block num of the open file
+   cold_log_data                                                  log_data;
+
+   void open(const std::filesystem::path& log_dir, const std::filesystem::path& cold_path, const char* name) {
+      cold_dir = cold_path.is_relative() ? log_dir / cold_path : cold_path;
+      std::filesystem::create_directories(cold_dir);
+      // left behind by a compaction that was interrupted
+      chain::for_each_file_in_dir_matches(cold_dir, std::string(name) + R"(-\d+-\d+\.zlog\.tmp)",
+                                          [](const std::filesystem::path& path) { std::filesystem::remove(path); });
+      chain::for_each_file_in_dir_matches(cold_dir, std::string(name) + R"(-\d+-\d+\.zlog)",
+                                          [this](const std::filesystem::path& path) { add(path); });
+   }
+
+   void add(const std::filesystem::path& path) {
+      cold_log_data log(path);
+      if (!collection.emplace(log.first_block_num(), std::make_pair(log.last_block_num(), path)).second)
+         wlog("${path} overlaps another cold state history log, dropping it from the catalog", ("path", path));
+   }
+
+   bool     empty() const { return collection.empty(); }
+   uint32_t first_block_num() const { return empty() ? std::numeric_limits<uint32_t>::max() : collection.begin()->first; }
+   uint32_t last_block_num() const { return empty() ? 0 : collection.rbegin()->second.first; }
+
+   cold_log_data* log_for_block(uint32_t block_num) {
+      auto it = collection.upper_bound(block_num);
+      if (it == collection.begin() || block_num > std::prev(it)->second.first)
+         return nullptr;
+      --it;
+      if (active != it->first) {
+         active.reset();
+         log_data.open(it->second.second);
+         active = it->first;
+      }
+      return &log_data;
+   }
+
+   std::optional<uint64_t> ro_stream_for_block(uint32_t block_num, locked_decompress_stream& result) {
+      if (auto log = log_for_block(block_num))
+         return log->ro_stream_for_block(block_num, result);
+      return {};
+   }
+
+   std::optional<chain::block_id_type> id_for_block(uint32_t block_num) {
+      if (auto log = log_for_block(block_num))
+         return log->block_id_at(block_num);
+      return {};
+   }
+};
+
+/// Thrown out of a scrub when the scrubber is stopped
+struct scrub_stopped {};
+
+/// Where the entry of a block is stored
+struct scrub_location {
+   std::filesystem::path file;
+   std::filesystem::path index_file;          ///< of a log file
+   uint32_t              first_block_num = 0; ///< of the index
+   bool                  cold            = false;
+
+   bool operator==(const scrub_location&) const = default;
+};
+
+/// Verify entries through read only handles of its own, so the log keeps being written and read meanwhile. Every
+/// read is reported to `on_read`, which throttles the scrubber and may throw scrub_stopped.
+///
+/// The files of the last location verified are kept open for the next entries, which are mostly in the same files.
+class log_scrubber {
+   std::function<void(uint64_t)> on_read;
+   std::optional<scrub_location> location; ///< of the open files
+   fc::cfile                     log_file;
+   fc::cfile                     index_file;
+   cold_log_data                 cold;
+   std::vector<char>             buf = std::vector<char>(64*1024);
+
+   void open(const scrub_location& loc) {
+      if (location == loc)
+         return;
+      close();
+      if (loc.cold) {
+         cold.open(loc.file);
+      } else {
+         index_file.set_file_path(loc.index_file);
+         index_file.open("rb");
+      }
+      log_file.set_file_path(loc.file);
+      log_file.open("rb");
+      location = loc;
+   }
+
+   void read(fc::cfile& file, char* data, uint64_t size) {
+      file.read(data, size);
+      on_read(size);
+   }
+
+   template <typename T>
+   T read_at(fc::cfile& file, uint64_t pos) {
+      T value;
+      file.seek(pos);
+      read(file, reinterpret_cast<char*>(&value), sizeof(value));
+      return value;
+   }
+
+   /// @return the decompressed size of the zlib stream of `size` bytes at the position of `file`
+   uint64_t decompressed_size(fc::cfile& file, uint64_t size) {
+      if (!size)
+         return 0;
+      counter cnt;
+      bio::filtering_ostream decomp;
+      decomp.push(bio::zlib_decompressor());
+      decomp.push(boost::ref(cnt));
+      decomp.push(bio::null_sink());
+      while (size > 0) {
+         const auto n = std::min<uint64_t>(size, buf.size());
+         read(file, buf.data(), n);
+         bio::write(decomp, buf.data(), n);
+         size -= n;
+      }
+      bio::close(decomp);
+      return cnt.characters();
+   }
+
+ public:
+   explicit log_scrubber(std::function<void(uint64_t)> on_read)
+   : on_read(std::move(on_read)) {}
+
+   /// Close the open files, to reopen them at the next verify in case they have been replaced meanwhile
+   void close() {
+      location.reset();
+      log_file.close();
+      index_file.close();
+   }
+
+   /// Verify the position in the index, the header, the position suffix and, if `check_payload`, the payload of the
+   /// entry of `block_num` in a log file
+   ///
+   /// @return the block id of the entry
+   chain::block_id_type verify_entry(const scrub_location& loc, uint32_t block_num, bool check_payload = true) {
+      open(loc);
+      // the files may have grown or been truncated by a fork since the last entry
+      fc::cfile& index = index_file;
+      index.seek_end(0);
+      const uint64_t index_pos = uint64_t(block_num - loc.first_block_num) * sizeof(uint64_t);
+      EOS_ASSERT(index_pos + sizeof(uint64_t) <= index.tellp(), chain::plugin_exception,
+                 "block ${b} is past the end of ${index}", ("b", block_num)("index", loc.index_file));
+      const uint64_t pos = read_at<uint64_t>(index, index_pos);
+
+      fc::cfile& file = log_file;
+      file.seek_end(0);
+      const uint64_t size = file.tellp();
+
+      EOS_ASSERT(pos + state_history_log_header_serial_size + sizeof(uint64_t) <= size, chain::plugin_exception,
+                 "entry at position ${pos} is past the end of the file", ("pos", pos));
+      char bytes[state_history_log_header_serial_size];
+      file.seek(pos);
+      read(file, bytes, sizeof(bytes));
+      fc::datastream<const char*> ds(bytes, sizeof(bytes));
+      state_history_log_header    header;
+      fc::raw::unpack(ds, header);
+      EOS_ASSERT(is_ship(header.magic) && is_ship_supported_version(header.magic), chain::plugin_exception,
+                 "invalid header for entry at position ${pos}", ("pos", pos));
+      EOS_ASSERT(chain::block_header::num_from_id(header.block_id) == block_num, chain::plugin_exception,
+                 "entry at position ${pos} is of block ${n}", ("pos", pos)("n", chain::block_header::num_from_id(header.block_id)));
+
+      const uint64_t payload_pos = pos + state_history_log_header_serial_size;
+      EOS_ASSERT(header.payload_size >= sizeof(uint32_t) && header.payload_size <= size &&
+                     payload_pos + header.payload_size + sizeof(uint64_t) <= size,
+                 chain::plugin_exception, "invalid payload size ${s} for entry at position ${pos}", ("s", header.payload_size)("pos", pos));
+      const uint64_t suffix = read_at<uint64_t>(file, payload_pos + header.payload_size);
+      EOS_ASSERT(suffix == pos, chain::plugin_exception, "entry at position ${pos} is followed by position ${suffix}",
+                 ("pos", pos)("suffix", suffix));
+      if (!check_payload)
+         return header.block_id;
+
+      // see pack_and_write_entry() and read_unpacked_entry()
+      const uint32_t s = read_at<uint32_t>(file, payload_pos);
+      if (s == 1 && header.payload_size > sizeof(uint32_t) + sizeof(uint64_t)) {
+         uint64_t expected;
+         read(file, reinterpret_cast<char*>(&expected), sizeof(expected));
+         const uint64_t actual = decompressed_size(file, header.payload_size - sizeof(uint32_t) - sizeof(uint64_t));
+         EOS_ASSERT(actual == expected, chain::plugin_exception,
+                    "payload of entry at position ${pos} decompressed to ${a} bytes, expected ${e}", ("pos", pos)("a", actual)("e", expected));
+      } else {
+         decompressed_size(file, header.payload_size - sizeof(uint32_t));
+      }
+      return header.block_id;
+   }
+
+   /// Verify the location of the entry of `block_num` in a cold file, and the frame holding it along with, if
+   /// `check_payload`, the first block of the frame
+   ///
+   /// @return the block id of the entry
+   chain::block_id_type verify_cold_entry(const scrub_location& loc, uint32_t block_num, bool check_payload = true) {
+      open(loc);
+      EOS_ASSERT(cold.first_block_num() <= block_num && block_num <= cold.last_block_num(), chain::plugin_exception,
+                 "block ${b} is not in blocks ${f}-${l} of the file", ("b", block_num)("f", cold.first_block_num())("l", cold.last_block_num()));
+      const cold_log_entry entry = cold.entry_at(block_num);
+      on_read(sizeof(entry));
+      EOS_ASSERT(chain::block_header::num_from_id(entry.block_id) == block_num && entry.frame < cold.num_frames(), chain::plugin_exception,
+                 "invalid entry of block ${b}", ("b", block_num));
+      const cold_log_frame frame = cold.frame_at(entry.frame);
+      on_read(sizeof(frame));
+      EOS_ASSERT(frame.first_block_num <= block_num && block_num - frame.first_block_num < frame.num_blocks &&
+                     entry.offset + entry.size <= frame.uncompressed_size,
+                 chain::plugin_exception, "entry of block ${b} is not in frame ${f}", ("b", block_num)("f", entry.frame));
+
+      if (check_payload && block_num == frame.first_block_num) {
+         log_file.seek(frame.pos);
+         const uint64_t actual = decompressed_size(log_file, frame.size);
+         EOS_ASSERT(actual == frame.uncompressed_size, chain::plugin_exception, "frame ${f} decompressed to ${a} bytes, expected ${e}",
+                    ("f", entry.frame)("a", actual)("e", frame.uncompressed_size));
+      }
+      return entry.block_id;
+   }
+};
+
 } // namespace detail
 
 class state_history_log {
@@ -296,6 +757,29 @@ class state_history_log {
    using catalog_t = chain::log_catalog<detail::state_history_log_data, chain::log_index<chain::plugin_exception>>;
    catalog_t catalog;
 
+   detail::cold_log_catalog cold;                      // partitions compacted out of the catalog, see partition_config::cold_dir
+   bool                     _compacting = false;       // guarded by _mx
+   std::atomic<bool>        _stop_compaction = false;
+   std::thread              _compaction_thread;
+
+ public:
+   using block_id_lookup = std::function<std::optional<chain::block_id_type>(uint32_t)>;
+   using scrub_callback  = std::function<void(const state_history::scrub_status&)>;
+   static constexpr size_t max_scrub_problems = 100;    // problems kept in the scrub status, and logged by a pass
+
+ private:
+   state_history::scrub_config           _scrub_config;
+   block_id_lookup                       _irreversible_block_id;
+   scrub_callback                        _on_scrub_update;
+   mutable std::mutex                    _scrub_mx;
+   std::condition_variable               _scrub_cv;
+   bool                                  _stop_scrub = false;       // guarded by _scrub_mx
+   state_history::scrub_status           _scrub_status;             // guarded by _scrub_mx
+   std::chrono::steady_clock::time_point _scrub_pass_start;         // guarded by _scrub_mx
+   uint64_t                              _scrub_pass_bytes = 0;     // guarded by _scrub_mx
+   bool                                  _scrub_throttled = true;   // scrub thread only
+   std::thread                           _scrub_thread;
+
  public:
    friend struct ::state_history_test_fixture;
 
@@ -321,9 +805,17 @@ class state_history_log {
             conf.prune_threshold = ~(conf.prune_threshold-1);
          }, [name, log_dir, this](state_history::partition_config& conf) {
             catalog.open(log_dir, conf.retained_dir, conf.archive_dir, name);
-            catalog.max_retained_files = conf.max_retained_files;
+            if (conf.cold_dir.empty()) {
+               catalog.max_retained_files = conf.max_retained_files;
+            } else {
+               // files beyond max_retained_files are compacted by compact_retained() instead of archived or deleted
+               cold.open(log_dir, conf.cold_dir, name);
+               // finish a compaction which was interrupted after its cold file was complete
+               while (!catalog.empty() && catalog.collection.begin()->second.last_block_num <= cold.last_block_num())
+                  remove_bundle(catalog.pop_front());
+            }
             if (_end_block == 0) {
-               _begin_block = _end_block = catalog.last_block_num() +1;
+               _begin_block = _end_block = std::max(catalog.last_block_num(), cold.last_block_num()) +1;
             }
          }
       }, _config);
@@ -354,9 +846,17 @@ class state_history_log {
             vacuum();
          }
       }
+
+      std::lock_guard g(_mx);
+      start_compaction();
    }
 
    ~state_history_log() {
+      stop_scrub();
+      _stop_compaction = true;
+      if (_compaction_thread.joinable())
+         _compaction_thread.join();
+
       //nothing to do if log is empty or we aren't pruning
       if(_begin_block == _end_block)
          return;
@@ -378,7 +878,7 @@ class state_history_log {
    //        begin     end
    std::pair<uint32_t, uint32_t> block_range() const {
       std::lock_guard g(_mx);
-      return { std::min(catalog.first_block_num(), _begin_block), _end_block };
+      return { std::min({catalog.first_block_num(), cold.first_block_num(), _begin_block}), _end_block };
    }
 
    bool empty() const {
@@ -399,6 +899,10 @@ class state_history_log {
       if (opt_decompressed_size)
          return *opt_decompressed_size;
 
+      opt_decompressed_size = cold.ro_stream_for_block(block_num, result);
+      if (opt_decompressed_size)
+         return *opt_decompressed_size;
+
       if (block_num < _begin_block || block_num >= _end_block)
          return 0;
 
@@ -460,8 +964,49 @@ class state_history_log {
       return get_block_id_i(block_num);
    }
 
+   /// Verify the entries of the log on a low priority thread, a pass over the whole log and the next one
+   /// `conf.interval_sec` after the end of it. The position, header, payload size and compressed payload of each entry
+   /// are checked, and its block id against `irreversible_block_id`, which returns the id of an irreversible block from
+   /// the block log or nothing. Problems are reported by get_scrub_status() and to `on_update`, which is called from the
+   /// scrub thread after each problem and each pass.
+   void start_scrub(state_history::scrub_config conf, block_id_lookup irreversible_block_id, scrub_callback on_update = {}) {
+      EOS_ASSERT(!_scrub_thread.joinable(), chain::plugin_exception, "${name}.log is already scrubbed", ("name", name));
+      _scrub_config          = conf;
+      _irreversible_block_id = std::move(irreversible_block_id);
+      _on_scrub_update       = std::move(on_update);
+      {
+         std::lock_guard g(_scrub_mx);
+         _stop_scrub           = false;
+         _scrub_status.enabled = true;
+      }
+      _scrub_thread = std::thread([this]() {
+         fc::set_thread_name(std::string(name) + "-scrub");
+         scrub();
+      });
+   }
+
+   void stop_scrub() {
+      {
+         std::lock_guard g(_scrub_mx);
+         _stop_scrub = true;
+      }
+      _scrub_cv.notify_all();
+      if (_scrub_thread.joinable())
+         _scrub_thread.join();
+   }
+
+   state_history::scrub_status get_scrub_status() const {
+      std::lock_guard g(_scrub_mx);
+      return _scrub_status;
+   }
+
 #ifdef BOOST_TEST
    fc::cfile& get_log_file() { return log;}
+
+   void wait_for_compaction() {
+      if (_compaction_thread.joinable())
+         _compaction_thread.join();
+   }
 #endif
 
  private:
@@ -572,6 +1117,8 @@ class state_history_log {
 
    std::optional<chain::block_id_type> get_block_id_i(uint32_t block_num) {
       auto result = catalog.id_for_block(block_num);
+      if (!result)
+         result = cold.id_for_block(block_num);
       if (!result) {
          if (block_num >= _begin_block && block_num < _end_block) {
             state_history_log_header header;
@@ -769,6 +1316,9 @@ class state_history_log {
    }
 
    void truncate(uint32_t block_num) {
+      EOS_ASSERT(block_num > cold.last_block_num(), chain::plugin_exception,
+                 "cannot remove block ${b} from ${name}.log, it was compacted into the cold tier", ("b", block_num)("name", name));
+
       log.close();
       index.close();
 
@@ -923,6 +1473,7 @@ class state_history_log {
       log.close();
 
       catalog.add(_begin_block, _end_block - 1, log.get_file_path().parent_path(), name);
+      start_compaction();
 
       _begin_block = _end_block;
 
@@ -936,6 +1487,238 @@ class state_history_log {
       log.set_file_path(log_file_path);
       index.set_file_path(index_file_path);
    }
+
+   static void remove_bundle(std::filesystem::path bundle) {
+      std::filesystem::remove(bundle.replace_extension("log"));
+      std::filesystem::remove(bundle.replace_extension("index"));
+   }
+
+   // _mx must be held
+   void start_compaction() {
+      auto partition_config = std::get_if<state_history::partition_config>(&_config);
+      if (!partition_config || partition_config->cold_dir.empty() || _compacting ||
+          catalog.collection.size() <= partition_config->max_retained_files)
+         return;
+      if (_compaction_thread.joinable())
+         _compaction_thread.join(); // already done with _mx
+      _compacting = true;
+      _compaction_thread = std::thread([this]() {
+         fc::set_thread_name(std::string(name) + "-compact");
+         compact_retained();
+      });
+   }
+
+   // compaction thread, recompress the oldest retained files into the cold tier without holding _mx so the log
+   // keeps being written and read meanwhile; a file stays in the catalog until its cold replacement is complete
+   void compact_retained() {
+      const auto& conf = std::get<state_history::partition_config>(_config);
+      while (!_stop_compaction) {
+         uint32_t              first_block_num;
+         std::filesystem::path bundle;
+         {
+            std::lock_guard g(_mx);
+            if (catalog.collection.size() <= conf.max_retained_files)
+               break;
+            first_block_num = catalog.collection.begin()->first;
+            bundle          = catalog.collection.begin()->second.filename_base;
+         }
+
+         std::optional<std::filesystem::path> cold_path;
+         try {
+            cold_path = detail::cold_log_data::compact(bundle, cold.cold_dir, conf.cold_frame_size, _stop_compaction);
+         } catch (const fc::exception& e) {
+            elog("failed to compact ${bundle}, retrying after the next split of ${name}.log: ${e}",
+                 ("bundle", bundle)("name", name)("e", e.to_detail_string()));
+         } catch (const std::exception& e) {
+            elog("failed to compact ${bundle}, retrying after the next split of ${name}.log: ${e}",
+                 ("bundle", bundle)("name", name)("e", e.what()));
+         }
+         if (!cold_path)
+            break;
+
+         std::lock_guard g(_mx);
+         if (catalog.empty() || catalog.collection.begin()->first != first_block_num) {
+            // removed by a fork meanwhile
+            std::filesystem::remove(*cold_path);
+            continue;
+         }
+         remove_bundle(catalog.pop_front());
+         cold.add(*cold_path);
+      }
+      std::lock_guard g(_mx);
+      _compacting = false;
+   }
+
+   // _mx must be held
+   std::optional<detail::scrub_location> scrub_locate(uint32_t block_num) {
+      auto retained = catalog.collection.upper_bound(block_num);
+      if (retained != catalog.collection.begin() && block_num <= std::prev(retained)->second.last_block_num) {
+         --retained;
+         auto bundle = retained->second.filename_base;
+         return detail::scrub_location{ .file            = std::filesystem::path(bundle).replace_extension("log"),
+                                        .index_file      = std::filesystem::path(bundle).replace_extension("index"),
+                                        .first_block_num = retained->first };
+      }
+      auto cold_file = cold.collection.upper_bound(block_num);
+      if (cold_file != cold.collection.begin() && block_num <= std::prev(cold_file)->second.first)
+         return detail::scrub_location{ .file = std::prev(cold_file)->second.second, .cold = true };
+      if (block_num >= _begin_block && block_num < _end_block)
+         return detail::scrub_location{ .file = log.get_file_path(), .index_file = index.get_file_path(), .first_block_num = _index_begin_block };
+      return {};
+   }
+
+   // scrub thread, throttle to max_bytes_per_sec over the pass
+   void scrub_read(uint64_t bytes) {
+      std::unique_lock g(_scrub_mx);
+      _scrub_status.bytes_read += bytes;
+      _scrub_pass_bytes += bytes;
+      if (_scrub_throttled && _scrub_config.max_bytes_per_sec) {
+         const auto until = _scrub_pass_start + std::chrono::duration_cast<std::chrono::microseconds>(
+                                                   std::chrono::duration<double>(double(_scrub_pass_bytes) / _scrub_config.max_bytes_per_sec));
+         _scrub_cv.wait_until(g, until, [this] { return _stop_scrub; });
+      }
+      if (_stop_scrub)
+         throw detail::scrub_stopped{};
+   }
+
+   // scrub thread
+   bool scrub_verify(detail::log_scrubber& scrubber, const detail::scrub_location& location, uint32_t block_num,
+                     chain::block_id_type& id, std::string& error, bool check_payload = true) {
+      try {
+         id = location.cold ? scrubber.verify_cold_entry(location, block_num, check_payload)
+                            : scrubber.verify_entry(location, block_num, check_payload);
+         return true;
+      } catch (const fc::exception& e) {
+         error = e.top_message();
+      } catch (const std::exception& e) {
+         error = e.what();
+      }
+      return false;
+   }
+
+   // scrub thread
+   std::optional<state_history::scrub_problem> scrub_entry(detail::log_scrubber& scrubber, uint32_t block_num) {
+      std::optional<detail::scrub_location> location;
+      {
+         std::lock_guard g(_mx);
+         location = scrub_locate(block_num);
+      }
+      if (!location)
+         return {}; // removed meanwhile by a fork or pruning
+
+      chain::block_id_type id;
+      std::string          error;
+      if (!scrub_verify(scrubber, *location, block_num, id, error)) {
+         // the entry may have been rewritten meanwhile after a fork, or its file replaced: verify it again through
+         // reopened files. Only its header and position are verified while the log cannot change, a few bytes read
+         // unthrottled, its payload is verified again without the lock.
+         scrubber.close();
+         std::optional<chain::block_id_type> header_id;
+         auto verify_header = [&]() {
+            std::lock_guard g(_mx);
+            if (scrub_locate(block_num) != location)
+               return false; // removed meanwhile by a fork or pruning
+            _scrub_throttled = false;
+            auto throttle = fc::make_scoped_exit([this]() { _scrub_throttled = true; });
+            header_id.reset();
+            if (scrub_verify(scrubber, *location, block_num, id, error, false))
+               header_id = id;
+            return true;
+         };
+         if (!verify_header())
+            return {};
+         if (!header_id)
+            return state_history::scrub_problem{ block_num, location->file.string(), error };
+
+         const chain::block_id_type verified_id = *header_id;
+         if (!scrub_verify(scrubber, *location, block_num, id, error)) {
+            const std::string payload_error = error;
+            // not a problem of this entry if it has been rewritten meanwhile
+            if (!verify_header() || header_id != verified_id)
+               return {};
+            return state_history::scrub_problem{ block_num, location->file.string(), payload_error };
+         }
+      }
+
+      auto expected = _irreversible_block_id(block_num);
+      // the block may have become irreversible on another fork after the entry was read
+      if (expected && *expected != id && get_block_id(block_num) == id)
+         return state_history::scrub_problem{ block_num, location->file.string(),
+                                              "block id " + id.str() + " does not match " + expected->str() + " of the block log" };
+      return {};
+   }
+
+   // scrub thread
+   void scrub_pass(detail::log_scrubber& scrubber) {
+      const auto [begin_block, end_block] = block_range();
+      {
+         std::lock_guard g(_scrub_mx);
+         _scrub_status.pass_begin_block = begin_block;
+         _scrub_status.pass_end_block   = end_block;
+         _scrub_status.next_block       = begin_block;
+         _scrub_pass_start              = std::chrono::steady_clock::now();
+         _scrub_pass_bytes              = 0;
+      }
+
+      uint32_t num_problems = 0;
+      for (uint32_t block_num = begin_block; block_num < end_block; ++block_num) {
+         auto                        problem = scrub_entry(scrubber, block_num);
+         state_history::scrub_status status;
+         {
+            std::lock_guard g(_scrub_mx);
+            ++_scrub_status.entries_verified;
+            _scrub_status.next_block = block_num + 1;
+            if (!problem)
+               continue;
+            ++_scrub_status.problems_found;
+            if (_scrub_status.problems.size() == max_scrub_problems)
+               _scrub_status.problems.erase(_scrub_status.problems.begin());
+            _scrub_status.problems.push_back(*problem);
+            status = _scrub_status;
+         }
+         if (++num_problems <= max_scrub_problems)
+            elog("scrub of ${name}.log found a problem with block ${b} in ${file}: ${m}",
+                 ("name", name)("b", block_num)("file", problem->file)("m", problem->message));
+         if (_on_scrub_update)
+            _on_scrub_update(status);
+      }
+
+      state_history::scrub_status status;
+      {
+         std::lock_guard g(_scrub_mx);
+         ++_scrub_status.passes_completed;
+         _scrub_status.last_pass_problems = num_problems;
+         status = _scrub_status;
+      }
+      if (num_problems)
+         elog("scrub of ${name}.log blocks ${b}-${e} found ${n} problems", ("name", name)("b", begin_block)("e", end_block - 1)("n", num_problems));
+      else if (begin_block != end_block)
+         ilog("scrub of ${name}.log blocks ${b}-${e} found no problem", ("name", name)("b", begin_block)("e", end_block - 1));
+      if (_on_scrub_update)
+         _on_scrub_update(status);
+   }
+
+   // scrub thread
+   void scrub() {
+#ifdef __linux__
+      // the nice value is per thread on linux
+      setpriority(PRIO_PROCESS, 0, 19);
+#endif
+      detail::log_scrubber scrubber([this](uint64_t bytes) { scrub_read(bytes); });
+      try {
+         while (true) {
+            scrub_pass(scrubber);
+            std::unique_lock g(_scrub_mx);
+            if (_scrub_cv.wait_for(g, std::chrono::seconds(_scrub_config.interval_sec), [this] { return _stop_scrub; }))
+               break;
+         }
+      } catch (const detail::scrub_stopped&) {
+      } catch (const fc::exception& e) {
+         elog("scrub of ${name}.log stopped: ${e}", ("name", name)("e", e.to_detail_string()));
+      } catch (const std::exception& e) {
+         elog("scrub of ${name}.log stopped: ${e}", ("name", name)("e", e.what()));
+      }
+   }
 }; // state_history_log
 
 } // namespace eosio
@@ -114,8 +114,34 @@ struct get_blocks_result_v0 : get_blocks_result_base {
    std::optional<bytes>          deltas;
 };
 
-using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0>;
-using state_result  = std::variant<get_status_result_v0, get_blocks_result_v0>;
+struct scrub_problem {
+   uint32_t    block_num = 0;
+   std::string file      = {};
+   std::string message   = {};
+};
+
+struct scrub_status {
+   bool                       enabled            = false;
+   uint32_t                   passes_completed   = 0;
+   uint32_t                   pass_begin_block   = 0;  // blocks of the current pass, or of the last one when idle
+   uint32_t                   pass_end_block     = 0;
+   uint32_t                   next_block         = 0;  // next block verified by the current pass
+   uint32_t                   last_pass_problems = 0;  // problems found by the last completed pass
+   uint64_t                   entries_verified   = 0;
+   uint64_t                   bytes_read         = 0;
+   uint64_t                   problems_found     = 0;
+   std::vector<scrub_problem> problems           = {}; // most recent problems, oldest first
+};
+
+struct get_scrub_status_request_v0 {};
+
+struct get_scrub_status_result_v0 {
+   scrub_status trace       = {};
+   scrub_status chain_state = {};
+};
+
+using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_scrub_status_request_v0>;
+using state_result  = std::variant<get_status_result_v0, get_blocks_result_v0, get_scrub_status_result_v0>;
 
 } // namespace state_history
 } // namespace eosio
@@ -129,4 +155,8 @@ FC_REFLECT(eosio::state_history::get_blocks_request_v0, (start_block_num)(end_bl
 FC_REFLECT(eosio::state_history::get_blocks_ack_request_v0, (num_messages));
 FC_REFLECT(eosio::state_history::get_blocks_result_base, (head)(last_irreversible)(this_block)(prev_block)(block));
 FC_REFLECT_DERIVED(eosio::state_history::get_blocks_result_v0, (eosio::state_history::get_blocks_result_base), (traces)(deltas));
+FC_REFLECT(eosio::state_history::scrub_problem, (block_num)(file)(message));
+FC_REFLECT(eosio::state_history::scrub_status, (enabled)(passes_completed)(pass_begin_block)(pass_end_block)(next_block)(last_pass_problems)(entries_verified)(bytes_read)(problems_found)(problems));
+FC_REFLECT_EMPTY(eosio::state_history::get_scrub_status_request_v0);
+FC_REFLECT(eosio::state_history::get_scrub_status_result_v0, (trace)(chain_state));
 // clang-format on
@@ -310,6 +310,7 @@ namespace eosio { namespace testing {
          void              set_abi( account_name name, const char* abi_json, const private_key_type* signer = nullptr );
 
          bool is_code_cached( account_name name ) const;
+         bool is_code_preinstantiated( account_name name ) const;
 
          bool                          chain_has_transaction( const transaction_id_type& txid ) const;
          const transaction_receipt&    get_transaction_receipt( const transaction_id_type& txid ) const;
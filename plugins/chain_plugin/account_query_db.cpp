@@ -13,6 +13,9 @@
 #include <boost/bimap/multiset_of.hpp>
 #include <boost/bimap/set_of.hpp>
 
+#include <fc/io/cfile.hpp>
+
+#include <fstream>
 #include <shared_mutex>
 
 using namespace eosio;
@@ -99,6 +102,14 @@ namespace {
          return {};
       }
    }
+
+   /**
+    * History:
+    * Version 1: initial version, permission_infos in {owner,name} order each followed by its weighted
+    *            account and key authorizers
+    */
+   constexpr uint32_t persist_magic_number = 0x41514442;
+   constexpr uint32_t persist_version      = 1;
 }
 
 namespace std {
@@ -144,7 +155,21 @@ namespace eosio::chain_apis {
          auto start = fc::time_point::now();
          const auto& index = controller.db().get_index<chain::permission_index>().indices().get<by_id>();
 
-         // build a initial time to block number map
+         build_time_to_block_num_map();
+
+         for (const auto& po : index ) {
+            uint32_t last_updated_height = last_updated_time_to_height(po.last_updated);
+            const auto& pi = permission_info_index.emplace( permission_info{ po.owner, po.name, last_updated_height, po.auth.threshold } ).first;
+            add_to_bimaps(*pi, po);
+         }
+         auto duration = fc::time_point::now() - start;
+         ilog("Finished building account query DB in ${sec}", ("sec", (duration.count() / 1'000'000.0 )));
+      }
+
+      /**
+       * build the initial time to block number map from the reversible blocks
+       */
+      void build_time_to_block_num_map() {
          const auto lib_num = controller.last_irreversible_block_num();
          const auto head_num = controller.head_block_num();
 
@@ -153,14 +178,135 @@ namespace eosio::chain_apis {
             EOS_ASSERT(block_p, chain::plugin_exception, "cannot fetch reversible block ${block_num}, required for account_db initialization", ("block_num", block_num));
             time_to_block_num.emplace(block_p->timestamp.to_time_point(), block_num);
          }
+      }
 
-         for (const auto& po : index ) {
-            uint32_t last_updated_height = last_updated_time_to_height(po.last_updated);
-            const auto& pi = permission_info_index.emplace( permission_info{ po.owner, po.name, last_updated_height, po.auth.threshold } ).first;
-            add_to_bimaps(*pi, po);
+      /**
+       * Load the database from a file written by `write_persist_file`. The file is only usable if it was written at
+       * the current head of the chain, in which case the chain state it was built from is identical to the current one.
+       * The file is removed once read, a later `close` writes it again.
+       * @return false if the file is missing or not usable, in which case the database is left empty
+       */
+      bool load_persist_file( const std::filesystem::path& persist_file ) {
+         if (!std::filesystem::exists(persist_file))
+            return false;
+
+         std::unique_lock write_lock(rw_mutex);
+
+         ilog("Loading account query DB from ${f}", ("f", persist_file));
+         auto start = fc::time_point::now();
+         bool loaded = false;
+         try {
+            fc::cfile file;
+            file.set_file_path(persist_file);
+            file.open("rb");
+            auto ds = file.create_datastream();
+
+            uint32_t totem = 0;
+            fc::raw::unpack( ds, totem );
+            EOS_ASSERT( totem == persist_magic_number, chain::plugin_exception,
+                        "Account query DB file '${filename}' has unexpected magic number: ${actual_totem}. Expected ${expected_totem}",
+                        ("filename", persist_file)("actual_totem", totem)("expected_totem", persist_magic_number) );
+
+            uint32_t version = 0;
+            fc::raw::unpack( ds, version );
+            EOS_ASSERT( version == persist_version, chain::plugin_exception,
+                        "Unsupported version of account query DB file '${filename}': ${version}, expected ${expected}",
+                        ("filename", persist_file)("version", version)("expected", persist_version) );
+
+            chain::chain_id_type chain_id = chain::chain_id_type::empty_chain_id();
+            chain::block_id_type head_id;
+            fc::raw::unpack( ds, chain_id );
+            fc::raw::unpack( ds, head_id );
+
+            if (chain_id != controller.get_chain_id() || head_id != controller.head_block_id()) {
+               ilog("Account query DB file ${f} was written at block ${b}, head is ${h}; rebuilding",
+                    ("f", persist_file)("b", chain::block_header::num_from_id(head_id))("h", controller.head_block_num()));
+            } else {
+               build_time_to_block_num_map();
+
+               fc::unsigned_int num_permissions;
+               fc::raw::unpack( ds, num_permissions );
+               for (uint32_t i = 0; i < num_permissions.value; ++i) {
+                  permission_info pi;
+                  fc::raw::unpack( ds, pi.owner );
+                  fc::raw::unpack( ds, pi.name );
+                  fc::raw::unpack( ds, pi.last_updated_height );
+                  fc::raw::unpack( ds, pi.threshold );
+                  const auto& stored = *permission_info_index.emplace( pi ).first;
+
+                  fc::unsigned_int num_authorizers;
+                  fc::raw::unpack( ds, num_authorizers );
+                  for (uint32_t a = 0; a < num_authorizers.value; ++a) {
+                     weighted<chain::permission_level> authorizer;
+                     fc::raw::unpack( ds, authorizer.value );
+                     fc::raw::unpack( ds, authorizer.weight );
+                     name_bimap.insert(name_bimap_t::value_type {std::move(authorizer), stored});
+                  }
+
+                  fc::raw::unpack( ds, num_authorizers );
+                  for (uint32_t k = 0; k < num_authorizers.value; ++k) {
+                     weighted<chain::public_key_type> authorizer;
+                     fc::raw::unpack( ds, authorizer.value );
+                     fc::raw::unpack( ds, authorizer.weight );
+                     key_bimap.insert(key_bimap_t::value_type {std::move(authorizer), stored});
+                  }
+               }
+               loaded = true;
+            }
+         } FC_LOG_AND_DROP(("Unable to load account query DB from ${f}", ("f", persist_file)));
+
+         std::filesystem::remove(persist_file);
+
+         if (!loaded) {
+            time_to_block_num.clear();
+            name_bimap.clear();
+            key_bimap.clear();
+            permission_info_index.clear();
+            return false;
          }
+
          auto duration = fc::time_point::now() - start;
-         ilog("Finished building account query DB in ${sec}", ("sec", (duration.count() / 1'000'000.0 )));
+         ilog("Finished loading account query DB in ${sec}", ("sec", (duration.count() / 1'000'000.0 )));
+         return true;
+      }
+
+      /**
+       * Write the database to a file along with the head it reflects so it can be loaded instead of rebuilt
+       */
+      void write_persist_file( const std::filesystem::path& persist_file ) const {
+         std::shared_lock read_lock(rw_mutex);
+
+         ilog("Writing account query DB to ${f}", ("f", persist_file));
+         std::ofstream out( persist_file.generic_string().c_str(), std::ios::out | std::ios::binary | std::ofstream::trunc );
+         fc::raw::pack( out, persist_magic_number );
+         fc::raw::pack( out, persist_version );
+         fc::raw::pack( out, controller.get_chain_id() );
+         fc::raw::pack( out, controller.head_block_id() );
+
+         const auto& index = permission_info_index.get<by_owner_name>();
+         fc::raw::pack( out, fc::unsigned_int(index.size()) );
+         for (const auto& pi : index) {
+            fc::raw::pack( out, pi.owner );
+            fc::raw::pack( out, pi.name );
+            fc::raw::pack( out, pi.last_updated_height );
+            fc::raw::pack( out, pi.threshold );
+
+            const auto name_range = name_bimap.right.equal_range(pi);
+            fc::raw::pack( out, fc::unsigned_int(std::distance(name_range.first, name_range.second)) );
+            for (auto itr = name_range.first; itr != name_range.second; ++itr) {
+               fc::raw::pack( out, itr->second.value );
+               fc::raw::pack( out, itr->second.weight );
+            }
+
+            const auto key_range = key_bimap.right.equal_range(pi);
+            fc::raw::pack( out, fc::unsigned_int(std::distance(key_range.first, key_range.second)) );
+            for (auto itr = key_range.first; itr != key_range.second; ++itr) {
+               fc::raw::pack( out, itr->second.value );
+               fc::raw::pack( out, itr->second.weight );
+            }
+         }
+         out.close();
+         EOS_ASSERT( out, chain::plugin_exception, "Unable to write account query DB file ${f}", ("f", persist_file) );
       }
 
       /**
@@ -484,6 +630,7 @@ namespace eosio::chain_apis {
       using onblock_trace_t = std::optional<chain::transaction_trace_ptr>;
 
       const chain::controller&   controller;               ///< the controller to read data from
+      std::filesystem::path      persist_file;             ///< file the database is loaded from and written to, if any
       cached_trace_map_t         cached_trace_map;         ///< temporary cache of uncommitted traces
       onblock_trace_t            onblock_trace;            ///< temporary cache of on_block trace
 
@@ -506,10 +653,12 @@ namespace eosio::chain_apis {
       mutable std::shared_mutex  rw_mutex;                 ///< mutex for read/write locking on the Multi-index and bimaps
    };
 
-   account_query_db::account_query_db( const chain::controller& controller )
+   account_query_db::account_query_db( const chain::controller& controller, const std::filesystem::path& persist_file )
    :_impl(std::make_unique<account_query_db_impl>(controller))
    {
-      _impl->build_account_query_map();
+      _impl->persist_file = persist_file;
+      if (persist_file.empty() || !_impl->load_persist_file(persist_file))
+         _impl->build_account_query_map();
    }
 
    account_query_db::~account_query_db() = default;
@@ -527,6 +676,14 @@ namespace eosio::chain_apis {
       } FC_LOG_AND_DROP(("ACCOUNT DB commit_block ERROR"));
    }
 
+   void account_query_db::close() {
+      if (_impl->persist_file.empty())
+         return;
+      try {
+         _impl->write_persist_file(_impl->persist_file);
+      } FC_LOG_AND_DROP(("ACCOUNT DB close ERROR"));
+   }
+
    account_query_db::get_accounts_by_authorizers_result account_query_db::get_accounts_by_authorizers( const account_query_db::get_accounts_by_authorizers_params& args) const {
       return _impl->get_accounts_by_authorizers(args);
    }
@@ -13,6 +13,8 @@
 #include <eosio/chain/snapshot.hpp>
 #include <eosio/chain/subjective_billing.hpp>
 #include <eosio/chain/deep_mind.hpp>
+#include <eosio/chain/table_access_tracer.hpp>
+#include <eosio/chain/platform_timer.hpp>
 #include <eosio/chain_plugin/trx_finality_status_processing.hpp>
 #include <eosio/chain/permission_link_object.hpp>
 #include <eosio/chain/global_property_object.hpp>
@@ -38,6 +40,8 @@ FC_REFLECT(chainbase::environment, (debug)(os)(arch)(boost_version)(compiler) )
 
 const std::string deep_mind_logger_name("deep-mind");
 eosio::chain::deep_mind_handler _deep_mind_log;
+const std::string table_access_logger_name("table-access");
+eosio::chain::table_access_tracer _table_access_tracer;
 
 namespace eosio {
 
@@ -308,6 +312,9 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "print contract's output to console")
          ("deep-mind", bpo::bool_switch()->default_value(false),
           "print deeper information about chain operations")
+         ("trace-table-access", bpo::bool_switch()->default_value(false),
+          "record the contract tables each transaction reads and writes, and log the conflict graph of every block "
+          "to the table-access logger at debug level")
          ("actor-whitelist", boost::program_options::value<vector<string>>()->composing()->multitoken(),
           "Account added to actor whitelist (may specify multiple times)")
          ("actor-blacklist", boost::program_options::value<vector<string>>()->composing()->multitoken(),
@@ -367,8 +374,14 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "'all'  - EOS VM OC tier-up is enabled for all contract execution.\n"
           "'none' - EOS VM OC tier-up is completely disabled.\n")
 #endif
+         ("wasm-preinstantiate", bpo::value<bool>()->default_value(true),
+          "Instantiate contracts on a background thread when their code is set and, at startup, the contracts most recently used before shutdown.")
          ("enable-account-queries", bpo::value<bool>()->default_value(false), "enable queries to find accounts by various metadata.")
          ("max-nonprivileged-inline-action-size", bpo::value<uint32_t>()->default_value(config::default_max_nonprivileged_inline_action_size), "maximum allowed size (in bytes) of an inline action for a nonprivileged account")
+         ("checktime-timer", bpo::value<std::string>()->default_value("native"),
+          "Timer bounding the execution time of transactions:\n"
+          "\"native\" : the platform's timer facility, a POSIX timer signal or kqueue.\n"
+          "\"watchdog\" : deadlines polled by a shared watchdog thread, arming and cancelling are atomic stores without a system call.")
          ("transaction-retry-max-storage-size-gb", bpo::value<uint64_t>(),
           "Maximum size (in GiB) allowed to be allocated for the Transaction Retry feature. Setting above 0 enables this feature.")
          ("transaction-retry-interval-sec", bpo::value<uint32_t>()->default_value(20),
@@ -384,7 +397,23 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
          ("transaction-finality-status-failure-duration-sec", bpo::value<uint64_t>()->default_value(config::default_max_transaction_finality_status_failure_duration_sec),
           "Duration (in seconds) a failed transaction's Finality Status will remain available from being first identified.")
          ("integrity-hash-on-start", bpo::bool_switch(), "Log the state integrity hash on startup")
-         ("integrity-hash-on-stop", bpo::bool_switch(), "Log the state integrity hash on shutdown");
+         ("integrity-hash-on-stop", bpo::bool_switch(), "Log the state integrity hash on shutdown")
+         ("state-checkpoint-dir", bpo::value<std::filesystem::path>(),
+          "the location of the state checkpoints directory (absolute path or relative to application data dir).\n"
+          "If set, incremental checkpoints of the state holding only what changed since the previous checkpoint are written there; "
+          "requires database-map-mode \"mapped\". Checkpoints are verified and restored with leap-util chain-state.")
+         ("state-checkpoint-interval-blocks", bpo::value<uint32_t>()->default_value(0),
+          "Write a state checkpoint every this many blocks, 0 disables state checkpoints.\n"
+          "Each checkpoint stops block processing while it reads and hashes the whole state file, up to chain-state-db-size-mb, "
+          "which takes seconds for a large state. It is never written at the start of a produced block: a producer writes "
+          "a due checkpoint between its slots, or while waiting for its production round if the last one took less time "
+          "than is left.")
+         ("state-checkpoint-increments-per-full", bpo::value<uint32_t>()->default_value(64),
+          "Incremental state checkpoints written on top of a full checkpoint before the next full one")
+         ("state-checkpoint-retained-full", bpo::value<uint32_t>()->default_value(2),
+          "Number of full state checkpoints kept along with the incremental checkpoints written on top of them")
+         ("state-checkpoint-threads", bpo::value<uint32_t>()->default_value(4),
+          "Number of threads reading the state when writing a state checkpoint");
 
     cfg.add_options()("block-log-retain-blocks", bpo::value<uint32_t>(), "If set to greater than 0, periodically prune the block log to store only configured number of most recent blocks.\n"
         "If set to 0, no blocks are be written to the block log; block log file is removed after startup.");
@@ -633,6 +662,15 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
       if( options.count( "max-nonprivileged-inline-action-size" ))
          chain_config->max_nonprivileged_inline_action_size = options.at( "max-nonprivileged-inline-action-size" ).as<uint32_t>();
 
+      {
+         // before the controller constructs its timers
+         const auto& checktime_timer = options.at( "checktime-timer" ).as<std::string>();
+         EOS_ASSERT( checktime_timer == "native" || checktime_timer == "watchdog", plugin_config_exception,
+                     "checktime-timer must be \"native\" or \"watchdog\", not \"${t}\"", ("t", checktime_timer) );
+         platform_timer::set_default_backend( checktime_timer == "watchdog" ? platform_timer::backend_t::watchdog
+                                                                            : platform_timer::backend_t::native );
+      }
+
       if( options.count( "transaction-finality-status-max-storage-size-gb" )) {
          const uint64_t max_storage_size = options.at( "transaction-finality-status-max-storage-size-gb" ).as<uint64_t>() * 1024 * 1024 * 1024;
          if (max_storage_size > 0) {
@@ -942,12 +980,26 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
          chain_config->eosvmoc_config.threads = options.at("eos-vm-oc-compile-threads").as<uint64_t>();
       chain_config->eosvmoc_tierup = options["eos-vm-oc-enable"].as<chain::wasm_interface::vm_oc_enable>();
 #endif
+      chain_config->wasm_preinstantiate = options.at("wasm-preinstantiate").as<bool>();
 
       account_queries_enabled = options.at("enable-account-queries").as<bool>();
 
       chain_config->integrity_hash_on_start = options.at("integrity-hash-on-start").as<bool>();
       chain_config->integrity_hash_on_stop = options.at("integrity-hash-on-stop").as<bool>();
 
+      if( options.count( "state-checkpoint-dir" ) ) {
+         auto scd = options.at( "state-checkpoint-dir" ).as<std::filesystem::path>();
+         chain_config->state_checkpoint.dir                 = scd.is_relative() ? app().data_dir() / scd : scd;
+         chain_config->state_checkpoint.interval_blocks     = options.at( "state-checkpoint-interval-blocks" ).as<uint32_t>();
+         chain_config->state_checkpoint.increments_per_full = options.at( "state-checkpoint-increments-per-full" ).as<uint32_t>();
+         chain_config->state_checkpoint.retained_full       = options.at( "state-checkpoint-retained-full" ).as<uint32_t>();
+         chain_config->state_checkpoint.threads             = options.at( "state-checkpoint-threads" ).as<uint32_t>();
+         EOS_ASSERT( chain_config->db_map_mode == pinnable_mapped_file::map_mode::mapped, plugin_config_exception,
+                     "state-checkpoint-dir requires database-map-mode \"mapped\"" );
+         EOS_ASSERT( chain_config->state_checkpoint.retained_full > 0 && chain_config->state_checkpoint.threads > 0, plugin_config_exception,
+                     "state-checkpoint-retained-full and state-checkpoint-threads must be greater than 0" );
+      }
+
       chain.emplace( *chain_config, std::move(pfs), *chain_id );
 
       if( options.count( "transaction-retry-max-storage-size-gb" )) {
@@ -1006,6 +1058,10 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
          chain->enable_deep_mind( &_deep_mind_log );
       }
 
+      if ( options.at( "trace-table-access" ).as<bool>() ) {
+         chain->enable_table_access_tracer( &_table_access_tracer );
+      }
+
       // set up method providers
       get_block_by_number_provider = app().get_method<methods::get_block_by_number>().register_provider(
             [this]( uint32_t block_num ) -> signed_block_ptr {
@@ -1157,7 +1213,7 @@ void chain_plugin_impl::plugin_startup()
    if (account_queries_enabled) {
       account_queries_enabled = false;
       try {
-         _account_query_db.emplace(*chain);
+         _account_query_db.emplace(*chain, state_dir / chain_apis::account_query_db::persist_filename);
          account_queries_enabled = true;
       } FC_LOG_AND_DROP(("Unable to enable account queries"));
    }
@@ -1177,6 +1233,8 @@ void chain_plugin_impl::plugin_shutdown() {
    accepted_transaction_connection.reset();
    applied_transaction_connection.reset();
    block_start_connection.reset();
+   if (_account_query_db)
+      _account_query_db->close();
    chain.reset();
 }
 
@@ -1186,6 +1244,7 @@ void chain_plugin::plugin_shutdown() {
 
 void chain_plugin::handle_sighup() {
    _deep_mind_log.update_logger( deep_mind_logger_name );
+   _table_access_tracer.update_logger( table_access_logger_name );
 }
 
 chain_apis::read_write::read_write(controller& db,
@@ -1569,18 +1628,39 @@ string get_table_type( const abi_def& abi, const name& table_name ) {
    EOS_ASSERT( false, chain::contract_table_query_exception, "Table ${table} is not specified in the ABI", ("table",table_name) );
 }
 
+shared_abi_serializer_ptr read_only::get_shared_abi( const name& account, abi_cache_t* abi_cache ) const {
+   if( abi_cache ) {
+      auto itr = abi_cache->find( account );
+      if( itr != abi_cache->end() )
+         return itr->second;
+   }
+   const account_object* code_accnt = db.db().find<account_object, by_name>( account );
+   EOS_ASSERT( code_accnt != nullptr, chain::account_query_exception, "Fail to retrieve account for ${account}", ("account", account) );
+   abi_def abi;
+   bool has_abi = abi_serializer::to_abi( code_accnt->abi, abi );
+   auto abis = std::make_shared<shared_abi_serializer>( std::move(abi), has_abi );
+   if( abi_cache )
+      abi_cache->emplace( account, abis );
+   return abis;
+}
+
 read_only::get_table_rows_return_t
 read_only::get_table_rows( const read_only::get_table_rows_params& p, const fc::time_point& deadline ) const {
-   abi_def abi = eosio::chain_apis::get_abi( db, p.code );
+   return get_table_rows( p, deadline, nullptr );
+}
+
+read_only::get_table_rows_return_t
+read_only::get_table_rows( const read_only::get_table_rows_params& p, const fc::time_point& deadline, abi_cache_t* abi_cache ) const {
+   shared_abi_serializer_ptr abi = get_shared_abi( p.code, abi_cache );
    bool primary = false;
    auto table_with_index = get_table_index_name( p, primary );
    if( primary ) {
       EOS_ASSERT( p.table == table_with_index, chain::contract_table_query_exception, "Invalid table name ${t}", ( "t", p.table ));
-      auto table_type = get_table_type( abi, p.table );
+      auto table_type = get_table_type( abi->abi(), p.table );
       if( table_type == KEYi64 || p.key_type == "i64" || p.key_type == "name" ) {
          return get_table_rows_ex<key_value_index>(p,std::move(abi),deadline);
       }
-      EOS_ASSERT( false, chain::contract_table_query_exception,  "Invalid table type ${type}", ("type",table_type)("abi",abi));
+      EOS_ASSERT( false, chain::contract_table_query_exception,  "Invalid table type ${type}", ("type",table_type)("abi",abi->abi()));
    } else {
       EOS_ASSERT( !p.key_type.empty(), chain::contract_table_query_exception, "key type required for non-primary index" );
 
@@ -2391,7 +2471,11 @@ read_only::get_raw_abi_results read_only::get_raw_abi( const get_raw_abi_params&
    } EOS_RETHROW_EXCEPTIONS(chain::account_query_exception, "unable to retrieve account abi")
 }
 
-read_only::get_account_return_t read_only::get_account( const get_account_params& params, const fc::time_point& ) const {
+read_only::get_account_return_t read_only::get_account( const get_account_params& params, const fc::time_point& deadline ) const {
+   return get_account( params, deadline, nullptr );
+}
+
+read_only::get_account_return_t read_only::get_account( const get_account_params& params, const fc::time_point&, abi_cache_t* abi_cache ) const {
    try {
    get_account_results result;
    result.account_name = params.account_name;
@@ -2475,7 +2559,7 @@ read_only::get_account_return_t read_only::get_account( const get_account_params
    // add eosio.any linked authorizations
    result.eosio_any_linked_actions = get_linked_actions(chain::config::eosio_any_name);
 
-   const auto& code_account = db.db().get<account_object,by_name>( config::system_account_name );
+   shared_abi_serializer_ptr system_abi = get_shared_abi( config::system_account_name, abi_cache );
    struct http_params_t {
       std::optional<vector<char>> total_resources;
       std::optional<vector<char>> self_delegated_bandwidth;
@@ -2486,7 +2570,7 @@ read_only::get_account_return_t read_only::get_account( const get_account_params
 
    http_params_t http_params;
    
-   if( abi_def abi; abi_serializer::to_abi(code_account.abi, abi) ) {
+   if( system_abi->has_abi() ) {
 
       const auto token_code = "eosio.token"_n;
 
@@ -2530,10 +2614,10 @@ read_only::get_account_return_t read_only::get_account( const get_account_params
       http_params.voter_info               = lookup_object("voters"_n, config::system_account_name);
       http_params.rex_info                 = lookup_object("rexbal"_n, config::system_account_name);
       
-      return [http_params = std::move(http_params), result = std::move(result), abi=std::move(abi), shorten_abi_errors=shorten_abi_errors,
+      return [http_params = std::move(http_params), result = std::move(result), system_abi=std::move(system_abi), shorten_abi_errors=shorten_abi_errors,
               abi_serializer_max_time=abi_serializer_max_time]() mutable ->  chain::t_or_exception<read_only::get_account_results> {
          auto yield = [&]() { return abi_serializer::create_yield_function(abi_serializer_max_time); };
-         abi_serializer abis(std::move(abi), yield());
+         const abi_serializer& abis = system_abi->get(abi_serializer_max_time);
          
          if (http_params.total_resources)
             result.total_resources = abis.binary_to_variant("user_resources", *http_params.total_resources, yield(), shorten_abi_errors);
@@ -2646,6 +2730,102 @@ read_only::get_consensus_parameters(const get_consensus_parameters_params&, cons
    return results;
 }
 
+namespace {
+   template<typename Result>
+   std::function<fc::variant()> batch_deferred( std::function<chain::t_or_exception<Result>()>&& f ) {
+      return [f = std::move(f)]() -> fc::variant {
+         chain::t_or_exception<Result> r = f();
+         if( std::holds_alternative<fc::exception_ptr>(r) )
+            std::get<fc::exception_ptr>(r)->dynamic_rethrow_exception();
+         return fc::variant( std::get<Result>(std::move(r)) );
+      };
+   }
+
+   template<typename Result>
+   std::function<fc::variant()> batch_ready( Result&& r ) {
+      return [v = fc::variant( std::forward<Result>(r) )]() -> fc::variant { return v; };
+   }
+
+   fc::variant batch_error( const fc::exception& e, bool shorten_errors ) {
+      return fc::mutable_variant_object()
+         ("error", fc::mutable_variant_object()
+            ("code", e.code())
+            ("name", e.name())
+            ("what", e.what())
+            ("details", shorten_errors ? e.top_message() : e.to_detail_string()));
+   }
+}
+
+read_only::batch_return_t read_only::batch( const batch_params& params, const fc::time_point& deadline ) const {
+   EOS_ASSERT( !params.empty(), chain::invalid_http_request, "batch requires at least one call" );
+   EOS_ASSERT( params.size() <= max_batch_calls, chain::invalid_http_request,
+               "batch of ${n} calls exceeds the maximum of ${m}", ("n", params.size())("m", max_batch_calls) );
+
+   batch_results results;
+   results.head_block_num = db.head_block_num();
+   results.head_block_id  = db.head_block_id();
+
+   // abis resolved here on the main thread, their abi_serializers are built on the http thread pool
+   abi_cache_t abi_cache;
+
+   auto dispatch = [&]( const batch_call& c ) -> std::function<fc::variant()> {
+      if( c.api == "get_info" )
+         return batch_ready( get_info( {}, deadline ) );
+      if( c.api == "get_account" )
+         return batch_deferred( get_account( c.params.as<get_account_params>(), deadline, &abi_cache ) );
+      if( c.api == "get_currency_balance" )
+         return batch_ready( get_currency_balance( c.params.as<get_currency_balance_params>(), deadline ) );
+      if( c.api == "get_currency_stats" )
+         return batch_ready( get_currency_stats( c.params.as<get_currency_stats_params>(), deadline ) );
+      if( c.api == "get_table_rows" )
+         return batch_deferred( get_table_rows( c.params.as<get_table_rows_params>(), deadline, &abi_cache ) );
+      if( c.api == "get_table_by_scope" )
+         return batch_ready( get_table_by_scope( c.params.as<get_table_by_scope_params>(), deadline ) );
+      if( c.api == "get_abi" )
+         return batch_ready( get_abi( c.params.as<get_abi_params>(), deadline ) );
+      if( c.api == "get_code_hash" )
+         return batch_ready( get_code_hash( c.params.as<get_code_hash_params>(), deadline ) );
+      if( c.api == "get_raw_abi" )
+         return batch_ready( get_raw_abi( c.params.as<get_raw_abi_params>(), deadline ) );
+      EOS_THROW( chain::invalid_http_request, "Unsupported batch api ${api}", ("api", c.api) );
+   };
+
+   std::vector<std::function<fc::variant()>> calls;
+   calls.reserve( params.size() );
+   for( const auto& c : params ) {
+      try {
+         EOS_ASSERT( fc::time_point::now() < deadline, chain::deadline_exception,
+                     "batch deadline exceeded before ${api}", ("api", c.api) );
+         calls.emplace_back( dispatch( c ) );
+      } catch( const fc::exception& e ) {
+         calls.emplace_back( batch_ready( batch_error( e, shorten_abi_errors ) ) );
+      } catch( const std::exception& e ) {
+         calls.emplace_back( batch_ready( batch_error( fc::std_exception_wrapper::from_current_exception( e ), shorten_abi_errors ) ) );
+      } catch( ... ) {
+         calls.emplace_back( batch_ready( batch_error( fc::unhandled_exception( FC_LOG_MESSAGE( error, "unknown exception" ) ), shorten_abi_errors ) ) );
+      }
+   }
+
+   // calls share the abi_serializers of abi_cache so they are converted sequentially on a single http thread
+   return [results = std::move(results), calls = std::move(calls), shorten_abi_errors = shorten_abi_errors]() mutable ->
+      chain::t_or_exception<read_only::batch_results> {
+      results.results.reserve( calls.size() );
+      for( auto& call : calls ) {
+         try {
+            results.results.emplace_back( call() );
+         } catch( const fc::exception& e ) {
+            results.results.emplace_back( batch_error( e, shorten_abi_errors ) );
+         } catch( const std::exception& e ) {
+            // an abi_serializer failed to build in shared_abi_serializer::get() rethrows whatever it threw
+            results.results.emplace_back( batch_error( fc::std_exception_wrapper::from_current_exception( e ), shorten_abi_errors ) );
+         } catch( ... ) {
+            results.results.emplace_back( batch_error( fc::unhandled_exception( FC_LOG_MESSAGE( error, "unknown exception" ) ), shorten_abi_errors ) );
+         }
+      }
+      return std::move(results);
+   };
+}
+
 } // namespace chain_apis
 
 fc::variant chain_plugin::get_log_trx_trace(const transaction_trace_ptr& trx_trace ) const {
@@ -3,22 +3,27 @@
 #include <eosio/chain/block_state.hpp>
 #include <eosio/chain/trace.hpp>
 
+#include <filesystem>
+
 namespace eosio::chain_apis {
    /**
-    * This class manages the ephemeral indices and data that provide the `get_accounts_by_authorizers` RPC call
-    * There is no persistence and the indices/caches are recreated when the class is instantiated based on the
-    * current state of the chain.
+    * This class manages the indices and data that provide the `get_accounts_by_authorizers` RPC call
+    * The indices are kept in memory and maintained incrementally as blocks are committed. When a persist file is
+    * given, they are written out on `close()` and loaded back on instantiation if the file was written at the
+    * current head of the chain; otherwise they are recreated from the current state of the chain.
     */
    class account_query_db {
    public:
+      static constexpr const char* persist_filename = "account_query_db.dat";
 
       /**
        * Instantiate a new account query DB from the given chain controller
        * The caller is expected to manage lifetimes such that this controller reference does not go stale
        * for the life of the account query DB
        * @param chain - controller to read data from
+       * @param persist_file - optional file to load the indices from and to write them to on close
        */
-      account_query_db( const class eosio::chain::controller& chain );
+      explicit account_query_db( const class eosio::chain::controller& chain, const std::filesystem::path& persist_file = {} );
       ~account_query_db();
 
       /**
@@ -42,6 +47,12 @@ namespace eosio::chain_apis {
        */
       void commit_block(const chain::block_state_ptr& block );
 
+      /**
+       * Write the indices to the persist file, if any, so they can be loaded on the next instantiation instead of
+       * being rebuilt. Must be called while the chain controller is still at the head the indices reflect.
+       */
+      void close();
+
       /**
        * parameters for the get_accounts_by_authorizers RPC
        */
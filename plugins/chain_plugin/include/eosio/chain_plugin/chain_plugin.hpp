@@ -115,6 +115,43 @@ string convert_to_string(const chain::key256_t& source, const string& key_type,
 template<>
 string convert_to_string(const float128_t& source, const string& key_type, const string& encode_type, const string& desc);
 
+/**
+ * Holds a contract abi resolved on the main thread and builds its abi_serializer on first use, which happens on the
+ * http thread pool. A /v1/chain/batch request shares one instance per contract between all of its calls so that each
+ * abi_serializer is built at most once per batch.
+ * Not thread safe, the deferred conversions sharing an instance are run sequentially.
+ */
+class shared_abi_serializer {
+public:
+   shared_abi_serializer(abi_def&& abi, bool has_abi)
+      : abi_(std::move(abi)), has_abi_(has_abi) {}
+
+   bool has_abi() const { return has_abi_; }
+
+   // only valid until get() is called, abi is moved into the abi_serializer
+   const abi_def& abi() const { return abi_; }
+
+   const abi_serializer& get(const fc::microseconds& max_time) {
+      if( !abis_ && !error_ ) {
+         try {
+            abis_.emplace( std::move(abi_), abi_serializer::create_yield_function(max_time) );
+         } catch( ... ) {
+            error_ = std::current_exception();
+         }
+      }
+      if( error_ )
+         std::rethrow_exception( error_ );
+      return *abis_;
+   }
+
+private:
+   abi_def                        abi_;
+   bool                           has_abi_ = false;
+   std::optional<abi_serializer>  abis_;
+   std::exception_ptr             error_;
+};
+using shared_abi_serializer_ptr = std::shared_ptr<shared_abi_serializer>;
+
 class read_write;
    
 class api_base {
@@ -144,9 +181,16 @@ class read_only : public api_base {
    bool  shorten_abi_errors = true;
    const trx_finality_status_processing* trx_finality_status_proc;
    friend class api_base;
+
+   // code account -> abi, shared by the calls of a batch
+   using abi_cache_t = std::map<name, shared_abi_serializer_ptr>;
+
+   // abi_cache is optional, when provided the abi of account is resolved at most once per cache
+   shared_abi_serializer_ptr get_shared_abi( const name& account, abi_cache_t* abi_cache ) const;
    
 public:
    static const string KEYi64;
+   static constexpr uint32_t max_batch_calls = 100;
 
    read_only(const controller& db, const std::optional<account_query_db>& aqdb,
              const fc::microseconds& abi_serializer_max_time, const fc::microseconds& http_max_response_time,
@@ -295,6 +339,7 @@ public:
    };
    using get_account_return_t = std::function<chain::t_or_exception<get_account_results>()>;
    get_account_return_t get_account( const get_account_params& params, const fc::time_point& deadline )const;
+   get_account_return_t get_account( const get_account_params& params, const fc::time_point& deadline, abi_cache_t* abi_cache )const;
 
 
    struct get_code_results {
@@ -440,6 +485,7 @@ public:
    using get_table_rows_return_t = std::function<chain::t_or_exception<get_table_rows_result>()>;
    
    get_table_rows_return_t get_table_rows( const get_table_rows_params& params, const fc::time_point& deadline )const;
+   get_table_rows_return_t get_table_rows( const get_table_rows_params& params, const fc::time_point& deadline, abi_cache_t* abi_cache )const;
 
    struct get_table_by_scope_params {
       name                 code; // mandatory
@@ -574,7 +620,7 @@ public:
    template <typename IndexType, typename SecKeyType, typename ConvFn>
    get_table_rows_return_t
    get_table_rows_by_seckey( const read_only::get_table_rows_params& p,
-                             abi_def&& abi,
+                             shared_abi_serializer_ptr abis,
                              const fc::time_point& deadline,
                              ConvFn conv ) const {
 
@@ -675,11 +721,10 @@ public:
 
       // not enforcing the deadline for that second processing part (the serialization), as it is not taking place
       // on the main thread, but in the http thread pool.
-      return [p = std::move(http_params), abi=std::move(abi), abi_serializer_max_time=abi_serializer_max_time]() mutable ->
+      return [p = std::move(http_params), shared_abis=std::move(abis), abi_serializer_max_time=abi_serializer_max_time]() mutable ->
          chain::t_or_exception<read_only::get_table_rows_result> {
          read_only::get_table_rows_result result;
-         abi_serializer abis;
-         abis.set_abi(std::move(abi), abi_serializer::create_yield_function(abi_serializer_max_time));
+         const abi_serializer& abis = shared_abis->get(abi_serializer_max_time);
          auto table_type = abis.get_table_type(p.table);
          
          for (auto& row : p.rows) {
@@ -707,7 +752,7 @@ public:
    template <typename IndexType>
    get_table_rows_return_t
    get_table_rows_ex( const read_only::get_table_rows_params& p,
-                      abi_def&& abi,
+                      shared_abi_serializer_ptr abis,
                       const fc::time_point& deadline ) const {
 
       fc::time_point params_deadline = p.time_limit_ms ? std::min(fc::time_point::now().safe_add(fc::milliseconds(*p.time_limit_ms)), deadline) : deadline;
@@ -787,11 +832,10 @@ public:
       
       // not enforcing the deadline for that second processing part (the serialization), as it is not taking place
       // on the main thread, but in the http thread pool.
-      return [p = std::move(http_params), abi=std::move(abi), abi_serializer_max_time=abi_serializer_max_time]() mutable ->
+      return [p = std::move(http_params), shared_abis=std::move(abis), abi_serializer_max_time=abi_serializer_max_time]() mutable ->
          chain::t_or_exception<read_only::get_table_rows_result> {
          read_only::get_table_rows_result result;
-         abi_serializer abis;
-         abis.set_abi(std::move(abi), abi_serializer::create_yield_function(abi_serializer_max_time));
+         const abi_serializer& abis = shared_abis->get(abi_serializer_max_time);
          auto table_type = abis.get_table_type(p.table);
          
          for (auto& row : p.rows) {
@@ -822,6 +866,23 @@ public:
 
    chain::symbol extract_core_symbol()const;
 
+   struct batch_call {
+      string       api;    ///< name of the read_only call, e.g. "get_account"
+      fc::variant  params; ///< params of the call, as they would be posted to /v1/chain/<api>
+   };
+   using batch_params = vector<batch_call>;
+
+   struct batch_results {
+      uint32_t              head_block_num = 0;
+      chain::block_id_type  head_block_id;
+      fc::variants          results; ///< one per call, in order, either the call result or an object with an "error" member
+   };
+
+   using batch_return_t = std::function<chain::t_or_exception<batch_results>()>;
+
+   // all calls are run against the same head, abis are resolved once per contract and shared between the calls
+   batch_return_t batch( const batch_params& params, const fc::time_point& deadline )const;
+
    using get_consensus_parameters_params = empty;
    struct get_consensus_parameters_results {
      chain::chain_config        chain_config;
@@ -1071,3 +1132,5 @@ FC_REFLECT( eosio::chain_apis::read_only::compute_transaction_results, (transact
 FC_REFLECT( eosio::chain_apis::read_only::send_read_only_transaction_params, (transaction))
 FC_REFLECT( eosio::chain_apis::read_only::send_read_only_transaction_results, (transaction_id)(processed) )
 FC_REFLECT( eosio::chain_apis::read_only::get_consensus_parameters_results, (chain_config)(wasm_config))
+FC_REFLECT( eosio::chain_apis::read_only::batch_call, (api)(params) )
+FC_REFLECT( eosio::chain_apis::read_only::batch_results, (head_block_num)(head_block_id)(results) )
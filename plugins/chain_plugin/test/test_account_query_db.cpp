@@ -6,6 +6,9 @@
 #include <eosio/chain_plugin/account_query_db.hpp>
 #include <eosio/chain/thread_utils.hpp>
 
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+
 using namespace eosio;
 using namespace eosio::chain;
 using namespace eosio::testing;
@@ -141,6 +144,63 @@ BOOST_FIXTURE_TEST_CASE(updateauth_test_multi_threaded, validating_tester) { try
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_FIXTURE_TEST_CASE(persist_test, validating_tester) { try {
+   fc::temp_directory tmp;
+   const auto persist_file = tmp.path() / account_query_db::persist_filename;
+
+   const auto& tester_account = "tester"_n;
+   const string role = "first";
+   params pars;
+   pars.keys.emplace_back(get_public_key(tester_account, role));
+   pars.accounts.emplace_back(params::permission_level{{tester_account, {}}});
+
+   results expected;
+   {
+      account_query_db aq_db(*control, persist_file);
+      auto c = control->accepted_block.connect([&](const block_state_ptr& blk) {
+         aq_db.commit_block( blk);
+      });
+
+      produce_blocks(10);
+      aq_db.cache_transaction_trace(create_account(tester_account));
+      produce_block();
+
+      const auto trace_ptr = push_action(config::system_account_name, updateauth::get_name(), tester_account, fc::mutable_variant_object()
+            ("account", tester_account)
+            ("permission", "role"_n)
+            ("parent", "active")
+            ("auth",  authority(get_public_key(tester_account, role), 5))
+      );
+      aq_db.cache_transaction_trace(trace_ptr);
+      produce_block();
+
+      expected = aq_db.get_accounts_by_authorizers(pars);
+      BOOST_TEST_REQUIRE(find_account_auth(expected, tester_account, "role"_n) == true);
+
+      aq_db.close();
+   }
+   BOOST_TEST_REQUIRE(std::filesystem::exists(persist_file));
+
+   // written at the current head, loaded instead of rebuilt and removed once read
+   {
+      account_query_db aq_db(*control, persist_file);
+      BOOST_TEST_REQUIRE(!std::filesystem::exists(persist_file));
+      const auto loaded = aq_db.get_accounts_by_authorizers(pars);
+      BOOST_TEST_REQUIRE(fc::json::to_string(loaded, fc::time_point::maximum()) == fc::json::to_string(expected, fc::time_point::maximum()));
+      aq_db.close();
+   }
+
+   // written at an older head, rebuilt from the chain
+   produce_block();
+   {
+      account_query_db aq_db(*control, persist_file);
+      BOOST_TEST_REQUIRE(!std::filesystem::exists(persist_file));
+      const auto rebuilt = aq_db.get_accounts_by_authorizers(pars);
+      BOOST_TEST_REQUIRE(find_account_auth(rebuilt, tester_account, "role"_n) == true);
+   }
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE(future_fork_test) { try {
    tester node_a(setup_policy::none);
    tester node_b(setup_policy::none);
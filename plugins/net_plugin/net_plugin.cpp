@@ -3008,6 +3008,11 @@ namespace eosio {
          return true;
       }
 
+      if( auto except_ptr = my_impl->producer_plug->admission_check( ptr, false ) ) {
+         peer_dlog( this, "dropping trx ${id}: ${e}", ("id", ptr->id())("e", except_ptr->top_message()) );
+         return true;
+      }
+
       handle_message( std::move( ptr ) );
       return true;
    }
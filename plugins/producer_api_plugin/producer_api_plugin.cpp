@@ -137,9 +137,17 @@ void producer_api_plugin::plugin_startup() {
             INVOKE_R_R(producer, unschedule_snapshot, chain::snapshot_scheduler::snapshot_request_id_information), 201),
        CALL_WITH_400(producer, producer_rw, producer, get_integrity_hash,
             INVOKE_R_V(producer, get_integrity_hash), 201),
+       CALL_WITH_400(producer, producer_rw, producer, get_sectioned_integrity_hash,
+            INVOKE_R_V(producer, get_sectioned_integrity_hash), 201),
        CALL_WITH_400(producer, producer_rw, producer, schedule_protocol_feature_activations,
             INVOKE_V_R(producer, schedule_protocol_feature_activations, producer_plugin::scheduled_protocol_feature_activations), 201),
    }, appbase::exec_queue::read_write, appbase::priority::medium_high);
+
+   // Runs on the http thread, the main thread is blocked for as long as get_sectioned_integrity_hash runs
+   app().get_plugin<http_plugin>().add_async_api({
+       CALL_WITH_400(producer, producer_ro, producer, get_integrity_hash_progress,
+            INVOKE_R_V(producer, get_integrity_hash_progress), 201),
+   });
 }
 
 void producer_api_plugin::plugin_initialize(const variables_map& options) {
@@ -0,0 +1,79 @@
+#pragma once
+#include <eosio/chain/controller.hpp>
+#include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/unapplied_transaction_queue.hpp>
+
+namespace eosio {
+
+namespace prepack_util {
+
+   struct prepack_result {
+      size_t expired = 0;
+      size_t checked = 0;
+      size_t dropped = 0;
+   };
+
+   // When to prepack for block production starting at block_start, or nothing if prepacking is disabled (lead of 0)
+   // or it is already too late for it.
+   inline std::optional<fc::time_point> prepack_time(const fc::microseconds& lead, const fc::time_point& block_start,
+                                                     const fc::time_point& now) {
+      if (lead.count() == 0)
+         return {};
+      const fc::time_point t = block_start - lead;
+      if (t <= now)
+         return {};
+      return t;
+   }
+
+   // Drop the queued transactions that would fail against the head block of chain regardless of what a block started
+   // at block_start applies before them: expired by block_start, already applied, or referencing a block that is not
+   // on the head's fork. next() of each dropped transaction is called with its failure, and
+   // on_dropped(trx_meta, except_ptr) for those not expired. Stops early when yield() returns true.
+   template <typename Yield, typename Callback>
+   prepack_result drop_failing_trxs(const chain::controller& chain, chain::unapplied_transaction_queue& queue,
+                                    const fc::time_point& block_start, Yield&& yield, Callback&& on_dropped) {
+      using namespace chain;
+      prepack_result result;
+
+      queue.clear_expired(block_start, yield, [&result](const packed_transaction_ptr&, trx_enum_type) { ++result.expired; });
+
+      const block_id_type head_id  = chain.head_block_id();
+      const uint32_t      head_num = chain.head_block_num();
+      for (auto itr = queue.begin(); itr != queue.end();) {
+         if (yield())
+            break;
+         ++result.checked;
+
+         const auto&       trx = itr->trx_meta->packed_trx()->get_transaction();
+         fc::exception_ptr except_ptr;
+         if (chain.is_known_unexpired_transaction(itr->id())) {
+            except_ptr = std::static_pointer_cast<fc::exception>(
+               std::make_shared<tx_duplicate>(FC_LOG_MESSAGE(error, "duplicate transaction ${id}", ("id", itr->id()))));
+         } else if (const uint16_t ref_age = static_cast<uint16_t>(head_num) - trx.ref_block_num; ref_age < 0x8000) {
+            // a larger age is more likely a reference to a block past our head than one 32K blocks old
+            try {
+               if (ref_age == 0)
+                  EOS_ASSERT(trx.verify_reference_block(head_id), invalid_ref_block_exception,
+                             "Transaction's reference block did not match. Is this transaction from a different fork?");
+               else
+                  chain.validate_tapos(trx);
+            } catch (const invalid_ref_block_exception& e) {
+               except_ptr = e.dynamic_copy_exception();
+            }
+         }
+
+         if (!except_ptr) {
+            ++itr;
+            continue;
+         }
+         ++result.dropped;
+         on_dropped(itr->trx_meta, except_ptr);
+         if (itr->next)
+            itr->next(except_ptr);
+         itr = queue.erase(itr);
+      }
+      return result;
+   }
+
+} // namespace prepack_util
+} // namespace eosio
@@ -42,6 +42,24 @@ public:
       chain::digest_type   integrity_hash;
    };
 
+   struct section_integrity_hash {
+      std::string          name;
+      chain::digest_type   hash;
+   };
+
+   struct sectioned_integrity_hash_information {
+      chain::block_id_type                head_block_id;
+      chain::digest_type                  integrity_hash; ///< merkle root of the section hashes
+      std::vector<section_integrity_hash> sections;
+   };
+
+   struct integrity_hash_progress {
+      bool                 in_progress = false;
+      uint32_t             done = 0;  ///< sections and contract tables hashed
+      uint32_t             total = 0;
+      fc::time_point       started;
+   };
+
    struct scheduled_protocol_feature_activations {
       std::vector<chain::digest_type> protocol_features_to_activate;
    };
@@ -96,6 +114,9 @@ public:
    void set_whitelist_blacklist(const whitelist_blacklist& params);
 
    integrity_hash_information get_integrity_hash() const;
+   sectioned_integrity_hash_information get_sectioned_integrity_hash() const;
+   /// thread-safe, reports a get_sectioned_integrity_hash() in progress on the main thread
+   integrity_hash_progress get_integrity_hash_progress() const;
 
    void create_snapshot(next_function<chain::snapshot_scheduler::snapshot_information> next);
    chain::snapshot_scheduler::snapshot_schedule_result schedule_snapshot(const chain::snapshot_scheduler::snapshot_request_params& srp);
@@ -139,6 +160,13 @@ public:
 
    void log_failed_transaction(const transaction_id_type& trx_id, const chain::packed_transaction_ptr& packed_trx_ptr, const char* reason) const;
 
+   enum class admission_reject_reason { failure_limit, subjective_bill };
+
+   // thread-safe, checks the admission state published by the main thread at the start of each block
+   // api transactions are checked when they are received, p2p transactions must be checked by their receiver
+   // @return exception to reject trx with if it would fail because of its account's failures or subjective bill, nullptr otherwise
+   fc::exception_ptr admission_check(const chain::packed_transaction_ptr& trx, bool api_trx) const;
+
    // thread-safe, called when a new block is received
    void received_block(uint32_t block_num);
 
@@ -170,6 +198,8 @@ public:
 
    void register_update_produced_block_metrics(std::function<void(produced_block_metrics)>&&);
    void register_update_incoming_block_metrics(std::function<void(incoming_block_metrics)>&&);
+   // called from any thread
+   void register_increment_admission_rejected_trxs(std::function<void(admission_reject_reason)>&&);
 
    inline static bool test_mode_{false}; // to be moved into appbase (application_base)
 
@@ -183,6 +213,9 @@ FC_REFLECT(eosio::producer_plugin::runtime_options, (max_transaction_time)(max_i
 FC_REFLECT(eosio::producer_plugin::greylist_params, (accounts));
 FC_REFLECT(eosio::producer_plugin::whitelist_blacklist, (actor_whitelist)(actor_blacklist)(contract_whitelist)(contract_blacklist)(action_blacklist)(key_blacklist) )
 FC_REFLECT(eosio::producer_plugin::integrity_hash_information, (head_block_id)(integrity_hash))
+FC_REFLECT(eosio::producer_plugin::section_integrity_hash, (name)(hash))
+FC_REFLECT(eosio::producer_plugin::sectioned_integrity_hash_information, (head_block_id)(integrity_hash)(sections))
+FC_REFLECT(eosio::producer_plugin::integrity_hash_progress, (in_progress)(done)(total)(started))
 FC_REFLECT(eosio::producer_plugin::scheduled_protocol_feature_activations, (protocol_features_to_activate))
 FC_REFLECT(eosio::producer_plugin::get_supported_protocol_features_params, (exclude_disabled)(exclude_unactivatable))
 FC_REFLECT(eosio::producer_plugin::get_account_ram_corrections_params, (lower_bound)(upper_bound)(limit)(reverse))
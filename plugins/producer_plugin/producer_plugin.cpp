@@ -1,5 +1,6 @@
 #include <eosio/producer_plugin/producer_plugin.hpp>
 #include <eosio/producer_plugin/block_timing_util.hpp>
+#include <eosio/producer_plugin/prepack_util.hpp>
 #include <eosio/chain/plugin_interface.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/generated_transaction_object.hpp>
@@ -159,6 +160,16 @@ public:
       }
    }
 
+   // accounts that exceed max_failures_per_account until the next reset
+   flat_set<account_name> failure_limited_accounts() const {
+      flat_set<account_name> result;
+      for (const auto& [n, fa] : failed_accounts) {
+         if (fa.num_failures >= max_failures_per_account)
+            result.insert(result.end(), n);
+      }
+      return result;
+   }
+
    fc::time_point next_reset_timepoint(uint32_t current_block_num, fc::time_point current_block_time) const {
       auto num_blocks_to_reset = reset_window_size_in_num_blocks - (current_block_num % reset_window_size_in_num_blocks);
       return current_block_time + fc::milliseconds(num_blocks_to_reset * eosio::chain::config::block_interval_ms);
@@ -379,6 +390,7 @@ class producer_plugin_impl : public std::enable_shared_from_this<producer_plugin
 public:
    producer_plugin_impl(boost::asio::io_service& io)
       : _timer(io)
+      , _prepack_timer(io)
       , _transaction_ack_channel(app().get_channel<compat::channels::transaction_ack>())
       , _ro_timer(io) {}
 
@@ -390,6 +402,8 @@ public:
    bool     block_is_exhausted() const;
    bool     remove_expired_trxs(const fc::time_point& deadline);
    bool     remove_expired_blacklisted_trxs(const fc::time_point& deadline);
+   void     schedule_prepack(const fc::time_point& block_start);
+   void     prepack_unapplied_trxs(const fc::time_point& block_start);
    bool     process_unapplied_trxs(const fc::time_point& deadline);
    void     process_scheduled_and_incoming_trxs(const fc::time_point& deadline, unapplied_transaction_queue::iterator& itr);
    bool     process_incoming_trxs(const fc::time_point& deadline, unapplied_transaction_queue::iterator& itr);
@@ -469,6 +483,50 @@ public:
       return {chain.head_block_id(), chain.calculate_integrity_hash()};
    }
 
+   producer_plugin::sectioned_integrity_hash_information get_sectioned_integrity_hash() {
+      chain::controller& chain = chain_plug->chain();
+
+      auto reschedule = fc::make_scoped_exit([this]() { schedule_production_loop(); });
+
+      if (chain.is_building_block()) {
+         // abort the pending block
+         abort_block();
+      } else {
+         reschedule.cancel();
+      }
+
+      const auto start = fc::time_point::now();
+      _integrity_hash_done = 0;
+      _integrity_hash_total = 0;
+      _integrity_hash_started_us = start.time_since_epoch().count();
+      _integrity_hash_in_progress = true;
+      auto finished = fc::make_scoped_exit([this]() { _integrity_hash_in_progress = false; });
+
+      auto progress = [this](uint32_t done, uint32_t total) {
+         _integrity_hash_total = total;
+         // reports can arrive out of order from the thread pool, keep the highest
+         uint32_t before = _integrity_hash_done;
+         while (before < done && !_integrity_hash_done.compare_exchange_weak(before, done)) {}
+         // log each tenth
+         if (total >= 10 && before < done && before / (total / 10) != done / (total / 10))
+            ilog("integrity hash ${d} of ${t} sections and contract tables", ("d", done)("t", total));
+      };
+      auto hash = chain.calculate_sectioned_integrity_hash(progress);
+
+      producer_plugin::sectioned_integrity_hash_information result{chain.head_block_id(), hash.root};
+      result.sections.reserve(hash.sections.size());
+      for (auto& [name, h] : hash.sections)
+         result.sections.push_back({std::move(name), h});
+      ilog("integrity hash ${h} at block ${b} took ${t}us",
+           ("h", result.integrity_hash)("b", chain.head_block_num())("t", fc::time_point::now() - start));
+      return result;
+   }
+
+   producer_plugin::integrity_hash_progress get_integrity_hash_progress() const {
+      return {_integrity_hash_in_progress, _integrity_hash_done, _integrity_hash_total,
+              fc::time_point(fc::microseconds(_integrity_hash_started_us))};
+   }
+
    void create_snapshot(producer_plugin::next_function<chain::snapshot_scheduler::snapshot_information> next) {
       chain::controller& chain = chain_plug->chain();
 
@@ -513,6 +571,9 @@ public:
    std::map<chain::public_key_type, signature_provider_type> _signature_providers;
    std::set<chain::account_name>                             _producers;
    boost::asio::deadline_timer                               _timer;
+   boost::asio::deadline_timer                               _prepack_timer;
+   uint32_t                                                  _prepack_timer_corelation_id = 0;
+   fc::microseconds                                          _prepack_lead_us{0}; // 0 disables pre-packing
    using producer_watermark = std::pair<uint32_t, block_timestamp_type>;
    std::map<chain::account_name, producer_watermark> _producer_watermarks;
    pending_block_mode                                _pending_block_mode = pending_block_mode::speculating;
@@ -521,6 +582,10 @@ public:
    named_thread_pool<struct prod>                    _thread_pool;
    std::atomic<int32_t>                              _max_transaction_time_ms; // modified by app thread, read by net_plugin thread pool
    std::atomic<uint32_t>                             _received_block{0};       // modified by net_plugin thread pool
+   std::atomic<bool>                                 _integrity_hash_in_progress{false}; // read by http threads
+   std::atomic<uint32_t>                             _integrity_hash_done{0};            // modified by chain thread pool
+   std::atomic<uint32_t>                             _integrity_hash_total{0};
+   std::atomic<int64_t>                              _integrity_hash_started_us{0};
    fc::microseconds                                  _max_irreversible_block_age_us;
    int32_t                                           _cpu_effort_us = 0;
    fc::time_point                                    _pending_block_deadline;
@@ -566,14 +631,87 @@ public:
    // keep a expected ratio between defer txn and incoming txn
    double _incoming_defer_ratio = 1.0; // 1:1
 
+   // incoming transactions of these accounts are ordered before all others
+   flat_set<account_name> _priority_accounts;
+   static constexpr int64_t priority_account_boost = int64_t{1} << 48; // well above any cpu estimate
+
+   // cheapest estimated cpu first, estimate is cpu billed on a previous attempt plus first authorizer's subjective bill
+   int64_t incoming_priority_by_cpu(const transaction_metadata_ptr& trx) const {
+      const account_name first_auth = trx->packed_trx()->get_transaction().first_authorizer();
+      const auto&        sub_bill   = chain_plug->chain().get_subjective_billing();
+      int64_t priority = -static_cast<int64_t>(trx->billed_cpu_time_us) -
+                         static_cast<int64_t>(sub_bill.get_subjective_bill(first_auth, fc::time_point::now()));
+      if (_priority_accounts.count(first_auth))
+         priority += priority_account_boost;
+      return priority;
+   }
+
    // path to write the snapshots to
    std::filesystem::path _snapshots_dir;
 
    // async snapshot scheduler
    snapshot_scheduler _snapshot_scheduler;
 
+   // of the last state checkpoint written while waiting for a production round
+   std::optional<fc::microseconds> _state_checkpoint_duration;
+
    std::function<void(producer_plugin::produced_block_metrics)> _update_produced_block_metrics;
    std::function<void(producer_plugin::incoming_block_metrics)> _update_incoming_block_metrics;
+   std::function<void(producer_plugin::admission_reject_reason)> _increment_admission_rejected_trxs;
+
+   // admission state of accounts, immutable once published by the main thread, read by net and http threads
+   struct admission_snapshot {
+      flat_set<account_name> failure_limited; // accounts over max-failures-per-account
+      fc::time_point         next_reset_time;
+   };
+   mutable std::mutex                        _admission_mtx; // only held to copy or replace the pointer
+   std::shared_ptr<const admission_snapshot> _admission_snapshot;
+
+   void publish_admission_snapshot(uint32_t head_block_num, fc::time_point head_block_time) {
+      auto failure_limited = _account_fails.failure_limited_accounts();
+      {
+         std::lock_guard g(_admission_mtx);
+         if (failure_limited.empty() && !_admission_snapshot)
+            return;
+      }
+      auto snapshot = failure_limited.empty()
+                         ? std::shared_ptr<const admission_snapshot>{}
+                         : std::make_shared<const admission_snapshot>(admission_snapshot{
+                              std::move(failure_limited), _account_fails.next_reset_timepoint(head_block_num, head_block_time)});
+      std::lock_guard g(_admission_mtx);
+      _admission_snapshot = std::move(snapshot);
+   }
+
+   // thread safe
+   fc::exception_ptr admission_check(const packed_transaction_ptr& trx, bool api_trx) const {
+      const chain::controller& chain = chain_plug->chain();
+      const auto& subjective_bill = chain.get_subjective_billing();
+      auto first_auth = trx->get_transaction().first_authorizer();
+      if ((api_trx && _disable_subjective_api_billing) || (!api_trx && _disable_subjective_p2p_billing) ||
+          subjective_bill.is_account_disabled(first_auth))
+         return {};
+
+      std::shared_ptr<const admission_snapshot> snapshot;
+      {
+         std::lock_guard g(_admission_mtx);
+         snapshot = _admission_snapshot;
+      }
+      if (snapshot && snapshot->failure_limited.count(first_auth)) {
+         if (_increment_admission_rejected_trxs)
+            _increment_admission_rejected_trxs(producer_plugin::admission_reject_reason::failure_limit);
+         return std::static_pointer_cast<fc::exception>(std::make_shared<tx_cpu_usage_exceeded>(
+            FC_LOG_MESSAGE(error, "transaction ${id} exceeded failure limit for account ${a} until ${next_reset_time}",
+                           ("id", trx->id())("a", first_auth)("next_reset_time", snapshot->next_reset_time))));
+      }
+      if (subjective_bill.is_account_exhausted(first_auth, fc::time_point::now())) {
+         if (_increment_admission_rejected_trxs)
+            _increment_admission_rejected_trxs(producer_plugin::admission_reject_reason::subjective_bill);
+         return std::static_pointer_cast<fc::exception>(std::make_shared<tx_cpu_usage_exceeded>(
+            FC_LOG_MESSAGE(error, "transaction ${id} rejected, subjective billing of account ${a} exceeds its available cpu",
+                           ("id", trx->id())("a", first_auth))));
+      }
+      return {};
+   }
 
    // ro for read-only
    struct ro_trx_t {
@@ -813,6 +951,19 @@ public:
          return;
       }
 
+      auto is_transient = (trx_type == transaction_metadata::trx_type::read_only || trx_type == transaction_metadata::trx_type::dry_run);
+      if (!is_transient && api_trx) {
+         // reject on this thread, before key recovery, what the main thread would reject; net_plugin has already
+         // done so for p2p transactions before handing them over
+         if (auto except_ptr = admission_check(trx, api_trx)) {
+            fc_dlog(_trx_failed_trace_log, "[TRX_TRACE] Speculative execution is REJECTING tx: ${txid} : ${why}",
+                    ("txid", trx->id())("why", except_ptr->to_string()));
+            next(except_ptr);
+            _transaction_ack_channel.publish(priority::low, std::pair<fc::exception_ptr, packed_transaction_ptr>(except_ptr, trx));
+            return;
+         }
+      }
+
       chain::controller& chain             = chain_plug->chain();
       const auto         max_trx_time_ms   = (trx_type == transaction_metadata::trx_type::read_only) ? -1 : _max_transaction_time_ms.load();
       fc::microseconds   max_trx_cpu_usage = max_trx_time_ms < 0 ? fc::microseconds::maximum() : fc::milliseconds(max_trx_time_ms);
@@ -824,7 +975,6 @@ public:
                                                              trx_type,
                                                              chain.configured_subjective_signature_length_limit());
 
-      auto is_transient = (trx_type == transaction_metadata::trx_type::read_only || trx_type == transaction_metadata::trx_type::dry_run);
       if (!is_transient) {
          next = [this, trx, next{std::move(next)}](const next_function_variant<transaction_trace_ptr>& response) {
             next(response);
@@ -996,6 +1146,7 @@ public:
 
    inline bool should_interrupt_start_block( const fc::time_point& deadline, uint32_t pending_block_num ) const;
    start_block_result start_block();
+   void maybe_write_state_checkpoint( const fc::time_point& deadline );
 
    block_timestamp_type calculate_pending_block_time() const;
    void schedule_delayed_production_loop(const std::weak_ptr<producer_plugin_impl>& weak_this, std::optional<fc::time_point> wake_up_time);
@@ -1066,6 +1217,10 @@ void producer_plugin::set_program_options(
           "Threshold of CPU block production to consider block full; when within threshold of max-block-cpu-usage block can be produced immediately")
          ("max-block-net-usage-threshold-bytes", bpo::value<uint32_t>()->default_value( 1024 ),
           "Threshold of NET block production to consider block full; when within threshold of max-block-net-usage block can be produced immediately")
+         ("production-prepack-lead-ms", bpo::value<uint32_t>()->default_value(0),
+          "Milliseconds before a local producer's block production is due to abort the speculative block and prepare the queued transactions "
+          "against the head block: expired, duplicate and invalid TaPoS transactions are dropped so production starts applying immediately. "
+          "0 disables.")
          ("max-scheduled-transaction-time-per-block-ms", boost::program_options::value<int32_t>()->default_value(100),
           "Maximum wall-clock time, in milliseconds, spent retiring scheduled transactions (and incoming transactions according to incoming-defer-ratio) in any block before returning to normal transaction processing.")
          ("subjective-cpu-leeway-us", boost::program_options::value<int32_t>()->default_value( config::default_subjective_cpu_leeway_us ),
@@ -1080,6 +1235,13 @@ void producer_plugin::set_program_options(
           "ratio between incoming transactions and deferred transactions when both are queued for execution")
          ("incoming-transaction-queue-size-mb", bpo::value<uint16_t>()->default_value( 1024 ),
           "Maximum size (in MiB) of the incoming transaction queue. Exceeding this value will subjectively drop transaction with resource exhaustion.")
+         ("incoming-transaction-ordering", bpo::value<string>()->default_value("arrival"),
+          "Order in which queued incoming transactions are applied:\n"
+          "   \"arrival\" - first come first served\n"
+          "   \"cpu\" - lowest estimated cpu first, estimated from previous attempts and the first authorizer's subjective cpu usage, then arrival")
+         ("priority-account", bpo::value<vector<string>>()->composing()->multitoken(),
+          "Account whose queued incoming transactions are applied before those of other accounts, may be specified multiple times. "
+          "Applies to incoming-transaction-ordering \"cpu\"")
          ("disable-subjective-account-billing", boost::program_options::value<vector<string>>()->composing()->multitoken(),
           "Account which is excluded from subjective CPU billing")
          ("disable-subjective-p2p-billing", bpo::value<bool>()->default_value(true),
@@ -1090,6 +1252,8 @@ void producer_plugin::set_program_options(
           "Number of worker threads in producer thread pool")
          ("snapshots-dir", bpo::value<std::filesystem::path>()->default_value("snapshots"),
           "the location of the snapshots directory (absolute path or relative to application data dir)")
+         ("snapshot-version", bpo::value<uint32_t>()->default_value(ostream_snapshot_writer::default_version),
+          "Binary snapshot format version written, 1 or 2. Version 2 packs rows in blocks and is only read by nodes that support it.")
          ("read-only-threads", bpo::value<uint32_t>(),
           "Number of worker threads in read-only execution thread pool. Max 8.")
          ("read-only-write-window-time-us", bpo::value<uint32_t>()->default_value(my->_ro_write_window_time_us.count()),
@@ -1174,6 +1338,10 @@ void producer_plugin_impl::plugin_initialize(const boost::program_options::varia
 
    _max_scheduled_transaction_time_per_block_ms = options.at("max-scheduled-transaction-time-per-block-ms").as<int32_t>();
 
+   _prepack_lead_us = fc::milliseconds(options.at("production-prepack-lead-ms").as<uint32_t>());
+   EOS_ASSERT(_prepack_lead_us.count() < config::block_interval_us * config::producer_repetitions, plugin_config_exception,
+              "production-prepack-lead-ms ${ms} must be less than a production round", ("ms", _prepack_lead_us.count() / 1000));
+
    if (options.at("subjective-cpu-leeway-us").as<int32_t>() != config::default_subjective_cpu_leeway_us) {
       chain.set_subjective_cpu_leeway(fc::microseconds(options.at("subjective-cpu-leeway-us").as<int32_t>()));
    }
@@ -1196,6 +1364,24 @@ void producer_plugin_impl::plugin_initialize(const boost::program_options::varia
 
    _unapplied_transactions.set_max_transaction_queue_size(max_incoming_transaction_queue_size);
 
+   if (options.count("priority-account")) {
+      for (const auto& a : options.at("priority-account").as<std::vector<std::string>>()) {
+         _priority_accounts.insert(account_name(a));
+      }
+   }
+
+   const auto incoming_ordering = options.at("incoming-transaction-ordering").as<string>();
+   if (incoming_ordering == "cpu") {
+      _unapplied_transactions.set_incoming_priority([this](const transaction_metadata_ptr& trx, trx_enum_type) {
+         return incoming_priority_by_cpu(trx);
+      });
+   } else {
+      EOS_ASSERT(incoming_ordering == "arrival", plugin_config_exception,
+                 "incoming-transaction-ordering ${o} must be \"arrival\" or \"cpu\"", ("o", incoming_ordering));
+      EOS_ASSERT(_priority_accounts.empty(), plugin_config_exception,
+                 "priority-account requires incoming-transaction-ordering \"cpu\"");
+   }
+
    _incoming_defer_ratio = options.at("incoming-defer-ratio").as<double>();
 
    _disable_subjective_p2p_billing = options.at("disable-subjective-p2p-billing").as<bool>();
@@ -1367,9 +1553,15 @@ void producer_plugin_impl::plugin_initialize(const boost::program_options::varia
          chain.get_mutable_subjective_billing().disable_account(account_name(a));
       }
    }
+   // read without synchronization from net and http threads from now on
+   chain.get_mutable_subjective_billing().freeze();
 
    _snapshot_scheduler.set_db_path(_snapshots_dir);
    _snapshot_scheduler.set_snapshots_path(_snapshots_dir);
+   const auto snapshot_version = options.at("snapshot-version").as<uint32_t>();
+   EOS_ASSERT(ostream_snapshot_writer::minimum_version <= snapshot_version && snapshot_version <= ostream_snapshot_writer::current_version,
+              plugin_config_exception, "snapshot-version ${v} is not supported", ("v", snapshot_version));
+   _snapshot_scheduler.set_snapshot_version(snapshot_version);
 }
 
 void producer_plugin::plugin_initialize(const boost::program_options::variables_map& options) {
@@ -1468,6 +1660,7 @@ void producer_plugin::plugin_startup() {
 void producer_plugin_impl::plugin_shutdown() {
    boost::system::error_code ec;
    _timer.cancel(ec);
+   _prepack_timer.cancel(ec);
    _thread_pool.stop();
    _unapplied_transactions.clear();
 
@@ -1599,6 +1792,14 @@ producer_plugin::integrity_hash_information producer_plugin::get_integrity_hash(
    return my->get_integrity_hash();
 }
 
+producer_plugin::sectioned_integrity_hash_information producer_plugin::get_sectioned_integrity_hash() const {
+   return my->get_sectioned_integrity_hash();
+}
+
+producer_plugin::integrity_hash_progress producer_plugin::get_integrity_hash_progress() const {
+   return my->get_integrity_hash_progress();
+}
+
 void producer_plugin::create_snapshot(producer_plugin::next_function<chain::snapshot_scheduler::snapshot_information> next) {
    my->create_snapshot(std::move(next));
 }
@@ -1974,6 +2175,8 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
       const auto start_block_time = block_time.to_time_point() - fc::microseconds(config::block_interval_us);
       if (now < start_block_time) {
          fc_dlog(_log, "Not starting block until ${bt}", ("bt", start_block_time));
+         if (in_producing_mode())
+            maybe_write_state_checkpoint(start_block_time);
          schedule_delayed_production_loop(weak_from_this(), start_block_time);
          return start_block_result::waiting_for_production;
       }
@@ -2063,6 +2266,7 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
       try {
          chain::subjective_billing& subjective_bill = chain.get_mutable_subjective_billing();
          _account_fails.report_and_clear(hbs->block_num, subjective_bill);
+         publish_admission_snapshot(hbs->block_num, hbs->header.timestamp.to_time_point());
 
          if (!remove_expired_trxs(preprocess_deadline))
             return start_block_result::exhausted;
@@ -2168,6 +2372,52 @@ bool producer_plugin_impl::remove_expired_blacklisted_trxs(const fc::time_point&
    return !exhausted;
 }
 
+void producer_plugin_impl::schedule_prepack(const fc::time_point& block_start) {
+   const auto prepack_time = prepack_util::prepack_time(_prepack_lead_us, block_start, fc::time_point::now());
+   if (!prepack_time)
+      return; // disabled, or too late and the speculative block started in the meantime is kept
+
+   static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+   _prepack_timer.expires_at(epoch + boost::posix_time::microseconds(prepack_time->time_since_epoch().count()));
+   _prepack_timer.async_wait(app().executor().wrap(
+      priority::high, exec_queue::read_write,
+      [weak_this = weak_from_this(), block_start, head_id = chain_plug->chain().head_block_id(),
+       cid = ++_prepack_timer_corelation_id](const boost::system::error_code& ec) {
+         auto self = weak_this.lock();
+         if (self && ec != boost::asio::error::operation_aborted && cid == self->_prepack_timer_corelation_id) {
+            // production paused or a new head since scheduling, the slot is not going to be produced on this head
+            if (self->production_disabled_by_policy() || self->chain_plug->chain().head_block_id() != head_id)
+               return;
+            self->prepack_unapplied_trxs(block_start);
+         }
+      }));
+}
+
+// Ahead of block production starting at block_start, drop the queued transactions that would fail against the head
+// block regardless of what the block applies before them, so the start of production is spent applying transactions.
+// The speculative block is aborted here rather than at block_start; its transactions return to the queue.
+void producer_plugin_impl::prepack_unapplied_trxs(const fc::time_point& block_start) {
+   chain::controller& chain = chain_plug->chain();
+   if (in_producing_mode() && chain.is_building_block())
+      return;
+
+   try {
+      const auto start = fc::time_point::now();
+      abort_block();
+
+      const size_t queued = _unapplied_transactions.size();
+      const auto   result = prepack_util::drop_failing_trxs(
+         chain, _unapplied_transactions, block_start,
+         [&]() { return fc::time_point::now() >= block_start; },
+         [this](const transaction_metadata_ptr& trx, const fc::exception_ptr& except_ptr) { log_trx_results(trx, except_ptr); });
+
+      fc_dlog(_log, "Prepacked ${c} of ${n} queued transactions for block production at ${t} in ${us}us, expired ${e}, dropped ${d}",
+              ("c", result.checked)("n", queued)("t", block_start)("us", fc::time_point::now() - start)
+              ("e", result.expired)("d", result.dropped));
+   }
+   LOG_AND_DROP();
+}
+
 // Returns contract name, action name, and exception text of an exception that occurred in a contract
 inline std::string get_detailed_contract_except_info(const packed_transaction_ptr& trx,
                                                      const transaction_trace_ptr&  trace,
@@ -2381,8 +2631,12 @@ producer_plugin_impl::handle_push_result(const transaction_metadata_ptr&
             // this failed our configured maximum transaction time, we don't want to replay it
             fc_tlog(_log, "Failed ${c} trx, auth: ${a}, prev billed: ${p}us, ran: ${r}us, id: ${id}, except: ${e}",
                     ("c", e.code())("a", first_auth)("p", prev_billed_cpu_time_us)("r", end - start)("id", trx->id())("e", e));
-            if (!disable_subjective_enforcement)
+            if (!disable_subjective_enforcement) {
                _account_fails.add(first_auth, e);
+               // failed before executing any action, no cpu left for its subjective bill
+               if (e.code() == tx_cpu_usage_exceeded::code_value && trace->action_traces.empty() && prev_billed_cpu_time_us == 0)
+                  subjective_bill.account_exhausted(first_auth, sub_bill);
+            }
          }
          if (next) {
             if (return_failure_trace) {
@@ -2641,6 +2895,33 @@ bool producer_plugin_impl::block_is_exhausted() const {
    return false;
 }
 
+// A state checkpoint is never written at the start of a produced block as it reads and hashes the whole state file.
+// While waiting for its production round, a due checkpoint is written if the last one took less time than is left.
+void producer_plugin_impl::maybe_write_state_checkpoint(const fc::time_point& deadline) {
+   chain::controller& chain = chain_plug->chain();
+   if (!chain.is_state_checkpoint_due())
+      return;
+
+   const auto start = fc::time_point::now();
+   if (_state_checkpoint_duration && start + *_state_checkpoint_duration > deadline) {
+      fc_dlog(_log, "Not writing state checkpoint, last one took ${d}us", ("d", _state_checkpoint_duration->count()));
+      return;
+   }
+
+   abort_block();
+   try {
+      const auto info = chain.write_state_checkpoint();
+      _state_checkpoint_duration = fc::time_point::now() - start;
+      fc_ilog(_log, "Wrote state checkpoint ${s} at block ${b} in ${d}us",
+              ("s", info.seq)("b", info.head_block_num)("d", _state_checkpoint_duration->count()));
+   } catch (const fc::exception& e) {
+      fc_elog(_log, "unable to write state checkpoint at block ${b}: ${e}", ("b", chain.head_block_num())("e", e.to_detail_string()));
+   } catch (const std::exception& e) {
+      fc_elog(_log, "unable to write state checkpoint at block ${b}: ${e}",
+              ("b", chain.head_block_num())("e", fc::std_exception_wrapper::from_current_exception(e).to_detail_string()));
+   }
+}
+
 // Example:
 // --> Start block A (block time x.500) at time x.000
 // -> start_block()
@@ -2649,6 +2930,7 @@ bool producer_plugin_impl::block_is_exhausted() const {
 // --> Start block B (block time y.000) at time x.500
 void producer_plugin_impl::schedule_production_loop() {
    _timer.cancel();
+   _prepack_timer.cancel();
 
    auto result = start_block();
 
@@ -2749,6 +3031,7 @@ std::optional<fc::time_point> producer_plugin_impl::calculate_producer_wake_up_t
 void producer_plugin_impl::schedule_delayed_production_loop(const std::weak_ptr<producer_plugin_impl>& weak_this,
                                                             std::optional<fc::time_point>              wake_up_time) {
    if (wake_up_time) {
+      schedule_prepack(*wake_up_time);
       fc_dlog(_log, "Scheduling Speculative/Production Change at ${time}", ("time", wake_up_time));
       static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
       _timer.expires_at(epoch + boost::posix_time::microseconds(wake_up_time->time_since_epoch().count()));
@@ -3098,4 +3381,12 @@ void producer_plugin::register_update_incoming_block_metrics(std::function<void(
    my->_update_incoming_block_metrics = std::move(fun);
 }
 
+void producer_plugin::register_increment_admission_rejected_trxs(std::function<void(admission_reject_reason)>&& fun) {
+   my->_increment_admission_rejected_trxs = std::move(fun);
+}
+
+fc::exception_ptr producer_plugin::admission_check(const chain::packed_transaction_ptr& trx, bool api_trx) const {
+   return my->admission_check(trx, api_trx);
+}
+
 } // namespace eosio
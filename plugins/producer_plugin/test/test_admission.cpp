@@ -0,0 +1,160 @@
+#include <boost/test/unit_test.hpp>
+
+#include <eosio/producer_plugin/producer_plugin.hpp>
+
+#include <eosio/testing/tester.hpp>
+
+#include <eosio/chain/contract_types.hpp>
+#include <eosio/chain/transaction_metadata.hpp>
+#include <eosio/chain/trace.hpp>
+#include <eosio/chain/name.hpp>
+
+#include <eosio/chain/application.hpp>
+
+#include "test_utils.hpp"
+
+#include <fc/scoped_exit.hpp>
+
+#include <condition_variable>
+#include <future>
+#include <thread>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::test::detail;
+
+BOOST_AUTO_TEST_SUITE(admission)
+
+// Transactions of an account over subjective-account-max-failures are rejected by admission_check when received over
+// the api, with the exception in next() and on the transaction_ack channel, and never applied. Transactions of other
+// accounts still flow through. p2p transactions are not checked by producer_plugin but still fail on the main thread.
+BOOST_AUTO_TEST_CASE(admission_check_rejects_failure_limited_account) try {
+   fc::temp_directory  temp;
+   appbase::scoped_app app;
+   auto                temp_dir_str = temp.path().string();
+
+   std::mutex                   mtx;
+   std::condition_variable      cv;
+   std::vector<block_state_ptr> blocks;
+   std::map<transaction_id_type, bool> acked; // id -> acked with an exception
+   std::atomic<uint32_t>        failure_limit_rejects = 0;
+   std::optional<boost::signals2::scoped_connection> accepted;
+   plugin_interface::compat::channels::transaction_ack::channel_type::handle ack_subscription;
+
+   std::promise<std::tuple<producer_plugin*, chain_plugin*>> plugin_promise;
+   std::future<std::tuple<producer_plugin*, chain_plugin*>> plugin_fut = plugin_promise.get_future();
+   std::thread app_thread( [&]() {
+      try {
+         std::vector<const char*> argv =
+               {"test", "--data-dir", temp_dir_str.c_str(), "--config-dir", temp_dir_str.c_str(),
+                "-p", "eosio", "-e",
+                "--disable-subjective-api-billing=false", "--disable-subjective-p2p-billing=false",
+                "--subjective-account-max-failures", "1", "--subjective-account-max-failures-window-size", "10000" };
+         app->initialize<chain_plugin, producer_plugin>( argv.size(), (char**) &argv[0] );
+         app->startup();
+         auto prod_plug  = app->find_plugin<producer_plugin>();
+         auto chain_plug = app->find_plugin<chain_plugin>();
+         prod_plug->register_increment_admission_rejected_trxs( [&]( producer_plugin::admission_reject_reason r ) {
+            if( r == producer_plugin::admission_reject_reason::failure_limit )
+               ++failure_limit_rejects;
+         } );
+         accepted.emplace( chain_plug->chain().accepted_block.connect( [&]( const block_state_ptr& bsp ) {
+            std::lock_guard g( mtx );
+            blocks.push_back( bsp );
+            cv.notify_all();
+         } ) );
+         ack_subscription = app->get_channel<plugin_interface::compat::channels::transaction_ack>().subscribe(
+            [&]( const std::pair<fc::exception_ptr, packed_transaction_ptr>& t ) {
+               std::lock_guard g( mtx );
+               acked[t.second->id()] = !!t.first;
+            } );
+         plugin_promise.set_value( {prod_plug, chain_plug} );
+         app->exec();
+         return;
+      } FC_LOG_AND_DROP()
+      BOOST_CHECK(!"app threw exception see logged error");
+   } );
+
+   auto [prod_plug, chain_plug] = plugin_fut.get();
+   const auto chain_id = chain_plug->get_chain_id();
+   auto stop = fc::make_scoped_exit( [&]() {
+      app->quit();
+      app_thread.join();
+   } );
+
+   // head after at least num more blocks
+   auto wait_for_blocks = [&]( size_t num ) {
+      std::unique_lock g( mtx );
+      const size_t n = blocks.size() + num;
+      BOOST_REQUIRE( cv.wait_for( g, std::chrono::seconds( 10 ), [&]() { return blocks.size() >= n; } ) );
+      return blocks.back();
+   };
+   auto push = [&]( const packed_transaction_ptr& trx, bool api_trx, trx_result& r ) {
+      post_trx( app, trx, api_trx, r );
+      BOOST_REQUIRE( wait_until( [&]() { return r.called.load(); }, fc::seconds( 5 ) ) );
+   };
+   auto make_packed_trx = [&]( account_name actor, const auto& act, const block_id_type& ref_block ) {
+      return std::make_shared<packed_transaction>(
+         make_trx( actor, act, ref_block, fc::time_point_sec{fc::time_point::now() + fc::seconds( 60 )}, chain_id ) );
+   };
+   auto in_blocks = [&]( const transaction_id_type& id ) {
+      std::lock_guard g( mtx );
+      for( const auto& bsp : blocks ) {
+         if( contains( bsp->block, id ) )
+            return true;
+      }
+      return false;
+   };
+   auto ack_of = [&]( const transaction_id_type& id ) -> std::optional<bool> {
+      std::lock_guard g( mtx );
+      auto itr = acked.find( id );
+      return itr == acked.end() ? std::optional<bool>{} : itr->second;
+   };
+
+   auto head = wait_for_blocks( 2 );
+   const authority auth( default_key.get_public_key() );
+
+   trx_result created;
+   push( make_packed_trx( config::system_account_name, newaccount{config::system_account_name, "alice"_n, auth, auth}, head->id ),
+         true, created );
+   BOOST_REQUIRE( !created.except_code );
+
+   // alice fails once, which is the limit for the account until the failures window resets
+   trx_result failed;
+   push( make_packed_trx( "alice"_n, newaccount{"alice"_n, config::system_account_name, auth, auth}, head->id ), true, failed );
+   BOOST_REQUIRE( failed.except_code );
+   BOOST_REQUIRE_EQUAL( failure_limit_rejects.load(), 0u );
+
+   // the admission state is published at the start of each block
+   head = wait_for_blocks( 2 );
+
+   trx_result rejected;
+   const auto rejected_trx = make_packed_trx( "alice"_n, testit{1}, head->id );
+   push( rejected_trx, true, rejected );
+   BOOST_TEST( rejected.is_exception );
+   BOOST_TEST( ( rejected.except_code == tx_cpu_usage_exceeded::code_value ) );
+   BOOST_TEST( failure_limit_rejects.load() == 1u );
+
+   trx_result admitted;
+   const auto admitted_trx = make_packed_trx( config::system_account_name, testit{2}, head->id );
+   push( admitted_trx, true, admitted );
+   BOOST_TEST( !admitted.except_code );
+
+   trx_result p2p;
+   const auto p2p_trx = make_packed_trx( "alice"_n, testit{3}, head->id );
+   push( p2p_trx, false, p2p );
+   BOOST_TEST( ( p2p.except_code == tx_cpu_usage_exceeded::code_value ) );
+   BOOST_TEST( failure_limit_rejects.load() == 1u ); // left to net_plugin
+
+   wait_for_blocks( 2 );
+   BOOST_TEST( !in_blocks( rejected_trx->id() ) );
+   BOOST_TEST( !in_blocks( p2p_trx->id() ) );
+   BOOST_TEST( in_blocks( admitted_trx->id() ) );
+
+   // net_plugin only forwards transactions acked without an exception
+   BOOST_TEST( wait_until( [&]() { return ack_of( rejected_trx->id() ) && ack_of( admitted_trx->id() ); }, fc::seconds( 5 ) ) );
+   BOOST_TEST( ( ack_of( rejected_trx->id() ) == true ) );
+   BOOST_TEST( ( ack_of( admitted_trx->id() ) == false ) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
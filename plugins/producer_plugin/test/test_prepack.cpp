@@ -0,0 +1,259 @@
+#include <boost/test/unit_test.hpp>
+
+#include <eosio/producer_plugin/producer_plugin.hpp>
+#include <eosio/producer_plugin/prepack_util.hpp>
+
+#include <eosio/testing/tester.hpp>
+
+#include <eosio/chain/transaction_metadata.hpp>
+#include <eosio/chain/trace.hpp>
+#include <eosio/chain/name.hpp>
+
+#include <eosio/chain/application.hpp>
+
+#include "test_utils.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <future>
+#include <thread>
+
+namespace {
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::test::detail;
+
+constexpr uint32_t prepack_lead_ms = 300;
+
+// Runs a single producer node with prepacking. Between the last block of a production round and the first block of
+// the next one it waits, not speculating, for more than prepack_lead_ms.
+struct prepack_node {
+   fc::temp_directory           temp;
+   appbase::scoped_app          app;
+   std::thread                  app_thread;
+   producer_plugin*             prod_plug  = nullptr;
+   chain_plugin*                chain_plug = nullptr;
+   std::mutex                   mtx;
+   std::condition_variable      cv;
+   std::vector<block_state_ptr> blocks;
+   std::optional<boost::signals2::scoped_connection> accepted;
+   std::promise<void>           started;
+   bool                         signalled  = false;
+
+   prepack_node() {
+      auto temp_dir_str = temp.path().string();
+      auto lead = std::to_string( prepack_lead_ms );
+      app_thread = std::thread( [&]() {
+         try {
+            std::vector<const char*> argv =
+                  {"test", "--data-dir", temp_dir_str.c_str(), "--config-dir", temp_dir_str.c_str(),
+                   "-p", "eosio", "-e", "--disable-subjective-p2p-billing=true",
+                   "--production-prepack-lead-ms", lead.c_str() };
+            app->initialize<chain_plugin, producer_plugin>( argv.size(), (char**) &argv[0] );
+            app->startup();
+            prod_plug  = app->find_plugin<producer_plugin>();
+            chain_plug = app->find_plugin<chain_plugin>();
+            accepted.emplace( chain_plug->chain().accepted_block.connect( [this]( const block_state_ptr& bsp ) {
+               std::lock_guard g( mtx );
+               blocks.push_back( bsp );
+               cv.notify_all();
+            } ) );
+            signalled = true;
+            started.set_value();
+            app->exec();
+            return;
+         } FC_LOG_AND_DROP()
+         BOOST_CHECK(!"app threw exception see logged error");
+         if( !signalled )
+            started.set_value();
+      } );
+      started.get_future().wait();
+      if( !signalled )
+         app_thread.join(); // failed to start, the destructor is not going to run
+      BOOST_REQUIRE( signalled );
+   }
+
+   ~prepack_node() {
+      app->quit();
+      app_thread.join();
+   }
+
+   // the last block of a production round, accepted with at least margin left before prepacking for the next one
+   block_state_ptr wait_for_round_end( fc::microseconds margin ) {
+      std::unique_lock g( mtx );
+      size_t seen = blocks.size();
+      for( int i = 0; i < 3 * config::producer_repetitions; ++i ) {
+         cv.wait_for( g, std::chrono::seconds( 2 ), [&]() { return blocks.size() > seen; } );
+         for( ; seen < blocks.size(); ++seen ) {
+            const auto& bsp = blocks[seen];
+            if( bsp->block->timestamp.slot % config::producer_repetitions == config::producer_repetitions - 1 &&
+                fc::time_point::now() + margin < bsp->block->timestamp.to_time_point() - fc::milliseconds( prepack_lead_ms ) )
+               return bsp;
+         }
+      }
+      return {};
+   }
+
+   // the block produced in slot, waiting for it to be accepted
+   block_state_ptr wait_for_slot( uint32_t slot ) {
+      std::unique_lock g( mtx );
+      block_state_ptr result;
+      cv.wait_for( g, std::chrono::seconds( 5 ), [&]() {
+         for( const auto& bsp : blocks ) {
+            if( bsp->block->timestamp.slot == slot )
+               result = bsp;
+         }
+         return !!result;
+      } );
+      return result;
+   }
+
+   void push( const signed_transaction& trx, trx_result& r ) {
+      post_trx( app, std::make_shared<packed_transaction>( trx ), false, r );
+   }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(prepack)
+
+BOOST_AUTO_TEST_CASE(prepack_time) {
+   const auto block_start = fc::time_point::now() + fc::seconds( 1 );
+   const auto now         = block_start - fc::milliseconds( 500 );
+   BOOST_TEST( !prepack_util::prepack_time( fc::microseconds( 0 ), block_start, now ) );
+   BOOST_TEST( !prepack_util::prepack_time( fc::milliseconds( 500 ), block_start, now ) );
+   BOOST_TEST( !prepack_util::prepack_time( fc::milliseconds( 600 ), block_start, now ) );
+   BOOST_TEST( ( prepack_util::prepack_time( fc::milliseconds( 300 ), block_start, now ) == block_start - fc::milliseconds( 300 ) ) );
+}
+
+// expired, duplicate and TaPoS failing transactions are dropped with their next() called, others are kept
+BOOST_AUTO_TEST_CASE(drop_failing_trxs) try {
+   eosio::testing::tester chain( eosio::testing::setup_policy::none ); // no contract on eosio for testit
+   chain.produce_blocks( 3 );
+   const auto& control     = *chain.control;
+   const auto  chain_id    = control.get_chain_id();
+   const auto  head_id     = control.head_block_id();
+   const auto  block_start = control.head_block_time() + fc::milliseconds( 500 );
+   const auto  expiration  = fc::time_point_sec( control.head_block_time() + fc::seconds( 60 ) );
+   const auto  key         = chain.get_private_key( config::system_account_name, "active" );
+
+   unapplied_transaction_queue queue;
+   auto add = [&]( const signed_transaction& trx, trx_result& r ) {
+      queue.add_incoming( transaction_metadata::create_no_recover_keys( std::make_shared<packed_transaction>( trx ),
+                                                                       transaction_metadata::trx_type::input ),
+                          false, false, record( r ) );
+      return trx.id();
+   };
+
+   trx_result valid, future_ref, expired, duplicate, wrong_head, wrong_older;
+   const auto valid_id      = add( make_trx( head_id, expiration, chain_id, key ), valid );
+   auto       future_trx    = make_trx( head_id, expiration, chain_id, key );
+   future_trx.ref_block_num = static_cast<uint16_t>( control.head_block_num() + 3 ); // past our head, can not tell yet
+   const auto future_id     = add( future_trx, future_ref );
+   add( make_trx( head_id, fc::time_point_sec( control.head_block_time() ), chain_id, key ), expired );
+
+   const auto applied = make_trx( head_id, expiration, chain_id, key );
+   chain.push_transaction( applied );
+   add( applied, duplicate );
+
+   auto head_trx = make_trx( head_id, expiration, chain_id, key );
+   head_trx.ref_block_prefix ^= 1;
+   add( head_trx, wrong_head );
+   auto older_trx = make_trx( head_id, expiration, chain_id, key );
+   older_trx.ref_block_num   = static_cast<uint16_t>( control.head_block_num() - 1 );
+   older_trx.ref_block_prefix = 0;
+   add( older_trx, wrong_older );
+   BOOST_REQUIRE_EQUAL( queue.size(), 6u );
+
+   // nothing is dropped once out of time
+   auto result = prepack_util::drop_failing_trxs( control, queue, block_start, []() { return true; },
+                                                  []( const transaction_metadata_ptr&, const fc::exception_ptr& ) {} );
+   BOOST_TEST( result.dropped == 0u );
+   BOOST_TEST( queue.size() == 6u );
+
+   std::vector<transaction_id_type> reported;
+   result = prepack_util::drop_failing_trxs( control, queue, block_start, []() { return false; },
+                                             [&]( const transaction_metadata_ptr& trx, const fc::exception_ptr& e ) {
+                                                BOOST_TEST( !!e );
+                                                reported.push_back( trx->id() );
+                                             } );
+   BOOST_TEST( result.expired == 1u );
+   BOOST_TEST( result.checked == 5u );
+   BOOST_TEST( result.dropped == 3u );
+   BOOST_TEST( reported.size() == 3u );
+
+   BOOST_TEST( !valid.called );
+   BOOST_TEST( !future_ref.called );
+   BOOST_TEST( !!queue.get_trx( valid_id ) );
+   BOOST_TEST( !!queue.get_trx( future_id ) );
+   BOOST_TEST( queue.size() == 2u );
+
+   BOOST_TEST( ( expired.called && expired.except_code == expired_tx_exception::code_value ) );
+   BOOST_TEST( ( duplicate.called && duplicate.except_code == tx_duplicate::code_value ) );
+   BOOST_TEST( ( wrong_head.called && wrong_head.except_code == invalid_ref_block_exception::code_value ) );
+   BOOST_TEST( ( wrong_older.called && wrong_older.except_code == invalid_ref_block_exception::code_value ) );
+} FC_LOG_AND_RETHROW()
+
+// transactions queued while waiting for our round are prepacked: failing ones are dropped before the round starts
+// and the rest are the ones included in its first block
+BOOST_AUTO_TEST_CASE(prepacked_trxs_included_at_block_start) try {
+   prepack_node node;
+   const auto   chain_id = node.chain_plug->get_chain_id();
+
+   const auto last = node.wait_for_round_end( fc::milliseconds( 200 ) );
+   BOOST_REQUIRE( last );
+   const auto block_start = last->block->timestamp.to_time_point();
+   const auto expiration  = fc::time_point_sec( block_start + fc::seconds( 60 ) );
+
+   std::array<trx_result, 3>        valid;
+   std::vector<transaction_id_type> valid_ids;
+   for( auto& r : valid ) {
+      auto trx = make_trx( last->id, expiration, chain_id );
+      valid_ids.push_back( trx.id() );
+      node.push( trx, r );
+   }
+   trx_result wrong_ref;
+   auto       wrong_ref_trx = make_trx( last->id, expiration, chain_id );
+   wrong_ref_trx.ref_block_prefix ^= 1;
+   node.push( wrong_ref_trx, wrong_ref );
+
+   BOOST_REQUIRE( wait_until( [&]() { return wrong_ref.called.load(); }, fc::seconds( 5 ) ) );
+   BOOST_TEST( ( wrong_ref.except_code == invalid_ref_block_exception::code_value ) );
+   BOOST_TEST( wrong_ref.time < block_start );
+
+   const auto first = node.wait_for_slot( last->block->timestamp.slot + 1 );
+   BOOST_REQUIRE( first );
+   for( size_t i = 0; i < valid.size(); ++i ) {
+      BOOST_TEST( wait_until( [&]() { return valid[i].called.load(); }, fc::seconds( 1 ) ) );
+      BOOST_TEST( !valid[i].except_code );
+      BOOST_TEST( contains( first->block, valid_ids[i] ) );
+   }
+   BOOST_TEST( !contains( first->block, wrong_ref_trx.id() ) );
+} FC_LOG_AND_RETHROW()
+
+// a prepack scheduled for a slot that production is paused for does not run
+BOOST_AUTO_TEST_CASE(prepack_cancelled_when_paused) try {
+   prepack_node node;
+   const auto   chain_id = node.chain_plug->get_chain_id();
+
+   const auto last = node.wait_for_round_end( fc::milliseconds( 200 ) );
+   BOOST_REQUIRE( last );
+   const auto block_start = last->block->timestamp.to_time_point();
+
+   std::promise<void> paused;
+   node.app->post( priority::high, [&]() { node.prod_plug->pause(); paused.set_value(); } );
+   paused.get_future().wait();
+
+   trx_result wrong_ref;
+   auto       wrong_ref_trx = make_trx( last->id, fc::time_point_sec( block_start + fc::seconds( 60 ) ), chain_id );
+   wrong_ref_trx.ref_block_prefix ^= 1;
+   node.push( wrong_ref_trx, wrong_ref );
+
+   // prepacking would have dropped it by block_start - prepack_lead_ms
+   std::this_thread::sleep_until( std::chrono::system_clock::time_point(
+      std::chrono::microseconds( ( block_start - fc::milliseconds( prepack_lead_ms / 3 ) ).time_since_epoch().count() ) ) );
+   BOOST_TEST( !wrong_ref.called );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
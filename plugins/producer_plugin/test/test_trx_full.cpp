@@ -12,24 +12,7 @@
 
 #include <eosio/chain/application.hpp>
 
-namespace eosio::test::detail {
-using namespace eosio::chain::literals;
-struct testit {
-   uint64_t      id;
-
-   testit( uint64_t id = 0 )
-         :id(id){}
-
-   static account_name get_account() {
-      return chain::config::system_account_name;
-   }
-
-   static action_name get_name() {
-      return "testit"_n;
-   }
-};
-}
-FC_REFLECT( eosio::test::detail::testit, (id) )
+#include "test_utils.hpp"
 
 namespace {
 
@@ -60,8 +43,7 @@ auto make_unique_trx( const chain_id_type& chain_id ) {
       auto bad_priv_key = private_key_type::regenerate<fc::ecc::private_key_shim>(fc::sha256::hash(std::string("kevin")));
       trx.sign( bad_priv_key, chain_id );
    } else {
-      auto priv_key = private_key_type::regenerate<fc::ecc::private_key_shim>(fc::sha256::hash(std::string("nathan")));
-      trx.sign( priv_key, chain_id );
+      trx.sign( default_key, chain_id );
    }
 
    return std::make_shared<packed_transaction>( std::move(trx) );
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <eosio/producer_plugin/producer_plugin.hpp>
+
+#include <eosio/chain/application.hpp>
+#include <eosio/chain/name.hpp>
+#include <eosio/chain/trace.hpp>
+#include <eosio/chain/transaction_metadata.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <thread>
+
+// Fixtures shared by the producer_plugin tests, which run a node without any contract on eosio
+namespace eosio::test::detail {
+using namespace eosio::chain::literals;
+
+// an action of eosio, which succeeds as eosio has no contract, made unique by its id
+struct testit {
+   uint64_t      id;
+
+   testit( uint64_t id = 0 )
+         :id(id){}
+
+   static chain::account_name get_account() {
+      return chain::config::system_account_name;
+   }
+
+   static chain::action_name get_name() {
+      return "testit"_n;
+   }
+};
+
+}
+FC_REFLECT( eosio::test::detail::testit, (id) )
+
+namespace eosio::test::detail {
+
+// key of eosio and of the accounts created by the tests
+inline const chain::private_key_type default_key =
+   chain::private_key_type::regenerate<fc::ecc::private_key_shim>( fc::sha256::hash( std::string( "nathan" ) ) );
+
+template<typename Action>
+chain::signed_transaction make_trx( chain::account_name actor, const Action& act, const chain::block_id_type& ref_block,
+                                    const fc::time_point_sec& expiration, const chain::chain_id_type& chain_id,
+                                    const chain::private_key_type& key = default_key ) {
+   chain::signed_transaction trx;
+   trx.expiration = expiration;
+   trx.set_reference_block( ref_block );
+   trx.actions.emplace_back( std::vector<chain::permission_level>{{actor, chain::config::active_name}}, act );
+   trx.sign( key, chain_id );
+   return trx;
+}
+
+// a unique transaction of eosio
+inline chain::signed_transaction make_trx( const chain::block_id_type& ref_block, const fc::time_point_sec& expiration,
+                                           const chain::chain_id_type& chain_id,
+                                           const chain::private_key_type& key = default_key ) {
+   static std::atomic<uint64_t> nextid = 0;
+   return make_trx( chain::config::system_account_name, testit{++nextid}, ref_block, expiration, chain_id, key );
+}
+
+struct trx_result {
+   std::atomic<bool>      called = false;
+   fc::time_point         time;
+   bool                   is_exception = false; // next() called with an exception rather than a trace
+   std::optional<int64_t> except_code;          // of a dropped or failed transaction
+};
+
+inline chain::next_function<chain::transaction_trace_ptr> record( trx_result& r ) {
+   return [&r]( const chain::next_function_variant<chain::transaction_trace_ptr>& result ) {
+      r.time = fc::time_point::now();
+      if( std::holds_alternative<fc::exception_ptr>( result ) ) {
+         r.is_exception = true;
+         r.except_code  = std::get<fc::exception_ptr>( result )->code();
+      } else if( std::get<chain::transaction_trace_ptr>( result )->except ) {
+         r.except_code = std::get<chain::transaction_trace_ptr>( result )->except->code();
+      }
+      r.called = true;
+   };
+}
+
+// push trx to the producer_plugin of app as received over the api or p2p, its result recorded in r
+inline void post_trx( appbase::scoped_app& app, const chain::packed_transaction_ptr& trx, bool api_trx, trx_result& r ) {
+   app->post( priority::low, [&app, trx, api_trx, next = record( r )]() {
+      app->get_method<chain::plugin_interface::incoming::methods::transaction_async>()(
+         trx, api_trx, chain::transaction_metadata::trx_type::input, false, next );
+   } );
+}
+
+inline bool wait_until( const std::function<bool()>& f, fc::microseconds timeout ) {
+   const auto until = fc::time_point::now() + timeout;
+   while( !f() && fc::time_point::now() < until )
+      std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+   return f();
+}
+
+inline bool contains( const chain::signed_block_ptr& block, const chain::transaction_id_type& id ) {
+   for( const auto& receipt : block->transactions ) {
+      if( std::get<chain::packed_transaction>( receipt.trx ).id() == id )
+         return true;
+   }
+   return false;
+}
+
+} // namespace eosio::test::detail
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <eosio/chain/action_profiler.hpp>
 #include <eosio/http_plugin/http_plugin.hpp>
 #include <eosio/net_plugin/net_plugin.hpp>
 #include <eosio/producer_plugin/producer_plugin.hpp>
+#include <eosio/state_history_plugin/state_history_plugin.hpp>
 
 #include <prometheus/counter.h>
 #include <prometheus/registry.h>
@@ -48,6 +50,11 @@ struct catalog_type {
    Gauge& last_irreversible;
    Gauge& head_block_num;
 
+   // transactions rejected by admission control on net and http threads
+   prometheus::Family<Counter>& admission_rejected_trxs;
+   Counter& admission_rejected_failure_limit;
+   Counter& admission_rejected_subjective_bill;
+
    // produced blocks
    Counter& unapplied_transactions_total;
    Counter& blacklisted_transactions_total;
@@ -64,10 +71,35 @@ struct catalog_type {
    Counter& net_usage_us_incoming_block;
    Counter& blocks_incoming;
 
+   // state history scrubber, labeled by log
+   prometheus::Family<Gauge>& ship_scrub_passes;
+   prometheus::Family<Gauge>& ship_scrub_entries_verified;
+   prometheus::Family<Gauge>& ship_scrub_bytes_read;
+   prometheus::Family<Gauge>& ship_scrub_problems_found;
+   prometheus::Family<Gauge>& ship_scrub_last_pass_problems;
+
    // prometheus exporter
    Counter& bytes_transferred;
    Counter& num_scrapes;
 
+   // action profiler, top-k (receiver, action) by wall time, only populated when enabled
+   chain::action_profiler*      action_profiler = nullptr;
+   uint32_t                     action_profile_top_k = 0;
+   prometheus::Family<Gauge>&   action_executions;
+   prometheus::Family<Gauge>&   action_wall_time_us;
+   prometheus::Family<Gauge>&   action_cpu_billed_us;
+   prometheus::Family<Gauge>&   action_ram_delta_bytes;
+   prometheus::Family<Gauge>&   action_db_calls;
+
+   struct action_series_type {
+      Gauge* executions;
+      Gauge* wall_time_us;
+      Gauge* cpu_billed_us;
+      Gauge* ram_delta_bytes;
+      Gauge* db_calls;
+   };
+   std::map<std::pair<chain::name, chain::name>, action_series_type> action_series;
+
 
    catalog_type()
        : http_request_counts(family<Counter>("http_requests_total", "number of HTTP requests"))
@@ -81,6 +113,10 @@ struct catalog_type {
        , net_usage_us(family<Counter>("net_usage_us_total", "total net usage in microseconds for blocks"))
        , last_irreversible(build<Gauge>("last_irreversible", "last irreversible block number"))
        , head_block_num(build<Gauge>("head_block_num", "head block number"))
+       , admission_rejected_trxs(family<Counter>("admission_rejected_trxs_total",
+                                                 "total number of transactions rejected before reaching the main thread"))
+       , admission_rejected_failure_limit(admission_rejected_trxs.Add({{"reason", "failure_limit"}}))
+       , admission_rejected_subjective_bill(admission_rejected_trxs.Add({{"reason", "subjective_bill"}}))
        , unapplied_transactions_total(build<Counter>("unapplied_transactions_total",
                                                      "total number of unapplied transactions from produced blocks"))
        , blacklisted_transactions_total(build<Counter>("blacklisted_transactions_total",
@@ -97,11 +133,61 @@ struct catalog_type {
        , cpu_usage_us_incoming_block(cpu_usage_us.Add({{"block_type", "incoming"}}))
        , net_usage_us_incoming_block(net_usage_us.Add({{"block_type", "incoming"}}))
        , blocks_incoming(build<Counter>("blocks_incoming", "number of incoming blocks"))
+       , ship_scrub_passes(family<Gauge>("ship_scrub_passes", "number of completed passes over a state history log"))
+       , ship_scrub_entries_verified(family<Gauge>("ship_scrub_entries_verified", "number of state history log entries verified"))
+       , ship_scrub_bytes_read(family<Gauge>("ship_scrub_bytes_read", "number of bytes read verifying a state history log"))
+       , ship_scrub_problems_found(family<Gauge>("ship_scrub_problems_found", "number of problems found in a state history log"))
+       , ship_scrub_last_pass_problems(family<Gauge>("ship_scrub_last_pass_problems",
+                                                     "number of problems found by the last pass over a state history log"))
        , bytes_transferred(build<Counter>("exposer_transferred_bytes_total",
                                           "total number of bytes for responses to prometheus scape requests"))
-       , num_scrapes(build<Counter>("exposer_scrapes_total", "total number of prometheus scape requests received")) {}
+       , num_scrapes(build<Counter>("exposer_scrapes_total", "total number of prometheus scape requests received"))
+       , action_executions(family<Gauge>("action_executions", "number of executions of the top actions by wall time"))
+       , action_wall_time_us(family<Gauge>("action_wall_time_us", "wall time in microseconds of the top actions by wall time"))
+       , action_cpu_billed_us(family<Gauge>("action_cpu_billed_us",
+                                            "billed cpu in microseconds attributed to the top actions by wall time"))
+       , action_ram_delta_bytes(family<Gauge>("action_ram_delta_bytes", "ram delta in bytes of the top actions by wall time"))
+       , action_db_calls(family<Gauge>("action_db_calls", "database intrinsic calls of the top actions by wall time")) {}
+
+   void update_action_profile() {
+      if (!action_profiler)
+         return;
+
+      std::map<std::pair<chain::name, chain::name>, action_series_type> current;
+      for (const auto& e : action_profiler->top(action_profile_top_k)) {
+         auto key = std::make_pair(e.receiver, e.action);
+         auto itr = action_series.find(key);
+         action_series_type series;
+         if (itr != action_series.end()) {
+            series = itr->second;
+            action_series.erase(itr);
+         } else {
+            const std::map<std::string, std::string> labels{{"receiver", e.receiver.to_string()}, {"action", e.action.to_string()}};
+            series = action_series_type{&action_executions.Add(labels), &action_wall_time_us.Add(labels),
+                                        &action_cpu_billed_us.Add(labels), &action_ram_delta_bytes.Add(labels),
+                                        &action_db_calls.Add(labels)};
+         }
+         series.executions->Set(e.totals.count);
+         series.wall_time_us->Set(e.totals.wall_time_us);
+         series.cpu_billed_us->Set(e.totals.cpu_billed_us);
+         series.ram_delta_bytes->Set(e.totals.ram_delta);
+         series.db_calls->Set(e.totals.db_calls);
+         current.emplace(key, series);
+      }
+
+      // drop the series of actions no longer in the top-k
+      for (const auto& [key, series] : action_series) {
+         action_executions.Remove(series.executions);
+         action_wall_time_us.Remove(series.wall_time_us);
+         action_cpu_billed_us.Remove(series.cpu_billed_us);
+         action_ram_delta_bytes.Remove(series.ram_delta_bytes);
+         action_db_calls.Remove(series.db_calls);
+      }
+      action_series = std::move(current);
+   }
 
    std::string report() {
+      update_action_profile();
       const prometheus::TextSerializer serializer;
       auto                             result = serializer.Serialize(registry.Collect());
       bytes_transferred.Increment(result.size());
@@ -142,6 +228,24 @@ struct catalog_type {
       head_block_num.Set(metrics.head_block_num);
    }
 
+   void update(const state_history_plugin::scrub_metrics& metrics) {
+      const std::map<std::string, std::string> labels{{"log", metrics.log}};
+      ship_scrub_passes.Add(labels).Set(metrics.status.passes_completed);
+      ship_scrub_entries_verified.Add(labels).Set(metrics.status.entries_verified);
+      ship_scrub_bytes_read.Add(labels).Set(metrics.status.bytes_read);
+      ship_scrub_problems_found.Add(labels).Set(metrics.status.problems_found);
+      ship_scrub_last_pass_problems.Add(labels).Set(metrics.status.last_pass_problems);
+   }
+
+   // state_history_plugin is optional, called once every plugin is registered
+   void register_state_history_update_handlers(boost::asio::io_context::strand& strand) {
+      if (auto ship = app().find_plugin<state_history_plugin>()) {
+         ship->register_update_scrub_metrics([&strand, this](state_history_plugin::scrub_metrics metrics) {
+            strand.post([metrics = std::move(metrics), this]() { update(metrics); });
+         });
+      }
+   }
+
    void register_update_handlers(boost::asio::io_context::strand& strand) {
       auto& http = app().get_plugin<http_plugin>();
       http.register_update_metrics(
@@ -171,6 +275,13 @@ struct catalog_type {
           [&strand, this](const producer_plugin::incoming_block_metrics& metrics) {
              strand.post([metrics, this]() { update(metrics); });
           });
+      producer.register_increment_admission_rejected_trxs([this](producer_plugin::admission_reject_reason reason) {
+         // Increment is thread safe
+         if (reason == producer_plugin::admission_reject_reason::failure_limit)
+            admission_rejected_failure_limit.Increment(1);
+         else
+            admission_rejected_subjective_bill.Increment(1);
+      });
    }
 };
 
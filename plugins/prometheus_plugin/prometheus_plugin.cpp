@@ -1,10 +1,12 @@
 #include <eosio/prometheus_plugin/prometheus_plugin.hpp>
 
+#include <eosio/chain/action_profiler.hpp>
 #include <eosio/chain/plugin_interface.hpp>
 #include <eosio/chain/thread_utils.hpp>
 #include <eosio/http_plugin/macros.hpp>
 #include <eosio/net_plugin/net_plugin.hpp>
 #include <eosio/http_plugin/http_plugin.hpp>
+#include <eosio/chain_plugin/chain_plugin.hpp>
 #include <eosio/producer_plugin/producer_plugin.hpp>
 
 #include <fc/log/logger.hpp>
@@ -23,6 +25,7 @@ namespace eosio {
       boost::asio::io_context::strand              _prometheus_strand;
       metrics::catalog_type                        _catalog;
       fc::microseconds                             _max_response_time_us;
+      std::optional<chain::action_profiler>        _action_profiler;
 
       prometheus_plugin_impl(): _prometheus_strand(_prometheus_thread_pool.get_executor()){ 
          _catalog.register_update_handlers(_prometheus_strand);
@@ -38,7 +41,10 @@ namespace eosio {
    void prometheus_plugin::set_program_options(options_description&, options_description& cfg) {
       cfg.add_options()
          ("prometheus-exporter-address", bpo::value<string>()->default_value("127.0.0.1:9101"),
-            "The local IP and port to listen for incoming prometheus metrics http request.");
+            "The local IP and port to listen for incoming prometheus metrics http request.")
+         ("prometheus-action-profile-top-k", bpo::value<uint32_t>()->default_value(0),
+            "Profile the wall time, attributed billed cpu, ram delta and database intrinsic calls of executed actions "
+            "per (receiver, action) and export the top K by wall time. 0 disables profiling.");
    }
 
    struct prometheus_api_handle {
@@ -62,6 +68,20 @@ namespace eosio {
       auto& _http_plugin = app().get_plugin<http_plugin>();
       my->_max_response_time_us = _http_plugin.get_max_response_time();
 
+      if (auto top_k = options.at("prometheus-action-profile-top-k").as<uint32_t>(); top_k > 0) {
+         // chain_plugin is only needed to profile actions, initialized here so its controller exists
+         auto* chain_plug = app().find_plugin<chain_plugin>();
+         EOS_ASSERT(chain_plug, chain::plugin_config_exception, "prometheus-action-profile-top-k requires chain_plugin");
+         chain_plug->initialize(options);
+         my->_action_profiler.emplace();
+         // set before the controller executes any action, top-k is only read on the prometheus strand
+         my->_catalog.action_profile_top_k = top_k;
+         my->_catalog.action_profiler = &*my->_action_profiler;
+         chain_plug->chain().enable_action_profiler(&*my->_action_profiler);
+      }
+
+      my->_catalog.register_state_history_update_handlers(my->_prometheus_strand);
+
       prometheus_api_handle handle{my.get()};
       app().get_plugin<http_plugin>().add_async_api({
         CALL_ASYNC_WITH_400(prometheus, prometheus, handle, eosio, metrics, std::string, 200, http_params_types::no_params)}
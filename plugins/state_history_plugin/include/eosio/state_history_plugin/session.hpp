@@ -145,6 +145,28 @@ public:
    }
 };
 
+template <typename Session>
+class scrub_status_result_send_queue_entry : public send_queue_entry_base {
+   std::shared_ptr<Session> session;
+   std::vector<char> data;
+
+public:
+
+   explicit scrub_status_result_send_queue_entry(std::shared_ptr<Session> s)
+   : session(std::move(s)) {};
+
+   void send_entry() override {
+      data = fc::raw::pack(state_history::state_result{session->get_scrub_status_result()});
+
+      session->socket_stream->async_write(boost::asio::buffer(data),
+                                   [s{session}](boost::system::error_code ec, size_t) {
+                                      s->callback(ec, true, "async_write", [s] {
+                                         s->session_mgr.pop_entry();
+                                      });
+                                   });
+   }
+};
+
 template <typename Session>
 class blocks_ack_request_send_queue_entry : public send_queue_entry_base {
    std::shared_ptr<Session> session;
@@ -301,6 +323,7 @@ private:
 
    friend class blocks_result_send_queue_entry<session>;
    friend class status_result_send_queue_entry<session>;
+   friend class scrub_status_result_send_queue_entry<session>;
    friend class blocks_ack_request_send_queue_entry<session>;
    friend class blocks_request_send_queue_entry<session>;
 
@@ -402,6 +425,14 @@ private:
       session_mgr.add_send_queue(std::move(self), std::move(entry_ptr));
    }
 
+   void process(state_history::get_scrub_status_request_v0&) {
+      fc_dlog(plugin.get_logger(), "received get_scrub_status_request_v0");
+
+      auto self = this->shared_from_this();
+      auto entry_ptr = std::make_unique<scrub_status_result_send_queue_entry<session>>(self);
+      session_mgr.add_send_queue(std::move(self), std::move(entry_ptr));
+   }
+
    void process(state_history::get_blocks_request_v0& req) {
       fc_dlog(plugin.get_logger(), "received get_blocks_request_v0 = ${req}", ("req", req));
 
@@ -445,6 +476,15 @@ private:
       return result;
    }
 
+   state_history::get_scrub_status_result_v0 get_scrub_status_result() {
+      state_history::get_scrub_status_result_v0 result;
+      if (auto&& trace_log = plugin.get_trace_log())
+         result.trace = trace_log->get_scrub_status();
+      if (auto&& chain_state_log = plugin.get_chain_state_log())
+         result.chain_state = chain_state_log->get_scrub_status();
+      return result;
+   }
+
    void update_current_request(state_history::get_blocks_request_v0& req) {
       fc_dlog(plugin.get_logger(), "replying get_blocks_request_v0 = ${req}", ("req", req));
       to_send_block_num = std::max(req.start_block_num, plugin.get_first_available_block_num());
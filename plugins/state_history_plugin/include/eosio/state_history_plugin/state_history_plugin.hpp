@@ -29,6 +29,13 @@ class state_history_plugin : public plugin<state_history_plugin> {
 
    void handle_sighup() override;
 
+   struct scrub_metrics {
+      std::string                 log; // trace_history or chain_state_history
+      state_history::scrub_status status;
+   };
+   // called from the scrub threads after each problem found and each pass over a log
+   void register_update_scrub_metrics(std::function<void(scrub_metrics)>&&);
+
    const state_history_log* trace_log() const;
    const state_history_log* chain_state_log() const;
 
@@ -71,6 +71,9 @@ private:
 
    named_thread_pool<struct ship> thread_pool;
 
+   std::optional<state_history::scrub_config>               scrub_conf;
+   std::function<void(state_history_plugin::scrub_metrics)> update_scrub_metrics;
+
    bool  plugin_started = false;
 
 public:
@@ -78,6 +81,9 @@ public:
    void plugin_startup();
    void plugin_shutdown();
    session_manager& get_session_manager() { return session_mgr; }
+   void register_update_scrub_metrics(std::function<void(state_history_plugin::scrub_metrics)>&& fun) {
+      update_scrub_metrics = std::move(fun);
+   }
 
    static fc::logger& get_logger() { return _log; }
 
@@ -298,6 +304,11 @@ void state_history_plugin::set_program_options(options_description& cli, options
           "the maximum number of history file groups to retain so that the blocks in those files can be queried.\n"
           "When the number is reached, the oldest history file would be moved to archive dir or deleted if the archive dir is empty.\n"
           "The retained history log files should not be manipulated by users." );
+   options("state-history-cold-dir", bpo::value<std::filesystem::path>(),
+           "the location of the state history cold directory (absolute path or relative to state-history dir).\n"
+           "When set, history files beyond max-retained-history-files are recompressed into this directory in the background\n"
+           "instead of being moved to the archive dir or deleted, and the blocks in those files can still be queried.\n"
+           "The cold history files should not be manipulated by users.");
    cli.add_options()("delete-state-history", bpo::bool_switch()->default_value(false), "clear state history files");
    options("trace-history", bpo::bool_switch()->default_value(false), "enable trace history");
    options("chain-state-history", bpo::bool_switch()->default_value(false), "enable chain state history");
@@ -307,6 +318,12 @@ void state_history_plugin::set_program_options(options_description& cli, options
    options("state-history-unix-socket-path", bpo::value<string>(),
            "the path (relative to data-dir) to create a unix socket upon which to listen for incoming connections.");
    options("trace-history-debug-mode", bpo::bool_switch()->default_value(false), "enable debug mode for trace history");
+   options("state-history-scrub-interval-sec", bpo::value<uint32_t>(),
+           "when set, verify the state history files in the background, starting a pass over them this many seconds after the end of the previous one.\n"
+           "The position, header, payload size and compressed payload of each entry are checked, and the block id of irreversible blocks\n"
+           "against the block log. Problems are logged, and reported by get_scrub_status_request_v0 and through prometheus_plugin.");
+   options("state-history-scrub-max-bytes-per-sec", bpo::value<uint64_t>()->default_value(8*1024*1024),
+           "the maximum number of bytes per second read when verifying the state history files, 0 for no limit");
 
    if(cfile::supports_hole_punching())
       options("state-history-log-retain-blocks", bpo::value<uint32_t>(), "if set, periodically prune the state history files to store only configured number of most recent blocks");
@@ -359,7 +376,8 @@ void state_history_plugin_impl::plugin_initialize(const variables_map& options)
 
       bool has_state_history_partition_options =
           options.count("state-history-retained-dir") || options.count("state-history-archive-dir") ||
-          options.count("state-history-stride") || options.count("max-retained-history-files");
+          options.count("state-history-stride") || options.count("max-retained-history-files") ||
+          options.count("state-history-cold-dir");
 
       state_history_log_config ship_log_conf;
       if (options.count("state-history-log-retain-blocks")) {
@@ -369,7 +387,7 @@ void state_history_plugin_impl::plugin_initialize(const variables_map& options)
          // before getting pruned out. ideally pruning would have been smart enough to know not to prune reversible blocks
          EOS_ASSERT(ship_log_prune_conf.prune_blocks >= 1000, plugin_exception, "state-history-log-retain-blocks must be 1000 blocks or greater");
          EOS_ASSERT(!has_state_history_partition_options, plugin_exception, "state-history-log-retain-blocks cannot be used together with state-history-retained-dir,"
-                  " state-history-archive-dir, state-history-stride or max-retained-history-files");
+                  " state-history-archive-dir, state-history-stride, max-retained-history-files or state-history-cold-dir");
       } else if (has_state_history_partition_options){
          auto& config  = ship_log_conf.emplace<state_history::partition_config>();
          if (options.count("state-history-retained-dir"))
@@ -380,6 +398,14 @@ void state_history_plugin_impl::plugin_initialize(const variables_map& options)
             config.stride             = options.at("state-history-stride").as<uint32_t>();
          if (options.count("max-retained-history-files"))
             config.max_retained_files = options.at("max-retained-history-files").as<uint32_t>();
+         if (options.count("state-history-cold-dir"))
+            config.cold_dir           = options.at("state-history-cold-dir").as<std::filesystem::path>();
+      }
+
+      if (options.count("state-history-scrub-interval-sec")) {
+         scrub_conf.emplace();
+         scrub_conf->interval_sec      = options.at("state-history-scrub-interval-sec").as<uint32_t>();
+         scrub_conf->max_bytes_per_sec = options.at("state-history-scrub-max-bytes-per-sec").as<uint64_t>();
       }
 
       if (options.at("trace-history").as<bool>())
@@ -417,6 +443,28 @@ void state_history_plugin_impl::plugin_startup() {
             first_available_block = std::min( first_available_block, first_state_block );
       }
       fc_ilog(_log, "First available block for SHiP ${b}", ("b", first_available_block));
+      if (scrub_conf) {
+         // called from the scrub threads
+         auto irreversible_block_id = [this](uint32_t block_num) -> std::optional<block_id_type> {
+            if (block_num > get_last_irreversible().block_num)
+               return {};
+            try {
+               return chain_plug->chain().get_block_id_for_num(block_num);
+            } catch (...) {
+            }
+            return {};
+         };
+         auto start_scrub = [&](std::optional<state_history_log>& log, const char* log_name) {
+            if (!log)
+               return;
+            log->start_scrub(*scrub_conf, irreversible_block_id, [this, log_name](const state_history::scrub_status& status) {
+               if (update_scrub_metrics)
+                  update_scrub_metrics(state_history_plugin::scrub_metrics{log_name, status});
+            });
+         };
+         start_scrub(trace_log, "trace_history");
+         start_scrub(chain_state_log, "chain_state_history");
+      }
       listen();
       // use of executor assumes only one thread
       thread_pool.start( 1, [](const fc::exception& e) {
@@ -437,6 +485,10 @@ void state_history_plugin_impl::plugin_shutdown() {
    applied_transaction_connection.reset();
    accepted_block_connection.reset();
    block_start_connection.reset();
+   if (trace_log)
+      trace_log->stop_scrub();
+   if (chain_state_log)
+      chain_state_log->stop_scrub();
    thread_pool.stop();
 }
 
@@ -448,6 +500,10 @@ void state_history_plugin::handle_sighup() {
    fc::logger::update(logger_name, _log);
 }
 
+void state_history_plugin::register_update_scrub_metrics(std::function<void(scrub_metrics)>&& fun) {
+   my->register_update_scrub_metrics(std::move(fun));
+}
+
 const state_history_log* state_history_plugin::trace_log() const {
    const auto& log = my->get_trace_log();
    return log ? std::addressof(*log) : nullptr;
@@ -20,6 +20,7 @@ BOOST_AUTO_TEST_CASE(state_history_plugin_default_tests) {
    auto* config = std::get_if<eosio::state_history::partition_config>(&plugin.trace_log()->config());
    BOOST_REQUIRE(config);
    BOOST_CHECK_EQUAL(config->max_retained_files, UINT32_MAX);
+   BOOST_CHECK(config->cold_dir.empty());
 }
 
 BOOST_AUTO_TEST_CASE(state_history_plugin_retain_blocks_tests) {
@@ -2,6 +2,9 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace {
    using seek_point_entry = std::tuple<uint64_t, uint64_t>;
    constexpr size_t expected_seek_point_entry_size = 16;
@@ -31,7 +34,8 @@ struct compressed_file_impl {
       }
    }
 
-   void read( char* d, size_t n, fc::cfile& file )
+   template<typename File>
+   void read( char* d, size_t n, File& file )
    {
       if (!initialized) {
          if (Z_OK != inflateInit2(&strm, raw_zlib_window_bits)) {
@@ -109,26 +113,48 @@ struct compressed_file_impl {
       }
    }
 
-   void seek( uint64_t loc, fc::cfile& file ) {
-      if (initialized) {
-         inflateEnd(&strm);
-         initialized = false;
-      }
-
-      auto remaining = loc;
-
-      // read in the seek point map
+   static std::vector<seek_point_entry> read_seek_point_map( fc::cfile& file ) {
       file.seek_end(-expected_seek_point_count_size);
       seek_point_count_type seek_point_count = 0;
       file.read(reinterpret_cast<char*>(&seek_point_count), sizeof(seek_point_count));
 
+      std::vector<seek_point_entry> seek_point_map(seek_point_count);
       if (seek_point_count > 0) {
          int seek_map_size = sizeof(seek_point_entry) * seek_point_count;
          file.seek_end(-expected_seek_point_count_size - seek_map_size);
-
-         std::vector<seek_point_entry> seek_point_map(seek_point_count);
          file.read(reinterpret_cast<char*>(seek_point_map.data()), seek_point_map.size() * sizeof(seek_point_entry));
+      }
+      return seek_point_map;
+   }
 
+   static std::vector<seek_point_entry> read_seek_point_map( const pread_file& file, uint64_t file_size ) {
+      if (file_size < expected_seek_point_count_size) {
+         throw compressed_file_error("Compressed file is too small to hold a seek point map: " + file.get_file_path().generic_string());
+      }
+      seek_point_count_type seek_point_count = 0;
+      file.read_at(file_size - expected_seek_point_count_size, reinterpret_cast<char*>(&seek_point_count), sizeof(seek_point_count));
+
+      std::vector<seek_point_entry> seek_point_map(seek_point_count);
+      const uint64_t seek_map_size = sizeof(seek_point_entry) * seek_point_count;
+      if (file_size < expected_seek_point_count_size + seek_map_size) {
+         throw compressed_file_error("Compressed file is too small to hold its seek point map: " + file.get_file_path().generic_string());
+      }
+      if (seek_point_count > 0) {
+         file.read_at(file_size - expected_seek_point_count_size - seek_map_size, reinterpret_cast<char*>(seek_point_map.data()), seek_map_size);
+      }
+      return seek_point_map;
+   }
+
+   template<typename File>
+   void seek( uint64_t loc, const std::vector<seek_point_entry>& seek_point_map, File& file ) {
+      if (initialized) {
+         inflateEnd(&strm);
+         initialized = false;
+      }
+
+      auto remaining = loc;
+
+      if (!seek_point_map.empty()) {
          // seek to the neareast seek point
          auto iter = std::lower_bound(seek_point_map.begin(), seek_point_map.end(), loc, []( const auto& lhs, const auto& rhs ){
             return std::get<0>(lhs) < rhs;
@@ -182,7 +208,7 @@ compressed_file::~compressed_file()
 {}
 
 void compressed_file::seek( uint64_t loc ) {
-   impl->seek(loc, *file_ptr);
+   impl->seek(loc, compressed_file_impl::read_seek_point_map(*file_ptr), *file_ptr);
 
 }
 
@@ -196,6 +222,35 @@ compressed_file::compressed_file( compressed_file&& ) = default;
 compressed_file& compressed_file::operator= ( compressed_file&& ) = default;
 
 
+shared_compressed_file::shared_compressed_file( std::filesystem::path file_path )
+:file(std::move(file_path))
+,file_size(file.size())
+,seek_point_map(compressed_file_impl::read_seek_point_map(file, file_size))
+{}
+
+shared_compressed_file_datastream shared_compressed_file::create_datastream( uint64_t loc ) const {
+   return shared_compressed_file_datastream(*this, loc);
+}
+
+shared_compressed_file_datastream::shared_compressed_file_datastream( const shared_compressed_file& cf, uint64_t loc )
+:cursor{cf.file}
+,impl(std::make_unique<compressed_file_impl>())
+{
+   impl->file_size = cf.file_size;
+   impl->seek(loc, cf.seek_point_map, cursor);
+}
+
+shared_compressed_file_datastream::~shared_compressed_file_datastream()
+{}
+
+shared_compressed_file_datastream::shared_compressed_file_datastream( shared_compressed_file_datastream&& ) = default;
+
+bool shared_compressed_file_datastream::read( char* d, size_t s ) {
+   impl->read(d, s, cursor);
+   return true;
+}
+
+
 bool compressed_file::process( const std::filesystem::path& input_path, const std::filesystem::path& output_path, size_t seek_point_stride  ) {
    if (!std::filesystem::exists(input_path)) {
       throw std::ios_base::failure(std::string("Attempting to create compressed_file from file that does not exist: ") + input_path.generic_string());
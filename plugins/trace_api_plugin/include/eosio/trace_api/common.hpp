@@ -49,6 +49,12 @@ namespace eosio::trace_api {
    using get_block_t = std::optional<std::tuple<data_log_entry, bool>>;
 
    using get_block_n = std::optional<uint32_t>;
+
+   // block traces with matching actions, each paired with the ordinals of those actions
+   struct get_actions_t {
+      std::vector<std::tuple<data_log_entry, std::vector<uint32_t>>> blocks;
+      std::optional<uint32_t> next_block_num; ///< set when the limit was reached before the end of the range
+   };
    /**
     * Normal use case: exception_handler except_handler;
     *   except_handler( MAKE_EXCEPTION_WITH_CONTEXT( std::current_exception() ) );
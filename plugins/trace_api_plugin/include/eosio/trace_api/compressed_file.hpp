@@ -1,7 +1,10 @@
 #pragma once
 
 #include <ios>
+#include <tuple>
+#include <vector>
 #include <fc/io/cfile.hpp>
+#include <eosio/trace_api/read_only_file.hpp>
 
 namespace eosio::trace_api {
 
@@ -156,6 +159,83 @@ namespace eosio::trace_api {
       return compressed_file_datastream(*this);
    }
 
+   class shared_compressed_file_datastream;
+
+   /**
+    * read-only access to a compressed file shared by concurrent readers.
+    *
+    * The file is read with pread and its seek point map is loaded once, when it is opened.  Each datastream created
+    * from it owns its decompressor and file offset, so any number of threads decompress from the file at once, each
+    * starting at the seek point nearest to the offset it reads.
+    */
+   class shared_compressed_file {
+   public:
+      /**
+       * @throws std::ios_base::failure if the file cannot be opened or read
+       * @throws compressed_file_error if the seek point map is malformed
+       */
+      explicit shared_compressed_file( std::filesystem::path file_path );
+
+      bool is_file( const struct stat& st ) const { return file.is_file(st); }
+
+      const std::filesystem::path& get_file_path() const { return file.get_file_path(); }
+
+      /**
+       * Create a datastream reading from the given uncompressed offset
+       * @throws std::ios_base::failure if this would seek past the end of the file
+       * @throws compressed_file_error if the compressed data stream is corrupt or unreadable
+       */
+      shared_compressed_file_datastream create_datastream( uint64_t loc ) const;
+
+   private:
+      friend class shared_compressed_file_datastream;
+
+      pread_file file;
+      uint64_t file_size = 0;
+      std::vector<std::tuple<uint64_t, uint64_t>> seek_point_map;
+   };
+
+   /*
+    *  @brief datastream over a shared_compressed_file for use with fc unpack
+    *
+    *  This class supports unpack functionality but not pack.
+    */
+   class shared_compressed_file_datastream {
+   public:
+      shared_compressed_file_datastream( const shared_compressed_file& cf, uint64_t loc );
+      ~shared_compressed_file_datastream();
+
+      shared_compressed_file_datastream( shared_compressed_file_datastream&& );
+
+      void skip( size_t s ) {
+         std::vector<char> d( s );
+         read( &d[0], s );
+      }
+
+      bool read( char* d, size_t s );
+
+      bool get( unsigned char& c ) { return get( *(char*)&c ); }
+
+      bool get( char& c ) { return read(&c, 1); }
+
+   private:
+      // the compressed file position of this reader, shaped like the fc::cfile calls the decompressor makes
+      struct cursor_t {
+         const pread_file& file;
+         uint64_t pos = 0;
+
+         uint64_t tellp() const { return pos; }
+         void seek( uint64_t loc ) { pos = loc; }
+         void read( char* d, size_t n ) {
+            file.read_at(pos, d, n);
+            pos += n;
+         }
+      };
+
+      cursor_t cursor;
+      std::unique_ptr<compressed_file_impl> impl;
+   };
+
    /**
     * Typed exception to represent errors encountered due to the processing of a compressed file
     * and not the underlying fc::cfile access
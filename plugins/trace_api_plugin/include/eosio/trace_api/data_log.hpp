@@ -12,4 +12,44 @@ namespace eosio { namespace trace_api {
       block_trace_v2
    >;
 
+   /**
+    * Visit the actions of a block trace in the order they are stored, passing each with its transaction trace.
+    * An action's position in this order is its ordinal in the action index.
+    */
+   template<typename F>
+   void for_each_action( const block_trace_v0& bt, F&& f ) {
+      for( const auto& t : bt.transactions ) {
+         for( const auto& a : t.actions ) {
+            f(t, a);
+         }
+      }
+   }
+
+   template<typename F>
+   void for_each_action( const block_trace_v1& bt, F&& f ) {
+      for( const auto& t : bt.transactions_v1 ) {
+         for( const auto& a : t.actions ) {
+            f(t, a);
+         }
+      }
+   }
+
+   template<typename F>
+   void for_each_action( const block_trace_v2& bt, F&& f ) {
+      std::visit([&](const auto& transactions) {
+         for( const auto& t : transactions ) {
+            for( const auto& a : std::get<std::vector<action_trace_v1>>(t.actions) ) {
+               f(t, a);
+            }
+         }
+      }, bt.transactions);
+   }
+
+   template<typename F>
+   void for_each_action( const data_log_entry& entry, F&& f ) {
+      std::visit([&](const auto& bt) {
+         for_each_action(bt, f);
+      }, entry);
+   }
+
 }}
@@ -4,6 +4,8 @@
 #include <eosio/chain/abi_def.hpp>
 #include <eosio/chain/protocol_feature_activation.hpp>
 
+#include <algorithm>
+
 namespace eosio { namespace trace_api {
    struct block_entry_v0 {
       chain::block_id_type   id;
@@ -21,7 +23,47 @@ namespace eosio { namespace trace_api {
       block_trxs_entry
    >;
 
+   /**
+    * The keys of one action in the action index
+    */
+   struct action_index_ref_v0 {
+      chain::name               receiver;
+      chain::name               action;
+      std::vector<chain::name>  authorizers; ///< distinct authorizing accounts
+   };
+
+   /**
+    * The action index entry of one block: the keys of each of its actions, in the order for_each_action visits them,
+    * and the offset of the block trace in the trace slice
+    */
+   struct action_index_entry_v0 {
+      uint32_t                          block_num = 0;
+      uint64_t                          offset = 0;
+      std::vector<action_index_ref_v0>  actions;
+   };
+
+   using action_index_log_entry = std::variant<
+      action_index_entry_v0
+   >;
+
+   /**
+    * Selects actions by their action index keys, an unset key matches any action
+    */
+   struct action_filter {
+      std::optional<chain::name> receiver;
+      std::optional<chain::name> action;
+      std::optional<chain::name> authorizer;
+
+      bool matches( const action_index_ref_v0& ref ) const {
+         return (!receiver || *receiver == ref.receiver) &&
+                (!action || *action == ref.action) &&
+                (!authorizer || std::find(ref.authorizers.begin(), ref.authorizers.end(), *authorizer) != ref.authorizers.end());
+      }
+   };
+
 }}
 
 FC_REFLECT(eosio::trace_api::block_entry_v0, (id)(number)(offset));
 FC_REFLECT(eosio::trace_api::lib_entry_v0, (lib));
+FC_REFLECT(eosio::trace_api::action_index_ref_v0, (receiver)(action)(authorizers));
+FC_REFLECT(eosio::trace_api::action_index_entry_v0, (block_num)(offset)(actions));
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace eosio::trace_api {
+
+   class pread_datastream;
+
+   /**
+    * A read-only file read with pread. Reads carry their own offset, so any number of threads read the same open
+    * file at once without sharing a file position or a lock.
+    */
+   class pread_file {
+   public:
+      /**
+       * @throws std::ios_base::failure if the file cannot be opened
+       */
+      explicit pread_file( std::filesystem::path file_path );
+      ~pread_file();
+
+      pread_file( const pread_file& ) = delete;
+      pread_file& operator=( const pread_file& ) = delete;
+
+      /**
+       * Read exactly `n` bytes at `offset`
+       * @throws std::ios_base::failure if this would read past the end of the file
+       */
+      void read_at( uint64_t offset, char* d, size_t n ) const;
+
+      /**
+       * Read up to `n` bytes at `offset`
+       * @return the number of bytes read, less than `n` only at the end of the file
+       */
+      size_t read_some_at( uint64_t offset, char* d, size_t n ) const;
+
+      /**
+       * @return the current size of the file, which grows while the slice is appended to
+       */
+      uint64_t size() const;
+
+      /**
+       * @return true if `st` describes the file this was opened on, false once the path was removed or replaced
+       */
+      bool is_file( const struct stat& st ) const { return st.st_dev == _dev && st.st_ino == _ino; }
+
+      const std::filesystem::path& get_file_path() const { return _file_path; }
+
+      pread_datastream create_datastream( uint64_t offset ) const;
+
+   private:
+      std::filesystem::path _file_path;
+      int                   _fd = -1;
+      dev_t                 _dev = 0;
+      ino_t                 _ino = 0;
+   };
+
+   /*
+    *  @brief buffered datastream over a pread_file with its own position, for use with fc unpack
+    *
+    *  This class supports unpack functionality but not pack.
+    */
+   class pread_datastream {
+   public:
+      static constexpr size_t buffer_size = 64*1024;
+
+      pread_datastream( const pread_file& file, uint64_t offset ) : _file(file), _pos(offset) {}
+
+      void skip( size_t s ) {
+         std::vector<char> d( s );
+         read( d.data(), s );
+      }
+
+      bool read( char* d, size_t s );
+
+      bool get( unsigned char& c ) { return get( *(char*)&c ); }
+
+      bool get( char& c ) { return read(&c, 1); }
+
+      /**
+       * @return the offset in the file of the next byte read
+       */
+      uint64_t tellp() const { return _pos; }
+
+   private:
+      const pread_file& _file;
+      uint64_t          _pos;        ///< file offset of the next byte read
+      std::vector<char> _buffer;
+      uint64_t          _buffer_pos = 0; ///< file offset of _buffer[0]
+   };
+
+   inline pread_datastream pread_file::create_datastream( uint64_t offset ) const {
+      return pread_datastream(*this, offset);
+   }
+
+   /**
+    * LRU cache of open read-only files shared by concurrent readers. A handle stays usable by a reader after it is
+    * evicted or erased; the file is closed when the last reader releases it.
+    *
+    * @tparam File : the handle type, which must provide `bool is_file(const struct stat&) const`
+    */
+   template<typename File>
+   class file_handle_cache {
+   public:
+      using handle = std::shared_ptr<const File>;
+
+      explicit file_handle_cache( size_t capacity ) : _capacity(capacity) {}
+
+      /**
+       * Find the open handle of a file, opening it with `open` if it is not cached or the path now names another file
+       *
+       * @return the handle, or nullptr if the file does not exist
+       */
+      template<typename Open>
+      handle get( const std::filesystem::path& file_path, Open&& open ) {
+         struct stat st;
+         if( ::stat(file_path.c_str(), &st) != 0 ) {
+            erase(file_path);
+            return {};
+         }
+
+         const auto key = file_path.generic_string();
+         {
+            std::scoped_lock lock(_mtx);
+            if( auto itr = _index.find(key); itr != _index.end() ) {
+               if( itr->second->second->is_file(st) ) {
+                  _lru.splice(_lru.begin(), _lru, itr->second);
+                  return itr->second->second;
+               }
+               _lru.erase(itr->second);
+               _index.erase(itr);
+            }
+         }
+
+         // open outside of the lock, a concurrent open of the same file only costs a second handle
+         handle h = open(file_path);
+         if( _capacity == 0 )
+            return h;
+
+         std::scoped_lock lock(_mtx);
+         if( auto itr = _index.find(key); itr != _index.end() ) {
+            _lru.erase(itr->second);
+            _index.erase(itr);
+         }
+         _lru.emplace_front(key, h);
+         _index[key] = _lru.begin();
+         if( _lru.size() > _capacity ) {
+            _index.erase(_lru.back().first);
+            _lru.pop_back();
+         }
+         return h;
+      }
+
+      /**
+       * Drop the cached handle of a file, e.g. before it is removed, so the cache does not keep it open
+       */
+      void erase( const std::filesystem::path& file_path ) {
+         std::scoped_lock lock(_mtx);
+         if( auto itr = _index.find(file_path.generic_string()); itr != _index.end() ) {
+            _lru.erase(itr->second);
+            _index.erase(itr);
+         }
+      }
+
+   private:
+      using lru_list = std::list<std::pair<std::string, handle>>;
+
+      const size_t                                                 _capacity;
+      std::mutex                                                   _mtx;
+      lru_list                                                     _lru;   ///< most recently used first
+      std::unordered_map<std::string, typename lru_list::iterator> _index;
+   };
+
+}
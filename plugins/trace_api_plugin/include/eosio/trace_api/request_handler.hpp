@@ -12,6 +12,7 @@ namespace eosio::trace_api {
       class response_formatter {
       public:
          static fc::variant process_block( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler );
+         static fc::variant process_actions( const get_actions_t& actions, const data_handler_function& data_handler );
       };
    }
 
@@ -89,6 +90,30 @@ namespace eosio::trace_api {
          return result;
       }
 
+      /**
+       * Fetch the actions matching a filter in a range of blocks and convert them to a fc::variant for conversion to a
+       * final format (eg JSON)
+       *
+       * @param filter - the keys the actions must match
+       * @param block_num_start - the first block of the range
+       * @param block_num_end - the last block of the range
+       * @param limit - no further blocks are read once this many matching actions were found
+       * @return a variant holding the matching actions in block order and, if the limit was reached, the block number
+       * to continue from
+       * @throws bad_data_exception when there are issues with the underlying data preventing processing.
+       */
+      fc::variant get_actions( const action_filter& filter, uint32_t block_num_start, uint32_t block_num_end, uint32_t limit ) {
+         auto data = logfile_provider.get_actions(filter, block_num_start, block_num_end, limit);
+
+         auto data_handler = [this](const auto& action) -> std::tuple<fc::variant, std::optional<fc::variant>> {
+            return std::visit([&](const auto& action_trace_t) {
+               return data_handler_provider.serialize_to_variant(action_trace_t);
+            }, action);
+         };
+
+         return detail::response_formatter::process_actions(data, data_handler);
+      }
+
    private:
       LogfileProvider logfile_provider;
       DataHandlerProvider data_handler_provider;
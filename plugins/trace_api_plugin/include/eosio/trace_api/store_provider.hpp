@@ -10,6 +10,7 @@
 #include <eosio/trace_api/metadata_log.hpp>
 #include <eosio/trace_api/data_log.hpp>
 #include <eosio/trace_api/compressed_file.hpp>
+#include <eosio/trace_api/read_only_file.hpp>
 
 namespace eosio::trace_api {
 
@@ -98,8 +99,15 @@ namespace eosio::trace_api {
       };
 
       enum class open_state { read /*read from front to back*/, write /*write to end of file*/ };
+
+      using read_only_slice = std::shared_ptr<const pread_file>;
+      using read_only_compressed_slice = std::shared_ptr<const shared_compressed_file>;
+
+      static constexpr size_t default_max_open_read_only_slices = 64;
+
       slice_directory(const std::filesystem::path& slice_dir, uint32_t width, std::optional<uint32_t> minimum_irreversible_history_blocks,
-                      std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride);
+                      std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride,
+                      size_t max_open_read_only_slices = default_max_open_read_only_slices);
 
       /**
        * Return the slice number that would include the passed in block_height
@@ -202,6 +210,79 @@ namespace eosio::trace_api {
        */
       bool find_trx_id_slice(uint32_t slice_number, open_state state, fc::cfile& trx_id_file, bool open_file = true) const;
 
+      /**
+       * Find or create the action index file associated with the indicated slice_number
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @param state : indicate if the file is going to be written to (appended) or read
+       * @param action_index_file : the cfile that will be set to the appropriate slice filename
+       *                            and opened to that file
+       * @return true if file was found (i.e. already existed)
+       */
+      bool find_or_create_action_index_slice(uint32_t slice_number, open_state state, fc::cfile& action_index_file) const;
+
+      /**
+       * Find the action index file associated with the indicated slice_number
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @param state : indicate if the file is going to be written to (appended) or read
+       * @param action_index_file : the cfile that will be set to the appropriate slice filename (always)
+       *                            and opened to that file (if it was found)
+       * @param open_file : indicate if the file should be opened (if found) or not
+       * @return true if file was found (i.e. already existed), if not found action_index_file
+       *         is set to the appropriate file, but not opened
+       */
+      bool find_action_index_slice(uint32_t slice_number, open_state state, fc::cfile& action_index_file, bool open_file = true) const;
+
+      /**
+       * Find the index file associated with the indicated slice_number, for reading concurrently with other readers.
+       * The header of the file is validated when it is opened; its entries start at index_entries_offset.
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @return the shared read-only file, or nullptr if it does not exist
+       * @throws old_slice_version if the file has an unsupported version
+       */
+      read_only_slice find_read_only_index_slice(uint32_t slice_number) const;
+
+      /**
+       * Find the trace file associated with the indicated slice_number, for reading concurrently with other readers
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @return the shared read-only file, or nullptr if it does not exist
+       */
+      read_only_slice find_read_only_trace_slice(uint32_t slice_number) const;
+
+      /**
+       * Find the trx id file associated with the indicated slice_number, for reading concurrently with other readers
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @return the shared read-only file, or nullptr if it does not exist
+       */
+      read_only_slice find_read_only_trx_id_slice(uint32_t slice_number) const;
+
+      /**
+       * Find the action index file associated with the indicated slice_number, for reading concurrently with other
+       * readers
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @return the shared read-only file, or nullptr if it does not exist
+       */
+      read_only_slice find_read_only_action_index_slice(uint32_t slice_number) const;
+
+      /**
+       * Find the compressed trace file associated with the indicated slice_number, for reading concurrently with
+       * other readers
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @return the shared compressed file, or nullptr if it does not exist
+       */
+      read_only_compressed_slice find_read_only_compressed_trace_slice(uint32_t slice_number) const;
+
+      /**
+       * offset of the first entry of an index file, following its header
+       */
+      static const uint64_t index_entries_offset;
+
       /**
        * set the LIB for maintenance
        * @param lib
@@ -237,6 +318,12 @@ namespace eosio::trace_api {
       // take an open index slice file and verify its header is valid and prepare the file to be appended to (or read from)
       void validate_existing_index_slice_file(fc::cfile& index_file, open_state state) const;
 
+      // path of the slice file for the slice_prefix, slice_ext and slice_number
+      std::filesystem::path slice_path(const char* slice_prefix, const char* slice_ext, uint32_t slice_number) const;
+
+      // drop the shared read-only handle of a slice file that maintenance is about to remove
+      void release_read_only_slice(const std::filesystem::path& slice_path);
+
       // helper for methods that process irreversible slice files
       template<typename F>
       void process_irreversible_slice_range(uint32_t lib, uint32_t upper_bound_block, std::optional<uint32_t>& lower_bound_slice, F&& f);
@@ -249,6 +336,10 @@ namespace eosio::trace_api {
       std::optional<uint32_t> _last_compressed_slice;
       const size_t _compression_seek_point_stride;
 
+      // read-only handles shared by concurrent readers, most recently used are kept open
+      mutable file_handle_cache<pread_file> _read_only_slices;
+      mutable file_handle_cache<shared_compressed_file> _read_only_compressed_slices;
+
       std::mutex _maintenance_mtx;
       std::condition_variable _maintenance_condition;
       std::thread _maintenance_thread;
@@ -264,7 +355,8 @@ namespace eosio::trace_api {
       using open_state = slice_directory::open_state;
 
       store_provider(const std::filesystem::path& slice_dir, uint32_t stride_width, std::optional<uint32_t> minimum_irreversible_history_blocks,
-            std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride);
+            std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride,
+            size_t max_open_read_only_slices = slice_directory::default_max_open_read_only_slices, bool action_index = false);
 
       template<typename BlockTrace>
       void append(const BlockTrace& bt);
@@ -281,6 +373,23 @@ namespace eosio::trace_api {
 
       get_block_n get_trx_block_number(const chain::transaction_id_type& trx_id, std::optional<uint32_t> minimum_irreversible_history_blocks, const yield_function& yield= {});
 
+      /**
+       * Find the actions matching a filter in a range of blocks through the action index, reading only the block
+       * traces which contain a match. Slices written without an action index are skipped.
+       *
+       * @param filter : the keys the actions must match
+       * @param block_num_start : the first block of the range
+       * @param block_num_end : the last block of the range
+       * @param limit : no further blocks are read once this many matching actions were found
+       * @return the matching blocks in block order, with where to continue if the limit was reached
+       */
+      get_actions_t get_actions(const action_filter& filter, uint32_t block_num_start, uint32_t block_num_end, uint32_t limit, const yield_function& yield= {});
+
+      /**
+       * @return true if actions are written to the action index as blocks are appended
+       */
+      bool has_action_index() const { return _action_index; }
+
       void start_maintenance_thread( log_handler log ) {
          _slice_directory.start_maintenance_thread( std::move(log) );
       }
@@ -301,24 +410,24 @@ namespace eosio::trace_api {
       template<typename Fn>
       uint64_t scan_metadata_log_from( uint32_t block_height, uint64_t offset, Fn&& fn, const yield_function& yield ) {
          // ignoring offset
-         offset = 0;
-         fc::cfile index;
          const uint32_t slice_number = _slice_directory.slice_number(block_height);
-         const bool found = _slice_directory.find_index_slice(slice_number, open_state::read, index);
-         if( !found ) {
+         const auto index = _slice_directory.find_read_only_index_slice(slice_number);
+         if( !index ) {
             return 0;
          }
-         const uint64_t end = file_size(index.get_file_path());
-         offset = index.tellp();
+         const uint64_t end = index->size();
+         auto ds = index->create_datastream(slice_directory::index_entries_offset);
+         offset = ds.tellp();
          uint64_t last_read_offset = offset;
          while (offset < end) {
             yield();
-            const auto metadata = extract_store<metadata_log_entry>(index);
+            metadata_log_entry metadata;
+            fc::raw::unpack(ds, metadata);
             if(! fn(metadata)) {
                break;
             }
             last_read_offset = offset;
-            offset = index.tellp();
+            offset = ds.tellp();
          }
          return last_read_offset;
       }
@@ -334,28 +443,32 @@ namespace eosio::trace_api {
       std::optional<data_log_entry> read_data_log( uint32_t block_height, uint64_t offset ) {
          const uint32_t slice_number = _slice_directory.slice_number(block_height);
 
-         fc::cfile trace;
-         if( !_slice_directory.find_trace_slice(slice_number, open_state::read, trace) ) {
+         const auto trace = _slice_directory.find_read_only_trace_slice(slice_number);
+         if( !trace ) {
             // attempt to read a compressed trace if one exists
-            std::optional<compressed_file> ctrace = _slice_directory.find_compressed_trace_slice(slice_number);
+            const auto ctrace = _slice_directory.find_read_only_compressed_trace_slice(slice_number);
             if (ctrace) {
-               ctrace->seek(offset);
-               return extract_store<data_log_entry>(*ctrace);
+               data_log_entry entry;
+               auto ds = ctrace->create_datastream(offset);
+               fc::raw::unpack(ds, entry);
+               return entry;
             }
 
             const std::string offset_str = boost::lexical_cast<std::string>(offset);
             const std::string bh_str = boost::lexical_cast<std::string>(block_height);
             throw malformed_slice_file("Requested offset: " + offset_str + " to retrieve block number: " + bh_str + " but this trace file is new, so there are no traces present.");
          }
-         const uint64_t end = file_size(trace.get_file_path());
+         const uint64_t end = trace->size();
          if( offset >= end ) {
             const std::string offset_str = boost::lexical_cast<std::string>(offset);
             const std::string bh_str = boost::lexical_cast<std::string>(block_height);
             const std::string end_str = boost::lexical_cast<std::string>(end);
             throw malformed_slice_file("Requested offset: " + offset_str + " to retrieve block number: " + bh_str + " but this trace file only goes to offset: " + end_str);
          }
-         trace.seek(offset);
-         return extract_store<data_log_entry>(trace);
+         data_log_entry entry;
+         auto ds = trace->create_datastream(offset);
+         fc::raw::unpack(ds, entry);
+         return entry;
       }
 
       /**
@@ -374,6 +487,7 @@ namespace eosio::trace_api {
       void validate_existing_index_slice_file(fc::cfile& index, open_state state);
 
       slice_directory _slice_directory;
+      const bool _action_index;
    };
 
 }
@@ -0,0 +1,96 @@
+#include <eosio/trace_api/read_only_file.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <ios>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace eosio::trace_api {
+
+pread_file::pread_file( std::filesystem::path file_path )
+:_file_path(std::move(file_path))
+{
+   _fd = ::open(_file_path.c_str(), O_RDONLY | O_CLOEXEC);
+   if( _fd < 0 ) {
+      throw std::ios_base::failure("Failed to open " + _file_path.generic_string() + ": " + std::strerror(errno));
+   }
+
+   struct stat st;
+   if( ::fstat(_fd, &st) != 0 ) {
+      const int err = errno;
+      ::close(_fd);
+      throw std::ios_base::failure("Failed to stat " + _file_path.generic_string() + ": " + std::strerror(err));
+   }
+   _dev = st.st_dev;
+   _ino = st.st_ino;
+}
+
+pread_file::~pread_file() {
+   ::close(_fd);
+}
+
+size_t pread_file::read_some_at( uint64_t offset, char* d, size_t n ) const {
+   size_t total = 0;
+   while( total < n ) {
+      const ssize_t r = ::pread(_fd, d + total, n - total, offset + total);
+      if( r < 0 ) {
+         if( errno == EINTR )
+            continue;
+         throw std::ios_base::failure("Failed to read " + _file_path.generic_string() + ": " + std::strerror(errno));
+      }
+      if( r == 0 )
+         break;
+      total += r;
+   }
+   return total;
+}
+
+void pread_file::read_at( uint64_t offset, char* d, size_t n ) const {
+   if( read_some_at(offset, d, n) != n ) {
+      throw std::ios_base::failure("Attempting to read past the end of " + _file_path.generic_string() +
+                                   " at offset: " + std::to_string(offset));
+   }
+}
+
+uint64_t pread_file::size() const {
+   struct stat st;
+   if( ::fstat(_fd, &st) != 0 ) {
+      throw std::ios_base::failure("Failed to stat " + _file_path.generic_string() + ": " + std::strerror(errno));
+   }
+   return st.st_size;
+}
+
+bool pread_datastream::read( char* d, size_t s ) {
+   // serve what the buffer holds, then refill it, or read a request larger than the buffer directly
+   const uint64_t buffered_end = _buffer_pos + _buffer.size();
+   if( _pos >= _buffer_pos && _pos < buffered_end ) {
+      const size_t n = std::min<uint64_t>(s, buffered_end - _pos);
+      std::memcpy(d, _buffer.data() + (_pos - _buffer_pos), n);
+      d += n;
+      s -= n;
+      _pos += n;
+   }
+   if( s == 0 )
+      return true;
+
+   if( s >= buffer_size ) {
+      _file.read_at(_pos, d, s);
+      _pos += s;
+      return true;
+   }
+
+   _buffer.resize(buffer_size);
+   _buffer.resize(_file.read_some_at(_pos, _buffer.data(), buffer_size));
+   _buffer_pos = _pos;
+   if( _buffer.size() < s ) {
+      throw std::ios_base::failure("Attempting to read past the end of " + _file.get_file_path().generic_string() +
+                                   " at offset: " + std::to_string(_pos));
+   }
+   std::memcpy(d, _buffer.data(), s);
+   _pos += s;
+   return true;
+}
+
+}
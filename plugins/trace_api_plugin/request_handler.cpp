@@ -25,6 +25,39 @@ namespace {
 
    }
 
+   template<typename ActionTrace>
+   fc::mutable_variant_object process_action(const ActionTrace& a, const data_handler_function & data_handler) {
+      auto common_mvo = fc::mutable_variant_object();
+
+      common_mvo("global_sequence", a.global_sequence)
+            ("receiver", a.receiver.to_string())
+            ("account", a.account.to_string())
+            ("action", a.action.to_string())
+            ("authorization", process_authorizations(a.authorization))
+            ("data", fc::to_hex(a.data.data(), a.data.size()));
+
+      auto action_variant = fc::mutable_variant_object();
+      if constexpr(std::is_same_v<ActionTrace, action_trace_v0>){
+         action_variant(std::move(common_mvo));
+         auto [params, return_data] = data_handler(a);
+         if (!params.is_null()) {
+            action_variant("params", params);
+         }
+      }
+      else if constexpr(std::is_same_v<ActionTrace, action_trace_v1>){
+         action_variant(std::move(common_mvo));
+         action_variant("return_value", fc::to_hex(a.return_value.data(),a.return_value.size())) ;
+         auto [params, return_data] = data_handler(a);
+         if (!params.is_null()) {
+            action_variant("params", params);
+         }
+         if(return_data.has_value()){
+            action_variant("return_data", *return_data);
+         }
+      }
+      return action_variant;
+   }
+
    template<typename ActionTrace>
    fc::variants process_actions(const std::vector<ActionTrace>& actions, const data_handler_function & data_handler) {
       fc::variants result;
@@ -36,36 +69,7 @@ namespace {
          return actions.at(lhs).global_sequence < actions.at(rhs).global_sequence;
       });
       for ( int index : indices) {
-         const auto& a = actions.at(index);
-         auto common_mvo = fc::mutable_variant_object();
-
-         common_mvo("global_sequence", a.global_sequence)
-               ("receiver", a.receiver.to_string())
-               ("account", a.account.to_string())
-               ("action", a.action.to_string())
-               ("authorization", process_authorizations(a.authorization))
-               ("data", fc::to_hex(a.data.data(), a.data.size()));
-
-         auto action_variant = fc::mutable_variant_object();
-         if constexpr(std::is_same_v<ActionTrace, action_trace_v0>){
-            action_variant(std::move(common_mvo));
-            auto [params, return_data] = data_handler(a);
-            if (!params.is_null()) {
-               action_variant("params", params);
-            }
-         }
-         else if constexpr(std::is_same_v<ActionTrace, action_trace_v1>){
-            action_variant(std::move(common_mvo));
-            action_variant("return_value", fc::to_hex(a.return_value.data(),a.return_value.size())) ;
-            auto [params, return_data] = data_handler(a);
-            if (!params.is_null()) {
-               action_variant("params", params);
-            }
-            if(return_data.has_value()){
-               action_variant("return_data", *return_data);
-            }
-         }
-         result.emplace_back( std::move(action_variant) );
+         result.emplace_back( process_action(actions.at(index), data_handler) );
       }
       return result;
    }
@@ -157,4 +161,33 @@ namespace eosio::trace_api::detail {
           return fc::mutable_variant_object();
        }
     }
+
+    fc::variant response_formatter::process_actions( const get_actions_t& actions, const data_handler_function& data_handler ) {
+       fc::variants result;
+       for( const auto& block : actions.blocks ) {
+          const auto& ordinals = std::get<1>(block);
+          std::visit([&](const auto& block_trace) {
+             uint32_t ordinal = 0;
+             auto next = ordinals.begin();
+             for_each_action(block_trace, [&](const auto& t, const auto& a) {
+                if( next != ordinals.end() && *next == ordinal ) {
+                   result.emplace_back(fc::mutable_variant_object()
+                      ("block_num", block_trace.number)
+                      ("block_id", block_trace.id.str())
+                      ("timestamp", to_iso8601_datetime(block_trace.timestamp))
+                      ("transaction_id", t.id.str())
+                      (process_action(a, data_handler)));
+                   ++next;
+                }
+                ++ordinal;
+             });
+          }, std::get<0>(block));
+       }
+
+       auto response = fc::mutable_variant_object()("actions", std::move(result));
+       if( actions.next_block_num ) {
+          response("next_block_num", *actions.next_block_num);
+       }
+       return response;
+    }
 }
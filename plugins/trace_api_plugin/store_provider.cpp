@@ -3,14 +3,17 @@
 #include <fc/variant_object.hpp>
 #include <fc/log/logger_config.hpp>
 
+#include <map>
+
 namespace {
       static constexpr uint32_t _current_version = 1;
       static constexpr const char* _trace_prefix = "trace_";
       static constexpr const char* _trace_index_prefix = "trace_index_";
       static constexpr const char* _trace_trx_id_prefix = "trace_trx_id_";
+      static constexpr const char* _trace_action_index_prefix = "trace_action_index_";
       static constexpr const char* _trace_ext = ".log";
       static constexpr const char* _compressed_trace_ext = ".clog";
-      static constexpr int _max_filename_size = std::char_traits<char>::length(_trace_index_prefix) + 10 + 1 + 10 + std::char_traits<char>::length(_compressed_trace_ext) + 1; // "trace_index_" + 10-digits + '-' + 10-digits + ".clog" + null-char
+      static constexpr int _max_filename_size = std::char_traits<char>::length(_trace_action_index_prefix) + 10 + 1 + 10 + std::char_traits<char>::length(_compressed_trace_ext) + 1; // "trace_action_index_" + 10-digits + '-' + 10-digits + ".clog" + null-char
 
       std::string make_filename(const char* slice_prefix, const char* slice_ext, uint32_t slice_number, uint32_t slice_width) {
          char filename[_max_filename_size] = {};
@@ -31,8 +34,11 @@ namespace {
 
 namespace eosio::trace_api {
       store_provider::store_provider(const std::filesystem::path& slice_dir, uint32_t stride_width, std::optional<uint32_t> minimum_irreversible_history_blocks,
-                                  std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride)
-   : _slice_directory(slice_dir, stride_width, minimum_irreversible_history_blocks, minimum_uncompressed_irreversible_history_blocks, compression_seek_point_stride) {
+                                  std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride,
+                                  size_t max_open_read_only_slices, bool action_index)
+   : _slice_directory(slice_dir, stride_width, minimum_irreversible_history_blocks, minimum_uncompressed_irreversible_history_blocks, compression_seek_point_stride,
+                      max_open_read_only_slices)
+   , _action_index(action_index) {
    }
 
    template<typename BlockTrace>
@@ -46,6 +52,20 @@ namespace eosio::trace_api {
 
       auto be = metadata_log_entry { block_entry_v0 { .id = bt.id, .number = bt.number, .offset = offset }};
       append_store(be, index);
+
+      if (_action_index) {
+         action_index_entry_v0 ae { .block_num = bt.number, .offset = offset };
+         for_each_action(bt, [&ae](const auto&, const auto& a) {
+            auto& ref = ae.actions.emplace_back(action_index_ref_v0 { .receiver = a.receiver, .action = a.action });
+            for (const auto& auth : a.authorization) {
+               if (std::find(ref.authorizers.begin(), ref.authorizers.end(), auth.account) == ref.authorizers.end())
+                  ref.authorizers.push_back(auth.account);
+            }
+         });
+         fc::cfile action_index;
+         _slice_directory.find_or_create_action_index_slice(slice_number, open_state::write, action_index);
+         append_store(action_index_log_entry { std::move(ae) }, action_index);
+      }
    }
 
    template void store_provider::append<block_trace_v1>(const block_trace_v1& bt);
@@ -99,7 +119,6 @@ namespace eosio::trace_api {
    }
 
    get_block_n store_provider::get_trx_block_number(const chain::transaction_id_type& trx_id, std::optional<uint32_t> minimum_irreversible_history_blocks, const yield_function& yield) {
-      fc::cfile trx_id_file;
       int32_t slice_number;
       if (minimum_irreversible_history_blocks) {
          slice_number = _slice_directory.slice_number(*minimum_irreversible_history_blocks);
@@ -110,14 +129,14 @@ namespace eosio::trace_api {
       uint32_t trx_block_num = 0; // number of the block that contains the target trx
       uint32_t trx_entries = 0;   // number of entries that contain the target trx
       while (true){
-         const bool found = _slice_directory.find_trx_id_slice(slice_number, open_state::read, trx_id_file);
-         if( !found )
+         const auto trx_id_file = _slice_directory.find_read_only_trx_id_slice(slice_number);
+         if( !trx_id_file )
             break; // traversed all slices
 
          metadata_log_entry entry;
-         auto ds = trx_id_file.create_datastream();
-         const uint64_t end = file_size(trx_id_file.get_file_path());
-         uint64_t offset = trx_id_file.tellp();
+         auto ds = trx_id_file->create_datastream(0);
+         const uint64_t end = trx_id_file->size();
+         uint64_t offset = ds.tellp();
          while (offset < end) {
             yield();
             fc::raw::unpack(ds, entry);
@@ -137,7 +156,7 @@ namespace eosio::trace_api {
             } else {
                FC_ASSERT( false, "unpacked data should be a block_trxs_entry or a lib_entry_v0" );;
             }
-            offset = trx_id_file.tellp();
+            offset = ds.tellp();
          }
          slice_number++;
       }
@@ -149,12 +168,65 @@ namespace eosio::trace_api {
       return get_block_n{};
    }
 
-   slice_directory::slice_directory(const std::filesystem::path& slice_dir, uint32_t width, std::optional<uint32_t> minimum_irreversible_history_blocks, std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride)
+   get_actions_t store_provider::get_actions(const action_filter& filter, uint32_t block_num_start, uint32_t block_num_end, uint32_t limit, const yield_function& yield) {
+      get_actions_t result;
+      uint32_t found = 0;
+      const uint64_t last_slice = _slice_directory.slice_number(block_num_end);
+      for (uint64_t slice_number = _slice_directory.slice_number(block_num_start); slice_number <= last_slice; ++slice_number) {
+         const auto action_index = _slice_directory.find_read_only_action_index_slice(slice_number);
+         if( !action_index )
+            continue;
+
+         // offset and matching ordinals by block, a block appended again after a fork replaces its earlier entry
+         std::map<uint32_t, std::tuple<uint64_t, std::vector<uint32_t>>> matches;
+         auto ds = action_index->create_datastream(0);
+         const uint64_t end = action_index->size();
+         while (ds.tellp() < end) {
+            yield();
+            action_index_log_entry entry;
+            fc::raw::unpack(ds, entry);
+            const auto& block = std::get<action_index_entry_v0>(entry);
+            if (block.block_num < block_num_start || block.block_num > block_num_end)
+               continue;
+
+            std::vector<uint32_t> ordinals;
+            for (uint32_t i = 0; i < block.actions.size(); ++i) {
+               if (filter.matches(block.actions[i]))
+                  ordinals.push_back(i);
+            }
+            if (ordinals.empty())
+               matches.erase(block.block_num);
+            else
+               matches[block.block_num] = std::make_tuple(block.offset, std::move(ordinals));
+         }
+
+         for (auto& [block_num, match] : matches) {
+            if (found >= limit) {
+               result.next_block_num = block_num;
+               return result;
+            }
+            yield();
+            std::optional<data_log_entry> trace = read_data_log(block_num, std::get<0>(match));
+            if (!trace)
+               continue;
+            found += std::get<1>(match).size();
+            result.blocks.emplace_back(std::move(*trace), std::move(std::get<1>(match)));
+         }
+      }
+      return result;
+   }
+
+   const uint64_t slice_directory::index_entries_offset = fc::raw::pack_size(slice_directory::index_header{});
+
+   slice_directory::slice_directory(const std::filesystem::path& slice_dir, uint32_t width, std::optional<uint32_t> minimum_irreversible_history_blocks, std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride,
+                                    size_t max_open_read_only_slices)
    : _slice_dir(slice_dir)
    , _width(width)
    , _minimum_irreversible_history_blocks(minimum_irreversible_history_blocks)
    , _minimum_uncompressed_irreversible_history_blocks(minimum_uncompressed_irreversible_history_blocks)
    , _compression_seek_point_stride(compression_seek_point_stride)
+   , _read_only_slices(max_open_read_only_slices)
+   , _read_only_compressed_slices(max_open_read_only_slices)
    , _best_known_lib(0) {
       if (!exists(_slice_dir)) {
          std::filesystem::create_directories(slice_dir);
@@ -240,6 +312,53 @@ namespace eosio::trace_api {
       }
    }
 
+   std::filesystem::path slice_directory::slice_path(const char* slice_prefix, const char* slice_ext, uint32_t slice_number) const {
+      return _slice_dir / make_filename(slice_prefix, slice_ext, slice_number, _width);
+   }
+
+   slice_directory::read_only_slice slice_directory::find_read_only_index_slice(uint32_t slice_number) const {
+      return _read_only_slices.get(slice_path(_trace_index_prefix, _trace_ext, slice_number), [](const std::filesystem::path& p) {
+         auto index_file = std::make_shared<const pread_file>(p);
+         index_header header;
+         auto ds = index_file->create_datastream(0);
+         fc::raw::unpack(ds, header);
+         if (header.version != _current_version) {
+            throw old_slice_version("Old slice file with version: " + std::to_string(header.version) +
+                                    " is in directory, only supporting version: " + std::to_string(_current_version));
+         }
+         return index_file;
+      });
+   }
+
+   slice_directory::read_only_slice slice_directory::find_read_only_trace_slice(uint32_t slice_number) const {
+      return _read_only_slices.get(slice_path(_trace_prefix, _trace_ext, slice_number), [](const std::filesystem::path& p) {
+         return std::make_shared<const pread_file>(p);
+      });
+   }
+
+   slice_directory::read_only_slice slice_directory::find_read_only_trx_id_slice(uint32_t slice_number) const {
+      return _read_only_slices.get(slice_path(_trace_trx_id_prefix, _trace_ext, slice_number), [](const std::filesystem::path& p) {
+         return std::make_shared<const pread_file>(p);
+      });
+   }
+
+   slice_directory::read_only_slice slice_directory::find_read_only_action_index_slice(uint32_t slice_number) const {
+      return _read_only_slices.get(slice_path(_trace_action_index_prefix, _trace_ext, slice_number), [](const std::filesystem::path& p) {
+         return std::make_shared<const pread_file>(p);
+      });
+   }
+
+   slice_directory::read_only_compressed_slice slice_directory::find_read_only_compressed_trace_slice(uint32_t slice_number) const {
+      return _read_only_compressed_slices.get(slice_path(_trace_prefix, _compressed_trace_ext, slice_number), [](const std::filesystem::path& p) {
+         return std::make_shared<const shared_compressed_file>(p);
+      });
+   }
+
+   void slice_directory::release_read_only_slice(const std::filesystem::path& slice_path) {
+      _read_only_slices.erase(slice_path);
+      _read_only_compressed_slices.erase(slice_path);
+   }
+
    bool slice_directory::find_slice(const char* slice_prefix, uint32_t slice_number, fc::cfile& slice_file, bool open_file) const {
       auto filename = make_filename(slice_prefix, _trace_ext, slice_number, _width);
       const auto slice_path = _slice_dir / filename;
@@ -287,6 +406,25 @@ namespace eosio::trace_api {
       return true;
    }
 
+   bool slice_directory::find_or_create_action_index_slice(uint32_t slice_number, open_state state, fc::cfile& action_index_file) const {
+      const bool found = find_action_index_slice(slice_number, state, action_index_file);
+      if( !found ) {
+         action_index_file.open(fc::cfile::create_or_update_rw_mode);
+      }
+      return found;
+   }
+
+   bool slice_directory::find_action_index_slice(uint32_t slice_number, open_state state, fc::cfile& action_index_file, bool open_file) const {
+      const bool found = find_slice(_trace_action_index_prefix, slice_number, action_index_file, open_file);
+      if( !found || !open_file ) {
+         return found;
+      }
+      if( state == open_state::write ) {
+         action_index_file.seek_end(0);
+      }
+      return true;
+   }
+
    void slice_directory::set_lib(uint32_t lib) {
       {
          std::scoped_lock lock(_maintenance_mtx);
@@ -357,6 +495,7 @@ namespace eosio::trace_api {
             fc::cfile trace;
             fc::cfile index;
             fc::cfile trx_id;
+            fc::cfile action_index;
 
             log(std::string("Attempting Prune of slice: ") + std::to_string(slice_to_clean));
 
@@ -365,22 +504,32 @@ namespace eosio::trace_api {
             const bool index_found = find_index_slice(slice_to_clean, open_state::read, index, dont_open_file);
             if (index_found) {
                log(std::string("Removing: ") + index.get_file_path().generic_string());
+               release_read_only_slice(index.get_file_path());
                std::filesystem::remove(index.get_file_path());
             }
             const bool trace_found = find_trace_slice(slice_to_clean, open_state::read, trace, dont_open_file);
             if (trace_found) {
                log(std::string("Removing: ") + trace.get_file_path().generic_string());
+               release_read_only_slice(trace.get_file_path());
                std::filesystem::remove(trace.get_file_path());
             }
             const bool trx_id_found = find_trx_id_slice(slice_to_clean, open_state::read, trx_id, dont_open_file);
             if (trx_id_found) {
                log(std::string("Removing: ") + trx_id.get_file_path().generic_string());
+               release_read_only_slice(trx_id.get_file_path());
                std::filesystem::remove(trx_id.get_file_path());
             }
+            const bool action_index_found = find_action_index_slice(slice_to_clean, open_state::read, action_index, dont_open_file);
+            if (action_index_found) {
+               log(std::string("Removing: ") + action_index.get_file_path().generic_string());
+               release_read_only_slice(action_index.get_file_path());
+               std::filesystem::remove(action_index.get_file_path());
+            }
 
             auto ctrace = find_compressed_trace_slice(slice_to_clean, dont_open_file);
             if (ctrace) {
                log(std::string("Removing: ") + ctrace->get_file_path().generic_string());
+               release_read_only_slice(ctrace->get_file_path());
                std::filesystem::remove(ctrace->get_file_path());
             }
          });
@@ -407,6 +556,7 @@ namespace eosio::trace_api {
 
                // after compression is complete, delete the old uncompressed file
                log(std::string("Removing: ") + trace.get_file_path().generic_string());
+               release_read_only_slice(trace.get_file_path());
                std::filesystem::remove(trace.get_file_path());
             }
          });
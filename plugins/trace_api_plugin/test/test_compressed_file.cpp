@@ -1,5 +1,7 @@
 #include <boost/test/unit_test.hpp>
+#include <atomic>
 #include <list>
+#include <thread>
 
 #include <eosio/trace_api/compressed_file.hpp>
 #include <eosio/trace_api/test_common.hpp>
@@ -201,4 +203,40 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(blob_access_no_seek_points, T, test_types, temp
 }
 
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(shared_concurrent_access, T, test_types, temp_file_fixture) {
+   auto data = std::vector<T>(128);
+   std::generate(data.begin(), data.end(), []() {
+      return make_random<T>();
+   });
+
+   auto uncompressed_filename = create_temp_file(data.data(), data.size() * sizeof(T));
+   auto compressed_filename = create_temp_file(nullptr, 0);
+
+   BOOST_TEST(compressed_file::process(uncompressed_filename, compressed_filename, 512));
+
+   // threads read all of the offsets through one shared file, each from its own datastream
+   const auto compf = shared_compressed_file(compressed_filename);
+   std::atomic<uint32_t> mismatches = 0;
+   std::vector<std::thread> readers;
+   for (size_t t = 0; t < 4; t++) {
+      readers.emplace_back([&, t]() {
+         for (size_t i = t; i < data.size(); i += 4) {
+            auto ds = compf.create_datastream(i * sizeof(T));
+            T value;
+            ds.read(reinterpret_cast<char*>(&value), sizeof(T));
+            if (!(value == data.at(i)))
+               ++mismatches;
+         }
+      });
+   }
+   for (auto& r : readers)
+      r.join();
+   BOOST_TEST(mismatches.load() == 0u);
+
+   // reading past the end of the uncompressed data fails
+   auto ds = compf.create_datastream((data.size() - 1) * sizeof(T));
+   auto tail = std::vector<char>(2 * sizeof(T));
+   BOOST_REQUIRE_THROW(ds.read(tail.data(), tail.size()), std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -28,6 +28,10 @@ struct response_test_fixture {
       get_block_t get_block(uint32_t height) {
          return fixture.mock_get_block(height);
       }
+
+      get_actions_t get_actions(const action_filter& filter, uint32_t block_num_start, uint32_t block_num_end, uint32_t limit) {
+         return fixture.mock_get_actions(filter, block_num_start, block_num_end, limit);
+      }
       response_test_fixture& fixture;
    };
 
@@ -72,8 +76,13 @@ struct response_test_fixture {
       return response_impl.get_block_trace( block_height );
    }
 
+   fc::variant get_actions( const action_filter& filter, uint32_t block_num_start, uint32_t block_num_end, uint32_t limit ) {
+      return response_impl.get_actions( filter, block_num_start, block_num_end, limit );
+   }
+
    // fixture data and methods
    std::function<get_block_t(uint32_t)> mock_get_block;
+   std::function<get_actions_t(const action_filter&, uint32_t, uint32_t, uint32_t)> mock_get_actions;
    std::function<std::tuple<fc::variant, std::optional<fc::variant>>(const action_trace_v0&)> mock_data_handler_v0 = default_mock_data_handler_v0;
    std::function<std::tuple<fc::variant, std::optional<fc::variant>>(const action_trace_v1&)> mock_data_handler_v1 = default_mock_data_handler_v1;
 
@@ -952,4 +961,72 @@ BOOST_AUTO_TEST_SUITE(trace_responses)
 
    }
 
+   BOOST_FIXTURE_TEST_CASE(get_actions_response, response_test_fixture)
+   {
+      auto transaction_trace = transaction_trace_v1 { {
+         "0000000000000000000000000000000000000000000000000000000000000001"_h,
+         {
+            action_trace_v0 { 0, "receiver"_n, "contract"_n, "action"_n, {{ "alice"_n, "active"_n }}, { 0x00, 0x01 } },
+            action_trace_v0 { 1, "other"_n, "contract"_n, "action"_n, {{ "bob"_n, "active"_n }}, { 0x02, 0x03 } }
+         }},
+         fc::enum_type<uint8_t, chain::transaction_receipt_header::status_enum>{chain::transaction_receipt_header::status_enum::executed},
+         10,
+         5,
+         std::vector<chain::signature_type>{ chain::signature_type() },
+         { chain::time_point_sec(), 1, 0, 100, 50, 0 }
+      };
+
+      auto block_trace = block_trace_v1 {
+         {
+            "b000000000000000000000000000000000000000000000000000000000000001"_h,
+            7,
+            "0000000000000000000000000000000000000000000000000000000000000000"_h,
+            chain::block_timestamp_type(0),
+            "bp.one"_n
+         },
+         "0000000000000000000000000000000000000000000000000000000000000000"_h,
+         "0000000000000000000000000000000000000000000000000000000000000000"_h,
+         0,
+         {
+            transaction_trace
+         }
+      };
+
+      fc::variant expected_response = fc::mutable_variant_object()
+         ("actions", fc::variants({
+            fc::mutable_variant_object()
+               ("block_num", 7)
+               ("block_id", "b000000000000000000000000000000000000000000000000000000000000001")
+               ("timestamp", "2000-01-01T00:00:00.000Z")
+               ("transaction_id", "0000000000000000000000000000000000000000000000000000000000000001")
+               ("global_sequence", 1)
+               ("receiver", "other")
+               ("account", "contract")
+               ("action", "action")
+               ("authorization", fc::variants({
+                  fc::mutable_variant_object()
+                     ("account", "bob")
+                     ("permission", "active")
+               }))
+               ("data", "0203")
+               ("params", fc::mutable_variant_object()
+                     ("hex", "0203"))
+         }))
+         ("next_block_num", 9)
+      ;
+
+      mock_get_actions = [&block_trace]( const action_filter& filter, uint32_t block_num_start, uint32_t block_num_end, uint32_t limit ) -> get_actions_t {
+         BOOST_TEST((filter.receiver == std::optional<chain::name>("other"_n)));
+         BOOST_TEST(block_num_start == 1);
+         BOOST_TEST(block_num_end == 10);
+         BOOST_TEST(limit == 1);
+         return get_actions_t{ { { data_log_entry{block_trace}, std::vector<uint32_t>{1} } }, 9 };
+      };
+
+      fc::variant actual_response = get_actions( action_filter{ .receiver = "other"_n }, 1, 10, 1 );
+
+      BOOST_TEST(to_kv(expected_response) == to_kv(actual_response), boost::test_tools::per_element());
+   }
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,9 @@
 #include <eosio/trace_api/test_common.hpp>
 #include <eosio/trace_api/store_provider.hpp>
 
+#include <atomic>
+#include <thread>
+
 using namespace eosio;
 using namespace eosio::trace_api;
 using namespace eosio::trace_api::test_common;
@@ -1067,4 +1070,97 @@ BOOST_AUTO_TEST_SUITE(slice_tests)
    }
 
 
+   BOOST_FIXTURE_TEST_CASE(test_get_block_concurrent, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      store_provider sp(tempdir.path(), 100, std::optional<uint32_t>(), std::optional<uint32_t>(), 0, 1);
+      sp.append(block_trace1_v2);
+      sp.append_lib(1);
+      sp.append(block_trace2_v2);
+
+      // readers share the open slice files, a cache of one handle also exercises eviction and reopening
+      std::atomic<uint32_t> mismatches = 0;
+      std::vector<std::thread> readers;
+      for (int t = 0; t < 8; ++t) {
+         readers.emplace_back([&]() {
+            for (int i = 0; i < 100; ++i) {
+               get_block_t block1 = sp.get_block(1);
+               get_block_t block2 = sp.get_block(5);
+               if (!block1 || !std::get<1>(*block1) || !(std::get<block_trace_v2>(std::get<0>(*block1)) == block_trace1_v2))
+                  ++mismatches;
+               if (!block2 || std::get<1>(*block2) || !(std::get<block_trace_v2>(std::get<0>(*block2)) == block_trace2_v2))
+                  ++mismatches;
+            }
+         });
+      }
+      for (auto& r : readers)
+         r.join();
+      BOOST_REQUIRE_EQUAL(mismatches.load(), 0u);
+
+      // a block appended after the slice files were opened is read through the cached handles
+      auto block_trace3_v2 = block_trace2_v2;
+      block_trace3_v2.number = 7;
+      sp.append(block_trace3_v2);
+      get_block_t block3 = sp.get_block(7);
+      BOOST_REQUIRE(block3);
+      BOOST_REQUIRE_EQUAL(std::get<block_trace_v2>(std::get<0>(*block3)), block_trace3_v2);
+   }
+
+
+   BOOST_FIXTURE_TEST_CASE(test_get_actions, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      store_provider sp(tempdir.path(), 100, std::optional<uint32_t>(), std::optional<uint32_t>(), 0,
+                        slice_directory::default_max_open_read_only_slices, true);
+      sp.append(block_trace1_v2);
+      sp.append_lib(1);
+      sp.append(block_trace2_v2);
+
+      auto ordinals_of = [](const get_actions_t& r) {
+         std::vector<std::tuple<uint32_t, std::vector<uint32_t>>> result;
+         for (const auto& [trace, ordinals] : r.blocks)
+            result.emplace_back(std::get<block_trace_v2>(trace).number, ordinals);
+         return result;
+      };
+      using ordinals_t = std::vector<std::tuple<uint32_t, std::vector<uint32_t>>>;
+
+      auto r = sp.get_actions(action_filter{ .receiver = "receiver"_n, .action = "action"_n }, 0, 200, 100);
+      BOOST_REQUIRE(ordinals_of(r) == (ordinals_t{ {1, {0, 1, 2}}, {5, {0, 1, 2}} }));
+      BOOST_REQUIRE(!r.next_block_num);
+      BOOST_REQUIRE_EQUAL(std::get<block_trace_v2>(std::get<0>(r.blocks.at(1))), block_trace2_v2);
+
+      // the range is inclusive of both ends
+      r = sp.get_actions(action_filter{ .authorizer = "alice"_n }, 2, 5, 100);
+      BOOST_REQUIRE(ordinals_of(r) == (ordinals_t{ {5, {0, 1, 2}} }));
+
+      r = sp.get_actions(action_filter{ .authorizer = "bob"_n }, 0, 200, 100);
+      BOOST_REQUIRE(r.blocks.empty());
+
+      // the limit is checked between blocks
+      r = sp.get_actions(action_filter{}, 0, 200, 1);
+      BOOST_REQUIRE(ordinals_of(r) == (ordinals_t{ {1, {0, 1, 2}} }));
+      BOOST_REQUIRE(r.next_block_num && *r.next_block_num == 5);
+
+      // a block appended again after a fork replaces its earlier index entry
+      auto fork_trace = block_trace2_v2;
+      auto fork_transaction = transaction_trace;
+      std::get<std::vector<action_trace_v1>>(fork_transaction.actions).at(1).receiver = "other"_n;
+      fork_trace.transactions = std::vector<transaction_trace_v2>{ fork_transaction };
+      sp.append(fork_trace);
+      r = sp.get_actions(action_filter{ .receiver = "other"_n }, 0, 200, 100);
+      BOOST_REQUIRE(ordinals_of(r) == (ordinals_t{ {5, {1}} }));
+      r = sp.get_actions(action_filter{ .receiver = "receiver"_n }, 5, 5, 100);
+      BOOST_REQUIRE(ordinals_of(r) == (ordinals_t{ {5, {0, 2}} }));
+   }
+
+   BOOST_FIXTURE_TEST_CASE(test_get_actions_without_index, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      store_provider sp(tempdir.path(), 100, std::optional<uint32_t>(), std::optional<uint32_t>(), 0);
+      sp.append(block_trace1_v2);
+      BOOST_REQUIRE(!sp.has_action_index());
+      BOOST_REQUIRE(sp.get_actions(action_filter{}, 0, 200, 100).blocks.empty());
+   }
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -87,6 +87,10 @@ namespace {
          return store->get_block(height);
       }
 
+      get_actions_t get_actions(const action_filter& filter, uint32_t block_num_start, uint32_t block_num_end, uint32_t limit) {
+         return store->get_actions(filter, block_num_start, block_num_end, limit);
+      }
+
       void append_trx_ids(block_trxs_entry tt){
          store->append_trx_ids(std::move(tt));
       }
@@ -113,6 +117,12 @@ struct trace_api_common_impl {
       cfg_options("trace-minimum-uncompressed-irreversible-history-blocks", boost::program_options::value<int32_t>()->default_value(-1),
                   "Number of blocks to ensure are uncompressed past LIB. Compressed \"slice\" files are still accessible but may carry a performance loss on retrieval\n"
                   "A value of -1 indicates that automatic compression of \"slice\" files will be turned off.");
+      cfg_options("trace-max-open-slice-files", bpo::value<uint32_t>()->default_value(slice_directory::default_max_open_read_only_slices),
+                  "Number of \"slice\" files kept open for reading and shared between concurrent requests.\n"
+                  "A value of 0 opens the files for each request.");
+      cfg_options("trace-action-index", bpo::value<bool>()->default_value(false),
+                  "Write an action index alongside each \"slice\", mapping receiver, action name and authorizer to blocks.\n"
+                  "Required by /v1/trace_api/get_actions, which only searches slices written with the index.");
    }
 
    void plugin_initialize(const appbase::variables_map& options) {
@@ -141,12 +151,17 @@ struct trace_api_common_impl {
          minimum_uncompressed_irreversible_history_blocks = uncompressed_blocks;
       }
 
+      const uint32_t max_open_slice_files = options.at("trace-max-open-slice-files").as<uint32_t>();
+      action_index = options.at("trace-action-index").as<bool>();
+
       store = std::make_shared<store_provider>(
          trace_dir,
          slice_stride,
          minimum_irreversible_history_blocks,
          minimum_uncompressed_irreversible_history_blocks,
-         compression_seek_point_stride
+         compression_seek_point_stride,
+         max_open_slice_files,
+         action_index
       );
    }
 
@@ -166,9 +181,12 @@ struct trace_api_common_impl {
 
    std::optional<uint32_t> minimum_irreversible_history_blocks;
    std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks;
+   bool action_index = false;
 
    static constexpr int32_t manual_slice_file_value = -1;
    static constexpr uint32_t compression_seek_point_stride = 6 * 1024 * 1024; // 6 MiB strides for clog seek points
+   static constexpr uint32_t default_get_actions_limit = 100;
+   static constexpr uint32_t max_get_actions_limit = 1000;
 
    std::shared_ptr<store_provider> store;
 };
@@ -333,6 +351,71 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
              http_plugin::handle_exception("trace_api", "get_transaction", body, cb);
           }
       }});
+
+      if (common->action_index) {
+         http.add_async_handler({"/v1/trace_api/get_actions",
+               api_category::trace_api,
+               [wthis=weak_from_this()](std::string, std::string body, url_response_callback cb)
+         {
+            auto that = wthis.lock();
+            if (!that) {
+               return;
+            }
+
+            struct get_actions_params {
+               action_filter filter;
+               uint32_t      block_num_start = 0;
+               uint32_t      block_num_end = 0;
+               uint32_t      limit = trace_api_common_impl::default_get_actions_limit;
+            };
+
+            auto params = ([&body]() -> std::optional<get_actions_params> {
+               if (body.empty()) {
+                  return {};
+               }
+               try {
+                  auto input = fc::json::from_string(body);
+                  const auto& obj = input.get_object();
+                  get_actions_params p;
+                  const auto block_num_start = obj["block_num_start"].as_uint64();
+                  const auto block_num_end = obj["block_num_end"].as_uint64();
+                  if (block_num_start > block_num_end || block_num_end > std::numeric_limits<uint32_t>::max()) {
+                     return {};
+                  }
+                  p.block_num_start = block_num_start;
+                  p.block_num_end = block_num_end;
+                  if (obj.contains("limit")) {
+                     const auto limit = obj["limit"].as_uint64();
+                     if (limit == 0 || limit > trace_api_common_impl::max_get_actions_limit) {
+                        return {};
+                     }
+                     p.limit = limit;
+                  }
+                  if (obj.contains("receiver"))
+                     p.filter.receiver = chain::name(obj["receiver"].as_string());
+                  if (obj.contains("action"))
+                     p.filter.action = chain::name(obj["action"].as_string());
+                  if (obj.contains("authorizer"))
+                     p.filter.authorizer = chain::name(obj["authorizer"].as_string());
+                  return p;
+               } catch (...) {
+                  return {};
+               }
+            })();
+
+            if (!params) {
+               error_results results{400, "Bad or missing block_num_start, block_num_end, limit, receiver, action or authorizer"};
+               cb( 400, fc::variant( results ));
+               return;
+            }
+
+            try {
+               cb( 200, that->req_handler->get_actions(params->filter, params->block_num_start, params->block_num_end, params->limit) );
+            } catch (...) {
+               http_plugin::handle_exception("trace_api", "get_actions", body, cb);
+            }
+         }});
+      }
    }
 
    void plugin_shutdown() {
@@ -2,7 +2,11 @@
 #include <eosio/chain/abi_serializer.hpp>
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/config.hpp>
+#include <eosio/chain/controller.hpp>
 #include <eosio/chain/fork_database.hpp>
+#include <eosio/chain/log_catalog.hpp>
+#include <eosio/chain/snapshot.hpp>
+#include <eosio/chain/table_access_tracer.hpp>
 #include <memory>
 
 #include <fc/bitutil.hpp>
@@ -99,6 +103,17 @@ void blocklog_actions::setup(CLI::App& app) {
    merge_blocks->add_option("--blocks-dir", opt->blocks_dir, "The location of the blocks directory (absolute path or relative to the current directory).");
    merge_blocks->add_option("--output-dir", opt->output_dir, "The output directory for the merged block log.")->required();
 
+   // subcommand - compress blocks
+   auto* compress_blocks = sub->add_subcommand("compress-blocks", "Compress the block log files in 'blocks-dir' with the file pattern 'blocks-\\d+-\\d+.[log,index]' to 'blocks-\\d+-\\d+.zlog' "
+          "in the same directory. A node with 'blocks-dir' as its blocks-retained-dir reads blocks from the compressed files.")->callback([err_guard]() { err_guard(&blocklog_actions::compress_blocks); });
+   compress_blocks->add_option("--frame-blocks", opt->frame_blocks, "The number of consecutive blocks compressed together; a read decompresses all the blocks of its frame.")->capture_default_str();
+   compress_blocks->add_flag("--remove-original", opt->remove_original, "Remove each block log and index file once compressed.");
+
+   // subcommand - decompress blocks
+   auto* decompress_blocks = sub->add_subcommand("decompress-blocks", "Decompress the files in 'blocks-dir' with the file pattern 'blocks-\\d+-\\d+.zlog' to the original "
+          "'blocks-\\d+-\\d+.[log,index]' in the same directory.")->callback([err_guard]() { err_guard(&blocklog_actions::decompress_blocks); });
+   decompress_blocks->add_flag("--remove-original", opt->remove_original, "Remove each compressed file once decompressed.");
+
    // subcommand - smoke test
    sub->add_subcommand("smoke-test", "Quick test that blocks.log and blocks.index are well formed and agree with each other.")->callback([err_guard]() { err_guard(&blocklog_actions::smoke_test); });
 
@@ -108,6 +123,14 @@ void blocklog_actions::setup(CLI::App& app) {
    // subcommand - genesis
    auto* genesis = sub->add_subcommand("genesis", "Extract genesis_state from blocks.log as JSON")->callback([err_guard]() { err_guard(&blocklog_actions::do_genesis); });
    genesis->add_option("--output-file,-o", opt->output_file, "The file to write the output to (absolute or relative path).  If not specified then output is to stdout.");
+
+   // subcommand - parallelism
+   auto* parallelism = sub->add_subcommand("parallelism", "Replay a range of blocks.log recording the contract tables each transaction reads and writes, and report "
+          "the parallelism the conflicts between transactions allow. Replays from genesis or from 'snapshot' into a temporary state directory.")->callback([err_guard]() { err_guard(&blocklog_actions::parallelism); });
+   parallelism->add_option("--first,-f", opt->first_block, "The first block number to replay, 1 or at most the snapshot head block number + 1.")->required();
+   parallelism->add_option("--last,-l", opt->last_block, "The last block number to replay.")->required();
+   parallelism->add_option("--snapshot", opt->snapshot_file, "Snapshot to start from, required unless replaying from block 1.");
+   parallelism->add_option("--db-size", opt->db_size, "Maximum size (in MiB) of the chain state database")->capture_default_str();
 }
 
 void blocklog_actions::initialize() {
@@ -224,6 +247,69 @@ void blocklog_actions::extract_block_range(std::filesystem::path block_dir, std:
    rt.report();
 }
 
+int blocklog_actions::parallelism() {
+   EOS_ASSERT(opt->first_block == 1 || !opt->snapshot_file.empty(), block_log_exception,
+              "a snapshot is required unless replaying from block 1");
+
+   // replay a copy of the range so the block log in blocks-dir is never modified
+   fc::temp_directory dir;
+   const std::filesystem::path blocks_dir = dir.path() / "blocks";
+   std::filesystem::create_directories(blocks_dir);
+   extract_block_range(opt->blocks_dir, blocks_dir, opt->first_block, opt->last_block);
+   const std::string range = "blocks-" + std::to_string(opt->first_block) + "-" + std::to_string(opt->last_block);
+   std::filesystem::rename(blocks_dir / (range + ".log"), blocks_dir / "blocks.log");
+   std::filesystem::rename(blocks_dir / (range + ".index"), blocks_dir / "blocks.index");
+
+   controller::config cfg;
+   cfg.blocks_dir = blocks_dir;
+   cfg.state_dir = dir.path() / "state";
+   cfg.state_size = opt->db_size * 1024 * 1024;
+   cfg.state_guard_size = 1024 * 1024;
+   protocol_feature_set pfs = initialize_protocol_features(std::filesystem::path("protocol_features"), false);
+
+   table_access_tracer tracer;
+   report_time rt("replaying for parallelism");
+   {
+      auto check_shutdown = []() { return false; };
+      auto shutdown = []() {};
+
+      std::unique_ptr<controller> control;
+      if(!opt->snapshot_file.empty()) {
+         auto infile = std::ifstream(opt->snapshot_file, (std::ios::in | std::ios::binary));
+         auto reader = std::make_shared<istream_snapshot_reader>(infile);
+         reader->validate();
+         const auto chain_id = controller::extract_chain_id(*reader);
+         control = std::make_unique<controller>(cfg, std::move(pfs), chain_id);
+         control->add_indices();
+         control->enable_table_access_tracer(&tracer);
+         control->startup(shutdown, check_shutdown, reader);
+      } else {
+         auto context = block_log::extract_chain_context(blocks_dir, blocks_dir);
+         EOS_ASSERT(context && std::holds_alternative<genesis_state>(*context), block_log_exception,
+                    "block log in ${d} does not contain a genesis state", ("d", opt->blocks_dir));
+         const auto& gs = std::get<genesis_state>(*context);
+         control = std::make_unique<controller>(cfg, std::move(pfs), gs.compute_chain_id());
+         control->add_indices();
+         control->enable_table_access_tracer(&tracer);
+         control->startup(shutdown, check_shutdown, gs);
+      }
+   }
+   rt.report();
+
+   const auto& t = tracer.totals();
+   std::cout << "blocks:                       " << t.blocks << '\n'
+             << "transactions:                 " << t.trxs << '\n'
+             << "conflicts:                    " << t.conflicts << '\n'
+             << "waves:                        " << t.waves << '\n'
+             << "billed cpu us:                " << t.cpu_usage_us << '\n'
+             << "critical path cpu us:         " << t.critical_path_cpu_us << '\n';
+   if(t.waves > 0)
+      std::cout << "transactions per wave:        " << static_cast<double>(t.trxs) / t.waves << '\n';
+   if(t.critical_path_cpu_us > 0)
+      std::cout << "achievable cpu speedup:       " << static_cast<double>(t.cpu_usage_us) / t.critical_path_cpu_us << '\n';
+   return 0;
+}
+
 int blocklog_actions::smoke_test() {
    using namespace std;
    std::filesystem::path block_dir = opt->blocks_dir;
@@ -358,4 +444,30 @@ int blocklog_actions::split_blocks() {
 int blocklog_actions::merge_blocks() {
    block_log::merge_blocklogs(opt->blocks_dir, opt->output_dir);
    return 0;
-}
\ No newline at end of file
+}
+
+int blocklog_actions::compress_blocks() {
+   std::vector<std::filesystem::path> files;
+   for_each_file_in_dir_matches(opt->blocks_dir, R"(blocks-\d+-\d+\.log)", [&](std::filesystem::path p) { files.push_back(std::move(p)); });
+   for(const auto& f : files) {
+      block_log::compress_blocklog(f, opt->frame_blocks);
+      if(opt->remove_original) {
+         std::filesystem::remove(f);
+         std::filesystem::remove(std::filesystem::path(f).replace_extension("index"));
+      }
+   }
+   std::cout << "compressed " << files.size() << " block log files" << std::endl;
+   return 0;
+}
+
+int blocklog_actions::decompress_blocks() {
+   std::vector<std::filesystem::path> files;
+   for_each_file_in_dir_matches(opt->blocks_dir, R"(blocks-\d+-\d+\.zlog)", [&](std::filesystem::path p) { files.push_back(std::move(p)); });
+   for(const auto& f : files) {
+      block_log::decompress_blocklog(f);
+      if(opt->remove_original)
+         std::filesystem::remove(f);
+   }
+   std::cout << "decompressed " << files.size() << " block log files" << std::endl;
+   return 0;
+}
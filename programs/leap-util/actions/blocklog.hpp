@@ -11,10 +11,14 @@ struct blocklog_options {
    uint32_t last_block = std::numeric_limits<uint32_t>::max();
    std::string output_dir = "";
    uint32_t stride = 100000;
+   std::string snapshot_file = "";
+   uint64_t db_size = 65536ull;
+   uint32_t frame_blocks = 64;
 
    // flags
    bool no_pretty_print = false;
    bool as_json_array = false;
+   bool remove_original = false;
 
    block_log_config blog_conf;
 };
@@ -37,7 +41,10 @@ protected:
    int do_vacuum();
    int do_genesis();
    int read_log();
+   int parallelism();
 
    int split_blocks();
    int merge_blocks();
+   int compress_blocks();
+   int decompress_blocks();
 };
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/state_checkpoint.hpp>
 #include <chainbase/environment.hpp>
 
 #include <boost/algorithm/string.hpp>
@@ -50,6 +51,46 @@ void chain_actions::setup(CLI::App& app) {
       // properly return err code in main
       if(rc) throw(CLI::RuntimeError(rc));
    });
+
+   // callback helper with error code handling
+   auto err_guard = [this](int (chain_actions::*fun)()) {
+      try {
+         int rc = (this->*fun)();
+         if(rc) throw(CLI::RuntimeError(rc));
+      } catch(const CLI::RuntimeError&) {
+         throw;
+      } catch(...) {
+         print_exception();
+         throw(CLI::RuntimeError(-1));
+      }
+   };
+
+   auto* verify = sub->add_subcommand("checkpoint-verify", "verify a state checkpoint and the checkpoints it applies on top of");
+   verify->add_option("--checkpoint-dir", opt->checkpoint_dir, "The location of the state checkpoints directory (absolute path or relative to the current directory)")->required();
+   verify->add_option("--seq", opt->checkpoint_seq, "The sequence number of the checkpoint, the latest one if not specified");
+   verify->callback([err_guard]() { err_guard(&chain_actions::run_subcommand_checkpoint_verify); });
+
+   auto* restore = sub->add_subcommand("checkpoint-restore", "verify and restore a state checkpoint into an empty state directory");
+   restore->add_option("--checkpoint-dir", opt->checkpoint_dir, "The location of the state checkpoints directory (absolute path or relative to the current directory)")->required();
+   restore->add_option("--seq", opt->checkpoint_seq, "The sequence number of the checkpoint, the latest one if not specified");
+   restore->add_option("--blocks-dir", opt->checkpoint_blocks_dir, "The location of the blocks directory whose fork database is replaced (absolute path or relative to the current directory)");
+   restore->callback([err_guard]() { err_guard(&chain_actions::run_subcommand_checkpoint_restore); });
+}
+
+std::filesystem::path chain_actions::state_dir() const {
+   // default state dir, if none specified
+   if(opt->sstate_state_dir.empty()) {
+      auto root = fc::app_path();
+      auto default_data_dir = root / "eosio" / "nodeos" / "data" ;
+      return default_data_dir / config::default_state_dir_name;
+   }
+
+   // adjust if path relative
+   std::filesystem::path state_dir = opt->sstate_state_dir;
+   if(state_dir.is_relative()) {
+      state_dir = std::filesystem::current_path() / state_dir;
+   }
+   return state_dir;
 }
 
 int chain_actions::run_subcommand_build() {
@@ -69,21 +110,7 @@ int chain_actions::run_subcommand_build() {
 }
 
 int chain_actions::run_subcommand_sstate() {
-   std::filesystem::path state_dir = "";
-
-   // default state dir, if none specified
-   if(opt->sstate_state_dir.empty()) {
-      auto root = fc::app_path();
-      auto default_data_dir = root / "eosio" / "nodeos" / "data" ;
-      state_dir  = default_data_dir / config::default_state_dir_name;
-   }
-   else {
-      // adjust if path relative
-      state_dir = opt->sstate_state_dir;
-      if(state_dir.is_relative()) {
-         state_dir = std::filesystem::current_path() / state_dir;
-      }
-   }
+   const std::filesystem::path state_dir = this->state_dir();
 
    auto shared_mem_path = state_dir / "shared_memory.bin";
 
@@ -113,4 +140,36 @@ int chain_actions::run_subcommand_sstate() {
 
    std::cout << "Database state is clean" << std::endl;
    return 0;
-}
\ No newline at end of file
+}
+
+int chain_actions::run_subcommand_checkpoint_verify() {
+   std::optional<uint64_t> seq;
+   if(opt->checkpoint_seq)
+      seq = opt->checkpoint_seq;
+
+   auto chain = verify_state_checkpoint(opt->checkpoint_dir, seq);
+   for(const auto& info : chain) {
+      std::cout << (info.parent_seq ? "incremental" : "full") << " checkpoint " << info.seq << " at block " << info.head_block_num
+                << " " << info.head_block_id.str() << ", " << info.num_chunks << " chunks: ok" << std::endl;
+   }
+   std::cout << "State checkpoint " << chain.back().seq << " is valid" << std::endl;
+   return 0;
+}
+
+int chain_actions::run_subcommand_checkpoint_restore() {
+   std::optional<uint64_t> seq;
+   if(opt->checkpoint_seq)
+      seq = opt->checkpoint_seq;
+
+   const std::filesystem::path state_dir = this->state_dir();
+   std::filesystem::path blocks_dir = opt->checkpoint_blocks_dir;
+   if(blocks_dir.empty())
+      blocks_dir = state_dir.parent_path() / config::default_blocks_dir_name;
+   else if(blocks_dir.is_relative())
+      blocks_dir = std::filesystem::current_path() / blocks_dir;
+
+   auto info = restore_state_checkpoint(opt->checkpoint_dir, seq, state_dir, blocks_dir / config::reversible_blocks_dir_name);
+   std::cout << "Restored state checkpoint " << info.seq << " at block " << info.head_block_num << " " << info.head_block_id.str()
+             << " into " << state_dir << std::endl;
+   return 0;
+}
@@ -1,9 +1,13 @@
 #include "subcommand.hpp"
+#include <filesystem>
 
 struct chain_options {
    bool build_just_print = false;
    std::string build_output_file = "";
    std::string sstate_state_dir = "";
+   std::string checkpoint_dir = "";
+   uint64_t checkpoint_seq = 0;
+   std::string checkpoint_blocks_dir = "";
 };
 
 class chain_actions : public sub_command<chain_options> {
@@ -14,4 +18,9 @@ public:
    // callbacks
    int run_subcommand_build();
    int run_subcommand_sstate();
+   int run_subcommand_checkpoint_verify();
+   int run_subcommand_checkpoint_restore();
+
+protected:
+   std::filesystem::path state_dir() const;
 };
\ No newline at end of file
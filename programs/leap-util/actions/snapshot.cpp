@@ -5,11 +5,18 @@
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/fork_database.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
 #include <memory>
+#include <optional>
+#include <thread>
 
 #include <fc/bitutil.hpp>
 #include <fc/filesystem.hpp>
 #include <fc/io/json.hpp>
+#include <fc/scoped_exit.hpp>
 #include <fc/variant.hpp>
 
 #include <boost/exception/diagnostic_information.hpp>
@@ -17,6 +24,44 @@
 using namespace eosio;
 using namespace eosio::chain;
 
+namespace {
+
+/// calls f(i) for each i in [0, n) on up to threads threads, then rethrows the exception of the lowest failed i
+template<typename F>
+void parallel_for(size_t n, uint32_t threads, F&& f) {
+   std::atomic<size_t> next = 0;
+   std::vector<std::exception_ptr> errors(n);
+   auto work = [&]() {
+      for(size_t i = next++; i < n; i = next++) {
+         try {
+            f(i);
+         } catch(...) {
+            errors[i] = std::current_exception();
+         }
+      }
+   };
+
+   std::vector<std::thread> workers;
+   for(size_t t = 1; t < std::min<size_t>(threads, n); ++t)
+      workers.emplace_back(work);
+   work();
+   for(auto& w : workers)
+      w.join();
+
+   for(auto& e : errors) {
+      if(e)
+         std::rethrow_exception(e);
+   }
+}
+
+std::vector<istream_snapshot_reader::section_info> list_snapshot_sections(const std::filesystem::path& snapshot_path) {
+   std::ifstream infile(snapshot_path, std::ios::in | std::ios::binary);
+   istream_snapshot_reader reader(infile);
+   reader.validate();
+   return reader.list_sections();
+}
+
+} // namespace
 
 void snapshot_actions::setup(CLI::App& app) {
    auto* sub = app.add_subcommand("snapshot", "Snapshot utility");
@@ -29,6 +74,9 @@ void snapshot_actions::setup(CLI::App& app) {
    to_json->add_option("--output-file,-o", opt->output_file, "The file to write the output to (absolute or relative path).  If not specified then output is to <input-file>.json.");
    to_json->add_option("--chain-id", opt->chain_id, "Specify a chain id in case it is not included in a snapshot or you want to override it.");
    to_json->add_option("--db-size", opt->db_size, "Maximum size (in MiB) of the chain state database")->capture_default_str();
+   to_json->add_flag("--stream", opt->stream, "Decode the snapshot row by row straight to json instead of loading it into a temporary state database. "
+                     "Memory use does not grow with the snapshot; snapshots older than v3.0.0 are not supported.");
+   to_json->add_option("--threads", opt->threads, "The number of sections decoded in parallel with --stream.")->capture_default_str();
 
    to_json->callback([this]() {
       try {
@@ -39,6 +87,42 @@ void snapshot_actions::setup(CLI::App& app) {
          throw(CLI::RuntimeError(-1));
       }
    });
+
+   // subcommand - compare two snapshots
+   auto diff_cmd = sub->add_subcommand("diff", "Compare two snapshot files section by section by the hash of each section's rows, without loading either. "
+                                       "Fails if they differ.");
+   diff_cmd->add_option("--input-file,-i", opt->input_file, "The first snapshot file to compare.")->required();
+   diff_cmd->add_option("--compare-file,-c", opt->compare_file, "The second snapshot file to compare.")->required();
+   diff_cmd->add_option("--threads", opt->threads, "The number of sections hashed in parallel.")->capture_default_str();
+
+   diff_cmd->callback([this]() {
+      try {
+         int rc = this->diff();
+         if(rc) throw(CLI::RuntimeError(rc));
+      } catch(...) {
+         print_exception();
+         throw(CLI::RuntimeError(-1));
+      }
+   });
+
+   // subcommand - rewrite a snapshot in another binary format version
+   auto convert_cmd = sub->add_subcommand("convert", "Rewrite a binary snapshot in the given binary snapshot version, without loading it. "
+                                          "Version 1 is read by all nodes, version 2 packs rows in blocks.");
+   convert_cmd->add_option("--input-file,-i", opt->input_file, "The snapshot file to convert.")->required();
+   convert_cmd->add_option("--output-file,-o", opt->output_file, "The file to write the converted snapshot to.")->required();
+   convert_cmd->add_option("--version", opt->version, "The binary snapshot version to write.")
+      ->check(CLI::Range(ostream_snapshot_writer::minimum_version, ostream_snapshot_writer::current_version))
+      ->capture_default_str();
+
+   convert_cmd->callback([this]() {
+      try {
+         int rc = this->convert();
+         if(rc) throw(CLI::RuntimeError(rc));
+      } catch(...) {
+         print_exception();
+         throw(CLI::RuntimeError(-1));
+      }
+   });
 }
 
 int snapshot_actions::run_subcommand() {
@@ -54,6 +138,9 @@ int snapshot_actions::run_subcommand() {
    std::filesystem::path json_path = opt->output_file.empty()
                                ? snapshot_path.generic_string() + ".json"
                                : opt->output_file;
+   if(opt->stream)
+      return stream_to_json(snapshot_path, json_path);
+
    // determine chain id
    auto chain_id = chain_id_type("");
    if(!opt->chain_id.empty()) { // override it
@@ -111,3 +198,137 @@ int snapshot_actions::run_subcommand() {
    ilog("Completed writing snapshot: ${s}", ("s", json_path));
    return 0;
 }
+
+int snapshot_actions::stream_to_json(const std::filesystem::path& snapshot_path, const std::filesystem::path& json_path) {
+   const auto sections = list_snapshot_sections(snapshot_path);
+
+   // each section is decoded through its own reader to its own part file next to json_path, so that the parts are
+   // on the filesystem of the output: the first part, which starts with the header, is renamed to json_path and the
+   // others are appended to it in file order
+   auto part_path = [&](size_t i) { return std::filesystem::path(json_path.generic_string() + ".part" + std::to_string(i)); };
+   auto remove_parts = fc::make_scoped_exit([&]() {
+      std::error_code ec;
+      for(size_t i = 0; i < sections.size(); ++i)
+         std::filesystem::remove(part_path(i), ec);
+   });
+
+   parallel_for(sections.size(), opt->threads, [&](size_t i) {
+      std::ifstream infile(snapshot_path, std::ios::in | std::ios::binary);
+      istream_snapshot_reader reader(infile);
+      std::ofstream part(part_path(i), std::ios::out | std::ios::trunc);
+      ostream_json_snapshot_writer writer(part, i == 0);
+      controller::copy_snapshot(reader, writer, [&](const std::string& name) { return name == sections[i].name; });
+      part.flush();
+      FC_ASSERT(part.good(), "Failed to write section ${s} to ${p}", ("s", sections[i].name)("p", part_path(i)));
+   });
+
+   ilog("Writing snapshot: ${s}", ("s", json_path));
+   FC_ASSERT(!sections.empty(), "Snapshot ${s} has no sections", ("s", snapshot_path));
+   std::filesystem::rename(part_path(0), json_path);
+   auto snap_out = std::ofstream(json_path.generic_string(), std::ios::out | std::ios::app);
+   for(size_t i = 1; i < sections.size(); ++i) {
+      {
+         std::ifstream part(part_path(i), std::ios::in);
+         if(part.peek() == std::ifstream::traits_type::eof()) {
+            wlog("Skipping unknown snapshot section ${s}", ("s", sections[i].name));
+         } else {
+            snap_out << part.rdbuf();
+         }
+      }
+      std::filesystem::remove(part_path(i));
+   }
+   ostream_json_snapshot_writer writer(snap_out, false);
+   writer.finalize();
+   FC_ASSERT(snap_out.good(), "Failed to write ${s}", ("s", json_path));
+   snap_out.close();
+
+   ilog("Completed writing snapshot: ${s}", ("s", json_path));
+   return 0;
+}
+
+int snapshot_actions::diff() {
+   const std::filesystem::path paths[] = {opt->input_file, opt->compare_file};
+   for(const auto& p : paths) {
+      if(!std::filesystem::exists(p)) {
+         std::cerr << "cannot load snapshot, " << p << " does not exist" << std::endl;
+         return -1;
+      }
+   }
+
+   struct section_diff {
+      std::string                                          name;
+      std::optional<istream_snapshot_reader::section_info> info[2];
+      fc::sha256                                           hash[2];
+   };
+
+   // sections in the file order of the first snapshot, followed by those only in the second
+   std::vector<section_diff> sections;
+   for(int f = 0; f < 2; ++f) {
+      for(auto& s : list_snapshot_sections(paths[f])) {
+         auto itr = std::find_if(sections.begin(), sections.end(), [&](const auto& d) { return d.name == s.name; });
+         if(itr == sections.end())
+            itr = sections.insert(sections.end(), section_diff{s.name});
+         itr->info[f] = std::move(s);
+      }
+   }
+
+   // sections of different sizes differ without hashing them
+   std::vector<std::pair<size_t, int>> to_hash;
+   for(size_t i = 0; i < sections.size(); ++i) {
+      const auto& d = sections[i];
+      if(d.info[0] && d.info[1] && d.info[0]->size == d.info[1]->size) {
+         to_hash.emplace_back(i, 0);
+         to_hash.emplace_back(i, 1);
+      }
+   }
+   parallel_for(to_hash.size(), opt->threads, [&](size_t i) {
+      auto [s, f] = to_hash[i];
+      std::ifstream infile(paths[f], std::ios::in | std::ios::binary);
+      istream_snapshot_reader reader(infile);
+      sections[s].hash[f] = reader.hash_section(sections[s].name);
+   });
+
+   uint32_t differing = 0;
+   for(const auto& d : sections) {
+      if(!d.info[0] || !d.info[1]) {
+         ++differing;
+         std::cout << "only in " << (d.info[0] ? "first " : "second") << "  " << d.name << std::endl;
+      } else if(d.info[0]->size != d.info[1]->size || d.hash[0] != d.hash[1]) {
+         ++differing;
+         std::cout << "differs      " << d.name << "  rows: " << d.info[0]->row_count << " vs " << d.info[1]->row_count
+                   << "  bytes: " << d.info[0]->size << " vs " << d.info[1]->size << std::endl;
+      } else {
+         std::cout << "equal        " << d.name << "  rows: " << d.info[0]->row_count << "  sha256: " << d.hash[0].str() << std::endl;
+      }
+   }
+
+   if(differing) {
+      std::cout << differing << " of " << sections.size() << " sections differ" << std::endl;
+      return 1;
+   }
+   std::cout << "all " << sections.size() << " sections are equal" << std::endl;
+   return 0;
+}
+
+int snapshot_actions::convert() {
+   if(!std::filesystem::exists(opt->input_file)) {
+      std::cerr << "cannot load snapshot, " << opt->input_file << " does not exist" << std::endl;
+      return -1;
+   }
+
+   std::ifstream infile(opt->input_file, std::ios::in | std::ios::binary);
+   istream_snapshot_reader reader(infile);
+   reader.validate();
+
+   ilog("Writing snapshot version ${v}: ${s}", ("v", opt->version)("s", opt->output_file));
+   std::ofstream snap_out(opt->output_file, std::ios::out | std::ios::binary | std::ios::trunc);
+   ostream_snapshot_writer writer(snap_out, opt->version);
+   controller::copy_snapshot(reader, writer, [](const std::string&) { return true; });
+   writer.finalize();
+   snap_out.flush();
+   FC_ASSERT(snap_out.good(), "Failed to write ${s}", ("s", opt->output_file));
+   snap_out.close();
+
+   ilog("Completed writing snapshot: ${s}", ("s", opt->output_file));
+   return 0;
+}
@@ -1,4 +1,5 @@
 #include "subcommand.hpp"
+#include <filesystem>
 
 struct snapshot_options {
    std::string input_file = "";
@@ -6,6 +7,12 @@ struct snapshot_options {
    uint64_t db_size = 65536ull;
    uint64_t guard_size = 1;
    std::string chain_id = "";
+   std::string compare_file = "";
+   uint32_t threads = 4;
+   uint32_t version = 1;
+
+   // flags
+   bool stream = false;
 };
 
 class snapshot_actions : public sub_command<snapshot_options> {
@@ -15,4 +22,9 @@ public:
 
    // callbacks
    int run_subcommand();
+   int diff();
+   int convert();
+
+protected:
+   int stream_to_json(const std::filesystem::path& snapshot_path, const std::filesystem::path& json_path);
 };
\ No newline at end of file
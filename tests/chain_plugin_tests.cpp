@@ -260,4 +260,55 @@ BOOST_FIXTURE_TEST_CASE( get_account, validating_tester ) try {
    }
 } FC_LOG_AND_RETHROW() /// get_account
 
+BOOST_FIXTURE_TEST_CASE( batch, validating_tester ) try {
+   produce_blocks(2);
+
+   std::vector<account_name> accs{{ "alice"_n, "bob"_n }};
+   create_accounts(accs, false, false);
+
+   produce_block();
+
+   chain_apis::read_only plugin(*(this->control), {}, fc::microseconds::maximum(), fc::microseconds::maximum(), nullptr);
+
+   chain_apis::read_only::batch_params params{
+      { "get_account", mutable_variant_object()("account_name", "alice") },
+      { "get_info", mutable_variant_object() },
+      { "get_account", mutable_variant_object()("account_name", "bob") },
+      { "get_account", mutable_variant_object()("account_name", "nosuchacct") },
+      { "no_such_api", mutable_variant_object() },
+      { "get_code_hash", mutable_variant_object()("account_name", "bob") }
+   };
+
+   auto res = plugin.batch(params, fc::time_point::maximum())();
+   BOOST_REQUIRE(!std::holds_alternative<fc::exception_ptr>(res));
+   auto result = std::get<chain_apis::read_only::batch_results>(std::move(res));
+
+   BOOST_REQUIRE_EQUAL(control->head_block_num(), result.head_block_num);
+   BOOST_REQUIRE_EQUAL(control->head_block_id(), result.head_block_id);
+   BOOST_REQUIRE_EQUAL(params.size(), result.results.size());
+
+   auto alice = result.results[0].as<chain_apis::read_only::get_account_results>();
+   BOOST_REQUIRE_EQUAL("alice"_n, alice.account_name);
+   BOOST_REQUIRE_EQUAL(2, alice.permissions.size());
+
+   auto info = result.results[1].as<chain_apis::read_only::get_info_results>();
+   BOOST_REQUIRE_EQUAL(result.head_block_num, info.head_block_num);
+
+   auto bob = result.results[2].as<chain_apis::read_only::get_account_results>();
+   BOOST_REQUIRE_EQUAL("bob"_n, bob.account_name);
+
+   // failed calls are reported in place and do not fail the batch
+   BOOST_REQUIRE(result.results[3].get_object().contains("error"));
+   BOOST_REQUIRE(result.results[4].get_object().contains("error"));
+
+   auto code_hash = result.results[5].as<chain_apis::read_only::get_code_hash_results>();
+   BOOST_REQUIRE_EQUAL("bob"_n, code_hash.account_name);
+
+   // too many calls
+   chain_apis::read_only::batch_params too_many(chain_apis::read_only::max_batch_calls + 1,
+                                                { "get_info", mutable_variant_object() });
+   BOOST_REQUIRE_THROW(plugin.batch(too_many, fc::time_point::maximum()), chain::invalid_http_request);
+
+} FC_LOG_AND_RETHROW() /// batch
+
 BOOST_AUTO_TEST_SUITE_END()
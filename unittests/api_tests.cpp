@@ -1028,6 +1028,7 @@ BOOST_AUTO_TEST_CASE(checktime_pause_max_trx_cpu_extended_test) { try {
    cfg.max_transaction_cpu_usage  = 24'999; // needs to be large enough for create_account and set_code
    cfg.min_transaction_cpu_usage  = 1;
 
+   conf_genesis.first.wasm_preinstantiate = false; // first call is expected to pay for the wasm load
    tester t( conf_genesis.first, conf_genesis.second );
    if( t.get_config().wasm_runtime == wasm_interface::vm_type::eos_vm_oc ) {
       // eos_vm_oc wasm_runtime does not tier-up and completes compile before continuing execution.
@@ -1094,6 +1095,7 @@ BOOST_AUTO_TEST_CASE(checktime_pause_max_trx_extended_test) { try {
    cfg.max_transaction_cpu_usage  = 250'000; // needs to be large enough for create_account and set_code
    cfg.min_transaction_cpu_usage  = 1;
 
+   conf_genesis.first.wasm_preinstantiate = false; // first call is expected to pay for the wasm load
    tester t( conf_genesis.first, conf_genesis.second );
    if( t.get_config().wasm_runtime == wasm_interface::vm_type::eos_vm_oc ) {
       // eos_vm_oc wasm_runtime does not tier-up and completes compile before continuing execution.
@@ -1156,11 +1158,11 @@ BOOST_AUTO_TEST_CASE(checktime_pause_block_deadline_not_extended_test) { try {
    t.produce_blocks(1);
 
    // Test block deadline is not extended when it is the limiting factor
-   // Specify large enough time so that WASM is completely loaded.
+   // Specify large enough time so that WASM is completely loaded, whether by the first call or preinstantiated by setcode.
 
-   BOOST_TEST( !t.is_code_cached("pause"_n) );
+   BOOST_TEST( (!t.is_code_cached("pause"_n) || t.is_code_preinstantiated("pause"_n)) ); // not applied yet
 
-   // First call to contract which should cause the WASM to load and trx_context.pause_billing_timer() to be called.
+   // First call to contract which may cause the WASM to load and trx_context.pause_billing_timer() to be called.
    auto before = fc::time_point::now();
    BOOST_CHECK_EXCEPTION( call_test( t, test_pause_action<TEST_METHOD("test_checktime", "checktime_failure")>{},
                                      0, 150, 75, fc::raw::pack(10000000000000000000ULL), "pause"_n ),
@@ -1189,6 +1191,7 @@ BOOST_AUTO_TEST_CASE(checktime_pause_block_deadline_not_extended_while_loading_t
    cfg.max_transaction_cpu_usage  = 250'000; // needs to be large enough for create_account and set_code
    cfg.min_transaction_cpu_usage  = 1;
 
+   conf_genesis.first.wasm_preinstantiate = false; // first call is expected to pay for the wasm load
    tester t( conf_genesis.first, conf_genesis.second );
    if( t.get_config().wasm_runtime == wasm_interface::vm_type::eos_vm_oc ) {
       // eos_vm_oc wasm_runtime does not tier-up and completes compile before continuing execution.
@@ -1278,7 +1281,7 @@ BOOST_FIXTURE_TEST_CASE(checktime_intrinsic, validating_tester) { try {
 	set_code( "testapi"_n, ss.str().c_str() );
 	produce_blocks(1);
 
-        BOOST_TEST( !is_code_cached("testapi"_n) );
+        BOOST_TEST( (!is_code_cached("testapi"_n) || is_code_preinstantiated("testapi"_n)) ); // not applied yet
 
         //initialize cache
         BOOST_CHECK_EXCEPTION( call_test( *this, test_api_action<TEST_METHOD("doesn't matter", "doesn't matter")>{},
@@ -1317,7 +1320,7 @@ BOOST_FIXTURE_TEST_CASE(checktime_grow_memory, validating_tester) { try {
 	set_code( "testapi"_n, ss.str().c_str() );
 	produce_blocks(1);
 
-        BOOST_TEST( !is_code_cached("testapi"_n) );
+        BOOST_TEST( (!is_code_cached("testapi"_n) || is_code_preinstantiated("testapi"_n)) ); // not applied yet
 
         //initialize cache
         BOOST_CHECK_EXCEPTION( call_test( *this, test_api_action<TEST_METHOD("doesn't matter", "doesn't matter")>{},
@@ -1339,7 +1342,7 @@ BOOST_FIXTURE_TEST_CASE(checktime_hashing_fail, validating_tester) { try {
 	set_code( "testapi"_n, test_contracts::test_api_wasm() );
 	produce_blocks(1);
 
-        BOOST_TEST( !is_code_cached("testapi"_n) );
+        BOOST_TEST( (!is_code_cached("testapi"_n) || is_code_preinstantiated("testapi"_n)) ); // not applied yet
 
         //hit deadline exception, but cache the contract
         BOOST_CHECK_EXCEPTION( call_test( *this, test_api_action<TEST_METHOD("test_checktime", "checktime_sha1_failure")>{},
@@ -1,3 +1,4 @@
+#include <eosio/chain/action_profiler.hpp>
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/permission_object.hpp>
@@ -185,4 +186,29 @@ BOOST_AUTO_TEST_CASE( signal_validated_blocks ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_AUTO_TEST_CASE( action_profiler_test ) try {
+   tester chain;
+   action_profiler profiler;
+   chain.control->enable_action_profiler(&profiler);
+   BOOST_REQUIRE(chain.control->get_action_profiler() == &profiler);
+
+   chain.create_accounts({"alice"_n, "bob"_n});
+   chain.produce_block();
+
+   auto entries = profiler.top(10);
+   auto newaccount = std::find_if(entries.begin(), entries.end(), [](const auto& e) {
+      return e.receiver == config::system_account_name && e.action == "newaccount"_n;
+   });
+   BOOST_REQUIRE(newaccount != entries.end());
+   BOOST_CHECK_EQUAL(newaccount->totals.count, 2u);
+   BOOST_CHECK_GT(newaccount->totals.ram_delta, 0);
+   BOOST_CHECK_GT(newaccount->totals.cpu_billed_us, 0u);
+
+   // sorted by wall time, highest first
+   for (size_t i = 1; i < entries.size(); ++i)
+      BOOST_CHECK_GE(entries[i-1].totals.wall_time_us, entries[i].totals.wall_time_us);
+   BOOST_CHECK_EQUAL(profiler.top(1).size(), 1u);
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #include <eosio/testing/tester.hpp>
 #include <eosio/chain/abi_serializer.hpp>
 #include <eosio/chain/generated_transaction_object.hpp>
+#include <eosio/chain/table_access_tracer.hpp>
 
 #include <fc/variant_object.hpp>
 #include <fc/io/json.hpp>
@@ -585,4 +586,29 @@ BOOST_FIXTURE_TEST_CASE( test_input_quantity, currency_tester ) try {
 
 } FC_LOG_AND_RETHROW() /// test_currency
 
+BOOST_FIXTURE_TEST_CASE( table_access_tracing, currency_tester ) try {
+   create_accounts( {"alice"_n, "bob"_n, "carl"_n, "dave"_n} );
+   transfer(eosio_token, "alice"_n, "100.0000 CUR");
+   transfer(eosio_token, "carl"_n, "100.0000 CUR");
+
+   table_access_tracer tracer;
+   control->enable_table_access_tracer(&tracer);
+   produce_block();
+   const auto before = tracer.totals();
+
+   // alice -> bob and carl -> dave only share the read of the stat table, bob -> carl depends on both
+   push_action("alice"_n, "transfer"_n, mutable_variant_object()("from", "alice"_n)("to", "bob"_n)("quantity", "10.0000 CUR")("memo", ""));
+   push_action("carl"_n, "transfer"_n, mutable_variant_object()("from", "carl"_n)("to", "dave"_n)("quantity", "10.0000 CUR")("memo", ""));
+   push_action("bob"_n, "transfer"_n, mutable_variant_object()("from", "bob"_n)("to", "carl"_n)("quantity", "5.0000 CUR")("memo", ""));
+   produce_block();
+
+   const auto& after = tracer.totals();
+   BOOST_TEST( after.blocks - before.blocks == 1u );
+   BOOST_TEST( after.trxs - before.trxs == 3u );
+   BOOST_TEST( after.waves - before.waves == 2u );
+   BOOST_TEST( after.conflicts - before.conflicts == 2u );
+   BOOST_TEST( after.critical_path_cpu_us - before.critical_path_cpu_us < after.cpu_usage_us - before.cpu_usage_us );
+
+} FC_LOG_AND_RETHROW() /// table_access_tracing
+
 BOOST_AUTO_TEST_SUITE_END()
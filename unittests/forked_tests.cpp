@@ -562,6 +562,35 @@ BOOST_AUTO_TEST_CASE( reopen_forkdb ) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_AUTO_TEST_CASE( forkdb_journal_survives_crash ) try {
+   tester c;
+
+   c.create_accounts( {"alice"_n,"bob"_n,"carol"_n} );
+   c.produce_block();
+   c.set_producers( {"alice"_n,"bob"_n,"carol"_n} );
+   c.produce_blocks(2);
+   produce_until_transition( c, "carol"_n, "alice"_n );
+   c.produce_blocks(3);
+
+   BOOST_REQUIRE( c.control->fork_db_head_block_num() > c.control->last_irreversible_block_num() + 1 );
+
+   // copy the fork database while the chain is running, as left behind by a crash
+   fc::temp_directory crashed;
+   for( const auto& entry : std::filesystem::directory_iterator( c.get_config().blocks_dir / config::reversible_blocks_dir_name ) )
+      std::filesystem::copy_file( entry.path(), crashed.path() / entry.path().filename() );
+
+   fork_database fork_db( crashed.path() );
+   fork_db.open( []( block_timestamp_type timestamp,
+                     const flat_set<digest_type>& cur_features,
+                     const vector<digest_type>& new_features ) {} );
+
+   BOOST_REQUIRE( fork_db.head() );
+   BOOST_CHECK_EQUAL( fork_db.head()->id, c.control->fork_db_head_block_id() );
+   BOOST_CHECK_EQUAL( fork_db.root()->id, c.control->last_irreversible_block_id() );
+   BOOST_CHECK_EQUAL( fork_db.fetch_branch( fork_db.head()->id ).size(),
+                      c.control->fork_db_head_block_num() - c.control->last_irreversible_block_num() );
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_CASE( push_block_returns_forked_transactions ) try {
    tester c;
    while (c.control->head_block_num() < 3) {
@@ -1,3 +1,4 @@
+#include <fstream>
 #include <sstream>
 
 #include <eosio/chain/block_log.hpp>
@@ -384,7 +385,38 @@ BOOST_FIXTURE_TEST_CASE(start_with_corrupted_index, restart_from_block_log_test_
    uint64_t data = UINT64_MAX;
    indexfile.write(reinterpret_cast<const char*>(&data), sizeof(data));
    indexfile.close();
-   BOOST_CHECK_THROW(restart_chain(), eosio::chain::block_log_exception);
+   // the index is reconstructed in the background while the chain replays
+   BOOST_CHECK_NO_THROW(restart_chain());
+}
+
+BOOST_AUTO_TEST_CASE(test_restart_without_index_file) {
+   eosio::testing::tester chain;
+   chain.produce_blocks(160);
+   chain.close();
+
+   auto blocks_dir = chain.get_config().blocks_dir;
+   std::vector<uint64_t> positions;
+   {
+      eosio::chain::block_log blog(blocks_dir);
+      for (uint32_t n = 1; n <= blog.head()->block_num(); ++n)
+         positions.push_back(blog.get_block_pos(n));
+   }
+   std::filesystem::remove(blocks_dir / "blocks.index");
+
+   {
+      eosio::chain::block_log blog(blocks_dir);
+      BOOST_REQUIRE_EQUAL(blog.head()->block_num(), positions.size());
+      // blocks which are not indexed yet are found as well, in any order
+      for (int64_t n = positions.size(); n > 0; n -= 7)
+         BOOST_CHECK_EQUAL(blog.read_block_by_num(n)->block_num(), n);
+      for (uint32_t n = 1; n <= positions.size(); ++n)
+         BOOST_CHECK_EQUAL(blog.get_block_pos(n), positions[n - 1]);
+   }
+
+   // reopening resumes an interrupted reconstruction
+   eosio::chain::block_log blog(blocks_dir);
+   for (uint32_t n = 1; n <= positions.size(); ++n)
+      BOOST_CHECK_EQUAL(blog.get_block_pos(n), positions[n - 1]);
 }
 
 BOOST_FIXTURE_TEST_CASE(start_with_corrupted_log_and_index, restart_from_block_log_test_fixture) {
@@ -517,4 +549,60 @@ BOOST_AUTO_TEST_CASE(test_blocklog_split_then_merge) {
    BOOST_CHECK(std::filesystem::exists(dest_dir.path() / "blocks-101-150.index"));
 }
 
+BOOST_AUTO_TEST_CASE(test_compressed_retained_blocklog) {
+
+   eosio::testing::tester chain;
+   chain.produce_blocks(160);
+   chain.close();
+
+   auto blocks_dir   = chain.get_config().blocks_dir;
+   auto retained_dir = blocks_dir / "retained";
+
+   BOOST_REQUIRE_NO_THROW(eosio::chain::block_log::split_blocklog(blocks_dir, retained_dir, 50));
+   std::filesystem::remove(blocks_dir / "blocks.log");
+   std::filesystem::remove(blocks_dir / "blocks.index");
+
+   auto read_file = [](const std::filesystem::path& p) {
+      std::ifstream in(p, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(in), {});
+   };
+   const std::string original_log   = read_file(retained_dir / "blocks-51-100.log");
+   const std::string original_index = read_file(retained_dir / "blocks-51-100.index");
+
+   // frames of 7 blocks, the last frame partial
+   std::vector<std::filesystem::path> logs;
+   for (const auto& entry : std::filesystem::directory_iterator(retained_dir)) {
+      if (entry.path().extension() == ".log")
+         logs.push_back(entry.path());
+   }
+   BOOST_REQUIRE(logs.size() > 1);
+   for (const auto& log : logs) {
+      BOOST_REQUIRE_NO_THROW(eosio::chain::block_log::compress_blocklog(log, 7));
+      std::filesystem::remove(log);
+      std::filesystem::remove(std::filesystem::path(log).replace_extension("index"));
+   }
+   BOOST_CHECK(std::filesystem::exists(retained_dir / "blocks-51-100.zlog"));
+
+   {
+      eosio::chain::block_log blog(blocks_dir, eosio::chain::partitioned_blocklog_config{ .retained_dir = retained_dir });
+      BOOST_CHECK_EQUAL(blog.first_block_num(), 1u);
+      BOOST_REQUIRE(blog.head());
+      const uint32_t head_num = blog.head()->block_num();
+      for (uint32_t n : {1u, 7u, 8u, 50u, 51u, 57u, 58u, 99u, 100u, 150u, head_num}) {
+         auto b = blog.read_block_by_num(n);
+         BOOST_REQUIRE(b);
+         BOOST_CHECK_EQUAL(b->block_num(), n);
+         BOOST_CHECK_EQUAL(blog.read_block_id_by_num(n), b->calculate_id());
+      }
+      BOOST_CHECK(!blog.read_block_by_num(head_num + 1));
+   }
+
+   BOOST_CHECK(eosio::chain::block_log::extract_chain_id(blocks_dir, retained_dir));
+
+   // decompression reproduces the original files
+   BOOST_REQUIRE_NO_THROW(eosio::chain::block_log::decompress_blocklog(retained_dir / "blocks-51-100.zlog"));
+   BOOST_CHECK(read_file(retained_dir / "blocks-51-100.log") == original_log);
+   BOOST_CHECK(read_file(retained_dir / "blocks-51-100.index") == original_index);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+
+#include <eosio/chain/platform_timer.hpp>
+
+#include <fc/time.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+using namespace eosio::chain;
+
+// expired is set before the expiration callback is called
+bool wait_for(const std::atomic<uint32_t>& v, uint32_t expected) {
+   const auto until = fc::time_point::now() + fc::seconds(5);
+   while( v != expected && fc::time_point::now() < until ) {}
+   return v == expected;
+}
+
+BOOST_AUTO_TEST_SUITE(platform_timer_tests)
+
+BOOST_AUTO_TEST_CASE( watchdog_expires_test ) {
+   platform_timer t(platform_timer::backend_t::watchdog);
+   BOOST_TEST( (t.backend() == platform_timer::backend_t::watchdog) );
+
+   std::atomic<uint32_t> fired = 0;
+   t.set_expiration_callback([](void* f) { ++*static_cast<std::atomic<uint32_t>*>(f); }, &fired);
+
+   const auto start = fc::time_point::now();
+   t.start(start + fc::milliseconds(5));
+   BOOST_TEST( !t.expired );
+   while( !t.expired ) {}
+   BOOST_TEST( (fc::time_point::now() - start >= fc::milliseconds(5)) );
+   BOOST_TEST( wait_for(fired, 1) );
+
+   // already past
+   t.start(start);
+   BOOST_TEST( t.expired );
+   BOOST_TEST( fired == 1u );
+
+   t.start(fc::time_point::maximum());
+   BOOST_TEST( !t.expired );
+   t.stop();
+   BOOST_TEST( t.expired );
+
+   t.set_expiration_callback(nullptr, nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( watchdog_cancel_test ) {
+   platform_timer t(platform_timer::backend_t::watchdog);
+
+   std::atomic<uint32_t> fired = 0;
+   t.set_expiration_callback([](void* f) { ++*static_cast<std::atomic<uint32_t>*>(f); }, &fired);
+
+   for( uint32_t i = 0; i < 1000; ++i ) {
+      t.start(fc::time_point::now() + fc::milliseconds(20));
+      t.stop();
+      BOOST_TEST( t.expired );
+   }
+   std::this_thread::sleep_for(std::chrono::milliseconds(40));
+   BOOST_TEST( fired == 0u );
+
+   // timers on other threads share the watchdog
+   std::atomic<uint32_t> fired2 = 0;
+   std::thread other([&]() {
+      platform_timer t2(platform_timer::backend_t::watchdog);
+      t2.set_expiration_callback([](void* f) { ++*static_cast<std::atomic<uint32_t>*>(f); }, &fired2);
+      t2.start(fc::time_point::now() + fc::milliseconds(2));
+      while( !t2.expired ) {}
+      wait_for(fired2, 1);
+      t2.set_expiration_callback(nullptr, nullptr);
+   });
+   t.start(fc::time_point::now() + fc::milliseconds(50));
+   other.join();
+   BOOST_TEST( fired2 == 1u );
+   BOOST_TEST( !t.expired );
+   t.stop();
+   BOOST_TEST( fired == 0u );
+
+   t.set_expiration_callback(nullptr, nullptr);
+}
+
+// a deadline armed while the watchdog idle-sleeps must wake it, wherever in its sleep cycle the arm lands
+BOOST_AUTO_TEST_CASE( watchdog_wakes_for_earlier_deadline_test ) {
+   platform_timer t(platform_timer::backend_t::watchdog);
+
+   std::atomic<uint32_t> fired = 0;
+   t.set_expiration_callback([](void* f) { ++*static_cast<std::atomic<uint32_t>*>(f); }, &fired);
+
+   // watchdog idle sleep is 10ms, a lost wakeup shows up as expiring up to that late
+   const fc::microseconds late = fc::milliseconds(5);
+   uint32_t late_count = 0;
+   for( uint32_t i = 0; i < 200; ++i ) {
+      std::this_thread::sleep_for(std::chrono::microseconds(i * 997 % 10'000)); // land throughout the idle sleep
+      const auto deadline = fc::time_point::now() + fc::microseconds(500);
+      t.start(deadline);
+      while( !t.expired ) {}
+      if( fc::time_point::now() - deadline > late )
+         ++late_count;
+      BOOST_REQUIRE( wait_for(fired, i + 1) );
+   }
+   BOOST_TEST( late_count == 0u );
+
+   t.set_expiration_callback(nullptr, nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // anonymous namespace
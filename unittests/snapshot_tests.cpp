@@ -1,3 +1,4 @@
+#include <fstream>
 #include <sstream>
 
 #include <eosio/chain/block_log.hpp>
@@ -653,4 +654,287 @@ BOOST_AUTO_TEST_CASE(json_snapshot_validity_test)
    remove(json_snap_path);
 }
 
+BOOST_AUTO_TEST_CASE(sectioned_integrity_hash_test)
+{
+   tester chain;
+
+   chain.create_account("snapshot"_n);
+   chain.produce_blocks(1);
+   chain.set_code("snapshot"_n, test_contracts::snapshot_test_wasm());
+   chain.set_abi("snapshot"_n, test_contracts::snapshot_test_abi().data());
+   chain.push_action("snapshot"_n, "increment"_n, "snapshot"_n, mutable_variant_object()("value", 1));
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+
+   uint32_t last_done = 0, last_total = 0;
+   const auto hash = chain.control->calculate_sectioned_integrity_hash([&](uint32_t done, uint32_t total) {
+      last_done = std::max(last_done, done);
+      last_total = total;
+   });
+   BOOST_REQUIRE_EQUAL(last_done, last_total);
+   BOOST_REQUIRE_EQUAL(hash.sections.front().first, detail::snapshot_section_traits<chain_snapshot_header>::section_name());
+   BOOST_REQUIRE(std::find_if(hash.sections.begin(), hash.sections.end(), [](const auto& s) { return s.first == "contract_tables"; }) != hash.sections.end());
+
+   // a node loaded from a snapshot of the state has the same hash
+   auto writer = buffered_snapshot_suite::get_writer();
+   chain.control->write_snapshot(writer);
+   auto reader = buffered_snapshot_suite::get_reader(buffered_snapshot_suite::finalize(writer));
+   snapshotted_tester loaded(chain.get_config(), reader, 0);
+   const auto loaded_hash = loaded.control->calculate_sectioned_integrity_hash();
+   BOOST_REQUIRE_EQUAL(hash.root.str(), loaded_hash.root.str());
+   BOOST_REQUIRE(hash.sections == loaded_hash.sections);
+
+   // changing a contract table changes the contract_tables section
+   chain.push_action("snapshot"_n, "increment"_n, "snapshot"_n, mutable_variant_object()("value", 1));
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+   const auto later_hash = chain.control->calculate_sectioned_integrity_hash();
+   BOOST_REQUIRE_NE(hash.root.str(), later_hash.root.str());
+   BOOST_REQUIRE_EQUAL(hash.sections.size(), later_hash.sections.size());
+   for (size_t i = 0; i < hash.sections.size(); ++i) {
+      if (hash.sections[i].first == "contract_tables")
+         BOOST_TEST(hash.sections[i].second != later_hash.sections[i].second);
+   }
+}
+
+BOOST_AUTO_TEST_CASE(streamed_snapshot_test)
+{
+   tester chain;
+
+   chain.create_account("snapshot"_n);
+   chain.produce_blocks(1);
+   chain.set_code("snapshot"_n, test_contracts::snapshot_test_wasm());
+   chain.set_abi("snapshot"_n, test_contracts::snapshot_test_abi().data());
+   chain.produce_blocks(1);
+   chain.push_action("snapshot"_n, "increment"_n, "snapshot"_n, mutable_variant_object()("value", 1));
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+
+   auto write_bin = [&]() {
+      auto writer = buffered_snapshot_suite::get_writer();
+      chain.control->write_snapshot(writer);
+      return buffered_snapshot_suite::finalize(writer);
+   };
+   const auto snapshot_bin = write_bin();
+
+   // copying the rows of the binary snapshot to json matches writing the state to json
+   std::ostringstream from_state;
+   {
+      auto writer = std::make_shared<ostream_json_snapshot_writer>(from_state);
+      chain.control->write_snapshot(writer);
+      writer->finalize();
+   }
+   std::ostringstream streamed;
+   {
+      std::istringstream in(snapshot_bin);
+      istream_snapshot_reader reader(in);
+      ostream_json_snapshot_writer writer(streamed);
+      controller::copy_snapshot(reader, writer, [](const std::string&) { return true; });
+      writer.finalize();
+   }
+   BOOST_REQUIRE_EQUAL(from_state.str(), streamed.str());
+
+   // sections copied separately join to the same json
+   std::ostringstream joined;
+   {
+      std::istringstream in(snapshot_bin);
+      istream_snapshot_reader reader(in);
+      ostream_json_snapshot_writer writer(joined);
+      for (const auto& s : reader.list_sections()) {
+         ostream_json_snapshot_writer section_writer(joined, false);
+         controller::copy_snapshot(reader, section_writer, [&](const std::string& name) { return name == s.name; });
+      }
+      writer.finalize();
+   }
+   BOOST_REQUIRE_EQUAL(from_state.str(), joined.str());
+
+   // section hashes of a later snapshot differ only where the state changed
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+   const auto later_bin = write_bin();
+
+   std::istringstream in(snapshot_bin), later_in(later_bin);
+   istream_snapshot_reader reader(in), later_reader(later_in);
+   const auto sections = reader.list_sections();
+   BOOST_REQUIRE_EQUAL(sections.size(), later_reader.list_sections().size());
+   BOOST_REQUIRE_EQUAL(sections.front().name, detail::snapshot_section_traits<chain_snapshot_header>::section_name());
+   for (const auto& s : sections) {
+      const bool equal = reader.hash_section(s.name) == later_reader.hash_section(s.name);
+      if (s.name == detail::snapshot_section_traits<chain_snapshot_header>::section_name() ||
+          s.name == "contract_tables")
+         BOOST_TEST(equal, s.name);
+      else if (s.name == detail::snapshot_section_traits<block_state>::section_name())
+         BOOST_TEST(!equal, s.name);
+   }
+}
+
+BOOST_AUTO_TEST_CASE(binary_snapshot_versions_test)
+{
+   tester chain;
+
+   chain.create_account("snapshot"_n);
+   chain.produce_blocks(1);
+   chain.set_code("snapshot"_n, test_contracts::snapshot_test_wasm());
+   chain.set_abi("snapshot"_n, test_contracts::snapshot_test_abi().data());
+   chain.produce_blocks(1);
+   for (uint32_t i = 0; i < 10; ++i)
+      chain.push_action("snapshot"_n, "increment"_n, "snapshot"_n, mutable_variant_object()("value", i + 1));
+   chain.produce_blocks(1);
+   chain.control->abort_block();
+
+   auto write_bin = [&](uint32_t version) {
+      std::ostringstream out;
+      auto writer = std::make_shared<ostream_snapshot_writer>(out, version);
+      chain.control->write_snapshot(writer);
+      writer->finalize();
+      return out.str();
+   };
+   const auto v1 = write_bin(1);
+   const auto v2 = write_bin(ostream_snapshot_writer::current_version);
+   BOOST_REQUIRE_NE(v1, v2);
+   BOOST_REQUIRE_EQUAL(write_bin(ostream_snapshot_writer::default_version), v1); // read by nodes predating version 2
+
+   // both versions hold the same rows
+   std::istringstream in1(v1), in2(v2);
+   istream_snapshot_reader reader1(in1), reader2(in2);
+   reader1.validate();
+   reader2.validate();
+   const auto sections = reader1.list_sections();
+   BOOST_REQUIRE_EQUAL(sections.size(), reader2.list_sections().size());
+   for (const auto& s : sections)
+      BOOST_TEST(reader1.hash_section(s.name) == reader2.hash_section(s.name), s.name);
+
+   // and load to the same state
+   int ordinal = 0;
+   for (const auto& bin : {v1, v2}) {
+      snapshotted_tester snap_chain(chain.get_config(), buffered_snapshot_suite::get_reader(bin), ordinal++);
+      BOOST_REQUIRE_EQUAL(chain.control->calculate_integrity_hash().str(), snap_chain.control->calculate_integrity_hash().str());
+   }
+
+   // a block whose rows do not add up to its size is rejected
+   auto corrupt = v2;
+   const auto& first = sections.front().name;
+   const size_t rows_size_pos = 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t) + first.size() + 1 + sizeof(uint32_t);
+   uint32_t rows_size = 0;
+   memcpy(&rows_size, corrupt.data() + rows_size_pos, sizeof(rows_size));
+   ++rows_size;
+   memcpy(corrupt.data() + rows_size_pos, &rows_size, sizeof(rows_size));
+   std::istringstream corrupt_in(corrupt);
+   istream_snapshot_reader corrupt_reader(corrupt_in);
+   BOOST_REQUIRE_THROW(corrupt_reader.hash_section(first), snapshot_exception);
+
+   std::ostringstream unsupported;
+   BOOST_REQUIRE_THROW((ostream_snapshot_writer{unsupported, ostream_snapshot_writer::current_version + 1}), snapshot_exception);
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_read_ahead_test)
+{
+   const std::vector<std::string> names = {"a", "b", "c"};
+   constexpr uint64_t num_rows = 1000;
+   auto row_value = [](size_t section, uint64_t i) { return section * 1'000'000 + i; };
+
+   auto write_bin = [&](uint32_t version) {
+      std::ostringstream out;
+      ostream_snapshot_writer writer(out, version);
+      for (size_t s = 0; s < names.size(); ++s) {
+         writer.write_section(names[s], [&](auto& section) {
+            for (uint64_t i = 0; i < num_rows; ++i)
+               section.add_row(row_value(s, i));
+         });
+      }
+      writer.finalize();
+      return out.str();
+   };
+
+   // up to max_rows rows of a section, calling between() before each row
+   auto read_rows = [](istream_snapshot_reader& reader, const std::string& name, uint64_t max_rows,
+                       const std::function<void()>& between = {}) {
+      std::vector<uint64_t> rows;
+      reader.read_section(name, [&](auto& section) {
+         bool more = !section.empty();
+         while (more && rows.size() < max_rows) {
+            if (between)
+               between();
+            uint64_t row = 0;
+            more = section.read_row(row);
+            rows.push_back(row);
+         }
+      });
+      return rows;
+   };
+   auto expected_rows = [&](size_t section, uint64_t count) {
+      std::vector<uint64_t> rows;
+      for (uint64_t i = 0; i < count; ++i)
+         rows.push_back(row_value(section, i));
+      return rows;
+   };
+
+   // chunks much smaller than a section, so most rows are read while the next chunk is read ahead
+   constexpr uint64_t read_ahead_size = 64;
+
+   for (uint32_t version : {1u, ostream_snapshot_writer::current_version}) {
+      BOOST_TEST_CONTEXT("version " << version) {
+         const auto bin = write_bin(version);
+
+         // sections out of file order
+         {
+            std::istringstream in(bin);
+            istream_snapshot_reader reader(in, read_ahead_size);
+            BOOST_TEST(read_rows(reader, "c", num_rows) == expected_rows(2, num_rows));
+            BOOST_TEST(read_rows(reader, "a", num_rows) == expected_rows(0, num_rows));
+            BOOST_TEST(read_rows(reader, "b", num_rows) == expected_rows(1, num_rows));
+            BOOST_TEST(read_rows(reader, "a", num_rows) == expected_rows(0, num_rows));
+         }
+
+         // switching to another section before the end of the current one
+         {
+            std::istringstream in(bin);
+            istream_snapshot_reader reader(in, read_ahead_size);
+            BOOST_TEST(read_rows(reader, "b", 10) == expected_rows(1, 10));
+            BOOST_TEST(read_rows(reader, "a", 500) == expected_rows(0, 500));
+            BOOST_TEST(read_rows(reader, "c", num_rows) == expected_rows(2, num_rows));
+            BOOST_TEST(read_rows(reader, "b", num_rows) == expected_rows(1, num_rows));
+         }
+
+         // the stream used directly in the middle of a section does not disturb its rows
+         {
+            std::istringstream in(bin);
+            istream_snapshot_reader reader(in, read_ahead_size);
+            uint64_t n = 0;
+            auto use_stream = [&]() {
+               if (n++ % 100 == 50) {
+                  reader.validate();
+                  BOOST_TEST(reader.list_sections().size() == names.size());
+               }
+            };
+            BOOST_TEST(read_rows(reader, "b", num_rows, use_stream) == expected_rows(1, num_rows));
+            BOOST_TEST(read_rows(reader, "c", num_rows) == expected_rows(2, num_rows));
+         }
+
+         // a truncated file is rejected when indexing its sections
+         {
+            std::istringstream in(bin.substr(0, bin.size() - 16));
+            istream_snapshot_reader reader(in, read_ahead_size);
+            BOOST_REQUIRE_THROW(reader.list_sections(), snapshot_exception);
+         }
+
+         // a section truncated after indexing fails when read ahead, the other sections stay readable
+         {
+            fc::temp_directory tempdir;
+            const auto path = tempdir.path() / "snapshot.bin";
+            {
+               std::ofstream out(path, std::ios::binary);
+               out.write(bin.data(), bin.size());
+            }
+            std::ifstream in(path, std::ios::binary);
+            istream_snapshot_reader reader(in, read_ahead_size);
+            BOOST_REQUIRE_EQUAL(reader.list_sections().size(), names.size());
+            std::filesystem::resize_file(path, bin.size() - 16);
+            BOOST_REQUIRE_THROW(read_rows(reader, "c", num_rows), snapshot_exception);
+            BOOST_TEST(read_rows(reader, "a", num_rows) == expected_rows(0, num_rows));
+         }
+      }
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
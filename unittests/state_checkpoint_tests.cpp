@@ -0,0 +1,137 @@
+#include <eosio/chain/state_checkpoint.hpp>
+#include <eosio/testing/tester.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::testing;
+
+BOOST_AUTO_TEST_SUITE(state_checkpoint_tests)
+
+BOOST_AUTO_TEST_CASE(test_checkpoint_restore) try {
+   fc::temp_directory tempdir;
+   const auto checkpoint_dir = tempdir.path() / "checkpoints";
+
+   tester chain(tempdir, [&](controller::config& cfg) {
+      cfg.state_checkpoint.dir = checkpoint_dir;
+   }, true);
+
+   chain.produce_blocks(10);
+   chain.control->abort_block();
+   auto full = chain.control->write_state_checkpoint();
+   BOOST_CHECK_EQUAL(full.parent_seq, 0u);
+   BOOST_CHECK_EQUAL(full.head_block_num, chain.control->head_block_num());
+
+   chain.create_accounts({"alice"_n, "bob"_n});
+   chain.produce_blocks(5);
+   chain.control->abort_block();
+   auto incremental = chain.control->write_state_checkpoint();
+   BOOST_CHECK_EQUAL(incremental.parent_seq, full.seq);
+   BOOST_CHECK_LT(incremental.num_chunks, full.num_chunks);
+
+   const auto head_id = chain.control->head_block_id();
+   const auto hash    = chain.control->calculate_integrity_hash();
+   BOOST_CHECK_EQUAL(verify_state_checkpoint(checkpoint_dir).size(), 2u);
+   chain.close();
+
+   // restore next to a copy of the block log
+   fc::temp_directory restore_dir;
+   const auto blocks_dir = restore_dir.path() / config::default_blocks_dir_name;
+   std::filesystem::create_directories(blocks_dir);
+   std::filesystem::copy_file(chain.get_config().blocks_dir / "blocks.log", blocks_dir / "blocks.log");
+   std::filesystem::copy_file(chain.get_config().blocks_dir / "blocks.index", blocks_dir / "blocks.index");
+   auto restored_info = restore_state_checkpoint(checkpoint_dir, {}, restore_dir.path() / config::default_state_dir_name,
+                                                 blocks_dir / config::reversible_blocks_dir_name);
+   BOOST_CHECK_EQUAL(restored_info.seq, incremental.seq);
+
+   tester restored(restore_dir, [](controller::config&) {}, false);
+   restored.control->abort_block();
+   BOOST_CHECK_EQUAL(restored.control->head_block_id(), head_id);
+   BOOST_CHECK_EQUAL(restored.control->calculate_integrity_hash(), hash);
+   restored.produce_blocks(2);
+
+   // a damaged chunk fails verification of the checkpoint and of everything applied on top of it
+   {
+      const auto pos = std::filesystem::file_size(full.file) / 2;
+      std::fstream f(full.file, std::ios::in | std::ios::out | std::ios::binary);
+      f.seekg(pos);
+      const char c = f.get();
+      f.seekp(pos);
+      f.put(static_cast<char>(c ^ 0xff));
+   }
+   BOOST_REQUIRE_THROW(verify_state_checkpoint(checkpoint_dir), state_checkpoint_exception);
+   BOOST_REQUIRE_THROW(verify_state_checkpoint(checkpoint_dir, full.seq), state_checkpoint_exception);
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(test_checkpoint_interval) try {
+   fc::temp_directory tempdir;
+   const auto checkpoint_dir = tempdir.path() / "checkpoints";
+
+   tester chain(tempdir, [&](controller::config& cfg) {
+      cfg.state_checkpoint.dir                 = checkpoint_dir;
+      cfg.state_checkpoint.interval_blocks     = 4;
+      cfg.state_checkpoint.increments_per_full = 1;
+      cfg.state_checkpoint.retained_full       = 1;
+   }, true);
+
+   // checkpoints are written at the start of blocks not produced, as the speculative blocks started between slots
+   for (int i = 0; i < 30; ++i) {
+      chain.produce_block();
+      chain.control->abort_block();
+      chain.control->start_block(chain.control->head_block_time() + fc::milliseconds(config::block_interval_ms), 0, {},
+                                 controller::block_status::ephemeral);
+      chain.control->abort_block();
+   }
+
+   // a full checkpoint is followed by one increment, only the latest full one is retained
+   auto checkpoints = list_state_checkpoints(checkpoint_dir);
+   BOOST_REQUIRE(!checkpoints.empty());
+   BOOST_REQUIRE_LE(checkpoints.size(), 2u);
+   BOOST_CHECK_EQUAL(checkpoints.front().parent_seq, 0u);
+   BOOST_CHECK_GT(checkpoints.front().seq, 1u);
+   for (const auto& info : checkpoints)
+      BOOST_CHECK_EQUAL(info.head_block_num % 4, 0u);
+   BOOST_CHECK_EQUAL(verify_state_checkpoint(checkpoint_dir).back().seq, checkpoints.back().seq);
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(test_checkpoint_not_written_while_producing) try {
+   fc::temp_directory tempdir;
+   const auto checkpoint_dir = tempdir.path() / "checkpoints";
+   auto head_block_nums = [&]() {
+      std::vector<uint32_t> nums;
+      for (const auto& info : list_state_checkpoints(checkpoint_dir))
+         nums.push_back(info.head_block_num);
+      return nums;
+   };
+
+   // never at the start of a produced block
+   tester chain(tempdir, [&](controller::config& cfg) {
+      cfg.state_checkpoint.dir             = checkpoint_dir;
+      cfg.state_checkpoint.interval_blocks = 4;
+   }, true);
+   chain.produce_blocks(10);
+   chain.control->abort_block();
+   BOOST_REQUIRE_EQUAL(chain.control->head_block_num(), 10u);
+   BOOST_TEST(head_block_nums().empty());
+   BOOST_TEST(chain.control->is_state_checkpoint_due());
+
+   // but at the start of a speculative block, between the slots of the producer
+   chain.control->start_block(chain.control->head_block_time() + fc::milliseconds(config::block_interval_ms), 0, {},
+                              controller::block_status::ephemeral);
+   chain.control->abort_block();
+   BOOST_TEST(!chain.control->is_state_checkpoint_due());
+   BOOST_TEST(head_block_nums() == (std::vector<uint32_t>{10}));
+
+   // or explicitly between blocks, as the producer_plugin does when it waits for its next round
+   chain.produce_blocks(4);
+   chain.control->abort_block();
+   BOOST_TEST(chain.control->is_state_checkpoint_due());
+   chain.control->write_state_checkpoint();
+   BOOST_TEST(!chain.control->is_state_checkpoint_due());
+   BOOST_TEST(head_block_nums() == (std::vector<uint32_t>{10, 14}));
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -738,6 +738,171 @@ BOOST_AUTO_TEST_CASE(test_splitted_log) {
    BOOST_CHECK(get_decompressed_entry(chain.chain_state_log, 160).empty());
 }
 
+BOOST_AUTO_TEST_CASE(test_cold_tier) {
+
+   fc::temp_directory state_history_dir;
+
+   eosio::state_history::partition_config config{
+      .retained_dir = "retained",
+      .archive_dir = "archive",
+      .stride  = 20,
+      .max_retained_files = 2,
+      .cold_dir = "cold",
+      .cold_frame_size = 4096
+   };
+
+   auto log_dir      = state_history_dir.path();
+   auto archive_dir  = log_dir / "archive";
+   auto retained_dir = log_dir / "retained";
+   auto cold_dir     = log_dir / "cold";
+
+   std::vector<char> traces_30, deltas_30, deltas_55;
+   {
+      state_history_tester chain(state_history_dir.path(), config);
+      chain.produce_blocks(50);
+
+      deploy_test_api(chain);
+      auto cfd_trace = push_test_cfd_transaction(chain);
+      chain.produce_blocks(10);
+
+      traces_30 = get_decompressed_entry(chain.traces_log, 30);
+      deltas_30 = get_decompressed_entry(chain.chain_state_log, 30);
+      deltas_55 = get_decompressed_entry(chain.chain_state_log, 55);
+
+      chain.produce_blocks(90);
+      chain.traces_log.wait_for_compaction();
+      chain.chain_state_log.wait_for_compaction();
+
+      for (auto name : { "trace_history", "chain_state_history" }) {
+         for (auto range : { "-2-20", "-21-40", "-41-60", "-61-80", "-81-100" }) {
+            BOOST_CHECK(std::filesystem::exists( cold_dir / (std::string(name) + range + ".zlog") ));
+            BOOST_CHECK(!std::filesystem::exists( retained_dir / (std::string(name) + range + ".log") ));
+            BOOST_CHECK(!std::filesystem::exists( archive_dir / (std::string(name) + range + ".log") ));
+         }
+         BOOST_CHECK(std::filesystem::exists( retained_dir / (std::string(name) + "-101-120.log") ));
+         BOOST_CHECK(std::filesystem::exists( retained_dir / (std::string(name) + "-121-140.log") ));
+      }
+
+      BOOST_CHECK_EQUAL(chain.traces_log.block_range().first, 2);
+      BOOST_CHECK_EQUAL(chain.chain_state_log.block_range().first, 2);
+
+      BOOST_CHECK(get_decompressed_entry(chain.traces_log, 30) == traces_30);
+      BOOST_CHECK(get_decompressed_entry(chain.chain_state_log, 30) == deltas_30);
+      BOOST_CHECK(get_decompressed_entry(chain.chain_state_log, 55) == deltas_55);
+      BOOST_CHECK(get_traces(chain.traces_log, 100).size());
+      BOOST_CHECK(get_traces(chain.traces_log, 140).size());
+      BOOST_CHECK(get_traces(chain.traces_log, 150).size());
+      BOOST_CHECK(get_traces(chain.traces_log, 160).empty());
+      BOOST_CHECK(chain.traces_log.get_block_id(30) == chain.control->fetch_block_by_number(30)->calculate_id());
+   }
+
+   // the cold tier is found again at startup
+   eosio::state_history_log chain_state_log("chain_state_history", log_dir, config);
+   BOOST_CHECK_EQUAL(chain_state_log.block_range().first, 2);
+   BOOST_CHECK(get_decompressed_entry(chain_state_log, 30) == deltas_30);
+   BOOST_CHECK(get_decompressed_entry(chain_state_log, 55) == deltas_55);
+}
+
+BOOST_AUTO_TEST_CASE(test_scrub) {
+
+   fc::temp_directory state_history_dir;
+
+   eosio::state_history::partition_config config{
+      .retained_dir = "retained",
+      .archive_dir = "archive",
+      .stride  = 20,
+      .max_retained_files = 1,
+      .cold_dir = "cold",
+      .cold_frame_size = 4096
+   };
+
+   std::mutex                                      block_ids_mx;
+   std::map<uint32_t, eosio::chain::block_id_type> block_ids; // outlives the scrub thread
+   state_history_tester chain(state_history_dir.path(), config);
+   chain.produce_blocks(70);
+   chain.chain_state_log.wait_for_compaction();
+
+   // blocks 2-40 are in the cold tier, 41-60 in a retained file and the rest in the log
+   auto log_dir = state_history_dir.path();
+   BOOST_REQUIRE(std::filesystem::exists( log_dir / "cold" / "chain_state_history-21-40.zlog" ));
+   BOOST_REQUIRE(std::filesystem::exists( log_dir / "retained" / "chain_state_history-41-60.log" ));
+
+   // the block log disagrees on the id of block 65
+   const uint32_t forked_block = 65;
+   for (uint32_t block_num = 2; block_num <= chain.control->head_block_num(); ++block_num)
+      block_ids[block_num] = chain.control->fetch_block_by_number(block_num)->calculate_id();
+   block_ids[forked_block] = eosio::chain::block_id_type{};
+
+   chain.chain_state_log.start_scrub({ .interval_sec = 0, .max_bytes_per_sec = 0 }, [&](uint32_t block_num) {
+      std::lock_guard g(block_ids_mx);
+      auto it = block_ids.find(block_num);
+      return it != block_ids.end() ? std::optional<eosio::chain::block_id_type>{ it->second } : std::nullopt;
+   });
+
+   // wait for a pass started after the call
+   auto scrub_pass = [&]() {
+      const auto passes   = chain.chain_state_log.get_scrub_status().passes_completed;
+      const auto deadline = std::chrono::steady_clock::now() + 60s;
+      while (chain.chain_state_log.get_scrub_status().passes_completed < passes + 2) {
+         BOOST_REQUIRE(std::chrono::steady_clock::now() < deadline);
+         std::this_thread::sleep_for(10ms);
+      }
+      return chain.chain_state_log.get_scrub_status();
+   };
+   auto problem_blocks = [](const eosio::state_history::scrub_status& status) {
+      std::set<uint32_t> result;
+      for (const auto& problem : status.problems)
+         result.insert(problem.block_num);
+      return result;
+   };
+   auto flip_byte = [](const std::filesystem::path& path, uint64_t pos) {
+      fc::cfile file;
+      file.set_file_path(path);
+      file.open(fc::cfile::update_rw_mode);
+      char c;
+      file.seek(pos);
+      file.read(&c, 1);
+      c ^= 0xff;
+      file.seek(pos);
+      file.write(&c, 1);
+      file.close();
+   };
+
+   auto status = scrub_pass();
+   BOOST_CHECK(status.enabled);
+   BOOST_CHECK_EQUAL(status.pass_begin_block, 2);
+   BOOST_CHECK_EQUAL(status.pass_end_block, chain.control->head_block_num() + 1);
+   BOOST_CHECK_EQUAL(status.last_pass_problems, 1);
+   BOOST_CHECK(problem_blocks(status) == std::set<uint32_t>{ forked_block });
+   BOOST_CHECK(status.problems.back().message.find("block log") != std::string::npos);
+
+   // damage the payload of block 50 in the retained file and the first frame of the cold file
+   {
+      eosio::chain::log_index<eosio::chain::plugin_exception> index(log_dir / "retained" / "chain_state_history-41-60.index");
+      const uint64_t pos = index.nth_block_position(50 - 41);
+      flip_byte(log_dir / "retained" / "chain_state_history-41-60.log", pos + eosio::state_history_log_header_serial_size + 16);
+   }
+   flip_byte(log_dir / "cold" / "chain_state_history-21-40.zlog", sizeof(eosio::detail::cold_log_header) + 16);
+
+   status = scrub_pass();
+   BOOST_CHECK_EQUAL(status.last_pass_problems, 3);
+   BOOST_CHECK(problem_blocks(status) == (std::set<uint32_t>{ 21, 50, forked_block }));
+
+   // the log grows under the files kept open by the scrubber
+   chain.produce_blocks(5);
+   {
+      std::lock_guard g(block_ids_mx);
+      for (uint32_t block_num = forked_block + 1; block_num <= chain.control->head_block_num(); ++block_num)
+         block_ids[block_num] = chain.control->fetch_block_by_number(block_num)->calculate_id();
+   }
+   status = scrub_pass();
+   BOOST_CHECK_EQUAL(status.pass_end_block, chain.control->head_block_num() + 1);
+   BOOST_CHECK_EQUAL(status.last_pass_problems, 3);
+   BOOST_CHECK(problem_blocks(status) == (std::set<uint32_t>{ 21, 50, forked_block }));
+
+   chain.chain_state_log.stop_scrub();
+}
+
 void push_blocks( tester& from, tester& to ) {
    while( to.control->fork_db_head_block_num()
             < from.control->fork_db_head_block_num() )
@@ -127,6 +127,88 @@ BOOST_AUTO_TEST_CASE( subjective_bill_test ) {
 
 }
 
+BOOST_AUTO_TEST_CASE( account_table_test ) {
+   subjective_billing::account_table table;
+
+   const uint64_t n = 1000;
+   for( uint64_t i = 0; i < n; ++i ) {
+      table[name(i << 4)].pending_cpu_us = i; // low bits of names are usually zero
+   }
+   BOOST_CHECK_EQUAL( n, table.size() );
+   BOOST_CHECK( table.capacity() >= 2 * n );
+   for( uint64_t i = 0; i < n; ++i ) {
+      auto* e = table.find( name(i << 4) );
+      BOOST_REQUIRE( e );
+      BOOST_CHECK_EQUAL( i, e->pending_cpu_us );
+   }
+   BOOST_CHECK( !table.find( name(n << 4) ) );
+
+   // erase odd entries, remaining ones must still be found
+   for( uint64_t i = 1; i < n; i += 2 ) {
+      table.erase( table.find( name(i << 4) ) );
+   }
+   BOOST_CHECK_EQUAL( n / 2, table.size() );
+   for( uint64_t i = 0; i < n; ++i ) {
+      auto* e = table.find( name(i << 4) );
+      BOOST_CHECK_EQUAL( i % 2 == 0, e != nullptr );
+      if( e ) BOOST_CHECK_EQUAL( i, e->pending_cpu_us );
+   }
+
+   // sweep visits at most the given number of slots
+   const auto erase_all = []( const auto& ) { return true; };
+   BOOST_CHECK( table.sweep( 16, erase_all ) <= 16 );
+   while( table.size() > 0 ) {
+      table.sweep( 64, erase_all );
+   }
+   for( uint64_t i = 0; i < n; ++i ) {
+      BOOST_CHECK( !table.find( name(i << 4) ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( account_exhausted_test ) {
+   fc::logger log;
+
+   transaction_id_type id1 = sha256::hash( "1" );
+   account_name a = "a"_n;
+   account_name b = "b"_n;
+
+   const auto now = time_point::now();
+   const fc::time_point_sec now_sec{now};
+
+   subjective_billing sub_bill;
+   sub_bill.subjective_bill( id1, now_sec, a, fc::microseconds( 1000 ) );
+   BOOST_CHECK( !sub_bill.is_account_exhausted( a, now ) );
+
+   sub_bill.account_exhausted( a, sub_bill.get_subjective_bill( a, now ) );
+   BOOST_CHECK( sub_bill.is_account_exhausted( a, now ) );
+   BOOST_CHECK( !sub_bill.is_account_exhausted( b, now ) );
+
+   // the bill is lower once the transaction expired and decayed
+   sub_bill.remove_expired( log, now + fc::seconds(1), now, [](){ return false; } );
+   const auto later = now + fc::milliseconds(sub_bill.get_expired_accumulator_average_window() * subjective_billing::subjective_time_interval_ms / 2);
+   BOOST_CHECK( sub_bill.is_account_exhausted( a, now ) );
+   BOOST_CHECK( !sub_bill.is_account_exhausted( a, later ) );
+
+   // the account failures fully decayed, sweeping removes the account
+   const auto endtime = now + fc::milliseconds(sub_bill.get_expired_accumulator_average_window() * subjective_billing::subjective_time_interval_ms);
+   BOOST_CHECK_EQUAL( 1u, sub_bill.get_account_cache_size() );
+   sub_bill.remove_expired( log, endtime, endtime, [](){ return false; } );
+   BOOST_CHECK_EQUAL( 0u, sub_bill.get_account_cache_size() );
+
+   // disabled accounts are never exhausted
+   subjective_billing disabled_sub_bill;
+   disabled_sub_bill.disable_account( a );
+   disabled_sub_bill.subjective_bill_failure( a, fc::microseconds( 1000 ), now );
+   disabled_sub_bill.account_exhausted( a, 1000 );
+   BOOST_CHECK( !disabled_sub_bill.is_account_exhausted( a, now ) );
+
+   // disabled accounts are read by other threads once frozen
+   disabled_sub_bill.freeze();
+   BOOST_CHECK_THROW( disabled_sub_bill.disable_account( "b"_n ), misc_exception );
+   BOOST_CHECK_THROW( disabled_sub_bill.disable(), misc_exception );
+   BOOST_CHECK( !disabled_sub_bill.is_account_disabled( "b"_n ) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
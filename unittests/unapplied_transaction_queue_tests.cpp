@@ -412,4 +412,54 @@ BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_incoming_count ) try {
 
 } FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_incoming_count
 
+BOOST_AUTO_TEST_CASE( unapplied_transaction_queue_incoming_priority ) try {
+
+   unapplied_transaction_queue q;
+
+   auto trx1 = unique_trx_meta_data();
+   auto trx2 = unique_trx_meta_data();
+   auto trx3 = unique_trx_meta_data();
+   auto trx4 = unique_trx_meta_data();
+   auto trx5 = unique_trx_meta_data();
+   auto trx6 = unique_trx_meta_data();
+
+   // no policy, arrival order
+   q.add_incoming( trx1, false, false, [](auto){} );
+   q.add_incoming( trx2, false, false, [](auto){} );
+   BOOST_CHECK( next( q ) == trx1 );
+   BOOST_CHECK( next( q ) == trx2 );
+
+   std::map<transaction_id_type, int64_t> priorities{ {trx1->id(), 1}, {trx2->id(), 5}, {trx3->id(), 1},
+                                                      {trx4->id(), 9}, {trx5->id(), 5}, {trx6->id(), -1} };
+   q.set_incoming_priority( [&]( const transaction_metadata_ptr& trx, trx_enum_type ) { return priorities.at( trx->id() ); } );
+
+   q.add_incoming( trx1, false, false, [](auto){} );
+   q.add_incoming( trx2, false, false, [](auto){} );
+   q.add_incoming( trx3, true, false, [](auto){} );
+   q.add_incoming( trx4, false, false, [](auto){} );
+   q.add_incoming( trx5, false, false, [](auto){} );
+   q.add_aborted( { trx6 } );
+   BOOST_CHECK( q.incoming_size() == 5u );
+
+   // aborted not affected by priority and still first; api before p2p; highest priority first; ties in arrival order
+   BOOST_CHECK( next( q ) == trx6 );
+   BOOST_CHECK( next( q ) == trx3 );
+   BOOST_CHECK( next( q ) == trx4 );
+   BOOST_CHECK( next( q ) == trx2 );
+   BOOST_CHECK( next( q ) == trx5 );
+   BOOST_CHECK( next( q ) == trx1 );
+   BOOST_CHECK( q.empty() );
+   BOOST_CHECK( q.incoming_size() == 0u );
+
+   // incoming_begin/end and lower_bound follow priority order
+   q.add_incoming( trx1, false, false, [](auto){} );
+   q.add_incoming( trx4, false, false, [](auto){} );
+   q.add_forked( { create_test_block_state( { trx6 } ) } );
+   BOOST_CHECK( q.unapplied_begin()->trx_meta == trx6 );
+   BOOST_CHECK( std::next( q.unapplied_begin() ) == q.unapplied_end() );
+   BOOST_CHECK( q.incoming_begin()->trx_meta == trx4 );
+   BOOST_CHECK( q.lower_bound( trx1->id() ) == std::next( q.incoming_begin() ) );
+
+} FC_LOG_AND_RETHROW() /// unapplied_transaction_queue_incoming_priority
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1,4 +1,5 @@
 #include <array>
+#include <fstream>
 #include <utility>
 
 #include <eosio/chain/abi_serializer.hpp>
@@ -2294,4 +2295,86 @@ BOOST_FIXTURE_TEST_CASE(weighted_net_usage_tests, tester ) try {
 } FC_LOG_AND_RETHROW()
 #endif
 
+// code applied before shutdown is listed in recently_used_code.dat and preinstantiated at the next startup
+BOOST_AUTO_TEST_CASE( preinstantiate_recently_used_code_test ) try {
+   tester chain(setup_policy::none);
+   if( chain.get_config().wasm_runtime == wasm_interface::vm_type::eos_vm_oc ) {
+      // eos_vm_oc does not keep instantiated modules, nothing is preinstantiated
+      return;
+   }
+   const auto filename = chain.get_config().state_dir / config::recently_used_code_filename;
+
+   chain.create_accounts( {"asserter"_n} );
+   chain.set_code( "asserter"_n, test_contracts::asserter_wasm() );
+   chain.produce_block();
+   const auto code_hash = chain.control->db().get<account_metadata_object, by_name>( "asserter"_n ).code_hash;
+
+   auto push_assertdef = [&]() {
+      signed_transaction trx;
+      trx.actions.emplace_back( vector<permission_level>{{"asserter"_n,config::active_name}},
+                                assertdef {1, "Should Not Assert!"} );
+      chain.set_transaction_headers( trx );
+      trx.sign( chain.get_private_key( "asserter"_n, "active" ), chain.control->get_chain_id() );
+      chain.push_transaction( trx );
+      chain.produce_block();
+   };
+   push_assertdef();
+   chain.close();
+
+   string content;
+   fc::read_file_contents( filename, content );
+   {
+      fc::datastream<const char*> ds( content.data(), content.size() );
+      uint32_t totem = 0;
+      fc::unsigned_int size;
+      digest_type hash;
+      uint8_t vm_type = 1, vm_version = 1;
+      fc::raw::unpack( ds, totem );
+      fc::raw::unpack( ds, size );
+      fc::raw::unpack( ds, hash );
+      fc::raw::unpack( ds, vm_type );
+      fc::raw::unpack( ds, vm_version );
+      BOOST_TEST( totem == 0x52554344u );
+      BOOST_TEST( size.value == 1u );
+      BOOST_TEST( hash == code_hash );
+      BOOST_TEST( vm_type == 0 );
+      BOOST_TEST( vm_version == 0 );
+      BOOST_TEST( ds.remaining() == 0u );
+   }
+
+   chain.open();
+   BOOST_TEST( chain.is_code_preinstantiated( "asserter"_n ) );
+   BOOST_TEST( chain.is_code_cached( "asserter"_n ) ); // before it is applied
+   push_assertdef();
+   BOOST_TEST( !chain.is_code_preinstantiated( "asserter"_n ) );
+   BOOST_TEST( chain.is_code_cached( "asserter"_n ) );
+   chain.close();
+
+   // round trip, the file is the same after the restart
+   string rewritten;
+   fc::read_file_contents( filename, rewritten );
+   BOOST_TEST( rewritten == content );
+
+   // a file that can not be read does not prevent startup
+   auto reopen_with = [&]( const string& file_content ) {
+      std::ofstream out( filename.generic_string().c_str(), std::ios::out | std::ios::binary | std::ofstream::trunc );
+      out.write( file_content.data(), file_content.size() );
+      out.close();
+      chain.open();
+      BOOST_TEST( !chain.is_code_preinstantiated( "asserter"_n ) );
+      push_assertdef();
+      chain.close();
+   };
+
+   string corrupt = content;
+   corrupt[0] = ~corrupt[0];
+   reopen_with( corrupt );
+   reopen_with( content.substr( 0, content.size() - 1 ) );
+   reopen_with( content.substr( 0, 3 ) );
+   reopen_with( string{} );
+
+   chain.open();
+   BOOST_TEST( chain.is_code_preinstantiated( "asserter"_n ) );
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()